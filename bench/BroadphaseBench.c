@@ -0,0 +1,159 @@
+// SPDX-License-Identifier: Beerware
+/**
+ * @file      BroadphaseBench.c
+ * @brief     Broadphase benchmark
+ * @details   Compares sweep-and-prune and the spatial hash against the
+ *            brute-force double loop over AABB_BoxesDoIntersect().
+ * @author    Michael Fitzmayer
+ * @copyright "THE BEER-WARE LICENCE" (Revision 42)
+ */
+
+#define SDL_MAIN_HANDLED
+#include <stdio.h>
+#include <SDL.h>
+#include "AABB.h"
+#include "Broadphase.h"
+#include "Scalar.h"
+
+#define BENCH_FRAMES    10
+#define BENCH_CELL_SIZE 32.0
+
+static Uint32 u32Seed = 0x2545F491;
+
+static double _Random(const double dMin, const double dMax)
+{
+    u32Seed ^= u32Seed << 13;
+    u32Seed ^= u32Seed >> 17;
+    u32Seed ^= u32Seed << 5;
+
+    return dMin + (dMax - dMin) * (double)u32Seed / (double)0xFFFFFFFF;
+}
+
+static double _GetTime(void)
+{
+    return (double)SDL_GetPerformanceCounter() * 1000.0 / (double)SDL_GetPerformanceFrequency();
+}
+
+static Uint32 _BruteForce(const Uint32 u32Count, const AABB* pstBB)
+{
+    Uint32 u32Pairs = 0;
+
+    for (Uint32 u32A = 0; u32A < u32Count; u32A++)
+    {
+        for (Uint32 u32B = u32A + 1; u32B < u32Count; u32B++)
+        {
+            if (AABB_BoxesDoIntersect(pstBB[u32A], pstBB[u32B]))
+            {
+                u32Pairs++;
+            }
+        }
+    }
+
+    return u32Pairs;
+}
+
+static void _Move(const Uint32 u32Count, AABB* pstBB)
+{
+    for (Uint32 u32Index = 0; u32Index < u32Count; u32Index++)
+    {
+        Scalar dDeltaX = Scalar_FromDouble(_Random(-2.0, 2.0));
+        Scalar dDeltaY = Scalar_FromDouble(_Random(-2.0, 2.0));
+
+        pstBB[u32Index].dLeft += dDeltaX;
+        pstBB[u32Index].dRight += dDeltaX;
+        pstBB[u32Index].dTop += dDeltaY;
+        pstBB[u32Index].dBottom += dDeltaY;
+    }
+}
+
+static int _Run(const Uint32 u32Count)
+{
+    double      dWorldSize = SDL_sqrt((double)u32Count) * 48.0;
+    AABB*       pstBB      = SDL_malloc(u32Count * sizeof(struct AABB_t));
+    Broadphase* apstBroadphase[2];
+    const char* apacName[2] = { "sweep-and-prune", "spatial hash" };
+    Uint32      u32Pairs;
+    double      dStart;
+
+    if (!pstBB)
+    {
+        return -1;
+    }
+
+    for (Uint32 u32Index = 0; u32Index < u32Count; u32Index++)
+    {
+        double dPosX = _Random(0.0, dWorldSize);
+        double dPosY = _Random(0.0, dWorldSize);
+
+        pstBB[u32Index].dLeft   = Scalar_FromDouble(dPosX);
+        pstBB[u32Index].dTop    = Scalar_FromDouble(dPosY);
+        pstBB[u32Index].dRight  = Scalar_FromDouble(dPosX + _Random(8.0, 32.0));
+        pstBB[u32Index].dBottom = Scalar_FromDouble(dPosY + _Random(8.0, 32.0));
+    }
+
+    dStart   = _GetTime();
+    u32Pairs = _BruteForce(u32Count, pstBB);
+    printf(
+        "%6u boxes  %-16s %10.3f ms  %u pairs\n",
+        u32Count,
+        "brute force",
+        _GetTime() - dStart,
+        u32Pairs);
+
+    if (-1 == Broadphase_Init(BROADPHASE_SWEEP_AND_PRUNE, 0.0, &apstBroadphase[0]) ||
+        -1 == Broadphase_Init(BROADPHASE_SPATIAL_HASH, BENCH_CELL_SIZE, &apstBroadphase[1]))
+    {
+        return -1;
+    }
+
+    for (Uint8 u8Method = 0; u8Method < 2; u8Method++)
+    {
+        const BroadphasePair* pstPair;
+
+        // The first update sorts or sizes everything from scratch.
+        if (-1 == Broadphase_Update(u32Count, pstBB, apstBroadphase[u8Method]) ||
+            u32Pairs != Broadphase_GetPairs(&pstPair, apstBroadphase[u8Method]))
+        {
+            printf("%s: pair mismatch\n", apacName[u8Method]);
+            return -1;
+        }
+    }
+
+    for (Uint8 u8Method = 0; u8Method < 2; u8Method++)
+    {
+        double dTime = 0.0;
+
+        for (Uint8 u8Frame = 0; u8Frame < BENCH_FRAMES; u8Frame++)
+        {
+            _Move(u32Count, pstBB);
+
+            dStart = _GetTime();
+            Broadphase_Update(u32Count, pstBB, apstBroadphase[u8Method]);
+            dTime += _GetTime() - dStart;
+        }
+
+        printf(
+            "%6u boxes  %-16s %10.3f ms\n", u32Count, apacName[u8Method], dTime / BENCH_FRAMES);
+    }
+
+    Broadphase_Free(apstBroadphase[0]);
+    Broadphase_Free(apstBroadphase[1]);
+    SDL_free(pstBB);
+
+    return 0;
+}
+
+int main(void)
+{
+    const Uint32 au32Count[] = { 1000, 10000, 50000 };
+
+    for (Uint8 u8Index = 0; u8Index < 3; u8Index++)
+    {
+        if (0 != _Run(au32Count[u8Index]))
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
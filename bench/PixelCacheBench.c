@@ -0,0 +1,106 @@
+// SPDX-License-Identifier: Beerware
+/**
+ * @file      PixelCacheBench.c
+ * @brief     Pixel cache benchmark
+ * @details   Measures how long loading a set of images as textures
+ *            takes without the pixel cache, with a cold one that still
+ *            has to decode and store every image, and with a warm one,
+ *            see Asset_SetPixelCache().  Pass an empty directory for
+ *            the cold run to be cold.
+ * @author    Michael Fitzmayer
+ * @copyright "THE BEER-WARE LICENCE" (Revision 42)
+ */
+
+#define SDL_MAIN_HANDLED
+#include <stdio.h>
+#include <SDL.h>
+#include <SDL_image.h>
+#include "Asset.h"
+
+static double _GetTime(void)
+{
+    return (double)SDL_GetPerformanceCounter() * 1000.0 / (double)SDL_GetPerformanceFrequency();
+}
+
+static int _Run(
+    const char*   pacName,
+    const char*   pacDirectory,
+    const int     iFileCount,
+    char**        ppacFiles,
+    SDL_Renderer* pstRenderer)
+{
+    AssetCache* pstCache;
+    double      dStart;
+    double      dTime;
+
+    if (-1 == Asset_Init(&pstCache) ||
+        -1 == Asset_SetPixelCache(pacDirectory, pstRenderer, pstCache))
+    {
+        return -1;
+    }
+
+    dStart = _GetTime();
+    for (int iIndex = 0; iIndex < iFileCount; iIndex++)
+    {
+        if (!Asset_LoadTexture(ppacFiles[iIndex], pstRenderer, pstCache))
+        {
+            Asset_Free(pstCache);
+            return -1;
+        }
+    }
+    dTime = _GetTime() - dStart;
+
+    printf("%-12s %10.3f ms  %d image(s)\n", pacName, dTime, iFileCount);
+
+    Asset_Free(pstCache);
+
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    SDL_Window*   pstWindow;
+    SDL_Renderer* pstRenderer;
+    int           iResult = 1;
+
+    if (argc < 3)
+    {
+        printf("Usage: %s cache-directory image...\n", argv[0]);
+        return 1;
+    }
+
+    if (0 != SDL_Init(SDL_INIT_VIDEO) || !IMG_Init(IMG_INIT_PNG))
+    {
+        printf("%s\n", SDL_GetError());
+        return 1;
+    }
+
+    pstWindow   = SDL_CreateWindow("", 0, 0, 64, 64, SDL_WINDOW_HIDDEN);
+    pstRenderer = pstWindow ? SDL_CreateRenderer(pstWindow, -1, 0) : NULL;
+
+    if (pstRenderer &&
+        0 == _Run("no cache", NULL, argc - 2, &argv[2], pstRenderer) &&
+        0 == _Run("cold cache", argv[1], argc - 2, &argv[2], pstRenderer) &&
+        0 == _Run("warm cache", argv[1], argc - 2, &argv[2], pstRenderer))
+    {
+        iResult = 0;
+    }
+    else
+    {
+        printf("%s\n", SDL_GetError());
+    }
+
+    if (pstRenderer)
+    {
+        SDL_DestroyRenderer(pstRenderer);
+    }
+    if (pstWindow)
+    {
+        SDL_DestroyWindow(pstWindow);
+    }
+
+    IMG_Quit();
+    SDL_Quit();
+
+    return iResult;
+}
@@ -0,0 +1,152 @@
+// SPDX-License-Identifier: Beerware
+/**
+ * @file      ScalarBench.c
+ * @brief     Scalar type benchmark
+ * @details   Measures the hot paths that depend on the scalar type, see
+ *            the ESZFW_SCALAR CMake option: entity updates one by one
+ *            and as entity world, and the batch AABB tests.  The
+ *            largest run stays within the range of 16.16 fixed-point
+ *            positions.
+ * @author    Michael Fitzmayer
+ * @copyright "THE BEER-WARE LICENCE" (Revision 42)
+ */
+
+#define SDL_MAIN_HANDLED
+#include <stdio.h>
+#include <SDL.h>
+#include "AABB.h"
+#include "Entity.h"
+#include "Scalar.h"
+
+#define BENCH_FRAMES      20
+#define BENCH_GRAVITATION 9.81
+#define BENCH_METER       16
+#define BENCH_QUERIES     256
+
+static Uint32 u32Seed = 0x2545F491;
+
+static double _Random(const double dMin, const double dMax)
+{
+    u32Seed ^= u32Seed << 13;
+    u32Seed ^= u32Seed >> 17;
+    u32Seed ^= u32Seed << 5;
+
+    return dMin + (dMax - dMin) * (double)u32Seed / (double)0xFFFFFFFF;
+}
+
+static double _GetTime(void)
+{
+    return (double)SDL_GetPerformanceCounter() * 1000.0 / (double)SDL_GetPerformanceFrequency();
+}
+
+static AABB _GetRandomBox(const double dWorldSize)
+{
+    double dPosX = _Random(0.0, dWorldSize);
+    double dPosY = _Random(0.0, dWorldSize);
+    AABB   stBB;
+
+    stBB.dBottom = Scalar_FromDouble(dPosY + _Random(8.0, 32.0));
+    stBB.dLeft   = Scalar_FromDouble(dPosX);
+    stBB.dRight  = Scalar_FromDouble(dPosX + _Random(8.0, 32.0));
+    stBB.dTop    = Scalar_FromDouble(dPosY);
+
+    return stBB;
+}
+
+static int _Run(const Uint32 u32Count)
+{
+    double       dWorldSize = SDL_sqrt((double)u32Count) * 48.0;
+    Entity*      pstEntity  = SDL_calloc(u32Count, sizeof(struct Entity_t));
+    Uint32*      pu32Mask   = SDL_calloc(AABB_MASK_WORDS(u32Count), sizeof(Uint32));
+    EntityWorld* pstWorld;
+    AABBArray*   pstArray;
+    double       dStart;
+    double       dTime;
+    Uint32       u32Hits = 0;
+
+    if (!pstEntity || !pu32Mask)
+    {
+        return -1;
+    }
+
+    if (-1 == Entity_InitWorld(u32Count, &pstWorld) || -1 == AABB_InitArray(u32Count, &pstArray))
+    {
+        return -1;
+    }
+
+    for (Uint32 u32Index = 0; u32Index < u32Count; u32Index++)
+    {
+        Entity* pstTemplate;
+
+        if (-1 == Entity_Init(_Random(0.0, dWorldSize), 0.0, 16, 32, &pstTemplate))
+        {
+            return -1;
+        }
+
+        Entity_Move(pstTemplate);
+        Entity_Drop(pstTemplate);
+        Entity_SetDirection((u32Index & 1) ? LEFT : RIGHT, pstTemplate);
+
+        pstEntity[u32Index] = *pstTemplate;
+        Entity_AddToWorld(pstTemplate, pstWorld);
+        AABB_AddToArray(_GetRandomBox(dWorldSize), pstArray);
+        Entity_Free(pstTemplate);
+    }
+
+    dStart = _GetTime();
+    for (Uint8 u8Frame = 0; u8Frame < BENCH_FRAMES; u8Frame++)
+    {
+        for (Uint32 u32Index = 0; u32Index < u32Count; u32Index++)
+        {
+            Entity_Update(DELTA_TIME, BENCH_GRAVITATION, BENCH_METER, &pstEntity[u32Index]);
+        }
+    }
+    dTime = _GetTime() - dStart;
+    printf("%7u  %-24s %10.3f ms\n", u32Count, "Entity_Update()", dTime / BENCH_FRAMES);
+
+    dStart = _GetTime();
+    for (Uint8 u8Frame = 0; u8Frame < BENCH_FRAMES; u8Frame++)
+    {
+        Entity_UpdateAll(DELTA_TIME, BENCH_GRAVITATION, BENCH_METER, 0, NULL, pstWorld, NULL);
+    }
+    dTime = _GetTime() - dStart;
+    printf("%7u  %-24s %10.3f ms\n", u32Count, "Entity_UpdateAll()", dTime / BENCH_FRAMES);
+
+    dStart = _GetTime();
+    for (Uint32 u32Query = 0; u32Query < BENCH_QUERIES; u32Query++)
+    {
+        u32Hits += AABB_TestOneVsMany(_GetRandomBox(dWorldSize), pstArray, pu32Mask);
+    }
+    dTime = _GetTime() - dStart;
+    printf(
+        "%7u  %-24s %10.3f ms  %u hits\n",
+        u32Count,
+        "AABB_TestOneVsMany()",
+        dTime / BENCH_QUERIES,
+        u32Hits);
+
+    AABB_FreeArray(pstArray);
+    Entity_FreeWorld(pstWorld);
+    SDL_free(pu32Mask);
+    SDL_free(pstEntity);
+
+    return 0;
+}
+
+int main(void)
+{
+    const char*  apacMode[] = { "double", "float", "16.16 fixed-point" };
+    const Uint32 au32Count[] = { 10000, 100000, 400000 };
+
+    printf("Scalar type: %s\n", apacMode[SCALAR_MODE]);
+
+    for (Uint8 u8Index = 0; u8Index < 3; u8Index++)
+    {
+        if (0 != _Run(au32Count[u8Index]))
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
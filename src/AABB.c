@@ -10,6 +10,100 @@
 
 #include <SDL.h>
 #include "AABB.h"
+#include "Simd.h"
+
+static Uint32 _Test(
+    const AABB       stBB,
+    const AABBArray* pstArray,
+    Uint32*          pu32Mask,
+    Uint32*          pu32Index,
+    const Uint32     u32MaxResults)
+{
+    SimdScalar vBottom = Simd_Set(stBB.dBottom);
+    SimdScalar vLeft   = Simd_Set(stBB.dLeft);
+    SimdScalar vRight  = Simd_Set(stBB.dRight);
+    SimdScalar vTop    = Simd_Set(stBB.dTop);
+    Uint32     u32Hits = 0;
+
+    if (pu32Mask)
+    {
+        SDL_memset(pu32Mask, 0, AABB_MASK_WORDS(pstArray->u32Count) * sizeof(Uint32));
+    }
+
+    // Lanes past the last box read padding and are masked out.
+    for (Uint32 u32Index = 0; u32Index < pstArray->u32Count; u32Index += SIMD_WIDTH)
+    {
+        SimdMask mX = Simd_And(
+            Simd_CmpLe(Simd_Load(&pstArray->pdLeft[u32Index]), vRight),
+            Simd_CmpLe(vLeft, Simd_Load(&pstArray->pdRight[u32Index])));
+        SimdMask mY = Simd_And(
+            Simd_CmpLe(Simd_Load(&pstArray->pdTop[u32Index]), vBottom),
+            Simd_CmpLe(vTop, Simd_Load(&pstArray->pdBottom[u32Index])));
+        Uint32 u32Bits = (Uint32)Simd_MoveMask(Simd_And(mX, mY));
+
+        if (pstArray->u32Count - u32Index < SIMD_WIDTH)
+        {
+            u32Bits &= (1u << (pstArray->u32Count - u32Index)) - 1;
+        }
+
+        if (0 == u32Bits)
+        {
+            continue;
+        }
+
+        // SIMD_WIDTH divides 32, so the bits never span two words.
+        if (pu32Mask)
+        {
+            pu32Mask[u32Index / 32] |= u32Bits << (u32Index % 32);
+        }
+
+        for (Uint32 u32Lane = 0; u32Lane < SIMD_WIDTH; u32Lane++)
+        {
+            if (!((u32Bits >> u32Lane) & 1))
+            {
+                continue;
+            }
+
+            if (pu32Index)
+            {
+                if (u32Hits >= u32MaxResults)
+                {
+                    return u32Hits;
+                }
+                pu32Index[u32Hits] = u32Index + u32Lane;
+            }
+            u32Hits++;
+        }
+    }
+
+    return u32Hits;
+}
+
+/**
+ * @brief   Add box to array
+ * @details Appends a box to an axis-aligned bounding box array
+ * @param   stBB
+ *          Box to add
+ * @param   pstArray
+ *          Pointer to box array handle
+ * @return  Index of the box
+ * @retval  -1: Array is full
+ */
+Sint32 AABB_AddToArray(const AABB stBB, AABBArray* pstArray)
+{
+    Uint32 u32Index = pstArray->u32Count;
+
+    if (u32Index >= pstArray->u32Capacity)
+    {
+        SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "AddToArray(): box array is full.\n");
+        return -1;
+    }
+
+    pstArray->u32Count++;
+    AABB_SetInArray(u32Index, stBB, pstArray);
+
+    return (Sint32)u32Index;
+}
 
 /**
  * @brief   Check if two axis-aligned bounding boxes intersect
@@ -25,10 +119,10 @@
  */
 SDL_bool AABB_BoxesDoIntersect(const AABB stBoxA, const AABB stBoxB)
 {
-    double dAx = stBoxB.dLeft - stBoxA.dRight;
-    double dAy = stBoxB.dTop  - stBoxA.dBottom;
-    double dBx = stBoxA.dLeft - stBoxB.dRight;
-    double dBy = stBoxA.dTop  - stBoxB.dBottom;
+    Scalar dAx = stBoxB.dLeft - stBoxA.dRight;
+    Scalar dAy = stBoxB.dTop  - stBoxA.dBottom;
+    Scalar dBx = stBoxA.dLeft - stBoxB.dRight;
+    Scalar dBy = stBoxA.dTop  - stBoxB.dBottom;
 
     if (dAx > 0.0 || dAy > 0.0)
     {
@@ -42,3 +136,185 @@ SDL_bool AABB_BoxesDoIntersect(const AABB stBoxA, const AABB stBoxB)
 
     return SDL_TRUE;
 }
+
+/**
+ * @brief   Free box array
+ * @details Frees up allocated memory of an axis-aligned bounding box
+ *          array
+ * @param   pstArray
+ *          Pointer to box array handle
+ */
+void AABB_FreeArray(AABBArray* pstArray)
+{
+    if (pstArray)
+    {
+        // All streams share one allocation.
+        SDL_free(pstArray->pdBottom);
+        SDL_free(pstArray);
+    }
+}
+
+/**
+ * @brief   Get intersecting boxes
+ * @details Determines all boxes of an array that intersect a box
+ * @param   stBB
+ *          Box to test
+ * @param   pstArray
+ *          Pointer to box array handle
+ * @param   pu32Index
+ *          Array to store the indices of the intersecting boxes
+ * @param   u32MaxResults
+ *          Capacity of the index array
+ * @return  Number of indices stored
+ */
+Uint32 AABB_GetIntersecting(
+    const AABB       stBB,
+    const AABBArray* pstArray,
+    Uint32*          pu32Index,
+    const Uint32     u32MaxResults)
+{
+    return _Test(stBB, pstArray, NULL, pu32Index, u32MaxResults);
+}
+
+/**
+ * @brief   Initialise box array
+ * @details Initialises an empty axis-aligned bounding box array
+ * @param   u32Capacity
+ *          Max. number of boxes
+ * @param   pstArray
+ *          Pointer to box array handle
+ * @return  Error code
+ * @retval   0: OK
+ * @retval  -1: Error
+ */
+Sint8 AABB_InitArray(const Uint32 u32Capacity, AABBArray** pstArray)
+{
+    Uint32 u32Padded = (u32Capacity + SIMD_PADDING - 1) & ~(Uint32)(SIMD_PADDING - 1);
+
+    *pstArray = SDL_calloc(sizeof(struct AABBArray_t), sizeof(Sint8));
+    if (!*pstArray)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InitArray(): error allocating memory.\n");
+        return -1;
+    }
+
+    (*pstArray)->pdBottom = SDL_calloc((size_t)u32Padded * 4 + SIMD_PADDING, sizeof(Scalar));
+    if (!(*pstArray)->pdBottom)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InitArray(): error allocating memory.\n");
+        SDL_free(*pstArray);
+        *pstArray = NULL;
+        return -1;
+    }
+
+    (*pstArray)->u32Capacity = u32Capacity;
+    (*pstArray)->pdLeft      = (*pstArray)->pdBottom + u32Padded;
+    (*pstArray)->pdRight     = (*pstArray)->pdLeft + u32Padded;
+    (*pstArray)->pdTop       = (*pstArray)->pdRight + u32Padded;
+
+    return 0;
+}
+
+/**
+ * @brief   Remove box from array
+ * @details Removes a box by moving the last box into its place
+ * @param   u32Index
+ *          Index of the box
+ * @param   pstArray
+ *          Pointer to box array handle
+ */
+void AABB_RemoveFromArray(const Uint32 u32Index, AABBArray* pstArray)
+{
+    Uint32 u32Last;
+
+    if (u32Index >= pstArray->u32Count)
+    {
+        return;
+    }
+
+    u32Last = pstArray->u32Count - 1;
+
+    pstArray->pdBottom[u32Index] = pstArray->pdBottom[u32Last];
+    pstArray->pdLeft[u32Index]   = pstArray->pdLeft[u32Last];
+    pstArray->pdRight[u32Index]  = pstArray->pdRight[u32Last];
+    pstArray->pdTop[u32Index]    = pstArray->pdTop[u32Last];
+    pstArray->u32Count--;
+}
+
+/**
+ * @brief   Set box in array
+ * @details Overwrites a box of an axis-aligned bounding box array
+ * @param   u32Index
+ *          Index of the box
+ * @param   stBB
+ *          New box
+ * @param   pstArray
+ *          Pointer to box array handle
+ */
+void AABB_SetInArray(const Uint32 u32Index, const AABB stBB, AABBArray* pstArray)
+{
+    if (u32Index >= pstArray->u32Count)
+    {
+        return;
+    }
+
+    pstArray->pdBottom[u32Index] = stBB.dBottom;
+    pstArray->pdLeft[u32Index]   = stBB.dLeft;
+    pstArray->pdRight[u32Index]  = stBB.dRight;
+    pstArray->pdTop[u32Index]    = stBB.dTop;
+}
+
+/**
+ * @brief   Test many boxes against many boxes
+ * @details Tests every box of array A against all boxes of array B,
+ *          e.g. bullets against tiles
+ * @param   pstArrayA
+ *          Pointer to box array handle A
+ * @param   pstArrayB
+ *          Pointer to box array handle B
+ * @param   pu32Mask
+ *          Array to store one bitmask row per box of A, each row
+ *          AABB_MASK_WORDS(B count) words long.  Bit n of a row is set
+ *          if the box intersects box n of B.
+ * @return  Number of intersecting pairs
+ */
+Uint32 AABB_TestManyVsMany(
+    const AABBArray* pstArrayA,
+    const AABBArray* pstArrayB,
+    Uint32*          pu32Mask)
+{
+    Uint32 u32Words = AABB_MASK_WORDS(pstArrayB->u32Count);
+    Uint32 u32Hits  = 0;
+
+    for (Uint32 u32Index = 0; u32Index < pstArrayA->u32Count; u32Index++)
+    {
+        AABB stBB;
+
+        stBB.dBottom = pstArrayA->pdBottom[u32Index];
+        stBB.dLeft   = pstArrayA->pdLeft[u32Index];
+        stBB.dRight  = pstArrayA->pdRight[u32Index];
+        stBB.dTop    = pstArrayA->pdTop[u32Index];
+
+        u32Hits += _Test(stBB, pstArrayB, &pu32Mask[u32Index * u32Words], NULL, 0);
+    }
+
+    return u32Hits;
+}
+
+/**
+ * @brief   Test one box against many boxes
+ * @details Tests a box against all boxes of an array, e.g. a trigger
+ *          against all entities or the camera against all sprites
+ * @param   stBB
+ *          Box to test
+ * @param   pstArray
+ *          Pointer to box array handle
+ * @param   pu32Mask
+ *          Array of AABB_MASK_WORDS(count) words to store the result.
+ *          Bit n is set if the box intersects box n of the array.
+ * @return  Number of intersecting boxes
+ */
+Uint32 AABB_TestOneVsMany(const AABB stBB, const AABBArray* pstArray, Uint32* pu32Mask)
+{
+    return _Test(stBB, pstArray, pu32Mask, NULL, 0);
+}
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <SDL.h>
+#include "Scalar.h"
 
 /**
  * @typedef AABB
@@ -16,11 +17,56 @@
  */
 typedef struct AABB_t
 {
-    double dBottom;  ///< Bottom edge position
-    double dLeft;    ///< Left edge position
-    double dRight;   ///< Right edge position
-    double dTop;     ///< Top edge position
+    Scalar dBottom;  ///< Bottom edge position
+    Scalar dLeft;    ///< Left edge position
+    Scalar dRight;   ///< Right edge position
+    Scalar dTop;     ///< Top edge position
 
 } AABB;
 
+/**
+ * @def     AABB_MASK_WORDS
+ * @brief   Number of 32-bit words of a bitmask with one bit per box
+ */
+#define AABB_MASK_WORDS(u32Count) (((u32Count) + 31) / 32)
+
+/**
+ * @typedef AABBArray
+ * @brief   Axis-aligned bounding box array handle type
+ * @struct  AABBArray_t
+ * @brief   Axis-aligned bounding boxes stored as structure of arrays
+ * @details Each edge is stored in a separate stream so many boxes can
+ *          be tested at once.  The streams are padded to a multiple of
+ *          SIMD_PADDING and share one allocation.
+ */
+typedef struct AABBArray_t
+{
+    Uint32  u32Count;     ///< Number of boxes
+    Uint32  u32Capacity;  ///< Max. number of boxes
+    Scalar* pdBottom;     ///< Bottom edge positions
+    Scalar* pdLeft;       ///< Left edge positions
+    Scalar* pdRight;      ///< Right edge positions
+    Scalar* pdTop;        ///< Top edge positions
+
+} AABBArray;
+
+Sint32   AABB_AddToArray(const AABB stBB, AABBArray* pstArray);
 SDL_bool AABB_BoxesDoIntersect(const AABB stBoxA, const AABB stBoxB);
+void     AABB_FreeArray(AABBArray* pstArray);
+
+Uint32 AABB_GetIntersecting(
+    const AABB       stBB,
+    const AABBArray* pstArray,
+    Uint32*          pu32Index,
+    const Uint32     u32MaxResults);
+
+Sint8 AABB_InitArray(const Uint32 u32Capacity, AABBArray** pstArray);
+void  AABB_RemoveFromArray(const Uint32 u32Index, AABBArray* pstArray);
+void  AABB_SetInArray(const Uint32 u32Index, const AABB stBB, AABBArray* pstArray);
+
+Uint32 AABB_TestManyVsMany(
+    const AABBArray* pstArrayA,
+    const AABBArray* pstArrayB,
+    Uint32*          pu32Mask);
+
+Uint32 AABB_TestOneVsMany(const AABB stBB, const AABBArray* pstArray, Uint32* pu32Mask);
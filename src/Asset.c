@@ -0,0 +1,1246 @@
+// SPDX-License-Identifier: Beerware
+/**
+ * @file      Asset.c
+ * @ingroup   Asset
+ * @defgroup  Asset Reference-counted asset cache
+ * @author    Michael Fitzmayer
+ * @copyright "THE BEER-WARE LICENCE" (Revision 42)
+ */
+
+#include <SDL.h>
+#include <SDL_image.h>
+#include <SDL_mixer.h>
+#include <SDL_ttf.h>
+#include "Asset.h"
+#include "Pack.h"
+#include "Utils.h"
+
+static AssetCache* _pstDefaultCache = NULL;
+
+static void _Destroy(const AssetType eType, void* pAsset)
+{
+    switch (eType)
+    {
+        case ASSET_TEXTURE:
+            SDL_DestroyTexture(pAsset);
+            break;
+        case ASSET_IMAGE:
+            SDL_FreeSurface(pAsset);
+            break;
+        case ASSET_MUSIC:
+            Mix_FreeMusic(pAsset);
+            break;
+        case ASSET_FONT:
+            TTF_CloseFont(pAsset);
+            break;
+        default:
+            break;
+    }
+}
+
+static AssetEntry* _Find(
+    const AssetType eType,
+    const char*     pacPath,
+    const Uint32    u32Hash,
+    const uintptr_t uParam,
+    AssetCache*     pstCache)
+{
+    for (Uint32 u32Index = 0; u32Index < pstCache->u32Count; u32Index++)
+    {
+        AssetEntry* pstEntry = &pstCache->pstEntry[u32Index];
+
+        if (u32Hash == pstEntry->u32Hash && eType == pstEntry->eType &&
+            uParam == pstEntry->uParam && 0 == SDL_strcmp(pacPath, pstEntry->acPath))
+        {
+            return pstEntry;
+        }
+    }
+
+    return NULL;
+}
+
+static size_t _GetBytes(const AssetType eType, const char* pacFileName, void* pAsset)
+{
+    SDL_RWops* pstFile;
+    Sint64     s64Size;
+
+    if (ASSET_TEXTURE == eType)
+    {
+        Uint32 u32Format;
+        int    iWidth;
+        int    iHeight;
+
+        if (0 != SDL_QueryTexture(pAsset, &u32Format, NULL, &iWidth, &iHeight))
+        {
+            return 0;
+        }
+
+        return (size_t)iWidth * (size_t)iHeight * SDL_BYTESPERPIXEL(u32Format);
+    }
+
+    if (ASSET_IMAGE == eType)
+    {
+        SDL_Surface* pstImage = pAsset;
+
+        return (size_t)pstImage->pitch * (size_t)pstImage->h;
+    }
+
+    // Music and fonts are estimated by the size of their file.
+    s64Size = Pack_GetSize(pacFileName, Pack_GetDefaultPack());
+    if (s64Size >= 0)
+    {
+        return (size_t)s64Size;
+    }
+
+    pstFile = SDL_RWFromFile(pacFileName, "rb");
+    if (!pstFile)
+    {
+        return 0;
+    }
+
+    s64Size = SDL_RWsize(pstFile);
+    SDL_RWclose(pstFile);
+
+    return (0 < s64Size) ? (size_t)s64Size : 0;
+}
+
+static Uint32 _Hash(const AssetType eType, const char* pacPath, const uintptr_t uParam)
+{
+    // FNV-1a
+    Uint32 u32Hash = 2166136261u ^ (Uint32)eType;
+
+    for (const char* pacChar = pacPath; '\0' != *pacChar; pacChar++)
+    {
+        u32Hash ^= (Uint8)*pacChar;
+        u32Hash *= 16777619u;
+    }
+
+    return u32Hash ^ (Uint32)uParam;
+}
+
+static const char* _GetFileType(const char* pacFileName)
+{
+    // The extension is passed on as type for formats without a
+    // signature, e.g. TGA.
+    const char* pacType = SDL_strrchr(pacFileName, '.');
+
+    return pacType ? pacType + 1 : NULL;
+}
+
+static void* _Decode(const AssetType eType, const char* pacFileName, const uintptr_t uParam)
+{
+    const Pack* pstPack = Pack_GetDefaultPack();
+    const char* pacType = _GetFileType(pacFileName);
+    SDL_RWops*  pstRW   = NULL;
+    void*       pAsset  = NULL;
+
+    // Packed files are read through a stream that the loaders close,
+    // loose files are opened by the loaders themselves.
+    if (Pack_Contains(pacFileName, pstPack))
+    {
+        pstRW = Pack_OpenRW(pacFileName, pstPack);
+        if (!pstRW)
+        {
+            return NULL;
+        }
+    }
+
+    switch (eType)
+    {
+        case ASSET_TEXTURE:
+            pAsset = pstRW
+                ? IMG_LoadTextureTyped_RW((SDL_Renderer*)uParam, pstRW, 1, pacType)
+                : IMG_LoadTexture((SDL_Renderer*)uParam, pacFileName);
+            if (!pAsset)
+            {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", IMG_GetError());
+            }
+            break;
+        case ASSET_IMAGE:
+            pAsset = pstRW ? IMG_LoadTyped_RW(pstRW, 1, pacType) : IMG_Load(pacFileName);
+            if (!pAsset)
+            {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", IMG_GetError());
+            }
+            break;
+        case ASSET_MUSIC:
+            pAsset = pstRW ? Mix_LoadMUS_RW(pstRW, 1) : Mix_LoadMUS(pacFileName);
+            if (!pAsset)
+            {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", Mix_GetError());
+            }
+            break;
+        case ASSET_FONT:
+            pAsset = pstRW
+                ? TTF_OpenFontRW(pstRW, 1, (int)uParam)
+                : TTF_OpenFont(pacFileName, (int)uParam);
+            if (!pAsset)
+            {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", TTF_GetError());
+            }
+            break;
+        default:
+            if (pstRW)
+            {
+                SDL_RWclose(pstRW);
+            }
+            break;
+    }
+
+    return pAsset;
+}
+
+static Uint32 _HashData(const Uint8* pu8Data, const size_t zSize)
+{
+    // FNV-1a
+    Uint32 u32Hash = 2166136261u;
+
+    for (size_t zIndex = 0; zIndex < zSize; zIndex++)
+    {
+        u32Hash ^= pu8Data[zIndex];
+        u32Hash *= 16777619u;
+    }
+
+    return u32Hash;
+}
+
+static SDL_Surface* _ReadPixels(const char* pacCacheFile, const AssetPixelHeader* pstKey)
+{
+    AssetPixelHeader stHeader;
+    SDL_Surface*     pstImage;
+    SDL_RWops*       pstRW;
+    Uint64           u64Row;
+    Uint64           u64Size;
+
+    // A missing file is the usual cold start, not an error.
+    pstRW = SDL_RWFromFile(pacCacheFile, "rb");
+    if (!pstRW)
+    {
+        return NULL;
+    }
+
+    if (1 != SDL_RWread(pstRW, &stHeader, sizeof(struct AssetPixelHeader_t), 1) ||
+        0 != SDL_memcmp(stHeader.acMagic, pstKey->acMagic, 4) ||
+        pstKey->u32Version != stHeader.u32Version ||
+        pstKey->u32SourceHash != stHeader.u32SourceHash ||
+        pstKey->u32SourceSize != stHeader.u32SourceSize ||
+        pstKey->u32Format != stHeader.u32Format)
+    {
+        SDL_RWclose(pstRW);
+        return NULL;
+    }
+
+    // Files cut short by an interrupted write are decoded again.
+    u64Row = (Uint64)stHeader.u32Width * SDL_BYTESPERPIXEL(stHeader.u32Format);
+    u64Size = sizeof(struct AssetPixelHeader_t) + u64Row * stHeader.u32Height;
+    if (0 == stHeader.u32Width || 0 == stHeader.u32Height ||
+        stHeader.u32Width > SDL_MAX_SINT32 || stHeader.u32Height > SDL_MAX_SINT32 ||
+        (Sint64)u64Size != SDL_RWsize(pstRW))
+    {
+        SDL_RWclose(pstRW);
+        return NULL;
+    }
+
+    pstImage = SDL_CreateRGBSurfaceWithFormat(
+        0,
+        (int)stHeader.u32Width,
+        (int)stHeader.u32Height,
+        SDL_BITSPERPIXEL(stHeader.u32Format),
+        stHeader.u32Format);
+    if (!pstImage)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+        SDL_RWclose(pstRW);
+        return NULL;
+    }
+
+    for (Uint32 u32Row = 0; u32Row < stHeader.u32Height; u32Row++)
+    {
+        Uint8* pu8Row = (Uint8*)pstImage->pixels + (size_t)u32Row * (size_t)pstImage->pitch;
+
+        if (1 != SDL_RWread(pstRW, pu8Row, (size_t)u64Row, 1))
+        {
+            SDL_FreeSurface(pstImage);
+            SDL_RWclose(pstRW);
+            return NULL;
+        }
+    }
+
+    SDL_RWclose(pstRW);
+
+    return pstImage;
+}
+
+static void _WritePixels(
+    const char*       pacCacheFile,
+    AssetPixelHeader* pstHeader,
+    SDL_Surface*      pstImage)
+{
+    size_t     zRow = (size_t)pstImage->w * SDL_BYTESPERPIXEL(pstHeader->u32Format);
+    SDL_RWops* pstRW;
+
+    pstHeader->u32Width  = (Uint32)pstImage->w;
+    pstHeader->u32Height = (Uint32)pstImage->h;
+
+    // Jobs that decode the same image at once write the same content;
+    // a file that is left incomplete fails the size check.
+    pstRW = SDL_RWFromFile(pacCacheFile, "wb");
+    if (!pstRW)
+    {
+        SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+        return;
+    }
+
+    if (1 != SDL_RWwrite(pstRW, pstHeader, sizeof(struct AssetPixelHeader_t), 1))
+    {
+        SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+        SDL_RWclose(pstRW);
+        return;
+    }
+
+    for (int iRow = 0; iRow < pstImage->h; iRow++)
+    {
+        const Uint8* pu8Row = (const Uint8*)pstImage->pixels + (size_t)iRow * pstImage->pitch;
+
+        if (1 != SDL_RWwrite(pstRW, pu8Row, zRow, 1))
+        {
+            SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+            break;
+        }
+    }
+
+    SDL_RWclose(pstRW);
+}
+
+static void* _LoadPixels(
+    const AssetType   eType,
+    const char*       pacFileName,
+    const uintptr_t   uParam,
+    const AssetCache* pstCache)
+{
+    char             acCacheFile[ASSET_PATH_LEN + 24];
+    AssetPixelHeader stKey;
+    MappedFile       stFile;
+    SDL_Surface*     pstImage;
+    SDL_Texture*     pstTexture;
+
+    if (-1 == Utils_MapFile(pacFileName, &stFile))
+    {
+        return NULL;
+    }
+
+    SDL_memcpy(stKey.acMagic, "ESZT", 4);
+    stKey.u32Version    = ASSET_PIXEL_VERSION;
+    stKey.u32SourceHash = _HashData(stFile.pData, stFile.zSize);
+    stKey.u32SourceSize = (Uint32)stFile.zSize;
+    stKey.u32Format     = pstCache->u32PixelFormat;
+    stKey.u32Width      = 0;
+    stKey.u32Height     = 0;
+
+    SDL_snprintf(
+        acCacheFile,
+        sizeof(acCacheFile),
+        "%s%08x%08x.pix",
+        pstCache->acPixelCache,
+        stKey.u32SourceHash,
+        stKey.u32SourceSize);
+
+    pstImage = _ReadPixels(acCacheFile, &stKey);
+    if (!pstImage)
+    {
+        SDL_Surface* pstDecoded = NULL;
+        SDL_RWops*   pstRW      = SDL_RWFromConstMem(stFile.pData, (int)stFile.zSize);
+
+        if (pstRW)
+        {
+            pstDecoded = IMG_LoadTyped_RW(pstRW, 1, _GetFileType(pacFileName));
+        }
+
+        if (!pstDecoded)
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", IMG_GetError());
+            Utils_UnmapFile(&stFile);
+            return NULL;
+        }
+
+        pstImage = SDL_ConvertSurfaceFormat(pstDecoded, pstCache->u32PixelFormat, 0);
+        SDL_FreeSurface(pstDecoded);
+        if (!pstImage)
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+            Utils_UnmapFile(&stFile);
+            return NULL;
+        }
+
+        _WritePixels(acCacheFile, &stKey, pstImage);
+    }
+
+    Utils_UnmapFile(&stFile);
+
+    if (ASSET_IMAGE == eType)
+    {
+        return pstImage;
+    }
+
+    // The pixels are in the format the cache was set up for, so the
+    // upload does not have to convert them.
+    pstTexture = SDL_CreateTexture(
+        (SDL_Renderer*)uParam,
+        pstCache->u32PixelFormat,
+        SDL_TEXTUREACCESS_STATIC,
+        pstImage->w,
+        pstImage->h);
+
+    if (!pstTexture || 0 != SDL_UpdateTexture(pstTexture, NULL, pstImage->pixels, pstImage->pitch))
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+        if (pstTexture)
+        {
+            SDL_DestroyTexture(pstTexture);
+        }
+        SDL_FreeSurface(pstImage);
+        return NULL;
+    }
+
+    SDL_SetTextureBlendMode(pstTexture, SDL_BLENDMODE_BLEND);
+    SDL_FreeSurface(pstImage);
+
+    return pstTexture;
+}
+
+static void* _Load(
+    const AssetType   eType,
+    const char*       pacFileName,
+    const uintptr_t   uParam,
+    const AssetCache* pstCache)
+{
+    if ((ASSET_TEXTURE == eType || ASSET_IMAGE == eType) && pstCache &&
+        '\0' != pstCache->acPixelCache[0])
+    {
+        return _LoadPixels(eType, pacFileName, uParam, pstCache);
+    }
+
+    return _Decode(eType, pacFileName, uParam);
+}
+
+static void* _Insert(
+    const AssetType eType,
+    const char*     pacPath,
+    const uintptr_t uParam,
+    void*           pAsset,
+    const size_t    zBytes,
+    AssetCache*     pstCache)
+{
+    AssetEntry* pstEntry;
+    void*       pDuplicate = NULL;
+    Uint32      u32Hash    = _Hash(eType, pacPath, uParam);
+
+    if (!pstCache)
+    {
+        return pAsset;
+    }
+
+    SDL_LockMutex(pstCache->pstLock);
+    pstEntry = _Find(eType, pacPath, u32Hash, uParam, pstCache);
+    if (pstEntry)
+    {
+        // Another thread has loaded the same file in the meantime.
+        pstEntry->u32RefCount++;
+        pstCache->astStats[eType].u32Hits++;
+        pDuplicate = pAsset;
+        pAsset     = pstEntry->pAsset;
+    }
+    else
+    {
+        if (pstCache->u32Count == pstCache->u32Capacity)
+        {
+            Uint32      u32Capacity = SDL_max(16, pstCache->u32Capacity * 2);
+            AssetEntry* pstNew;
+
+            pstNew = SDL_realloc(pstCache->pstEntry, u32Capacity * sizeof(struct AssetEntry_t));
+            if (pstNew)
+            {
+                pstCache->pstEntry    = pstNew;
+                pstCache->u32Capacity = u32Capacity;
+            }
+        }
+
+        // Without room the asset stays usable, just uncached.
+        if (pstCache->u32Count < pstCache->u32Capacity)
+        {
+            pstEntry = &pstCache->pstEntry[pstCache->u32Count];
+
+            SDL_strlcpy(pstEntry->acPath, pacPath, ASSET_PATH_LEN);
+            pstEntry->pAsset      = pAsset;
+            pstEntry->uParam      = uParam;
+            pstEntry->zBytes      = zBytes;
+            pstEntry->u32Hash     = u32Hash;
+            pstEntry->u32RefCount = 1;
+            pstEntry->eType       = eType;
+
+            pstCache->u32Count++;
+        }
+        else
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "LoadAsset(): error allocating memory.\n");
+        }
+        pstCache->astStats[eType].u32Misses++;
+    }
+    SDL_UnlockMutex(pstCache->pstLock);
+
+    if (pDuplicate)
+    {
+        _Destroy(eType, pDuplicate);
+    }
+
+    return pAsset;
+}
+
+static void* _Lookup(
+    const AssetType eType,
+    const char*     pacPath,
+    const uintptr_t uParam,
+    AssetCache*     pstCache)
+{
+    AssetEntry* pstEntry;
+    void*       pAsset = NULL;
+
+    if (!pstCache)
+    {
+        return NULL;
+    }
+
+    SDL_LockMutex(pstCache->pstLock);
+    pstEntry = _Find(eType, pacPath, _Hash(eType, pacPath, uParam), uParam, pstCache);
+    if (pstEntry)
+    {
+        pstEntry->u32RefCount++;
+        pstCache->astStats[eType].u32Hits++;
+        pAsset = pstEntry->pAsset;
+    }
+    SDL_UnlockMutex(pstCache->pstLock);
+
+    return pAsset;
+}
+
+static void* _Acquire(
+    const AssetType eType,
+    const char*     pacFileName,
+    const uintptr_t uParam,
+    AssetCache*     pstCache)
+{
+    char  acPath[ASSET_PATH_LEN];
+    void* pAsset;
+
+    // Uncached assets are destroyed by Asset_Release() right away.
+    if (!pstCache || !pacFileName || !Utils_NormalisePath(pacFileName, ASSET_PATH_LEN, acPath))
+    {
+        return pacFileName ? _Load(eType, pacFileName, uParam, pstCache) : NULL;
+    }
+
+    pAsset = _Lookup(eType, acPath, uParam, pstCache);
+    if (pAsset)
+    {
+        return pAsset;
+    }
+
+    // Decode without holding the lock, other files may be loaded in
+    // parallel by the job pool.
+    pAsset = _Load(eType, pacFileName, uParam, pstCache);
+    if (!pAsset)
+    {
+        return NULL;
+    }
+
+    return _Insert(
+        eType, acPath, uParam, pAsset, _GetBytes(eType, pacFileName, pAsset), pstCache);
+}
+
+static void _DecodeRequest(void* pData)
+{
+    AssetRequest* pstRequest = pData;
+
+    pstRequest->pstImage =
+        _Load(ASSET_IMAGE, pstRequest->acFileName, 0, pstRequest->pstUploader->pstCache);
+
+    // Publishes the image to the rendering thread.
+    SDL_AtomicSet(&pstRequest->stState, pstRequest->pstImage ? ASSET_DECODED : ASSET_FAILED);
+}
+
+static void _DestroyRequest(AssetRequest* pstRequest)
+{
+    if (pstRequest->pstImage)
+    {
+        SDL_FreeSurface(pstRequest->pstImage);
+    }
+
+    Asset_Release(ASSET_TEXTURE, pstRequest->pstTexture, pstRequest->pstUploader->pstCache);
+    SDL_free(pstRequest);
+}
+
+static void _UploadRequest(AssetRequest* pstRequest)
+{
+    AssetUploader* pstUploader = pstRequest->pstUploader;
+    SDL_Texture*   pstTexture;
+
+    pstTexture = SDL_CreateTextureFromSurface(pstUploader->pstRenderer, pstRequest->pstImage);
+
+    SDL_FreeSurface(pstRequest->pstImage);
+    pstRequest->pstImage = NULL;
+
+    if (!pstTexture)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+        SDL_AtomicSet(&pstRequest->stState, ASSET_FAILED);
+        return;
+    }
+
+    pstRequest->pstTexture = _Insert(
+        ASSET_TEXTURE,
+        pstRequest->acPath,
+        (uintptr_t)pstUploader->pstRenderer,
+        pstTexture,
+        _GetBytes(ASSET_TEXTURE, pstRequest->acFileName, pstTexture),
+        pstUploader->pstCache);
+
+    SDL_AtomicSet(&pstRequest->stState, ASSET_READY);
+}
+
+/**
+ * @brief   Free asset cache
+ * @details Destroys all cached assets, including those that are still
+ *          in use.  Free the users of the cache first.
+ * @param   pstCache
+ *          Pointer to asset cache handle
+ */
+void Asset_Free(AssetCache* pstCache)
+{
+    if (!pstCache)
+    {
+        return;
+    }
+
+    for (Uint32 u32Index = 0; u32Index < pstCache->u32Count; u32Index++)
+    {
+        _Destroy(pstCache->pstEntry[u32Index].eType, pstCache->pstEntry[u32Index].pAsset);
+    }
+
+    if (pstCache->pstLock)
+    {
+        SDL_DestroyMutex(pstCache->pstLock);
+    }
+
+    if (_pstDefaultCache == pstCache)
+    {
+        _pstDefaultCache = NULL;
+    }
+
+    SDL_free(pstCache->pstEntry);
+    SDL_free(pstCache);
+}
+
+/**
+ * @brief   Free asset request
+ * @details Drops one holder of an asset request.  The last one frees
+ *          the request and releases its texture; a request that is
+ *          still decoding is freed by Asset_Upload() once it is done.
+ * @param   pstRequest
+ *          Pointer to asset request handle, may be NULL
+ */
+void Asset_FreeRequest(AssetRequest* pstRequest)
+{
+    AssetRequest** ppstLink;
+
+    if (!pstRequest)
+    {
+        return;
+    }
+
+    ppstLink = &pstRequest->pstUploader->pstRequest;
+
+    if (pstRequest->u32Users)
+    {
+        pstRequest->u32Users--;
+    }
+
+    if (pstRequest->u32Users || ASSET_DECODING == SDL_AtomicGet(&pstRequest->stState))
+    {
+        return;
+    }
+
+    for (; *ppstLink; ppstLink = &(*ppstLink)->pstNext)
+    {
+        if (pstRequest == *ppstLink)
+        {
+            *ppstLink = pstRequest->pstNext;
+            break;
+        }
+    }
+
+    _DestroyRequest(pstRequest);
+}
+
+/**
+ * @brief   Free asset uploader
+ * @details Waits for pending decodes and frees all requests of the
+ *          uploader.  Free the holders of the requests first.
+ * @param   pstUploader
+ *          Pointer to asset uploader handle
+ */
+void Asset_FreeUploader(AssetUploader* pstUploader)
+{
+    if (!pstUploader)
+    {
+        return;
+    }
+
+    Job_Wait(&pstUploader->stDecoding, pstUploader->pstPool);
+
+    while (pstUploader->pstRequest)
+    {
+        AssetRequest* pstRequest = pstUploader->pstRequest;
+
+        pstUploader->pstRequest = pstRequest->pstNext;
+        _DestroyRequest(pstRequest);
+    }
+
+    SDL_free(pstUploader);
+}
+
+/**
+ * @brief   Get default asset cache
+ * @details Returns the first asset cache that has been initialised.
+ *          The framework loads all of its textures, images, music and
+ *          fonts through it, and loads every file on its own if there
+ *          is none.
+ * @return  Pointer to asset cache handle, NULL if there is none
+ */
+AssetCache* Asset_GetDefaultCache(void)
+{
+    return _pstDefaultCache;
+}
+
+/**
+ * @brief   Get asset request state
+ * @param   pstRequest
+ *          Pointer to asset request handle
+ * @return  Request state
+ */
+AssetState Asset_GetState(AssetRequest* pstRequest)
+{
+    return (AssetState)SDL_AtomicGet(&pstRequest->stState);
+}
+
+/**
+ * @brief   Get asset statistics
+ * @details Reports number, memory usage and users of the cached assets
+ *          of one type, and how many loads the cache has served.
+ *          Texture and image sizes are calculated from their pixel
+ *          format, music and fonts are estimated by their file size.
+ * @param   eType
+ *          Asset type
+ * @param   pstStats
+ *          Pointer to statistics, zeroed if there is no cache
+ * @param   pstCache
+ *          Pointer to asset cache handle
+ */
+void Asset_GetStats(const AssetType eType, AssetStats* pstStats, AssetCache* pstCache)
+{
+    SDL_zerop(pstStats);
+
+    if (!pstCache || eType >= ASSET_TYPES)
+    {
+        return;
+    }
+
+    SDL_LockMutex(pstCache->pstLock);
+    pstStats->u32Hits   = pstCache->astStats[eType].u32Hits;
+    pstStats->u32Misses = pstCache->astStats[eType].u32Misses;
+
+    for (Uint32 u32Index = 0; u32Index < pstCache->u32Count; u32Index++)
+    {
+        const AssetEntry* pstEntry = &pstCache->pstEntry[u32Index];
+
+        if (eType != pstEntry->eType)
+        {
+            continue;
+        }
+
+        pstStats->zBytes      += pstEntry->zBytes;
+        pstStats->u32RefCount += pstEntry->u32RefCount;
+        pstStats->u32Count++;
+        if (0 == pstEntry->u32RefCount)
+        {
+            pstStats->u32Unused++;
+        }
+    }
+    SDL_UnlockMutex(pstCache->pstLock);
+}
+
+/**
+ * @brief   Get texture of asset request
+ * @param   pstRequest
+ *          Pointer to asset request handle
+ * @return  Pointer to texture, NULL until the request is ready
+ * @remark  The texture belongs to the request and is valid until the
+ *          request is freed.
+ */
+SDL_Texture* Asset_GetTexture(AssetRequest* pstRequest)
+{
+    if (ASSET_READY != SDL_AtomicGet(&pstRequest->stState))
+    {
+        return NULL;
+    }
+
+    return pstRequest->pstTexture;
+}
+
+/**
+ * @brief   Initialise asset cache
+ * @details Initialises an empty asset cache.  The first cache that is
+ *          initialised becomes the default cache.
+ * @param   pstCache
+ *          Pointer to asset cache handle
+ * @return  Error code
+ * @retval  0:  OK
+ * @retval  -1: Error
+ */
+Sint8 Asset_Init(AssetCache** pstCache)
+{
+    *pstCache = SDL_calloc(sizeof(struct AssetCache_t), sizeof(Sint8));
+    if (!*pstCache)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InitAsset(): error allocating memory.\n");
+        return -1;
+    }
+
+    (*pstCache)->pstLock = SDL_CreateMutex();
+    if (!(*pstCache)->pstLock)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+        Asset_Free(*pstCache);
+        return -1;
+    }
+
+    if (!_pstDefaultCache)
+    {
+        _pstDefaultCache = *pstCache;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief   Initialise asset uploader
+ * @details Initialises an uploader that loads textures in the
+ *          background: the images are decoded by the default job pool
+ *          and uploaded by Asset_Upload() on the rendering thread, a
+ *          few per frame.
+ * @param   zByteBudget
+ *          Max. number of bytes uploaded per frame, 0 for no limit
+ * @param   u32TextureBudget
+ *          Max. number of textures uploaded per frame, 0 for no limit
+ * @param   pstRenderer
+ *          Pointer to SDL2 rendering context
+ * @param   pstCache
+ *          Pointer to asset cache handle the textures are shared
+ *          through, may be NULL
+ * @param   pstUploader
+ *          Pointer to asset uploader handle
+ * @return  Error code
+ * @retval  0:  OK
+ * @retval  -1: Error
+ */
+Sint8 Asset_InitUploader(
+    const size_t    zByteBudget,
+    const Uint32    u32TextureBudget,
+    SDL_Renderer*   pstRenderer,
+    AssetCache*     pstCache,
+    AssetUploader** pstUploader)
+{
+    *pstUploader = SDL_calloc(sizeof(struct AssetUploader_t), sizeof(Sint8));
+    if (!*pstUploader)
+    {
+        SDL_LogError(
+            SDL_LOG_CATEGORY_APPLICATION, "InitAssetUploader(): error allocating memory.\n");
+        return -1;
+    }
+
+    (*pstUploader)->pstRenderer      = pstRenderer;
+    (*pstUploader)->pstCache         = pstCache;
+    (*pstUploader)->pstPool          = Job_GetDefaultPool();
+    (*pstUploader)->zByteBudget      = zByteBudget;
+    (*pstUploader)->u32TextureBudget = u32TextureBudget;
+
+    return 0;
+}
+
+/**
+ * @brief   Load font
+ * @details Opens a TrueType font, or shares the one that is already
+ *          open in the same point size
+ * @param   pacFileName
+ *          Path to font file
+ * @param   iPtSize
+ *          Point size
+ * @param   pstCache
+ *          Pointer to asset cache handle, may be NULL
+ * @return  Pointer to font, NULL on error
+ * @remark  Hand it back with Asset_Release().
+ */
+TTF_Font* Asset_LoadFont(const char* pacFileName, const int iPtSize, AssetCache* pstCache)
+{
+    return _Acquire(ASSET_FONT, pacFileName, (uintptr_t)iPtSize, pstCache);
+}
+
+/**
+ * @brief   Load image
+ * @details Decodes an image file into a surface, or shares the one
+ *          that is already decoded.  Safe to call from the job pool.
+ * @param   pacFileName
+ *          Path to image file
+ * @param   pstCache
+ *          Pointer to asset cache handle, may be NULL
+ * @return  Pointer to surface, NULL on error
+ * @remark  The surface is shared; restore any state that is changed
+ *          on it, e.g. the blend mode.  Hand it back with
+ *          Asset_Release().
+ */
+SDL_Surface* Asset_LoadImage(const char* pacFileName, AssetCache* pstCache)
+{
+    return _Acquire(ASSET_IMAGE, pacFileName, 0, pstCache);
+}
+
+/**
+ * @brief   Load music
+ * @details Loads a music file, or shares the one that is already loaded
+ * @param   pacFileName
+ *          Path to music file
+ * @param   pstCache
+ *          Pointer to asset cache handle, may be NULL
+ * @return  Pointer to music, NULL on error
+ * @remark  Hand it back with Asset_Release().
+ */
+Mix_Music* Asset_LoadMusic(const char* pacFileName, AssetCache* pstCache)
+{
+    return _Acquire(ASSET_MUSIC, pacFileName, 0, pstCache);
+}
+
+/**
+ * @brief   Load texture
+ * @details Loads an image file into a texture, or shares the one that
+ *          is already loaded for the same renderer
+ * @param   pacFileName
+ *          Path to image file
+ * @param   pstRenderer
+ *          Pointer to SDL2 rendering context
+ * @param   pstCache
+ *          Pointer to asset cache handle, may be NULL
+ * @return  Pointer to texture, NULL on error
+ * @remark  Hand it back with Asset_Release().
+ */
+SDL_Texture* Asset_LoadTexture(
+    const char*   pacFileName,
+    SDL_Renderer* pstRenderer,
+    AssetCache*   pstCache)
+{
+    return _Acquire(ASSET_TEXTURE, pacFileName, (uintptr_t)pstRenderer, pstCache);
+}
+
+/**
+ * @brief   Purge unused assets
+ * @details Destroys cached assets that have no users left.  Released
+ *          assets stay cached until they are purged, so that loading
+ *          the same file again is free.
+ * @param   eType
+ *          Asset type to purge, ASSET_TYPES for all of them
+ * @param   pstCache
+ *          Pointer to asset cache handle
+ * @return  Number of destroyed assets
+ */
+Uint32 Asset_Purge(const AssetType eType, AssetCache* pstCache)
+{
+    Uint32 u32Purged = 0;
+    Uint32 u32Index  = 0;
+
+    if (!pstCache)
+    {
+        return 0;
+    }
+
+    SDL_LockMutex(pstCache->pstLock);
+    while (u32Index < pstCache->u32Count)
+    {
+        AssetEntry* pstEntry = &pstCache->pstEntry[u32Index];
+
+        if (0 != pstEntry->u32RefCount || (ASSET_TYPES != eType && eType != pstEntry->eType))
+        {
+            u32Index++;
+            continue;
+        }
+
+        _Destroy(pstEntry->eType, pstEntry->pAsset);
+
+        pstCache->u32Count--;
+        *pstEntry = pstCache->pstEntry[pstCache->u32Count];
+        u32Purged++;
+    }
+    SDL_UnlockMutex(pstCache->pstLock);
+
+    if (u32Purged)
+    {
+        SDL_Log("Purge %u unused asset(s).\n", u32Purged);
+    }
+
+    return u32Purged;
+}
+
+/**
+ * @brief   Release asset
+ * @details Drops one user of a loaded asset.  Assets that are not
+ *          cached are destroyed right away.
+ * @param   eType
+ *          Asset type
+ * @param   pAsset
+ *          Pointer to asset, may be NULL
+ * @param   pstCache
+ *          Pointer to asset cache handle it was loaded with
+ */
+void Asset_Release(const AssetType eType, void* pAsset, AssetCache* pstCache)
+{
+    SDL_bool bIsCached = SDL_FALSE;
+
+    if (!pAsset)
+    {
+        return;
+    }
+
+    if (pstCache)
+    {
+        SDL_LockMutex(pstCache->pstLock);
+        for (Uint32 u32Index = 0; u32Index < pstCache->u32Count; u32Index++)
+        {
+            AssetEntry* pstEntry = &pstCache->pstEntry[u32Index];
+
+            if (pAsset == pstEntry->pAsset && eType == pstEntry->eType)
+            {
+                if (pstEntry->u32RefCount)
+                {
+                    pstEntry->u32RefCount--;
+                }
+                bIsCached = SDL_TRUE;
+                break;
+            }
+        }
+        SDL_UnlockMutex(pstCache->pstLock);
+    }
+
+    if (!bIsCached)
+    {
+        _Destroy(eType, pAsset);
+    }
+}
+
+/**
+ * @brief   Request texture
+ * @details Starts loading an image file into a texture without waiting
+ *          for it.  Textures that are cached already are ready right
+ *          away, and requesting a file twice shares the request.
+ * @param   pacFileName
+ *          Path to image file
+ * @param   pstUploader
+ *          Pointer to asset uploader handle
+ * @return  Pointer to asset request handle, NULL on error
+ * @remark  Poll it with Asset_GetTexture() and hand it back with
+ *          Asset_FreeRequest().
+ */
+AssetRequest* Asset_RequestTexture(const char* pacFileName, AssetUploader* pstUploader)
+{
+    AssetRequest*  pstRequest;
+    AssetRequest** ppstLink = &pstUploader->pstRequest;
+    char           acPath[ASSET_PATH_LEN];
+
+    // Normalising never makes a path longer.
+    if (SDL_strlen(pacFileName) >= ASSET_PATH_LEN)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "RequestTexture(): path too long.\n");
+        return NULL;
+    }
+    Utils_NormalisePath(pacFileName, ASSET_PATH_LEN, acPath);
+
+    for (; *ppstLink; ppstLink = &(*ppstLink)->pstNext)
+    {
+        pstRequest = *ppstLink;
+
+        if (pstRequest->u32Users && ASSET_FAILED != SDL_AtomicGet(&pstRequest->stState) &&
+            0 == SDL_strcmp(acPath, pstRequest->acPath))
+        {
+            pstRequest->u32Users++;
+            return pstRequest;
+        }
+    }
+
+    pstRequest = SDL_calloc(sizeof(struct AssetRequest_t), sizeof(Sint8));
+    if (!pstRequest)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "RequestTexture(): error allocating memory.\n");
+        return NULL;
+    }
+
+    SDL_strlcpy(pstRequest->acFileName, pacFileName, ASSET_PATH_LEN);
+    SDL_strlcpy(pstRequest->acPath, acPath, ASSET_PATH_LEN);
+    pstRequest->pstUploader = pstUploader;
+    pstRequest->u32Users    = 1;
+    *ppstLink               = pstRequest;
+
+    pstRequest->pstTexture = _Lookup(
+        ASSET_TEXTURE, acPath, (uintptr_t)pstUploader->pstRenderer, pstUploader->pstCache);
+
+    if (pstRequest->pstTexture)
+    {
+        SDL_AtomicSet(&pstRequest->stState, ASSET_READY);
+    }
+    else
+    {
+        SDL_AtomicSet(&pstRequest->stState, ASSET_DECODING);
+        Job_Submit(_DecodeRequest, pstRequest, &pstUploader->stDecoding, pstUploader->pstPool);
+    }
+
+    return pstRequest;
+}
+
+/**
+ * @brief   Set up pixel cache
+ * @details Stores decoded images and textures of the cache in a
+ *          directory, so that later runs read the pixels instead of
+ *          decoding the image files again.  The files are named after
+ *          the hash of the image file they were decoded from.
+ * @param   pacDirectory
+ *          Existing, writable directory, e.g. from SDL_GetPrefPath();
+ *          NULL to turn the pixel cache off
+ * @param   pstRenderer
+ *          Pointer to SDL2 rendering context whose native texture
+ *          format the pixels are stored in, may be NULL
+ * @param   pstCache
+ *          Pointer to asset cache handle
+ * @return  Error code
+ * @retval  0:  OK
+ * @retval  -1: Error
+ * @remark  Set up the pixel cache before loading any images.  The
+ *          pixels keep their straight alpha, as expected by
+ *          SDL_BLENDMODE_BLEND.
+ */
+Sint8 Asset_SetPixelCache(
+    const char*   pacDirectory,
+    SDL_Renderer* pstRenderer,
+    AssetCache*   pstCache)
+{
+    SDL_RendererInfo stInfo;
+    size_t           zLength;
+
+    pstCache->acPixelCache[0] = '\0';
+    pstCache->u32PixelFormat  = SDL_PIXELFORMAT_ARGB8888;
+
+    if (!pacDirectory)
+    {
+        return 0;
+    }
+
+    zLength = SDL_strlen(pacDirectory);
+    if (0 == zLength || zLength + 1 >= ASSET_PATH_LEN)
+    {
+        SDL_LogError(
+            SDL_LOG_CATEGORY_APPLICATION,
+            "SetAssetPixelCache(): invalid directory %s.\n",
+            pacDirectory);
+        return -1;
+    }
+
+    SDL_strlcpy(pstCache->acPixelCache, pacDirectory, ASSET_PATH_LEN);
+    if ('/' != pacDirectory[zLength - 1] && '\\' != pacDirectory[zLength - 1])
+    {
+        SDL_strlcat(pstCache->acPixelCache, "/", ASSET_PATH_LEN);
+    }
+
+    // The first format with an alpha channel is the one the renderer
+    // prefers.
+    if (pstRenderer && 0 == SDL_GetRendererInfo(pstRenderer, &stInfo))
+    {
+        for (Uint32 u32Index = 0; u32Index < stInfo.num_texture_formats; u32Index++)
+        {
+            Uint32 u32Format = stInfo.texture_formats[u32Index];
+
+            if (!SDL_ISPIXELFORMAT_FOURCC(u32Format) && SDL_ISPIXELFORMAT_ALPHA(u32Format))
+            {
+                pstCache->u32PixelFormat = u32Format;
+                break;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief   Upload decoded images
+ * @details Turns decoded images into textures, in the order they were
+ *          requested, until the byte or texture budget of the frame is
+ *          used up.  At least one image is uploaded per call.  Call
+ *          once per frame on the rendering thread.
+ * @param   pstUploader
+ *          Pointer to asset uploader handle
+ * @return  Number of requests that are not done yet, 0 once
+ *          everything is loaded
+ */
+Uint32 Asset_Upload(AssetUploader* pstUploader)
+{
+    AssetRequest** ppstLink   = &pstUploader->pstRequest;
+    size_t         zBytes     = 0;
+    Uint32         u32Uploads = 0;
+    Uint32         u32Pending = 0;
+
+    while (*ppstLink)
+    {
+        AssetRequest* pstRequest = *ppstLink;
+        AssetState    eState     = (AssetState)SDL_AtomicGet(&pstRequest->stState);
+        size_t        zSize;
+
+        if (ASSET_DECODING == eState)
+        {
+            u32Pending++;
+            ppstLink = &pstRequest->pstNext;
+            continue;
+        }
+
+        // Freed by all of its holders while decoding.
+        if (0 == pstRequest->u32Users)
+        {
+            *ppstLink = pstRequest->pstNext;
+            _DestroyRequest(pstRequest);
+            continue;
+        }
+
+        ppstLink = &pstRequest->pstNext;
+
+        if (ASSET_DECODED != eState)
+        {
+            continue;
+        }
+
+        zSize = (size_t)pstRequest->pstImage->pitch * (size_t)pstRequest->pstImage->h;
+
+        if (u32Uploads &&
+            ((pstUploader->zByteBudget && zBytes + zSize > pstUploader->zByteBudget) ||
+             (pstUploader->u32TextureBudget && u32Uploads >= pstUploader->u32TextureBudget)))
+        {
+            u32Pending++;
+            continue;
+        }
+
+        _UploadRequest(pstRequest);
+        zBytes += zSize;
+        u32Uploads++;
+    }
+
+    return u32Pending;
+}
@@ -0,0 +1,205 @@
+// SPDX-License-Identifier: Beerware
+/**
+ * @file    Asset.h
+ * @brief   Asset cache include header
+ * @ingroup Asset
+ */
+#pragma once
+
+#include <SDL.h>
+#include <SDL_mixer.h>
+#include <SDL_ttf.h>
+#include "Job.h"
+
+/**
+ * @typedef AssetConstants
+ * @brief   Asset cache constants handle type
+ * @enum    AssetConstants_t
+ * @brief   Asset cache constants enumeration
+ */
+typedef enum AssetConstants_t
+{
+    ASSET_PATH_LEN      = 256,  ///< Max. normalised path length
+    ASSET_PIXEL_VERSION = 1     ///< Decoded image file format version
+
+} AssetConstants;
+
+/**
+ * @typedef AssetType
+ * @brief   Asset type handle type
+ * @enum    AssetType_t
+ * @brief   Asset type enumeration
+ */
+typedef enum AssetType_t
+{
+    ASSET_TEXTURE = 0,  ///< SDL_Texture, one per file and renderer
+    ASSET_IMAGE,        ///< Decoded SDL_Surface
+    ASSET_MUSIC,        ///< Mix_Music
+    ASSET_FONT,         ///< TTF_Font, one per file and point size
+    ASSET_TYPES         ///< Number of asset types, selects all of them in Asset_Purge()
+
+} AssetType;
+
+/**
+ * @typedef AssetState
+ * @brief   Asset request state handle type
+ * @enum    AssetState_t
+ * @brief   Asset request state enumeration
+ */
+typedef enum AssetState_t
+{
+    ASSET_DECODING = 0,  ///< Image is decoded by the job pool
+    ASSET_DECODED,       ///< Image waits for its upload
+    ASSET_READY,         ///< Texture is available
+    ASSET_FAILED         ///< File could not be loaded
+
+} AssetState;
+
+/**
+ * @typedef AssetEntry
+ * @brief   Asset entry handle type
+ * @struct  AssetEntry_t
+ * @brief   Loaded asset shared by all users of the same file
+ */
+typedef struct AssetEntry_t
+{
+    char      acPath[ASSET_PATH_LEN];  ///< Normalised path
+    void*     pAsset;                  ///< Shared asset handle
+    uintptr_t uParam;                  ///< Load parameter: renderer or point size
+    size_t    zBytes;                  ///< Estimated memory usage
+    Uint32    u32Hash;                 ///< Hash of type, path and parameter
+    Uint32    u32RefCount;             ///< Number of users
+    AssetType eType;                   ///< Asset type
+
+} AssetEntry;
+
+/**
+ * @typedef AssetStats
+ * @brief   Asset statistics handle type
+ * @struct  AssetStats_t
+ * @brief   Memory and usage statistics of one asset type
+ */
+typedef struct AssetStats_t
+{
+    size_t zBytes;       ///< Estimated memory usage of the cached assets
+    Uint32 u32Count;     ///< Number of cached assets
+    Uint32 u32Unused;    ///< Cached assets without users, freed by Asset_Purge()
+    Uint32 u32RefCount;  ///< Number of users of all cached assets
+    Uint32 u32Hits;      ///< Loads served from the cache
+    Uint32 u32Misses;    ///< Loads that had to decode the file
+
+} AssetStats;
+
+/**
+ * @typedef AssetPixelHeader
+ * @brief   Decoded image header handle type
+ * @struct  AssetPixelHeader_t
+ * @brief   File header of a decoded image in the pixel cache
+ * @details Followed by the rows of pixels without padding.  The
+ *          numbers are stored in native byte order: the cache belongs
+ *          to one machine, files written by another one fail the
+ *          version check and are replaced.
+ */
+typedef struct AssetPixelHeader_t
+{
+    char   acMagic[4];     ///< "ESZT"
+    Uint32 u32Version;     ///< ASSET_PIXEL_VERSION
+    Uint32 u32SourceHash;  ///< Hash of the image file
+    Uint32 u32SourceSize;  ///< Size of the image file in bytes
+    Uint32 u32Format;      ///< SDL_PixelFormatEnum of the pixels
+    Uint32 u32Width;       ///< Image width in pixel
+    Uint32 u32Height;      ///< Image height in pixel
+
+} AssetPixelHeader;
+
+/**
+ * @typedef AssetCache
+ * @brief   Asset cache handle type
+ * @struct  AssetCache_t
+ * @brief   Asset cache handle data
+ */
+typedef struct AssetCache_t
+{
+    AssetEntry* pstEntry;                      ///< Cached assets
+    Uint32      u32Count;                      ///< Number of cached assets
+    Uint32      u32Capacity;                   ///< Capacity of pstEntry
+    AssetStats  astStats[ASSET_TYPES];         ///< Hit and miss counters per asset type
+    SDL_mutex*  pstLock;                       ///< Images are loaded by the job pool
+    char        acPixelCache[ASSET_PATH_LEN];  ///< Directory of decoded images, empty if unused
+    Uint32      u32PixelFormat;                ///< Pixel format of decoded images
+
+} AssetCache;
+
+/**
+ * @typedef AssetRequest
+ * @brief   Asset request handle type
+ * @struct  AssetRequest_t
+ * @brief   Texture that is loaded in the background
+ */
+typedef struct AssetRequest_t
+{
+    char                    acFileName[ASSET_PATH_LEN];  ///< Image file
+    char                    acPath[ASSET_PATH_LEN];      ///< Normalised path
+    SDL_Surface*            pstImage;                    ///< Decoded image until uploaded
+    SDL_Texture*            pstTexture;                  ///< Texture, valid once ready
+    struct AssetUploader_t* pstUploader;                 ///< Owning uploader
+    struct AssetRequest_t*  pstNext;                     ///< Next request of the uploader
+    Uint32                  u32Users;                    ///< Number of holders
+    SDL_atomic_t            stState;                     ///< AssetState
+
+} AssetRequest;
+
+/**
+ * @typedef AssetUploader
+ * @brief   Asset uploader handle type
+ * @struct  AssetUploader_t
+ * @brief   Asset uploader handle data
+ */
+typedef struct AssetUploader_t
+{
+    AssetRequest* pstRequest;        ///< Requests in submission order
+    SDL_Renderer* pstRenderer;       ///< Rendering context of the textures
+    AssetCache*   pstCache;          ///< Cache the textures are shared through, may be NULL
+    JobPool*      pstPool;           ///< Pool the images are decoded on, may be NULL
+    JobCounter    stDecoding;        ///< Pending decode jobs
+    size_t        zByteBudget;       ///< Max. bytes uploaded per frame, 0 for no limit
+    Uint32        u32TextureBudget;  ///< Max. textures uploaded per frame, 0 for no limit
+
+} AssetUploader;
+
+void         Asset_Free(AssetCache* pstCache);
+void         Asset_FreeRequest(AssetRequest* pstRequest);
+void         Asset_FreeUploader(AssetUploader* pstUploader);
+AssetCache*  Asset_GetDefaultCache(void);
+AssetState   Asset_GetState(AssetRequest* pstRequest);
+void         Asset_GetStats(const AssetType eType, AssetStats* pstStats, AssetCache* pstCache);
+SDL_Texture* Asset_GetTexture(AssetRequest* pstRequest);
+Sint8        Asset_Init(AssetCache** pstCache);
+
+Sint8 Asset_InitUploader(
+    const size_t    zByteBudget,
+    const Uint32    u32TextureBudget,
+    SDL_Renderer*   pstRenderer,
+    AssetCache*     pstCache,
+    AssetUploader** pstUploader);
+
+TTF_Font*    Asset_LoadFont(const char* pacFileName, const int iPtSize, AssetCache* pstCache);
+SDL_Surface* Asset_LoadImage(const char* pacFileName, AssetCache* pstCache);
+Mix_Music*   Asset_LoadMusic(const char* pacFileName, AssetCache* pstCache);
+
+SDL_Texture* Asset_LoadTexture(
+    const char*   pacFileName,
+    SDL_Renderer* pstRenderer,
+    AssetCache*   pstCache);
+
+Uint32 Asset_Purge(const AssetType eType, AssetCache* pstCache);
+void   Asset_Release(const AssetType eType, void* pAsset, AssetCache* pstCache);
+
+AssetRequest* Asset_RequestTexture(const char* pacFileName, AssetUploader* pstUploader);
+
+Sint8 Asset_SetPixelCache(
+    const char*   pacDirectory,
+    SDL_Renderer* pstRenderer,
+    AssetCache*   pstCache);
+
+Uint32 Asset_Upload(AssetUploader* pstUploader);
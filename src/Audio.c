@@ -10,6 +10,7 @@
 
 #include <SDL.h>
 #include <SDL_mixer.h>
+#include "Asset.h"
 #include "Audio.h"
 
 /**
@@ -20,6 +21,8 @@
  */
 void Audio_Free(Audio* pstAudio)
 {
+    Asset_Purge(ASSET_MUSIC, Asset_GetDefaultCache());
+
     Mix_CloseAudio();
     while (Mix_Init(0))
     {
@@ -39,10 +42,7 @@ void Audio_FreeMusic(Music* pstMusic)
 {
     if (pstMusic)
     {
-        if (pstMusic->pstMusic)
-        {
-            Mix_FreeMusic(pstMusic->pstMusic);
-        }
+        Asset_Release(ASSET_MUSIC, pstMusic->pstMusic, Asset_GetDefaultCache());
 
         SDL_free(pstMusic);
         SDL_Log("Unload music track.\n");
@@ -117,12 +117,11 @@ Sint8 Audio_InitMusic(const char* pacFileName, const Sint8 s8Loops, Music** pstM
         return -1;
     }
 
-    (*pstMusic)->pstMusic = Mix_LoadMUS(pacFileName);
+    (*pstMusic)->pstMusic = Asset_LoadMusic(pacFileName, Asset_GetDefaultCache());
     (*pstMusic)->s8Loops  = s8Loops;
 
     if (!(*pstMusic)->pstMusic)
     {
-        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", Mix_GetError());
         return -1;
     }
 
@@ -9,9 +9,10 @@
  */
 
 #include <SDL.h>
-#include <SDL_image.h>
+#include "Asset.h"
 #include "Background.h"
 #include "Constants.h"
+#include "Job.h"
 
 static Sint8 _DrawLayer(
     const Uint8   u8Index,
@@ -112,27 +113,29 @@ static Sint8 _DrawLayer(
     return 0;
 }
 
+static void _DecodeLayers(const Uint32 u32First, const Uint32 u32Last, void* pData)
+{
+    BGDecode* pstDecode = pData;
+
+    for (Uint32 u32Index = u32First; u32Index < u32Last; u32Index++)
+    {
+        pstDecode->ppstImage[u32Index] =
+            Asset_LoadImage(pstDecode->pacFileNames[u32Index], Asset_GetDefaultCache());
+    }
+}
+
 static Sint8 _RenderLayer(
-    const char*   pacFileName,
+    SDL_Texture*  pstImage,
     const Sint32  s32WindowWidth,
     SDL_Renderer* pstRenderer,
-    SDL_Texture** pstLayer)
+    BGLayer*      pstLayer)
 {
-    Sint8        s8ReturnValue  = 0;
-    SDL_Texture* pstImage       = NULL;
-    Sint32       s32ImageWidth  = 0;
-    Sint32       s32ImageHeight = 0;
-    Sint32       s32LayerHeight = 0;
-    Sint32       s32LayerWidth  = 0;
-    Uint8        u8WidthFactor  = 0;
-
-    pstImage = IMG_LoadTexture(pstRenderer, pacFileName);
-    if (!pstImage)
-    {
-        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", IMG_GetError());
-        s8ReturnValue = -1;
-        goto exit;
-    }
+    Sint8  s8ReturnValue  = 0;
+    Sint32 s32ImageWidth  = 0;
+    Sint32 s32ImageHeight = 0;
+    Sint32 s32LayerHeight = 0;
+    Sint32 s32LayerWidth  = 0;
+    Uint8  u8WidthFactor  = 0;
 
     if (0 != SDL_QueryTexture(pstImage, NULL, NULL, &s32ImageWidth, &s32ImageHeight))
     {
@@ -141,24 +144,24 @@ static Sint8 _RenderLayer(
         goto exit;
     }
 
-    u8WidthFactor  = SDL_ceil((double)s32WindowWidth / (double)s32ImageWidth);
-    s32LayerWidth  = s32ImageWidth * u8WidthFactor;
-    s32LayerHeight = s32ImageHeight;
-    (*pstLayer)    = SDL_CreateTexture(
+    u8WidthFactor     = SDL_ceil((double)s32WindowWidth / (double)s32ImageWidth);
+    s32LayerWidth     = s32ImageWidth * u8WidthFactor;
+    s32LayerHeight    = s32ImageHeight;
+    pstLayer->pstLayer = SDL_CreateTexture(
         pstRenderer,
         SDL_PIXELFORMAT_ARGB8888,
         SDL_TEXTUREACCESS_TARGET,
         s32LayerWidth,
         s32LayerHeight);
 
-    if (!(*pstLayer))
+    if (!pstLayer->pstLayer)
     {
         SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
         s8ReturnValue = -1;
         goto exit;
     }
 
-    if (0 != SDL_SetRenderTarget(pstRenderer, (*pstLayer)))
+    if (0 != SDL_SetRenderTarget(pstRenderer, pstLayer->pstLayer))
     {
         SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
         s8ReturnValue = -1;
@@ -176,7 +179,7 @@ static Sint8 _RenderLayer(
         stDst.x += s32ImageWidth;
     }
 
-    if (0 != SDL_SetTextureBlendMode((*pstLayer), SDL_BLENDMODE_BLEND))
+    if (0 != SDL_SetTextureBlendMode(pstLayer->pstLayer, SDL_BLENDMODE_BLEND))
     {
         SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
         s8ReturnValue = -1;
@@ -190,22 +193,41 @@ static Sint8 _RenderLayer(
         goto exit;
     }
 
+    pstLayer->s32Width  = s32LayerWidth;
+    pstLayer->s32Height = s32LayerHeight;
+
 exit:
-    if (-1 == s8ReturnValue)
+    if (-1 == s8ReturnValue && pstLayer->pstLayer)
     {
-        if ((*pstLayer))
-        {
-            SDL_DestroyTexture((*pstLayer));
-        }
-        if (pstImage)
-        {
-            SDL_DestroyTexture(pstImage);
-        }
+        SDL_DestroyTexture(pstLayer->pstLayer);
+        pstLayer->pstLayer = NULL;
     }
 
     return s8ReturnValue;
 }
 
+static void _ResolveLayer(
+    const Sint32  s32WindowWidth,
+    SDL_Renderer* pstRenderer,
+    BGLayer*      pstLayer)
+{
+    SDL_Texture* pstImage = Asset_GetTexture(pstLayer->pstRequest);
+
+    if (!pstImage && ASSET_FAILED != Asset_GetState(pstLayer->pstRequest))
+    {
+        return;
+    }
+
+    // A layer that fails to load stays empty.
+    if (pstImage)
+    {
+        _RenderLayer(pstImage, s32WindowWidth, pstRenderer, pstLayer);
+    }
+
+    Asset_FreeRequest(pstLayer->pstRequest);
+    pstLayer->pstRequest = NULL;
+}
+
 /**
  * @brief   Draw background
  * @details Draws the layers of a parallax-scrolling background
@@ -237,10 +259,21 @@ Sint8 Background_Draw(
     double dFactor = pstBackground->u8Num + 1;
     for (Uint8 u8Index = 0; u8Index < pstBackground->u8Num; u8Index++)
     {
-        pstBackground->acLayer[u8Index].dVelocity = dVelocity / dFactor;
+        BGLayer* pstLayer = &pstBackground->acLayer[u8Index];
+
+        pstLayer->dVelocity = dVelocity / dFactor;
         dFactor -= 0.5f;
 
-        _DrawLayer(u8Index, s32LogicalWindowHeight, dCameraPosY, pstRenderer, pstBackground);
+        if (pstLayer->pstRequest)
+        {
+            _ResolveLayer(pstBackground->s32WindowWidth, pstRenderer, pstLayer);
+        }
+
+        // Layers that are still loading are left out.
+        if (pstLayer->pstLayer)
+        {
+            _DrawLayer(u8Index, s32LogicalWindowHeight, dCameraPosY, pstRenderer, pstBackground);
+        }
     }
 
     return 0;
@@ -255,6 +288,21 @@ Sint8 Background_Draw(
  */
 void Background_Free(Background* pstBackground)
 {
+    if (!pstBackground)
+    {
+        return;
+    }
+
+    for (Uint8 u8Index = 0; u8Index < pstBackground->u8Num; u8Index++)
+    {
+        Asset_FreeRequest(pstBackground->acLayer[u8Index].pstRequest);
+
+        if (pstBackground->acLayer[u8Index].pstLayer)
+        {
+            SDL_DestroyTexture(pstBackground->acLayer[u8Index].pstLayer);
+        }
+    }
+
     SDL_free(pstBackground);
     SDL_Log("Unload parallax scrolling background.\n");
 }
@@ -286,6 +334,9 @@ Sint8 Background_Init(
     SDL_Renderer*   pstRenderer,
     Background**    pstBackground)
 {
+    BGDecode stDecode;
+    Sint8    s8ReturnValue = 0;
+
     *pstBackground =
         SDL_calloc(sizeof(struct Background_t) + (u8Num * sizeof(struct BGLayer_t)), sizeof(Sint8));
     if (!*pstBackground)
@@ -294,34 +345,117 @@ Sint8 Background_Init(
         return -1;
     }
 
-    (*pstBackground)->u8Num      = u8Num;
-    (*pstBackground)->eAlignment = eAlignment;
+    (*pstBackground)->u8Num          = u8Num;
+    (*pstBackground)->eAlignment     = eAlignment;
+    (*pstBackground)->s32WindowWidth = s32WindowWidth;
+
+    stDecode.pacFileNames = pacFileNames;
+    stDecode.ppstImage    = SDL_calloc(u8Num, sizeof(SDL_Surface*));
+    if (!stDecode.ppstImage && u8Num)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InitBackground(): error allocating memory.\n");
+        return -1;
+    }
 
     SDL_Log("Initialise parallax scrolling background with %d layers:\n", u8Num);
 
+    // Decode all images at once; textures can only be created on the
+    // rendering thread.
+    Job_ParallelFor(u8Num, 1, _DecodeLayers, &stDecode, Job_GetDefaultPool());
+
     for (Uint8 u8Index = 0; u8Index < u8Num; u8Index++)
     {
-        if (-1 == _RenderLayer(
-                pacFileNames[u8Index],
-                s32WindowWidth,
-                pstRenderer,
-                &(*pstBackground)->acLayer[u8Index].pstLayer))
+        SDL_Texture* pstImage = NULL;
+
+        if (stDecode.ppstImage[u8Index])
         {
-            return -1;
+            pstImage = SDL_CreateTextureFromSurface(pstRenderer, stDecode.ppstImage[u8Index]);
+            if (!pstImage)
+            {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+            }
+        }
+
+        if (!pstImage ||
+            -1 == _RenderLayer(
+                pstImage, s32WindowWidth, pstRenderer, &(*pstBackground)->acLayer[u8Index]))
+        {
+            s8ReturnValue = -1;
+        }
+
+        // The image has been copied into the layer.
+        if (pstImage)
+        {
+            SDL_DestroyTexture(pstImage);
+        }
+
+        if (-1 == s8ReturnValue)
+        {
+            break;
         }
         SDL_Log("  Render background layer %d layer: %s.\n", u8Index + 1, pacFileNames[u8Index]);
     }
 
     for (Uint8 u8Index = 0; u8Index < u8Num; u8Index++)
     {
-        if (0 != SDL_QueryTexture(
-                (*pstBackground)->acLayer[u8Index].pstLayer,
-                NULL,
-                NULL,
-                &(*pstBackground)->acLayer[u8Index].s32Width,
-                &(*pstBackground)->acLayer[u8Index].s32Height))
+        Asset_Release(ASSET_IMAGE, stDecode.ppstImage[u8Index], Asset_GetDefaultCache());
+    }
+    SDL_free(stDecode.ppstImage);
+
+    return s8ReturnValue;
+}
+
+/**
+ * @brief   Initialise background asynchronously
+ * @details Initialises a parallax-scrolling background whose images are
+ *          loaded in the background by an asset uploader.  Each layer
+ *          is rendered by Background_Draw() once its image has been
+ *          uploaded and is left out until then.
+ * @param   u8Num
+ *          Number of backgrounds
+ * @param   pacFileNames
+ *          Pointer to array with list of filenames
+ * @param   s32WindowWidth
+ *          Window width in pixel
+ * @param   eAlignment
+ *          Background alignment
+ * @param   pstUploader
+ *          Pointer to asset uploader handle
+ * @param   pstBackground
+ *          Pointer to background handle
+ * @return  Error code
+ * @retval   0: OK
+ * @retval  -1: Error
+ */
+Sint8 Background_InitAsync(
+    const Uint8     u8Num,
+    const char*     pacFileNames[static u8Num],
+    const Sint32    s32WindowWidth,
+    const Alignment eAlignment,
+    AssetUploader*  pstUploader,
+    Background**    pstBackground)
+{
+    *pstBackground =
+        SDL_calloc(sizeof(struct Background_t) + (u8Num * sizeof(struct BGLayer_t)), sizeof(Sint8));
+    if (!*pstBackground)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InitBackground(): error allocating memory.\n");
+        return -1;
+    }
+
+    (*pstBackground)->u8Num          = u8Num;
+    (*pstBackground)->eAlignment     = eAlignment;
+    (*pstBackground)->s32WindowWidth = s32WindowWidth;
+
+    SDL_Log("Request parallax scrolling background with %d layers.\n", u8Num);
+
+    for (Uint8 u8Index = 0; u8Index < u8Num; u8Index++)
+    {
+        (*pstBackground)->acLayer[u8Index].pstRequest =
+            Asset_RequestTexture(pacFileNames[u8Index], pstUploader);
+
+        if (!(*pstBackground)->acLayer[u8Index].pstRequest)
         {
-            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
             return -1;
         }
     }
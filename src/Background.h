@@ -7,6 +7,7 @@
 #pragma once
 
 #include <SDL.h>
+#include "Asset.h"
 #include "Constants.h"
 
 /**
@@ -17,15 +18,29 @@
  */
 typedef struct BGLayer_t
 {
-    SDL_Texture* pstLayer;   ///< Pointer to SDL2 texture
-    Sint32       s32Width;   ///< Background width in pixel
-    Sint32       s32Height;  ///< Background height in pixel
-    double       dPosX;      ///< Position along the x-axis
-    double       dPosY;      ///< Position along the y-axis
-    double       dVelocity;  ///< Velocity
+    SDL_Texture*  pstLayer;    ///< Pointer to SDL2 texture
+    AssetRequest* pstRequest;  ///< Layer image loaded in the background, NULL once rendered
+    Sint32        s32Width;    ///< Background width in pixel
+    Sint32        s32Height;   ///< Background height in pixel
+    double        dPosX;       ///< Position along the x-axis
+    double        dPosY;       ///< Position along the y-axis
+    double        dVelocity;   ///< Velocity
 
 } BGLayer;
 
+/**
+ * @typedef BGDecode
+ * @brief   Background decode handle type
+ * @struct  BGDecode_t
+ * @brief   Layer images decoded in parallel
+ */
+typedef struct BGDecode_t
+{
+    const char**  pacFileNames;  ///< Image file name per layer
+    SDL_Surface** ppstImage;     ///< Decoded image per layer, NULL on error
+
+} BGDecode;
+
 /**
  * @typedef Background
  * @brief   Background handle type
@@ -34,10 +49,11 @@ typedef struct BGLayer_t
  */
 typedef struct Background_t
 {
-    Uint8     u8Num;       ///< Number of layers
-    Alignment eAlignment;  ///< Background alignment
-    Direction eDirection;  ///< Scroll direction
-    BGLayer   acLayer[];   ///< Array of background layers
+    Uint8     u8Num;           ///< Number of layers
+    Alignment eAlignment;      ///< Background alignment
+    Direction eDirection;      ///< Scroll direction
+    Sint32    s32WindowWidth;  ///< Window width the layers are rendered for
+    BGLayer   acLayer[];       ///< Array of background layers
 
 } Background;
 
@@ -58,3 +74,11 @@ Sint8 Background_Init(
     const Alignment eAlignment,
     SDL_Renderer*   pstRenderer,
     Background**    pstBackground);
+
+Sint8 Background_InitAsync(
+    const Uint8     u8Num,
+    const char*     pacFilenames[static u8Num],
+    const Sint32    s32WindowWidth,
+    const Alignment eAlignment,
+    AssetUploader*  pstUploader,
+    Background**    pstBackground);
@@ -0,0 +1,505 @@
+// SPDX-License-Identifier: Beerware
+/**
+ * @file      Broadphase.c
+ * @ingroup   Broadphase
+ * @defgroup  Broadphase Broadphase collision
+ * @author    Michael Fitzmayer
+ * @copyright "THE BEER-WARE LICENCE" (Revision 42)
+ */
+
+#include <SDL.h>
+#include "AABB.h"
+#include "Broadphase.h"
+#include "Scalar.h"
+
+static Uint32 _GetCapacity(const Uint32 u32Capacity, const Uint32 u32Needed)
+{
+    Uint32 u32New = SDL_max(u32Capacity, 16);
+
+    while (u32New < u32Needed)
+    {
+        u32New *= 2;
+    }
+
+    return u32New;
+}
+
+static void* _Resize(void* pData, const Uint32 u32Capacity, const size_t zElement)
+{
+    void* pNew = SDL_realloc(pData, u32Capacity * zElement);
+
+    if (!pNew)
+    {
+        SDL_LogError(
+            SDL_LOG_CATEGORY_APPLICATION, "UpdateBroadphase(): error allocating memory.\n");
+    }
+
+    return pNew;
+}
+
+static SDL_bool _DoOverlap(const AABB* pstBoxA, const AABB* pstBoxB)
+{
+    // Same rules as AABB_BoxesDoIntersect(): touching boxes intersect.
+    return (pstBoxA->dLeft <= pstBoxB->dRight && pstBoxB->dLeft <= pstBoxA->dRight &&
+            pstBoxA->dTop <= pstBoxB->dBottom && pstBoxB->dTop <= pstBoxA->dBottom)
+        ? SDL_TRUE
+        : SDL_FALSE;
+}
+
+static Sint8 _AddPair(const Uint32 u32A, const Uint32 u32B, Broadphase* pstBroadphase)
+{
+    BroadphasePair* pstPair;
+
+    if (pstBroadphase->u32PairCount == pstBroadphase->u32PairCapacity)
+    {
+        Uint32 u32Capacity = _GetCapacity(
+            pstBroadphase->u32PairCapacity, pstBroadphase->u32PairCapacity + 1);
+
+        pstPair = _Resize(pstBroadphase->pstPair, u32Capacity, sizeof(struct BroadphasePair_t));
+        if (!pstPair)
+        {
+            return -1;
+        }
+
+        pstBroadphase->pstPair         = pstPair;
+        pstBroadphase->u32PairCapacity = u32Capacity;
+    }
+
+    pstPair       = &pstBroadphase->pstPair[pstBroadphase->u32PairCount];
+    pstPair->u32A = SDL_min(u32A, u32B);
+    pstPair->u32B = SDL_max(u32A, u32B);
+    pstBroadphase->u32PairCount++;
+
+    return 0;
+}
+
+static int _CompareKeys(const void* pKeyA, const void* pKeyB)
+{
+    const BroadphaseKey* pstKeyA = pKeyA;
+    const BroadphaseKey* pstKeyB = pKeyB;
+
+    if (pstKeyA->dLeft < pstKeyB->dLeft)
+    {
+        return -1;
+    }
+
+    return (pstKeyA->dLeft > pstKeyB->dLeft) ? 1 : 0;
+}
+
+static void _SortKeys(const Uint32 u32Count, const AABB* pstBB, Broadphase* pstBroadphase)
+{
+    BroadphaseKey* pstKey    = pstBroadphase->pstKey;
+    Uint32         u32Kept   = 0;
+    Uint32         u32Shifts = 0;
+
+    // Drop boxes that no longer exist and append new ones; everything
+    // else keeps its position from the last update.
+    for (Uint32 u32Index = 0; u32Index < pstBroadphase->u32Count; u32Index++)
+    {
+        if (pstKey[u32Index].u32Index < u32Count)
+        {
+            pstKey[u32Kept].u32Index = pstKey[u32Index].u32Index;
+            u32Kept++;
+        }
+    }
+
+    for (Uint32 u32Index = pstBroadphase->u32Count; u32Index < u32Count; u32Index++)
+    {
+        pstKey[u32Kept].u32Index = u32Index;
+        u32Kept++;
+    }
+
+    for (Uint32 u32Index = 0; u32Index < u32Count; u32Index++)
+    {
+        pstKey[u32Index].dLeft = pstBB[pstKey[u32Index].u32Index].dLeft;
+    }
+
+    // Boxes move little between updates, so the keys are nearly sorted
+    // and insertion sort is close to linear.  Fall back to a full sort
+    // if that turns out to be wrong, e.g. on the first update.
+    for (Uint32 u32Index = 1; u32Index < u32Count; u32Index++)
+    {
+        BroadphaseKey stKey  = pstKey[u32Index];
+        Uint32        u32Pos = u32Index;
+
+        while (u32Pos > 0 && pstKey[u32Pos - 1].dLeft > stKey.dLeft)
+        {
+            pstKey[u32Pos] = pstKey[u32Pos - 1];
+            u32Pos--;
+            u32Shifts++;
+        }
+        pstKey[u32Pos] = stKey;
+
+        if (u32Shifts > u32Count * BROADPHASE_SHIFT_LIMIT)
+        {
+            SDL_qsort(pstKey, u32Count, sizeof(struct BroadphaseKey_t), _CompareKeys);
+            break;
+        }
+    }
+}
+
+static Sint8 _SweepAndPrune(const Uint32 u32Count, const AABB* pstBB, Broadphase* pstBroadphase)
+{
+    if (u32Count > pstBroadphase->u32BoxCapacity)
+    {
+        Uint32         u32Capacity = _GetCapacity(pstBroadphase->u32BoxCapacity, u32Count);
+        BroadphaseKey* pstKey;
+        AABB*          pstSorted;
+
+        pstKey = _Resize(pstBroadphase->pstKey, u32Capacity, sizeof(struct BroadphaseKey_t));
+        if (!pstKey)
+        {
+            return -1;
+        }
+        pstBroadphase->pstKey = pstKey;
+
+        pstSorted = _Resize(pstBroadphase->pstSorted, u32Capacity, sizeof(struct AABB_t));
+        if (!pstSorted)
+        {
+            return -1;
+        }
+        pstBroadphase->pstSorted      = pstSorted;
+        pstBroadphase->u32BoxCapacity = u32Capacity;
+    }
+
+    _SortKeys(u32Count, pstBB, pstBroadphase);
+    pstBroadphase->u32Count = u32Count;
+
+    // Sweep over a sorted copy so the inner loop reads memory in order.
+    for (Uint32 u32Index = 0; u32Index < u32Count; u32Index++)
+    {
+        pstBroadphase->pstSorted[u32Index] = pstBB[pstBroadphase->pstKey[u32Index].u32Index];
+    }
+
+    for (Uint32 u32Index = 0; u32Index < u32Count; u32Index++)
+    {
+        const AABB* pstBoxA = &pstBroadphase->pstSorted[u32Index];
+
+        for (Uint32 u32Other = u32Index + 1;
+             u32Other < u32Count && pstBroadphase->pstSorted[u32Other].dLeft <= pstBoxA->dRight;
+             u32Other++)
+        {
+            const AABB* pstBoxB = &pstBroadphase->pstSorted[u32Other];
+
+            if (pstBoxB->dTop <= pstBoxA->dBottom && pstBoxA->dTop <= pstBoxB->dBottom)
+            {
+                if (-1 == _AddPair(
+                        pstBroadphase->pstKey[u32Index].u32Index,
+                        pstBroadphase->pstKey[u32Other].u32Index,
+                        pstBroadphase))
+                {
+                    return -1;
+                }
+            }
+        }
+    }
+
+    return 0;
+}
+
+static Uint32 _HashCell(const Sint32 s32CellX, const Sint32 s32CellY, const Uint32 u32BucketCount)
+{
+    return (((Uint32)s32CellX * 73856093u) ^ ((Uint32)s32CellY * 19349663u)) &
+        (u32BucketCount - 1);
+}
+
+static Sint32 _GetCell(const Scalar dPos, const double dCellSize)
+{
+    return (Sint32)SDL_floor(Scalar_ToDouble(dPos) / dCellSize);
+}
+
+static Sint8 _CountCells(const AABB* pstBox, const double dCellSize, Uint64* pu64Cells)
+{
+    double dLeft   = SDL_floor(Scalar_ToDouble(pstBox->dLeft) / dCellSize);
+    double dRight  = SDL_floor(Scalar_ToDouble(pstBox->dRight) / dCellSize);
+    double dTop    = SDL_floor(Scalar_ToDouble(pstBox->dTop) / dCellSize);
+    double dBottom = SDL_floor(Scalar_ToDouble(pstBox->dBottom) / dCellSize);
+
+    // Cell positions have to fit into Sint32, see _GetCell().  Written
+    // this way round, NaN fails as well.
+    if (!(dLeft >= SDL_MIN_SINT32 && dLeft <= dRight && dRight <= SDL_MAX_SINT32 &&
+          dTop >= SDL_MIN_SINT32 && dTop <= dBottom && dBottom <= SDL_MAX_SINT32))
+    {
+        return -1;
+    }
+
+    // Each span can reach 2^32 cells, so their product could wrap.
+    // Capped one above the limit, a too large box still exceeds it.
+    *pu64Cells = (Uint64)SDL_min(dRight - dLeft + 1, BROADPHASE_CELLS_MAX + 1) *
+                 (Uint64)SDL_min(dBottom - dTop + 1, BROADPHASE_CELLS_MAX + 1);
+
+    return 0;
+}
+
+static Sint8 _SpatialHash(const Uint32 u32Count, const AABB* pstBB, Broadphase* pstBroadphase)
+{
+    double  dCellSize     = pstBroadphase->dCellSize;
+    Uint64  u64EntryCount = 0;
+    Uint32  u32EntryCount;
+    Uint32* pu32Start;
+    Uint32  u32BucketCount;
+
+    pstBroadphase->u32Count = u32Count;
+
+    for (Uint32 u32Index = 0; u32Index < u32Count; u32Index++)
+    {
+        Uint64 u64Cells;
+
+        if (-1 == _CountCells(&pstBB[u32Index], dCellSize, &u64Cells) ||
+            u64Cells > BROADPHASE_CELLS_MAX)
+        {
+            SDL_LogError(
+                SDL_LOG_CATEGORY_APPLICATION,
+                "UpdateBroadphase(): box %u is invalid or covers too many cells.\n",
+                u32Index);
+            return -1;
+        }
+
+        u64EntryCount += u64Cells;
+    }
+
+    if (u64EntryCount > BROADPHASE_ENTRIES_MAX)
+    {
+        SDL_LogError(
+            SDL_LOG_CATEGORY_APPLICATION, "UpdateBroadphase(): too many spatial hash entries.\n");
+        return -1;
+    }
+    u32EntryCount = (Uint32)u64EntryCount;
+
+    if (u32EntryCount > pstBroadphase->u32EntryCapacity)
+    {
+        Uint32           u32Capacity;
+        BroadphaseEntry* pstEntry;
+
+        u32Capacity = _GetCapacity(pstBroadphase->u32EntryCapacity, u32EntryCount);
+        pstEntry =
+            _Resize(pstBroadphase->pstEntry, u32Capacity, sizeof(struct BroadphaseEntry_t));
+        if (!pstEntry)
+        {
+            return -1;
+        }
+        pstBroadphase->pstEntry         = pstEntry;
+        pstBroadphase->u32EntryCapacity = u32Capacity;
+    }
+
+    // The bucket table only grows; about one entry per bucket.
+    u32BucketCount = pstBroadphase->u32BucketCount;
+    if (u32EntryCount > u32BucketCount)
+    {
+        u32BucketCount = _GetCapacity(u32BucketCount, u32EntryCount);
+
+        pu32Start = _Resize(pstBroadphase->pu32BucketStart, u32BucketCount + 1, sizeof(Uint32));
+        if (!pu32Start)
+        {
+            return -1;
+        }
+        pstBroadphase->pu32BucketStart = pu32Start;
+        pstBroadphase->u32BucketCount  = u32BucketCount;
+    }
+
+    if (0 == u32BucketCount)
+    {
+        return 0;
+    }
+
+    // Group the entries by bucket (counting sort).  After the second
+    // pass each bucket starts where the previous one ends.
+    pu32Start = pstBroadphase->pu32BucketStart;
+    SDL_memset(pu32Start, 0, (u32BucketCount + 1) * sizeof(Uint32));
+
+    for (Uint8 u8Pass = 0; u8Pass < 2; u8Pass++)
+    {
+        for (Uint32 u32Index = 0; u32Index < u32Count; u32Index++)
+        {
+            Sint32 s32CellX0 = _GetCell(pstBB[u32Index].dLeft, dCellSize);
+            Sint32 s32CellY0 = _GetCell(pstBB[u32Index].dTop, dCellSize);
+            Sint32 s32CellX1 = _GetCell(pstBB[u32Index].dRight, dCellSize);
+            Sint32 s32CellY1 = _GetCell(pstBB[u32Index].dBottom, dCellSize);
+
+            for (Sint32 s32CellY = s32CellY0; s32CellY <= s32CellY1; s32CellY++)
+            {
+                for (Sint32 s32CellX = s32CellX0; s32CellX <= s32CellX1; s32CellX++)
+                {
+                    Uint32 u32Bucket = _HashCell(s32CellX, s32CellY, u32BucketCount);
+
+                    if (0 == u8Pass)
+                    {
+                        pu32Start[u32Bucket]++;
+                    }
+                    else
+                    {
+                        BroadphaseEntry* pstEntry;
+
+                        pu32Start[u32Bucket]--;
+                        pstEntry           = &pstBroadphase->pstEntry[pu32Start[u32Bucket]];
+                        pstEntry->s32CellX = s32CellX;
+                        pstEntry->s32CellY = s32CellY;
+                        pstEntry->u32Index = u32Index;
+                    }
+                }
+            }
+        }
+
+        if (0 == u8Pass)
+        {
+            for (Uint32 u32Bucket = 1; u32Bucket < u32BucketCount; u32Bucket++)
+            {
+                pu32Start[u32Bucket] += pu32Start[u32Bucket - 1];
+            }
+            pu32Start[u32BucketCount] = u32EntryCount;
+        }
+    }
+
+    for (Uint32 u32Bucket = 0; u32Bucket < u32BucketCount; u32Bucket++)
+    {
+        Uint32 u32End = pu32Start[u32Bucket + 1];
+
+        for (Uint32 u32Entry = pu32Start[u32Bucket]; u32Entry < u32End; u32Entry++)
+        {
+            const BroadphaseEntry* pstEntryA = &pstBroadphase->pstEntry[u32Entry];
+            const AABB*            pstBoxA   = &pstBB[pstEntryA->u32Index];
+
+            for (Uint32 u32Other = u32Entry + 1; u32Other < u32End; u32Other++)
+            {
+                const BroadphaseEntry* pstEntryB = &pstBroadphase->pstEntry[u32Other];
+                const AABB*            pstBoxB   = &pstBB[pstEntryB->u32Index];
+                Sint32                 s32CellX;
+                Sint32                 s32CellY;
+
+                // Different cells may share a bucket.
+                if (pstEntryA->s32CellX != pstEntryB->s32CellX ||
+                    pstEntryA->s32CellY != pstEntryB->s32CellY || !_DoOverlap(pstBoxA, pstBoxB))
+                {
+                    continue;
+                }
+
+                // Boxes that share several cells are only reported in
+                // the cell that holds the top-left corner of their
+                // intersection.
+                s32CellX = _GetCell(SDL_max(pstBoxA->dLeft, pstBoxB->dLeft), dCellSize);
+                s32CellY = _GetCell(SDL_max(pstBoxA->dTop, pstBoxB->dTop), dCellSize);
+                if (pstEntryA->s32CellX != s32CellX || pstEntryA->s32CellY != s32CellY)
+                {
+                    continue;
+                }
+
+                if (-1 == _AddPair(pstEntryA->u32Index, pstEntryB->u32Index, pstBroadphase))
+                {
+                    return -1;
+                }
+            }
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief   Free broadphase
+ * @details Frees up allocated memory of a broadphase
+ * @param   pstBroadphase
+ *          Pointer to broadphase handle
+ */
+void Broadphase_Free(Broadphase* pstBroadphase)
+{
+    if (pstBroadphase)
+    {
+        SDL_free(pstBroadphase->pstKey);
+        SDL_free(pstBroadphase->pstSorted);
+        SDL_free(pstBroadphase->pstEntry);
+        SDL_free(pstBroadphase->pu32BucketStart);
+        SDL_free(pstBroadphase->pstPair);
+        SDL_free(pstBroadphase);
+    }
+}
+
+/**
+ * @brief   Get intersecting pairs
+ * @details Returns the pairs of intersecting boxes found by the last
+ *          call of Broadphase_Update().  Every pair is listed once, in
+ *          no particular order.
+ * @param   ppstPair
+ *          Pointer to store the address of the pair array
+ * @param   pstBroadphase
+ *          Pointer to broadphase handle
+ * @return  Number of pairs
+ */
+Uint32 Broadphase_GetPairs(const BroadphasePair** ppstPair, const Broadphase* pstBroadphase)
+{
+    *ppstPair = pstBroadphase->pstPair;
+
+    return pstBroadphase->u32PairCount;
+}
+
+/**
+ * @brief   Initialise broadphase
+ * @details Initialises a broadphase that finds the pairs of
+ *          intersecting boxes among a set of boxes
+ * @remark  Sweep-and-prune works well for any box size and profits
+ *          from boxes keeping their indices between updates.  The
+ *          spatial hash suits many boxes of similar size; the cell size
+ *          should be about the size of a typical box.
+ * @param   eMethod
+ *          Method used to find pairs
+ * @param   dCellSize
+ *          Spatial hash cell edge length in pixel, ignored by
+ *          sweep-and-prune
+ * @param   pstBroadphase
+ *          Pointer to broadphase handle
+ * @return  Error code
+ * @retval   0: OK
+ * @retval  -1: Error
+ */
+Sint8 Broadphase_Init(
+    const BroadphaseMethod eMethod,
+    const double           dCellSize,
+    Broadphase**           pstBroadphase)
+{
+    if (BROADPHASE_SPATIAL_HASH == eMethod && dCellSize <= 0)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InitBroadphase(): invalid cell size.\n");
+        return -1;
+    }
+
+    *pstBroadphase = SDL_calloc(sizeof(struct Broadphase_t), sizeof(Sint8));
+    if (!*pstBroadphase)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InitBroadphase(): error allocating memory.\n");
+        return -1;
+    }
+
+    (*pstBroadphase)->eMethod   = eMethod;
+    (*pstBroadphase)->dCellSize = dCellSize;
+
+    return 0;
+}
+
+/**
+ * @brief   Update broadphase
+ * @details Finds all pairs of intersecting boxes, see
+ *          Broadphase_GetPairs()
+ * @remark  This function is usually called once per frame, e.g. with
+ *          the bounding boxes of all entities.  The spatial hash
+ *          rejects boxes that cover more than BROADPHASE_CELLS_MAX
+ *          cells; use a larger cell size or sweep-and-prune for them.
+ * @param   u32Count
+ *          Number of boxes
+ * @param   pstBB
+ *          Array of boxes
+ * @param   pstBroadphase
+ *          Pointer to broadphase handle
+ * @return  Error code
+ * @retval   0: OK
+ * @retval  -1: Error, the pair list is incomplete
+ */
+Sint8 Broadphase_Update(const Uint32 u32Count, const AABB* pstBB, Broadphase* pstBroadphase)
+{
+    pstBroadphase->u32PairCount = 0;
+
+    if (BROADPHASE_SPATIAL_HASH == pstBroadphase->eMethod)
+    {
+        return _SpatialHash(u32Count, pstBB, pstBroadphase);
+    }
+
+    return _SweepAndPrune(u32Count, pstBB, pstBroadphase);
+}
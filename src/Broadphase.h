@@ -0,0 +1,112 @@
+// SPDX-License-Identifier: Beerware
+/**
+ * @file    Broadphase.h
+ * @brief   Broadphase collision include header
+ * @ingroup Broadphase
+ */
+#pragma once
+
+#include <SDL.h>
+#include "AABB.h"
+
+/**
+ * @typedef BroadphaseConstants
+ * @brief   Broadphase constants handle type
+ * @enum    BroadphaseConstants_t
+ * @brief   Broadphase constants enumeration
+ */
+typedef enum BroadphaseConstants_t
+{
+    BROADPHASE_SHIFT_LIMIT = 8,         ///< Insertion sort moves per box before a full sort
+    BROADPHASE_CELLS_MAX   = 4096,      ///< Max. spatial hash cells covered by one box
+    BROADPHASE_ENTRIES_MAX = 0x4000000  ///< Max. spatial hash entries per update
+
+} BroadphaseConstants;
+
+/**
+ * @typedef BroadphaseMethod
+ * @brief   Broadphase method type
+ * @enum    BroadphaseMethod_t
+ * @brief   Broadphase method enumeration
+ */
+typedef enum BroadphaseMethod_t
+{
+    BROADPHASE_SWEEP_AND_PRUNE = 0,  ///< Boxes kept sorted along the x-axis between updates
+    BROADPHASE_SPATIAL_HASH          ///< Boxes hashed into a uniform grid each update
+
+} BroadphaseMethod;
+
+/**
+ * @typedef BroadphasePair
+ * @brief   Broadphase pair handle type
+ * @struct  BroadphasePair_t
+ * @brief   Pair of intersecting boxes
+ */
+typedef struct BroadphasePair_t
+{
+    Uint32 u32A;  ///< Index of the first box
+    Uint32 u32B;  ///< Index of the second box, always greater than u32A
+
+} BroadphasePair;
+
+/**
+ * @typedef BroadphaseKey
+ * @brief   Broadphase key handle type
+ * @struct  BroadphaseKey_t
+ * @brief   Sort key of a box for sweep-and-prune
+ */
+typedef struct BroadphaseKey_t
+{
+    Scalar dLeft;     ///< Left edge position
+    Uint32 u32Index;  ///< Box index
+
+} BroadphaseKey;
+
+/**
+ * @typedef BroadphaseEntry
+ * @brief   Broadphase entry handle type
+ * @struct  BroadphaseEntry_t
+ * @brief   Grid cell covered by a box for the spatial hash
+ */
+typedef struct BroadphaseEntry_t
+{
+    Sint32 s32CellX;  ///< Cell position along the x-axis
+    Sint32 s32CellY;  ///< Cell position along the y-axis
+    Uint32 u32Index;  ///< Box index
+
+} BroadphaseEntry;
+
+/**
+ * @typedef Broadphase
+ * @brief   Broadphase handle type
+ * @struct  Broadphase_t
+ * @brief   Broadphase handle data
+ */
+typedef struct Broadphase_t
+{
+    BroadphaseMethod eMethod;           ///< Method used to find pairs
+    double           dCellSize;         ///< Spatial hash cell edge length in pixel
+    Uint32           u32Count;          ///< Number of boxes of the last update
+    Uint32           u32BoxCapacity;    ///< Capacity of the per-box arrays
+    BroadphaseKey*   pstKey;            ///< Sweep-and-prune: keys sorted by left edge
+    AABB*            pstSorted;         ///< Sweep-and-prune: boxes in key order
+    BroadphaseEntry* pstEntry;          ///< Spatial hash: entries grouped by bucket
+    Uint32           u32EntryCapacity;  ///< Capacity of pstEntry
+    Uint32*          pu32BucketStart;   ///< Spatial hash: first entry per bucket
+    Uint32           u32BucketCount;    ///< Spatial hash: number of buckets, power of two
+    BroadphasePair*  pstPair;           ///< Pairs of the last update
+    Uint32           u32PairCount;      ///< Number of pairs
+    Uint32           u32PairCapacity;   ///< Capacity of pstPair
+
+} Broadphase;
+
+void Broadphase_Free(Broadphase* pstBroadphase);
+
+Uint32 Broadphase_GetPairs(const BroadphasePair** ppstPair, const Broadphase* pstBroadphase);
+
+Sint8 Broadphase_Init(
+    const BroadphaseMethod eMethod,
+    const double           dCellSize,
+    Broadphase**           pstBroadphase);
+
+Sint8 Broadphase_Update(const Uint32 u32Count, const AABB* pstBB, Broadphase* pstBroadphase);
@@ -9,12 +9,47 @@
  */
 
 #include <SDL.h>
-#include <SDL_image.h>
 #include "AABB.h"
+#include "Asset.h"
 #include "Constants.h"
 #include "Entity.h"
+#include "Job.h"
+#include "Map.h"
+#include "Scalar.h"
+#include "Simd.h"
+#include "SpriteAtlas.h"
+#include "SpriteBatch.h"
 #include "Utils.h"
 
+/**
+ * @def     UPDATE_BLOCK_LEN
+ * @brief   Number of entities Entity_UpdateAll() processes per pass and
+ *          job
+ * @details Chosen so the per-block scratch arrays stay in L1 cache.
+ */
+#define UPDATE_BLOCK_LEN 256
+
+/**
+ * @def     BULLET_CHUNK_LEN
+ * @brief   Number of entities a bullet is tested against at once
+ * @details Keeps the intersection mask on the stack; a multiple of 32
+ *          and SIMD_PADDING.
+ */
+#define BULLET_CHUNK_LEN 1024
+
+/**
+ * @def     GROUND_PROBE
+ * @brief   Distance in pixel a grounded entity is probed for ground
+ *          below it, see Entity_UpdateAll()
+ */
+#define GROUND_PROBE 1.0
+
+/**
+ * @def     ENTITY_WORLD_POOLS
+ * @brief   Number of Scalar pools of an entity world
+ */
+#define ENTITY_WORLD_POOLS 14
+
 /**
  * @typedef Flags
  * @brief   Entity flags type
@@ -32,6 +67,696 @@ typedef enum Flags_t
 
 } Flags;
 
+/**
+ * @typedef EntityUpdate
+ * @brief   Entity update handle type
+ * @struct  EntityUpdate_t
+ * @brief   Parameters of an entity world update, shared by all blocks
+ */
+typedef struct EntityUpdate_t
+{
+    Scalar       dDeltaTime;      ///< Delta time since last update
+    Scalar       dGravitation;    ///< Gravitational constant
+    Scalar       dStepY;          ///< Vertical velocity gained per update
+    Uint8        u8MeterInPixel;  ///< Definition of meter in pixel
+    Uint32       u32SolidMask;    ///< Tile types to collide with
+    const Map*   pstMap;          ///< Map to collide with, may be NULL
+    EntityWorld* pstWorld;        ///< Entity world to update
+    TileContact* pstContact;      ///< Contact per entity, may be NULL
+
+} EntityUpdate;
+
+/**
+ * @typedef BulletUpdate
+ * @brief   Bullet update handle type
+ * @struct  BulletUpdate_t
+ * @brief   Parameters of a bullet pool update, shared by all blocks
+ */
+typedef struct BulletUpdate_t
+{
+    Uint32             u32SolidMask;  ///< Tile types to collide with
+    const Map*         pstMap;        ///< Map to collide with, may be NULL
+    const EntityWorld* pstWorld;      ///< Entities to collide with, may be NULL
+    BulletPool*        pstPool;       ///< Bullet pool to update
+
+} BulletUpdate;
+
+static void _GetFrameRects(
+    const Entity* pstEntity,
+    const Camera* pstCamera,
+    const Sprite* pstSprite,
+    SDL_Rect*     pstSrc,
+    SDL_Rect*     pstDst)
+{
+    double dPosX = Scalar_ToDouble(pstEntity->dPosX - pstCamera->dPosX);
+    double dPosY = Scalar_ToDouble(pstEntity->dPosY - pstCamera->dPosY);
+
+    pstSrc->x = pstSprite->u16ImageOffsetX;
+    pstSrc->x += pstEntity->u8FrameOffsetX * pstEntity->u16Width;
+    pstSrc->x += pstEntity->u8AnimFrame * pstEntity->u16Width;
+    pstSrc->y = pstSprite->u16ImageOffsetY;
+    pstSrc->y += pstEntity->u8FrameOffsetY * pstEntity->u16Height;
+    pstSrc->w = pstEntity->u16Width;
+    pstSrc->h = pstEntity->u16Height;
+    pstDst->x = dPosX - (pstEntity->u16Width / 2);
+    pstDst->y = dPosY - (pstEntity->u16Height / 2);
+    pstDst->w = pstEntity->u16Width;
+    pstDst->h = pstEntity->u16Height;
+}
+
+static SDL_Texture* _GetTexture(const Sprite* pstSprite)
+{
+    if (pstSprite->pstRequest)
+    {
+        return Asset_GetTexture(pstSprite->pstRequest);
+    }
+
+    return pstSprite->pstTexture;
+}
+
+static double _GetTimeOfImpact(
+    const double dPosX,
+    const double dPosY,
+    const double dHalfSize,
+    const double dDeltaX,
+    const double dDeltaY,
+    const AABB   stTarget)
+{
+    // Sweep the centre point against the target grown by the half size
+    // of the bullet; anything above 1 is a miss.
+    double adPos[2]   = { dPosX, dPosY };
+    double adDelta[2] = { dDeltaX, dDeltaY };
+    double adMin[2]   = { Scalar_ToDouble(stTarget.dLeft) - dHalfSize,
+                          Scalar_ToDouble(stTarget.dTop) - dHalfSize };
+    double adMax[2]   = { Scalar_ToDouble(stTarget.dRight) + dHalfSize,
+                          Scalar_ToDouble(stTarget.dBottom) + dHalfSize };
+    double dNear      = 0.0;
+    double dFar       = 1.0;
+
+    for (Uint8 u8Axis = 0; u8Axis < 2; u8Axis++)
+    {
+        double dEnter;
+        double dExit;
+
+        if (0 == adDelta[u8Axis])
+        {
+            if (adPos[u8Axis] < adMin[u8Axis] || adPos[u8Axis] > adMax[u8Axis])
+            {
+                return 2.0;
+            }
+            continue;
+        }
+
+        dEnter = (adMin[u8Axis] - adPos[u8Axis]) / adDelta[u8Axis];
+        dExit  = (adMax[u8Axis] - adPos[u8Axis]) / adDelta[u8Axis];
+
+        dNear = SDL_max(dNear, SDL_min(dEnter, dExit));
+        dFar  = SDL_min(dFar, SDL_max(dEnter, dExit));
+        if (dNear > dFar)
+        {
+            return 2.0;
+        }
+    }
+
+    return dNear;
+}
+
+static Sint32 _GetFirstHit(
+    const AABB         stSwept,
+    const double       dPosX,
+    const double       dPosY,
+    const double       dHalfSize,
+    double*            pdDeltaX,
+    double*            pdDeltaY,
+    const Sint32       s32Owner,
+    const EntityWorld* pstWorld)
+{
+    Uint32 au32Mask[AABB_MASK_WORDS(BULLET_CHUNK_LEN)];
+    Sint32 s32Target = BULLET_HIT_NONE;
+    double dFirst    = 1.0;
+
+    // Narrow the entities down to those the path's bounding box
+    // touches, then find the first one hit on the path.  The bounding
+    // boxes of the entity world serve as box array.
+    for (Uint32 u32Start = 0; u32Start < pstWorld->u32Count; u32Start += BULLET_CHUNK_LEN)
+    {
+        AABBArray stChunk;
+
+        stChunk.u32Count    = SDL_min(pstWorld->u32Count - u32Start, BULLET_CHUNK_LEN);
+        stChunk.u32Capacity = stChunk.u32Count;
+        stChunk.pdBottom    = &pstWorld->pdBottom[u32Start];
+        stChunk.pdLeft      = &pstWorld->pdLeft[u32Start];
+        stChunk.pdRight     = &pstWorld->pdRight[u32Start];
+        stChunk.pdTop       = &pstWorld->pdTop[u32Start];
+
+        if (0 == AABB_TestOneVsMany(stSwept, &stChunk, au32Mask))
+        {
+            continue;
+        }
+
+        for (Uint32 u32Word = 0; u32Word < AABB_MASK_WORDS(stChunk.u32Count); u32Word++)
+        {
+            for (Uint32 u32Bit = 0; u32Bit < 32; u32Bit++)
+            {
+                Uint32 u32Entity = u32Start + u32Word * 32 + u32Bit;
+                AABB   stTarget;
+                double dTime;
+
+                if (!((au32Mask[u32Word] >> u32Bit) & 1) || (Sint32)u32Entity == s32Owner)
+                {
+                    continue;
+                }
+
+                stTarget.dBottom = pstWorld->pdBottom[u32Entity];
+                stTarget.dLeft   = pstWorld->pdLeft[u32Entity];
+                stTarget.dRight  = pstWorld->pdRight[u32Entity];
+                stTarget.dTop    = pstWorld->pdTop[u32Entity];
+
+                dTime = _GetTimeOfImpact(dPosX, dPosY, dHalfSize, *pdDeltaX, *pdDeltaY, stTarget);
+                if (dTime <= dFirst)
+                {
+                    dFirst    = dTime;
+                    s32Target = (Sint32)u32Entity;
+                }
+            }
+        }
+    }
+
+    if (s32Target >= 0)
+    {
+        *pdDeltaX *= dFirst;
+        *pdDeltaY *= dFirst;
+    }
+
+    return s32Target;
+}
+
+static void _Integrate(
+    const Uint32  u32Count,
+    const Scalar  dStepY,
+    const Scalar* pdStepX,
+    const Scalar* pdSign,
+    const Scalar* pdFall,
+    const Scalar* pdMaxVelocityX,
+    Scalar*       pdVelocityX,
+    Scalar*       pdVelocityY,
+    Scalar*       pdPosX,
+    Scalar*       pdPosY)
+{
+    SimdScalar vStepY = Simd_Set(dStepY);
+    SimdScalar vZero  = Simd_Set(0.f);
+
+    for (Uint32 u32Index = 0; u32Index < u32Count; u32Index += SIMD_WIDTH)
+    {
+        SimdScalar vFall      = Simd_Load(&pdFall[u32Index]);
+        SimdScalar vVelocityX = Simd_Load(&pdVelocityX[u32Index]);
+        SimdScalar vVelocityY = Simd_Add(Simd_Load(&pdVelocityY[u32Index]), vStepY);
+        SimdScalar vMoveX;
+
+        // Clamp the speed to [0, max]; grounded entities lose their
+        // vertical velocity.
+        vVelocityX = Simd_Add(vVelocityX, Simd_Load(&pdStepX[u32Index]));
+        vVelocityX = Simd_Max(Simd_Min(vVelocityX, Simd_Load(&pdMaxVelocityX[u32Index])), vZero);
+        vVelocityY = Simd_Mul(vVelocityY, vFall);
+        vMoveX     = Simd_Mul(Simd_Load(&pdSign[u32Index]), vVelocityX);
+
+        Simd_Store(&pdVelocityX[u32Index], vVelocityX);
+        Simd_Store(&pdVelocityY[u32Index], vVelocityY);
+        Simd_Store(&pdPosX[u32Index], Simd_Add(Simd_Load(&pdPosX[u32Index]), vMoveX));
+        Simd_Store(&pdPosY[u32Index], Simd_Add(Simd_Load(&pdPosY[u32Index]), vVelocityY));
+    }
+}
+
+static void _MoveBullets(const Uint32 u32First, const Uint32 u32Count, BulletPool* pstPool)
+{
+    for (Uint32 u32Index = u32First; u32Index < u32First + u32Count; u32Index += SIMD_WIDTH)
+    {
+        SimdScalar vPosX = Simd_Load(&pstPool->pdPosX[u32Index]);
+        SimdScalar vPosY = Simd_Load(&pstPool->pdPosY[u32Index]);
+
+        // Free slots have no velocity and stay where they are.
+        vPosX = Simd_Add(vPosX, Simd_Load(&pstPool->pdVelocityX[u32Index]));
+        vPosY = Simd_Add(vPosY, Simd_Load(&pstPool->pdVelocityY[u32Index]));
+
+        Simd_Store(&pstPool->pdPosX[u32Index], vPosX);
+        Simd_Store(&pstPool->pdPosY[u32Index], vPosY);
+    }
+}
+
+static void _RebuildBB(const Uint32 u32First, const Uint32 u32Count, EntityWorld* pstWorld)
+{
+    SimdScalar vZero = Simd_Set(0.f);
+
+    for (Uint32 u32Index = u32First; u32Index < u32First + u32Count; u32Index += SIMD_WIDTH)
+    {
+        SimdScalar vPosX       = Simd_Load(&pstWorld->pdPosX[u32Index]);
+        SimdScalar vPosY       = Simd_Load(&pstWorld->pdPosY[u32Index]);
+        SimdScalar vHalfWidth  = Simd_Load(&pstWorld->pdHalfWidth[u32Index]);
+        SimdScalar vHalfHeight = Simd_Load(&pstWorld->pdHalfHeight[u32Index]);
+
+        Simd_Store(&pstWorld->pdBottom[u32Index], Simd_Add(vPosY, vHalfHeight));
+        Simd_Store(&pstWorld->pdLeft[u32Index], Simd_Max(Simd_Sub(vPosX, vHalfWidth), vZero));
+        Simd_Store(&pstWorld->pdRight[u32Index], Simd_Add(vPosX, vHalfWidth));
+        Simd_Store(&pstWorld->pdTop[u32Index], Simd_Max(Simd_Sub(vPosY, vHalfHeight), vZero));
+    }
+}
+
+static void _ReleaseBullet(const Uint32 u32Index, BulletPool* pstPool)
+{
+    pstPool->pdVelocityX[u32Index]  = 0;
+    pstPool->pdVelocityY[u32Index]  = 0;
+    pstPool->pu16Life[u32Index]     = 0;
+    pstPool->pu32NextFree[u32Index] = pstPool->u32FreeHead;
+    pstPool->u32FreeHead            = u32Index;
+    pstPool->u32Count--;
+
+    // Once empty, start over from the first slot.
+    if (0 == pstPool->u32Count)
+    {
+        pstPool->u32Used     = 0;
+        pstPool->u32FreeHead = pstPool->u32Capacity;
+    }
+}
+
+static void _UpdateBB(Entity* pstEntity)
+{
+    pstEntity->stBB.dBottom = pstEntity->dPosY + Scalar_FromDouble(pstEntity->u16Height / 2.f);
+    pstEntity->stBB.dLeft   = pstEntity->dPosX - Scalar_FromDouble(pstEntity->u16Width / 2.f);
+    pstEntity->stBB.dRight  = pstEntity->dPosX + Scalar_FromDouble(pstEntity->u16Width / 2.f);
+    pstEntity->stBB.dTop    = pstEntity->dPosY - Scalar_FromDouble(pstEntity->u16Height / 2.f);
+
+    if (pstEntity->stBB.dLeft <= 0)
+    {
+        pstEntity->stBB.dLeft = 0;
+    }
+
+    if (pstEntity->stBB.dTop <= 0)
+    {
+        pstEntity->stBB.dTop = 0;
+    }
+}
+
+static void _UpdateBlocks(const Uint32 u32First, const Uint32 u32Last, void* pData)
+{
+    const EntityUpdate* pstUpdate      = pData;
+    EntityWorld*        pstWorld       = pstUpdate->pstWorld;
+    const Map*          pstMap         = pstUpdate->pstMap;
+    Scalar              dDeltaTime     = pstUpdate->dDeltaTime;
+    Scalar              dGravitation   = pstUpdate->dGravitation;
+    Scalar              dStepTime      = Scalar_FromDouble(DELTA_TIME);
+    Uint8               u8MeterInPixel = pstUpdate->u8MeterInPixel;
+    TileContact*        pstContact     = pstUpdate->pstContact;
+    Scalar              adStepX[UPDATE_BLOCK_LEN];
+    Scalar              adSign[UPDATE_BLOCK_LEN];
+    Scalar              adFall[UPDATE_BLOCK_LEN];
+    Scalar              adStartX[UPDATE_BLOCK_LEN];
+    Scalar              adStartY[UPDATE_BLOCK_LEN];
+    Scalar              adVelocityY[UPDATE_BLOCK_LEN];
+
+    for (Uint32 u32Block = u32First; u32Block < u32Last; u32Block++)
+    {
+        Uint32 u32Base   = u32Block * UPDATE_BLOCK_LEN;
+        Uint32 u32Count  = SDL_min(pstWorld->u32Count - u32Base, UPDATE_BLOCK_LEN);
+        Uint32 u32Padded = (u32Count + SIMD_PADDING - 1) & ~(Uint32)(SIMD_PADDING - 1);
+
+        // Turn the flags into per-entity factors so the integration is
+        // free of branches.  Padding entries are processed as well.
+        for (Uint32 u32Index = 0; u32Index < u32Padded; u32Index++)
+        {
+            Uint32 u32Entity = u32Base + u32Index;
+            Uint8  u8Flags   = pstWorld->pu8Flags[u32Entity];
+            Scalar dAccel    = pstWorld->pdAcceleration[u32Entity];
+
+            if (0 != dGravitation)
+            {
+                if (0 > pstWorld->pdVelocityY[u32Entity])
+                {
+                    u8Flags |= ENTITY_IS_IN_MID_AIR;
+                }
+                else if (!(u8Flags & ENTITY_IS_IN_MID_AIR))
+                {
+                    u8Flags &= ~ENTITY_IS_JUMPING;
+                }
+            }
+
+            adFall[u32Index]   = (u8Flags & ENTITY_IS_IN_MID_AIR) ? Scalar_FromInt(1) : 0;
+            adStepX[u32Index]  = -Scalar_Mul(dAccel, dStepTime);
+            adSign[u32Index]   = Scalar_FromInt((u8Flags & ENTITY_FACES_LEFT) ? -1 : 1);
+
+            if (u8Flags & ENTITY_IS_MOVING)
+            {
+                adStepX[u32Index] =
+                    Scalar_Mul(Scalar_Mul(dAccel * u8MeterInPixel, dStepTime), dStepTime);
+            }
+
+            if (0 == dGravitation)
+            {
+                adFall[u32Index] = 0;
+            }
+            adStartX[u32Index] = pstWorld->pdPosX[u32Entity];
+            adStartY[u32Index] = pstWorld->pdPosY[u32Entity];
+
+            pstWorld->pu8Flags[u32Entity] = u8Flags;
+        }
+
+        // Without gravitation, Entity_Update() keeps the vertical
+        // velocity, whereas a zero fall factor clears it.
+        if (0 == dGravitation)
+        {
+            SDL_memcpy(adVelocityY, &pstWorld->pdVelocityY[u32Base], u32Padded * sizeof(Scalar));
+        }
+
+        _Integrate(
+            u32Padded,
+            pstUpdate->dStepY,
+            adStepX,
+            adSign,
+            adFall,
+            &pstWorld->pdMaxVelocityX[u32Base],
+            &pstWorld->pdVelocityX[u32Base],
+            &pstWorld->pdVelocityY[u32Base],
+            &pstWorld->pdPosX[u32Base],
+            &pstWorld->pdPosY[u32Base]);
+
+        if (0 == dGravitation)
+        {
+            SDL_memcpy(&pstWorld->pdVelocityY[u32Base], adVelocityY, u32Padded * sizeof(Scalar));
+        }
+
+        for (Uint32 u32Index = 0; pstMap && u32Index < u32Count; u32Index++)
+        {
+            Uint32      u32Entity   = u32Base + u32Index;
+            Scalar      dHalfWidth  = pstWorld->pdHalfWidth[u32Entity];
+            Scalar      dHalfHeight = pstWorld->pdHalfHeight[u32Entity];
+            TileContact stContact;
+            AABB        stBB;
+
+            stBB.dBottom = adStartY[u32Index] + dHalfHeight;
+            stBB.dLeft   = adStartX[u32Index] - dHalfWidth;
+            stBB.dRight  = adStartX[u32Index] + dHalfWidth;
+            stBB.dTop    = adStartY[u32Index] - dHalfHeight;
+
+            Map_SweepBox(
+                stBB,
+                Scalar_ToDouble(pstWorld->pdPosX[u32Entity] - adStartX[u32Index]),
+                Scalar_ToDouble(pstWorld->pdPosY[u32Entity] - adStartY[u32Index]),
+                pstUpdate->u32SolidMask,
+                pstMap,
+                &stContact);
+
+            if (stContact.s8NormalX)
+            {
+                pstWorld->pdVelocityX[u32Entity] = 0;
+            }
+
+            if (stContact.s8NormalY)
+            {
+                pstWorld->pdVelocityY[u32Entity] = 0;
+            }
+
+            pstWorld->pdPosX[u32Entity] = adStartX[u32Index] + Scalar_FromDouble(stContact.dDeltaX);
+            pstWorld->pdPosY[u32Entity] = adStartY[u32Index] + Scalar_FromDouble(stContact.dDeltaY);
+
+            if (-1 == stContact.s8NormalY)
+            {
+                pstWorld->pu8Flags[u32Entity] &= ~(ENTITY_IS_IN_MID_AIR | ENTITY_IS_JUMPING);
+            }
+            else if (0 != dGravitation && !(pstWorld->pu8Flags[u32Entity] & ENTITY_IS_IN_MID_AIR))
+            {
+                TileContact stGround;
+
+                // Grounded entities do not fall, so check whether they
+                // have walked off their ground.
+                stBB.dBottom = pstWorld->pdPosY[u32Entity] + dHalfHeight;
+                stBB.dLeft   = pstWorld->pdPosX[u32Entity] - dHalfWidth;
+                stBB.dRight  = pstWorld->pdPosX[u32Entity] + dHalfWidth;
+                stBB.dTop    = pstWorld->pdPosY[u32Entity] - dHalfHeight;
+
+                Map_SweepBox(stBB, 0, GROUND_PROBE, pstUpdate->u32SolidMask, pstMap, &stGround);
+                if (-1 != stGround.s8NormalY)
+                {
+                    pstWorld->pu8Flags[u32Entity] |= ENTITY_IS_IN_MID_AIR;
+                }
+            }
+
+            if (pstContact)
+            {
+                pstContact[u32Entity] = stContact;
+            }
+        }
+
+        _RebuildBB(u32Base, u32Padded, pstWorld);
+
+        // Update animation frames.
+        for (Uint32 u32Entity = u32Base; u32Entity < u32Base + u32Count; u32Entity++)
+        {
+            Uint8* pu8Frame = &pstWorld->pu8AnimFrame[u32Entity];
+
+            if (!(pstWorld->pu8Flags[u32Entity] & ENTITY_IS_ANIMATED))
+            {
+                *pu8Frame = pstWorld->pu8AnimStart[u32Entity];
+                continue;
+            }
+
+            pstWorld->pdAnimDelay[u32Entity] += dDeltaTime;
+
+            if (*pu8Frame < pstWorld->pu8AnimStart[u32Entity])
+            {
+                *pu8Frame = pstWorld->pu8AnimStart[u32Entity];
+            }
+
+            if (0 != pstWorld->pdAnimSpeed[u32Entity] &&
+                pstWorld->pdAnimDelay[u32Entity] >
+                    (Scalar_Div(Scalar_FromInt(1), pstWorld->pdAnimSpeed[u32Entity]) - dDeltaTime))
+            {
+                (*pu8Frame)++;
+                pstWorld->pdAnimDelay[u32Entity] = 0;
+            }
+
+            // Loop animation.
+            if (*pu8Frame >= pstWorld->pu8AnimEnd[u32Entity])
+            {
+                *pu8Frame = pstWorld->pu8AnimStart[u32Entity];
+            }
+        }
+    }
+}
+
+static void _UpdateBulletBlocks(const Uint32 u32First, const Uint32 u32Last, void* pData)
+{
+    const BulletUpdate* pstUpdate = pData;
+    BulletPool*         pstPool   = pstUpdate->pstPool;
+    const Map*          pstMap    = pstUpdate->pstMap;
+    const EntityWorld*  pstWorld  = pstUpdate->pstWorld;
+    Scalar              adStartX[UPDATE_BLOCK_LEN];
+    Scalar              adStartY[UPDATE_BLOCK_LEN];
+
+    for (Uint32 u32Block = u32First; u32Block < u32Last; u32Block++)
+    {
+        Uint32 u32Base   = u32Block * UPDATE_BLOCK_LEN;
+        Uint32 u32Count  = SDL_min(pstPool->u32Used - u32Base, UPDATE_BLOCK_LEN);
+        Uint32 u32Padded = (u32Count + SIMD_PADDING - 1) & ~(Uint32)(SIMD_PADDING - 1);
+
+        SDL_memcpy(adStartX, &pstPool->pdPosX[u32Base], u32Count * sizeof(Scalar));
+        SDL_memcpy(adStartY, &pstPool->pdPosY[u32Base], u32Count * sizeof(Scalar));
+
+        _MoveBullets(u32Base, u32Padded, pstPool);
+
+        for (Uint32 u32Index = 0; u32Index < u32Count; u32Index++)
+        {
+            Uint32 u32Bullet = u32Base + u32Index;
+            Scalar dHalfSize = pstPool->pdHalfSize[u32Bullet];
+            Sint32 s32Target = BULLET_HIT_NONE;
+            double dDeltaX;
+            double dDeltaY;
+            AABB   stBB;
+
+            if (0 == pstPool->pu16Life[u32Bullet])
+            {
+                continue;
+            }
+
+            pstPool->ps32Target[u32Bullet] = BULLET_HIT_NONE;
+            if (!pstMap && !pstWorld)
+            {
+                continue;
+            }
+
+            dDeltaX      = Scalar_ToDouble(pstPool->pdPosX[u32Bullet] - adStartX[u32Index]);
+            dDeltaY      = Scalar_ToDouble(pstPool->pdPosY[u32Bullet] - adStartY[u32Index]);
+            stBB.dBottom = adStartY[u32Index] + dHalfSize;
+            stBB.dLeft   = adStartX[u32Index] - dHalfSize;
+            stBB.dRight  = adStartX[u32Index] + dHalfSize;
+            stBB.dTop    = adStartY[u32Index] - dHalfSize;
+
+            if (pstMap)
+            {
+                TileContact stContact;
+
+                Map_SweepBox(stBB, dDeltaX, dDeltaY, pstUpdate->u32SolidMask, pstMap, &stContact);
+                if (stContact.s8NormalX || stContact.s8NormalY)
+                {
+                    s32Target = BULLET_HIT_TILE;
+                    dDeltaX   = stContact.dDeltaX;
+                    dDeltaY   = stContact.dDeltaY;
+                }
+            }
+
+            if (pstWorld)
+            {
+                Scalar dMoveX = Scalar_FromDouble(dDeltaX);
+                Scalar dMoveY = Scalar_FromDouble(dDeltaY);
+                Sint32 s32Entity;
+                AABB   stSwept;
+
+                stSwept.dBottom = stBB.dBottom + SDL_max(dMoveY, 0);
+                stSwept.dLeft   = stBB.dLeft + SDL_min(dMoveX, 0);
+                stSwept.dRight  = stBB.dRight + SDL_max(dMoveX, 0);
+                stSwept.dTop    = stBB.dTop + SDL_min(dMoveY, 0);
+
+                s32Entity = _GetFirstHit(
+                    stSwept,
+                    Scalar_ToDouble(adStartX[u32Index]),
+                    Scalar_ToDouble(adStartY[u32Index]),
+                    Scalar_ToDouble(dHalfSize),
+                    &dDeltaX,
+                    &dDeltaY,
+                    pstPool->ps32Owner[u32Bullet],
+                    pstWorld);
+
+                if (BULLET_HIT_NONE != s32Entity)
+                {
+                    s32Target = s32Entity;
+                }
+            }
+
+            if (BULLET_HIT_NONE != s32Target)
+            {
+                pstPool->pdPosX[u32Bullet]     = adStartX[u32Index] + Scalar_FromDouble(dDeltaX);
+                pstPool->pdPosY[u32Bullet]     = adStartY[u32Index] + Scalar_FromDouble(dDeltaY);
+                pstPool->ps32Target[u32Bullet] = s32Target;
+            }
+        }
+    }
+}
+
+/**
+ * @brief   Add entity to sprite batch
+ * @details Queues the current animation frame of an entity, the
+ *          batched counterpart of Entity_Draw()
+ * @param   pstEntity
+ *          Pointer to entity handle
+ * @param   pstCamera
+ *          Pointer to camera handle
+ * @param   pstSprite
+ *          Pointer to sprite handle
+ * @param   s16Layer
+ *          Layer, see SpriteBatch_Add()
+ * @param   pstBatch
+ *          Pointer to sprite batch handle
+ * @return  Error code
+ * @retval   0: OK
+ * @retval  -1: Error, the batch is full
+ */
+Sint8 Entity_AddToBatch(
+    const Entity* pstEntity,
+    const Camera* pstCamera,
+    const Sprite* pstSprite,
+    const Sint16  s16Layer,
+    SpriteBatch*  pstBatch)
+{
+    SDL_Color        stWhite    = { 0xff, 0xff, 0xff, 0xff };
+    SDL_RendererFlip s8Flip     = SDL_FLIP_NONE;
+    SDL_Texture*     pstTexture = _GetTexture(pstSprite);
+    SDL_Rect         stDst;
+    SDL_Rect         stSrc;
+
+    if (!pstTexture)
+    {
+        return 0;
+    }
+
+    if (LEFT == pstEntity->eDirection)
+    {
+        s8Flip = SDL_FLIP_HORIZONTAL;
+    }
+
+    _GetFrameRects(pstEntity, pstCamera, pstSprite, &stSrc, &stDst);
+
+    return SpriteBatch_Add(pstTexture, &stSrc, &stDst, s8Flip, stWhite, s16Layer, pstBatch);
+}
+
+/**
+ * @brief   Add entity to world
+ * @details Copies the state of an entity into an entity world, e.g. to
+ *          spawn many entities from one template entity
+ * @param   pstEntity
+ *          Pointer to entity handle
+ * @param   pstWorld
+ *          Pointer to entity world handle
+ * @return  Index of the entity in the world
+ * @retval  -1: World is full
+ */
+Sint32 Entity_AddToWorld(const Entity* pstEntity, EntityWorld* pstWorld)
+{
+    Uint32 u32Index = pstWorld->u32Count;
+    Uint8  u8Flags  = 0;
+
+    if (u32Index >= pstWorld->u32Capacity)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "AddToWorld(): entity world is full.\n");
+        return -1;
+    }
+
+    if (Utils_IsFlagSet(IS_ANIMATED, pstEntity->u16Flags))
+    {
+        u8Flags |= ENTITY_IS_ANIMATED;
+    }
+
+    if (Utils_IsFlagSet(IS_IN_MID_AIR, pstEntity->u16Flags))
+    {
+        u8Flags |= ENTITY_IS_IN_MID_AIR;
+    }
+
+    if (Utils_IsFlagSet(IS_MOVING, pstEntity->u16Flags))
+    {
+        u8Flags |= ENTITY_IS_MOVING;
+    }
+
+    if (pstEntity->bIsJumping)
+    {
+        u8Flags |= ENTITY_IS_JUMPING;
+    }
+
+    if (LEFT == pstEntity->eDirection)
+    {
+        u8Flags |= ENTITY_FACES_LEFT;
+    }
+
+    pstWorld->pdPosX[u32Index]         = pstEntity->dPosX;
+    pstWorld->pdPosY[u32Index]         = pstEntity->dPosY;
+    pstWorld->pdVelocityX[u32Index]    = pstEntity->dVelocityX;
+    pstWorld->pdVelocityY[u32Index]    = pstEntity->dVelocityY;
+    pstWorld->pdAcceleration[u32Index] = pstEntity->dAcceleration;
+    pstWorld->pdMaxVelocityX[u32Index] = pstEntity->dMaxVelocityX;
+    pstWorld->pdHalfWidth[u32Index]    = Scalar_FromDouble(pstEntity->u16Width / 2.f);
+    pstWorld->pdHalfHeight[u32Index]   = Scalar_FromDouble(pstEntity->u16Height / 2.f);
+    pstWorld->pdBottom[u32Index]       = pstEntity->stBB.dBottom;
+    pstWorld->pdLeft[u32Index]         = pstEntity->stBB.dLeft;
+    pstWorld->pdRight[u32Index]        = pstEntity->stBB.dRight;
+    pstWorld->pdTop[u32Index]          = pstEntity->stBB.dTop;
+    pstWorld->pdAnimDelay[u32Index]    = pstEntity->dAnimDelay;
+    pstWorld->pdAnimSpeed[u32Index]    = pstEntity->dAnimSpeed;
+    pstWorld->pu8Flags[u32Index]       = u8Flags;
+    pstWorld->pu8AnimFrame[u32Index]   = pstEntity->u8AnimFrame;
+    pstWorld->pu8AnimStart[u32Index]   = pstEntity->u8AnimStart;
+    pstWorld->pu8AnimEnd[u32Index]     = pstEntity->u8AnimEnd;
+
+    pstWorld->u32Count++;
+
+    return (Sint32)u32Index;
+}
+
 /**
  * @brief   Animate entity
  * @details Sets or clears the entity's IS_ANIMATED flag
@@ -56,20 +781,21 @@ void Entity_Animate(SDL_bool bAnimate, Entity* pstEntity)
  * @brief   Connect horizontal map ends for entity
  * @details Connects the horizontal map ends for an entity so it can
  *          travel from one side to the other by leaving the map
- * @param   u16MapWidth
+ * @param   u32MapWidth
  *          Map width
  * @param   pstEntity
  *          Pointer to entity handle
  */
-void Entity_ConnectHorizontalMapEnds(const Uint16 u16MapWidth, Entity* pstEntity)
+void Entity_ConnectHorizontalMapEnds(const Uint32 u32MapWidth, Entity* pstEntity)
 {
-    double dWidth = (double)pstEntity->u16Width;
+    Scalar dWidth    = Scalar_FromInt(pstEntity->u16Width);
+    Scalar dMapWidth = Scalar_FromInt(u32MapWidth);
 
-    if (pstEntity->dPosX < 0.f - dWidth)
+    if (pstEntity->dPosX < 0 - dWidth)
     {
-        pstEntity->dPosX = u16MapWidth + dWidth;
+        pstEntity->dPosX = dMapWidth + dWidth;
     }
-    else if (pstEntity->dPosX > u16MapWidth + dWidth)
+    else if (pstEntity->dPosX > dMapWidth + dWidth)
     {
         pstEntity->dPosX = 0 - dWidth;
     }
@@ -79,37 +805,38 @@ void Entity_ConnectHorizontalMapEnds(const Uint16 u16MapWidth, Entity* pstEntity
  * @brief   Connect all map ends for entity
  * @details Connects horizontal and vertical map ends for an entity so
  *          it can travel from one side to the other by leaving the map
- * @param   u16MapWidth
+ * @param   u32MapWidth
  *          Map width
- * @param   u16MapHeight
+ * @param   u32MapHeight
  *          Map height
  * @param   pstEntity
  *          Pointer to entity handle
  */
-void Entity_ConnectMapEnds(const Uint16 u16MapWidth, const Uint16 u16MapHeight, Entity* pstEntity)
+void Entity_ConnectMapEnds(const Uint32 u32MapWidth, const Uint32 u32MapHeight, Entity* pstEntity)
 {
-    Entity_ConnectHorizontalMapEnds(u16MapWidth, pstEntity);
-    Entity_ConnectVerticalMapEnds(u16MapHeight, pstEntity);
+    Entity_ConnectHorizontalMapEnds(u32MapWidth, pstEntity);
+    Entity_ConnectVerticalMapEnds(u32MapHeight, pstEntity);
 }
 
 /**
  * @brief   Connect vertical map ends for entity
  * @details Connects the vertical map ends for an entity so it can
  *          travel from one side to the other by leaving the map
- * @param   u16MapHeight
+ * @param   u32MapHeight
  *          Map height
  * @param   pstEntity
  *          Pointer to entity handle
  */
-void Entity_ConnectVerticalMapEnds(const Uint16 u16MapHeight, Entity* pstEntity)
+void Entity_ConnectVerticalMapEnds(const Uint32 u32MapHeight, Entity* pstEntity)
 {
-    double dHeight = (double)pstEntity->u16Height;
+    Scalar dHeight    = Scalar_FromInt(pstEntity->u16Height);
+    Scalar dMapHeight = Scalar_FromInt(u32MapHeight);
 
     if (pstEntity->dPosY < 0 - dHeight)
     {
-        pstEntity->dPosY = u16MapHeight + dHeight;
+        pstEntity->dPosY = dMapHeight + dHeight;
     }
-    else if (pstEntity->dPosY > u16MapHeight + dHeight)
+    else if (pstEntity->dPosY > dMapHeight + dHeight)
     {
         pstEntity->dPosY = 0 - dHeight;
     }
@@ -117,22 +844,32 @@ void Entity_ConnectVerticalMapEnds(const Uint16 u16MapHeight, Entity* pstEntity)
 
 /**
  * @brief   Create bullet/projectile
- * @details Creates a special bullet/projectile entity
+ * @details Initialises a bullet at rest with the default size and
+ *          lifetime and without owner, e.g. as template for
+ *          Entity_FireBullet()
  * @param   dPosX
  *          Position along the x-axis
  * @param   dPosY
  *          Position along the y-axis
  * @param   pstBullet
  *          Pointer to bullet handle
- * @remark  Does nothing yet, function needs to be implemented
- * @return  Always 0 at this point
- * @todo    Implement function
+ * @return  Always 0
  */
 int Entity_CreateBullet(const double dPosX, const double dPosY, Bullet* pstBullet)
 {
-    (void)dPosX;
-    (void)dPosY;
-    (void)pstBullet;
+    Scalar dHalfSize = Scalar_FromDouble(BULLET_SIZE / 2.f);
+
+    SDL_memset(pstBullet, 0, sizeof(struct Bullet_t));
+
+    pstBullet->dPosX        = Scalar_FromDouble(dPosX);
+    pstBullet->dPosY        = Scalar_FromDouble(dPosY);
+    pstBullet->u8Size       = BULLET_SIZE;
+    pstBullet->u16Lifetime  = BULLET_LIFETIME;
+    pstBullet->s32Owner     = -1;
+    pstBullet->stBB.dBottom = pstBullet->dPosY + dHalfSize;
+    pstBullet->stBB.dLeft   = pstBullet->dPosX - dHalfSize;
+    pstBullet->stBB.dRight  = pstBullet->dPosX + dHalfSize;
+    pstBullet->stBB.dTop    = pstBullet->dPosY - dHalfSize;
 
     return 0;
 }
@@ -140,6 +877,8 @@ int Entity_CreateBullet(const double dPosX, const double dPosY, Bullet* pstBulle
 /**
  * @brief   Draw entity
  * @details Draws an entity on screen
+ * @remark  Each call is a draw call of its own; scenes with many
+ *          entities should use Entity_AddToBatch() instead.
  * @param   pstEntity
  *          Pointer to entity handle
  * @param   pstCamera
@@ -158,34 +897,178 @@ int Entity_Draw(
     const Sprite* pstSprite,
     SDL_Renderer* pstRenderer)
 {
-    double           dPosX  = pstEntity->dPosX - pstCamera->dPosX;
-    double           dPosY  = pstEntity->dPosY - pstCamera->dPosY;
-    SDL_RendererFlip s8Flip = SDL_FLIP_NONE;
+    SDL_RendererFlip s8Flip     = SDL_FLIP_NONE;
+    SDL_Texture*     pstTexture = _GetTexture(pstSprite);
     SDL_Rect         stDst;
     SDL_Rect         stSrc;
 
+    if (!pstTexture)
+    {
+        return 0;
+    }
+
     if (LEFT == pstEntity->eDirection)
     {
         s8Flip = SDL_FLIP_HORIZONTAL;
     }
 
-    stSrc.x = pstSprite->u16ImageOffsetX;
-    stSrc.x += pstEntity->u8FrameOffsetX * pstEntity->u16Width;
-    stSrc.x += pstEntity->u8AnimFrame * pstEntity->u16Width;
-    stSrc.y = pstSprite->u16ImageOffsetY;
-    stSrc.y += pstEntity->u8FrameOffsetY * pstEntity->u16Height;
-    stSrc.w = pstEntity->u16Width;
-    stSrc.h = pstEntity->u16Height;
-    stDst.x = dPosX - (pstEntity->u16Width / 2);
-    stDst.y = dPosY - (pstEntity->u16Height / 2);
-    stDst.w = pstEntity->u16Width;
-    stDst.h = pstEntity->u16Height;
+    _GetFrameRects(pstEntity, pstCamera, pstSprite, &stSrc, &stDst);
+
+    if (0 != SDL_RenderCopyEx(pstRenderer, pstTexture, &stSrc, &stDst, 0, NULL, s8Flip))
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief   Draw bullets
+ * @details Draws all live bullets of a bullet pool with one sprite
+ * @param   pstPool
+ *          Pointer to bullet pool handle
+ * @param   pstCamera
+ *          Pointer to camera handle
+ * @param   pstSprite
+ *          Pointer to sprite handle, the sprite size is the size of
+ *          the source image area
+ * @param   pstRenderer
+ *          Pointer to SDL2 rendering context
+ * @remark  With SDL 2.0.18 or newer, all bullets are drawn with a single
+ *          SDL_RenderGeometry() call; bullets moving to the left are
+ *          mirrored.
+ * @return  Error code
+ * @retval  0:  OK
+ * @retval  -1: Error
+ */
+int Entity_DrawBullets(
+    const BulletPool* pstPool,
+    const Camera*     pstCamera,
+    const Sprite*     pstSprite,
+    SDL_Renderer*     pstRenderer)
+{
+    SDL_Texture* pstTexture = _GetTexture(pstSprite);
+
+    if (!pstTexture)
+    {
+        return 0;
+    }
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    SDL_Color   stWhite   = { 0xff, 0xff, 0xff, 0xff };
+    SDL_Vertex* pstVertex = pstPool->pstVertex;
+    int         iQuads    = 0;
+    int         iTextureWidth;
+    int         iTextureHeight;
+    float       fU0;
+    float       fU1;
+    float       fV0;
+    float       fV1;
+
+    if (0 == pstPool->u32Count)
+    {
+        return 0;
+    }
 
-    if (0 != SDL_RenderCopyEx(pstRenderer, pstSprite->pstTexture, &stSrc, &stDst, 0, NULL, s8Flip))
+    if (0 != SDL_QueryTexture(pstTexture, NULL, NULL, &iTextureWidth, &iTextureHeight))
     {
         SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
         return -1;
     }
+
+    fU0 = (float)pstSprite->u16ImageOffsetX / (float)iTextureWidth;
+    fU1 = (float)(pstSprite->u16ImageOffsetX + pstSprite->u16Width) / (float)iTextureWidth;
+    fV0 = (float)pstSprite->u16ImageOffsetY / (float)iTextureHeight;
+    fV1 = (float)(pstSprite->u16ImageOffsetY + pstSprite->u16Height) / (float)iTextureHeight;
+
+    for (Uint32 u32Index = 0; u32Index < pstPool->u32Used; u32Index++)
+    {
+        SDL_Vertex* pstQuad = &pstVertex[iQuads * 4];
+        SDL_bool    bFlip   = pstPool->pdVelocityX[u32Index] < 0;
+        float       fHalf   = (float)Scalar_ToDouble(pstPool->pdHalfSize[u32Index]);
+        float       fPosX;
+        float       fPosY;
+
+        if (0 == pstPool->pu16Life[u32Index])
+        {
+            continue;
+        }
+
+        fPosX = (float)Scalar_ToDouble(pstPool->pdPosX[u32Index] - pstCamera->dPosX);
+        fPosY = (float)Scalar_ToDouble(pstPool->pdPosY[u32Index] - pstCamera->dPosY);
+
+        pstQuad[0].position.x  = fPosX - fHalf;
+        pstQuad[0].position.y  = fPosY - fHalf;
+        pstQuad[0].tex_coord.x = bFlip ? fU1 : fU0;
+        pstQuad[0].tex_coord.y = fV0;
+        pstQuad[1].position.x  = fPosX + fHalf;
+        pstQuad[1].position.y  = fPosY - fHalf;
+        pstQuad[1].tex_coord.x = bFlip ? fU0 : fU1;
+        pstQuad[1].tex_coord.y = fV0;
+        pstQuad[2].position.x  = fPosX + fHalf;
+        pstQuad[2].position.y  = fPosY + fHalf;
+        pstQuad[2].tex_coord.x = bFlip ? fU0 : fU1;
+        pstQuad[2].tex_coord.y = fV1;
+        pstQuad[3].position.x  = fPosX - fHalf;
+        pstQuad[3].position.y  = fPosY + fHalf;
+        pstQuad[3].tex_coord.x = bFlip ? fU1 : fU0;
+        pstQuad[3].tex_coord.y = fV1;
+
+        for (Uint8 u8Vertex = 0; u8Vertex < 4; u8Vertex++)
+        {
+            pstQuad[u8Vertex].color = stWhite;
+        }
+        iQuads++;
+    }
+
+    if (0 != SDL_RenderGeometry(
+                 pstRenderer,
+                 pstTexture,
+                 pstVertex,
+                 iQuads * 4,
+                 pstPool->piIndex,
+                 iQuads * 6))
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+        return -1;
+    }
+#else
+    SDL_Rect stSrc;
+
+    stSrc.x = pstSprite->u16ImageOffsetX;
+    stSrc.y = pstSprite->u16ImageOffsetY;
+    stSrc.w = pstSprite->u16Width;
+    stSrc.h = pstSprite->u16Height;
+
+    for (Uint32 u32Index = 0; u32Index < pstPool->u32Used; u32Index++)
+    {
+        SDL_RendererFlip s8Flip = SDL_FLIP_NONE;
+        double           dHalf  = Scalar_ToDouble(pstPool->pdHalfSize[u32Index]);
+        SDL_Rect         stDst;
+
+        if (0 == pstPool->pu16Life[u32Index])
+        {
+            continue;
+        }
+
+        if (pstPool->pdVelocityX[u32Index] < 0)
+        {
+            s8Flip = SDL_FLIP_HORIZONTAL;
+        }
+
+        stDst.x = Scalar_ToDouble(pstPool->pdPosX[u32Index] - pstCamera->dPosX) - dHalf;
+        stDst.y = Scalar_ToDouble(pstPool->pdPosY[u32Index] - pstCamera->dPosY) - dHalf;
+        stDst.w = dHalf * 2;
+        stDst.h = dHalf * 2;
+
+        if (0 != SDL_RenderCopyEx(pstRenderer, pstTexture, &stSrc, &stDst, 0, NULL, s8Flip))
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+            return -1;
+        }
+    }
+#endif
+
     return 0;
 }
 
@@ -200,6 +1083,48 @@ void Entity_Drop(Entity* pstEntity)
     Utils_SetFlag(IS_IN_MID_AIR, &pstEntity->u16Flags);
 }
 
+/**
+ * @brief   Fire bullet
+ * @details Copies a bullet into a free slot of a bullet pool
+ * @param   pstBullet
+ *          Pointer to bullet handle, see Entity_CreateBullet()
+ * @param   pstPool
+ *          Pointer to bullet pool handle
+ * @return  Slot of the bullet in the pool
+ * @retval  -1: Pool is full
+ */
+Sint32 Entity_FireBullet(const Bullet* pstBullet, BulletPool* pstPool)
+{
+    Uint32 u32Index;
+
+    if (pstPool->u32FreeHead < pstPool->u32Capacity)
+    {
+        u32Index             = pstPool->u32FreeHead;
+        pstPool->u32FreeHead = pstPool->pu32NextFree[u32Index];
+    }
+    else if (pstPool->u32Used < pstPool->u32Capacity)
+    {
+        u32Index = pstPool->u32Used;
+        pstPool->u32Used++;
+    }
+    else
+    {
+        return -1;
+    }
+
+    pstPool->pdPosX[u32Index]      = pstBullet->dPosX;
+    pstPool->pdPosY[u32Index]      = pstBullet->dPosY;
+    pstPool->pdVelocityX[u32Index] = pstBullet->dVelocityX;
+    pstPool->pdVelocityY[u32Index] = pstBullet->dVelocityY;
+    pstPool->pdHalfSize[u32Index]  = Scalar_FromDouble(pstBullet->u8Size / 2.f);
+    pstPool->ps32Owner[u32Index]   = pstBullet->s32Owner;
+    pstPool->ps32Target[u32Index]  = BULLET_HIT_NONE;
+    pstPool->pu16Life[u32Index]    = SDL_max(pstBullet->u16Lifetime, 1);
+    pstPool->u32Count++;
+
+    return (Sint32)u32Index;
+}
+
 /**
  * @brief   Free entity
  * @details Frees up allocated memory and unloads entity
@@ -211,6 +1136,26 @@ void Entity_Free(Entity* pstEntity)
     SDL_free(pstEntity);
 }
 
+/**
+ * @brief   Free bullet pool
+ * @details Frees up allocated memory and unloads bullet pool
+ * @param   pstPool
+ *          Pointer to bullet pool handle
+ */
+void Entity_FreeBulletPool(BulletPool* pstPool)
+{
+    if (pstPool)
+    {
+        // All slot arrays share one allocation.
+        SDL_free(pstPool->pdPosX);
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+        SDL_free(pstPool->pstVertex);
+        SDL_free(pstPool->piIndex);
+#endif
+        SDL_free(pstPool);
+    }
+}
+
 /**
  * @brief   Free camera
  * @details Frees up allocated memory and unloads camera
@@ -232,12 +1177,37 @@ void Entity_FreeSprite(Sprite* pstSprite)
 {
     if (pstSprite)
     {
-        SDL_DestroyTexture(pstSprite->pstTexture);
+        // Atlas pages are owned by their sprite atlas, requested
+        // textures by their request.
+        if (pstSprite->pstRequest)
+        {
+            Asset_FreeRequest(pstSprite->pstRequest);
+        }
+        else if (!pstSprite->bIsShared)
+        {
+            Asset_Release(ASSET_TEXTURE, pstSprite->pstTexture, Asset_GetDefaultCache());
+        }
         SDL_free(pstSprite);
         SDL_Log("Unload sprite image file.\n");
     }
 }
 
+/**
+ * @brief   Free entity world
+ * @details Frees up allocated memory and unloads entity world
+ * @param   pstWorld
+ *          Pointer to entity world handle
+ */
+void Entity_FreeWorld(EntityWorld* pstWorld)
+{
+    if (pstWorld)
+    {
+        // All pools share one allocation.
+        SDL_free(pstWorld->pdPosX);
+        SDL_free(pstWorld);
+    }
+}
+
 /**
  * @brief   Initialise entity
  * @details Initialises entity
@@ -269,14 +1239,99 @@ int Entity_Init(
         return -1;
     }
 
-    (*pstEntity)->dPosX         = dPosX;
-    (*pstEntity)->dPosY         = dPosY;
+    (*pstEntity)->dPosX         = Scalar_FromDouble(dPosX);
+    (*pstEntity)->dPosY         = Scalar_FromDouble(dPosY);
     (*pstEntity)->eDirection    = RIGHT;
-    (*pstEntity)->dAcceleration = 8.f;
-    (*pstEntity)->dMaxVelocityX = 4.5f;
+    (*pstEntity)->dAcceleration = Scalar_FromDouble(8.f);
+    (*pstEntity)->dMaxVelocityX = Scalar_FromDouble(4.5f);
     (*pstEntity)->u16Width      = u16Width;
     (*pstEntity)->u16Height     = u16Height;
-    (*pstEntity)->dAnimSpeed    = 12.f;
+    (*pstEntity)->dAnimSpeed    = Scalar_FromDouble(12.f);
+
+    return 0;
+}
+
+/**
+ * @brief   Initialise bullet pool
+ * @details Initialises an empty bullet pool with a fixed capacity
+ * @param   u32Capacity
+ *          Max. number of live bullets
+ * @param   pstPool
+ *          Pointer to bullet pool handle
+ * @return  Error code
+ * @retval  0:  OK
+ * @retval  -1: Error
+ */
+int Entity_InitBulletPool(const Uint32 u32Capacity, BulletPool** pstPool)
+{
+    Uint32  u32Size = (SDL_max(u32Capacity, 1) + SIMD_PADDING - 1) & ~(Uint32)(SIMD_PADDING - 1);
+    size_t  zSlot   = 5 * sizeof(Scalar) + 2 * sizeof(Sint32) + sizeof(Uint32) + sizeof(Uint16);
+    Scalar* pdPool;
+
+    *pstPool = SDL_calloc(sizeof(struct BulletPool_t), sizeof(Sint8));
+    if (!*pstPool)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InitBulletPool(): error allocating memory.\n");
+        return -1;
+    }
+
+    // The vertex buffer needs the most bytes per slot.
+    if (u32Size > SDL_MAX_SINT32 / (4 * sizeof(SDL_Vertex) + zSlot))
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InitBulletPool(): capacity too large.\n");
+        Entity_FreeBulletPool(*pstPool);
+        *pstPool = NULL;
+        return -1;
+    }
+
+    pdPool = SDL_calloc(u32Size, zSlot);
+    if (!pdPool)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InitBulletPool(): error allocating memory.\n");
+        Entity_FreeBulletPool(*pstPool);
+        *pstPool = NULL;
+        return -1;
+    }
+
+    (*pstPool)->u32Capacity  = u32Capacity;
+    (*pstPool)->u32FreeHead  = u32Capacity;
+    (*pstPool)->pdPosX       = pdPool;
+    (*pstPool)->pdPosY       = pdPool + u32Size;
+    (*pstPool)->pdVelocityX  = pdPool + u32Size * 2;
+    (*pstPool)->pdVelocityY  = pdPool + u32Size * 3;
+    (*pstPool)->pdHalfSize   = pdPool + u32Size * 4;
+    (*pstPool)->ps32Owner    = (Sint32*)(pdPool + u32Size * 5);
+    (*pstPool)->ps32Target   = (*pstPool)->ps32Owner + u32Size;
+    (*pstPool)->pu32NextFree = (Uint32*)((*pstPool)->ps32Target + u32Size);
+    (*pstPool)->pu16Life     = (Uint16*)((*pstPool)->pu32NextFree + u32Size);
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    (*pstPool)->pstVertex = SDL_calloc(u32Size * 4, sizeof(SDL_Vertex));
+    (*pstPool)->piIndex   = SDL_calloc(u32Size * 6, sizeof(int));
+    if (!(*pstPool)->pstVertex || !(*pstPool)->piIndex)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InitBulletPool(): error allocating memory.\n");
+        Entity_FreeBulletPool(*pstPool);
+        *pstPool = NULL;
+        return -1;
+    }
+
+    // Two triangles per quad; the order never changes.
+    for (Uint32 u32Index = 0; u32Index < u32Size; u32Index++)
+    {
+        int* piQuad = &(*pstPool)->piIndex[u32Index * 6];
+        int  iFirst = (int)u32Index * 4;
+
+        piQuad[0] = iFirst;
+        piQuad[1] = iFirst + 1;
+        piQuad[2] = iFirst + 2;
+        piQuad[3] = iFirst;
+        piQuad[4] = iFirst + 2;
+        piQuad[5] = iFirst + 3;
+    }
+#endif
+
+    SDL_Log("Initialise bullet pool for %u bullets.\n", u32Capacity);
 
     return 0;
 }
@@ -341,10 +1396,10 @@ int Entity_InitSprite(
         return -1;
     }
 
-    (*pstSprite)->pstTexture = IMG_LoadTexture(pstRenderer, pacFileName);
+    (*pstSprite)->pstTexture =
+        Asset_LoadTexture(pacFileName, pstRenderer, Asset_GetDefaultCache());
     if (!(*pstSprite)->pstTexture)
     {
-        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", IMG_GetError());
         return -1;
     }
 
@@ -358,6 +1413,187 @@ int Entity_InitSprite(
     return 0;
 }
 
+/**
+ * @brief   Initialise sprite asynchronously
+ * @details Initialises a sprite whose image is loaded in the background
+ *          by an asset uploader.  The sprite is not drawn until its
+ *          texture has been uploaded.
+ * @param   pacFileName
+ *          Path to image file
+ * @param   u16Width
+ *          Sprite width in pixel
+ * @param   u16Height
+ *          Sprite height in pixel
+ * @param   u16ImageOffsetX
+ *          Image pixel offset along the x-axis in case a partial image
+ *          should be loaded
+ * @param   u16ImageOffsetY
+ *          Image pixel offset along the y-axis in case a partial image
+ *          should be loaded
+ * @param   pstSprite
+ *          Pointer to sprite handle
+ * @param   pstUploader
+ *          Pointer to asset uploader handle
+ * @return  Error code
+ * @retval  0:  OK
+ * @retval  -1: Error
+ */
+int Entity_InitSpriteAsync(
+    const char*    pacFileName,
+    const Uint16   u16Width,
+    const Uint16   u16Height,
+    const Uint16   u16ImageOffsetX,
+    const Uint16   u16ImageOffsetY,
+    Sprite**       pstSprite,
+    AssetUploader* pstUploader)
+{
+    *pstSprite = SDL_calloc(sizeof(struct Sprite_t), sizeof(Sint8));
+    if (!*pstSprite)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InitSprite(): error allocating memory.\n");
+        return -1;
+    }
+
+    (*pstSprite)->pstRequest = Asset_RequestTexture(pacFileName, pstUploader);
+    if (!(*pstSprite)->pstRequest)
+    {
+        return -1;
+    }
+
+    (*pstSprite)->u16Width        = u16Width;
+    (*pstSprite)->u16Height       = u16Height;
+    (*pstSprite)->u16ImageOffsetX = u16ImageOffsetX;
+    (*pstSprite)->u16ImageOffsetY = u16ImageOffsetY;
+
+    SDL_Log("Request sprite image file: %s.\n", pacFileName);
+
+    return 0;
+}
+
+/**
+ * @brief   Initialise sprite from atlas
+ * @details Initialises a sprite that uses an image area packed into a
+ *          sprite atlas instead of a texture of its own
+ * @param   u32Entry
+ *          Entry index returned by SpriteAtlas_Add()
+ * @param   u16Width
+ *          Sprite width in pixel
+ * @param   u16Height
+ *          Sprite height in pixel
+ * @param   pstAtlas
+ *          Pointer to sprite atlas handle, see SpriteAtlas_Pack()
+ * @param   pstSprite
+ *          Pointer to sprite handle
+ * @remark  The image area has to contain all frames of the sprite, as
+ *          frames are addressed relative to its top-left corner.  The
+ *          sprite must be freed before the atlas.
+ * @return  Error code
+ * @retval  0:  OK
+ * @retval  -1: Error
+ */
+int Entity_InitSpriteFromAtlas(
+    const Uint32       u32Entry,
+    const Uint16       u16Width,
+    const Uint16       u16Height,
+    const SpriteAtlas* pstAtlas,
+    Sprite**           pstSprite)
+{
+    const SpriteAtlasEntry* pstEntry;
+
+    if (!pstAtlas->bIsUploaded || u32Entry >= pstAtlas->u32EntryCount)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InitSprite(): invalid sprite atlas entry.\n");
+        return -1;
+    }
+
+    *pstSprite = SDL_calloc(sizeof(struct Sprite_t), sizeof(Sint8));
+    if (!*pstSprite)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InitSprite(): error allocating memory.\n");
+        return -1;
+    }
+
+    pstEntry = &pstAtlas->pstEntry[u32Entry];
+
+    (*pstSprite)->pstTexture      = pstAtlas->astPage[pstEntry->u8Page].pstTexture;
+    (*pstSprite)->u16Width        = u16Width;
+    (*pstSprite)->u16Height       = u16Height;
+    (*pstSprite)->u16ImageOffsetX = pstEntry->u16PosX;
+    (*pstSprite)->u16ImageOffsetY = pstEntry->u16PosY;
+    (*pstSprite)->bIsShared       = SDL_TRUE;
+
+    return 0;
+}
+
+/**
+ * @brief   Initialise entity world
+ * @details Initialises an entity world with a fixed capacity
+ * @param   u32Capacity
+ *          Max. number of entities
+ * @param   pstWorld
+ *          Pointer to entity world handle
+ * @return  Error code
+ * @retval  0:  OK
+ * @retval  -1: Error
+ */
+int Entity_InitWorld(const Uint32 u32Capacity, EntityWorld** pstWorld)
+{
+    Uint32  u32Size = (SDL_max(u32Capacity, 1) + SIMD_PADDING - 1) & ~(Uint32)(SIMD_PADDING - 1);
+    size_t  zSlot   = ENTITY_WORLD_POOLS * sizeof(Scalar) + 4 * sizeof(Uint8);
+    Scalar* pdPool;
+    Uint8*  pu8Pool;
+
+    *pstWorld = SDL_calloc(sizeof(struct EntityWorld_t), sizeof(Sint8));
+    if (!*pstWorld)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InitWorld(): error allocating memory.\n");
+        return -1;
+    }
+
+    if (u32Size > SDL_MAX_SINT32 / zSlot)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InitWorld(): capacity too large.\n");
+        Entity_FreeWorld(*pstWorld);
+        *pstWorld = NULL;
+        return -1;
+    }
+
+    pdPool = SDL_calloc(u32Size, zSlot);
+    if (!pdPool)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InitWorld(): error allocating memory.\n");
+        Entity_FreeWorld(*pstWorld);
+        *pstWorld = NULL;
+        return -1;
+    }
+
+    (*pstWorld)->u32Capacity    = u32Capacity;
+    (*pstWorld)->pdPosX         = pdPool;
+    (*pstWorld)->pdPosY         = pdPool + u32Size;
+    (*pstWorld)->pdVelocityX    = pdPool + u32Size * 2;
+    (*pstWorld)->pdVelocityY    = pdPool + u32Size * 3;
+    (*pstWorld)->pdAcceleration = pdPool + u32Size * 4;
+    (*pstWorld)->pdMaxVelocityX = pdPool + u32Size * 5;
+    (*pstWorld)->pdHalfWidth    = pdPool + u32Size * 6;
+    (*pstWorld)->pdHalfHeight   = pdPool + u32Size * 7;
+    (*pstWorld)->pdBottom       = pdPool + u32Size * 8;
+    (*pstWorld)->pdLeft         = pdPool + u32Size * 9;
+    (*pstWorld)->pdRight        = pdPool + u32Size * 10;
+    (*pstWorld)->pdTop          = pdPool + u32Size * 11;
+    (*pstWorld)->pdAnimDelay    = pdPool + u32Size * 12;
+    (*pstWorld)->pdAnimSpeed    = pdPool + u32Size * 13;
+
+    pu8Pool                   = (Uint8*)(pdPool + u32Size * ENTITY_WORLD_POOLS);
+    (*pstWorld)->pu8Flags     = pu8Pool;
+    (*pstWorld)->pu8AnimFrame = pu8Pool + u32Size;
+    (*pstWorld)->pu8AnimStart = pu8Pool + u32Size * 2;
+    (*pstWorld)->pu8AnimEnd   = pu8Pool + u32Size * 3;
+
+    SDL_Log("Initialise entity world for %u entities.\n", u32Capacity);
+
+    return 0;
+}
+
 /**
  * @brief   Check if camera is locked
  * @details Check whether the camera's IS_LOCKED flag is set or not
@@ -437,8 +1673,8 @@ void Entity_Jump(const double dForce, Entity* pstEntity)
         if (0 >= pstEntity->dVelocityY)
         {
             // Initial lift-up; may need adjustment (estimated value).
-            pstEntity->dPosY -= pstEntity->u16Height / 8.0;
-            pstEntity->dVelocityY = -dForce;  // Apply force.
+            pstEntity->dPosY -= Scalar_FromDouble(pstEntity->u16Height / 8.0);
+            pstEntity->dVelocityY = -Scalar_FromDouble(dForce);  // Apply force.
             pstEntity->bIsJumping = 1;
         }
     }
@@ -503,6 +1739,88 @@ void Entity_MoveFull(
     Entity_SetAnimation(u8AnimStart, u8AnimEnd, dAnimSpeed, pstEntity);
 }
 
+/**
+ * @brief   Remove bullet
+ * @details Releases a bullet and returns its slot to the free list
+ * @param   u32Index
+ *          Slot of the bullet
+ * @param   pstPool
+ *          Pointer to bullet pool handle
+ */
+void Entity_RemoveBullet(const Uint32 u32Index, BulletPool* pstPool)
+{
+    if (u32Index >= pstPool->u32Used || 0 == pstPool->pu16Life[u32Index])
+    {
+        return;
+    }
+
+    _ReleaseBullet(u32Index, pstPool);
+}
+
+/**
+ * @brief   Remove entity from world
+ * @details Removes an entity from an entity world; the last entity
+ *          takes its place, i.e. its index changes.  Bullets fired by
+ *          the moved entity follow it, bullets fired by the removed
+ *          one lose their owner.
+ * @param   u32Index
+ *          Index of the entity to remove
+ * @param   pstWorld
+ *          Pointer to entity world handle
+ * @param   pstPool
+ *          Pointer to bullet pool handle whose owners refer to the
+ *          world, can be NULL
+ */
+void Entity_RemoveFromWorld(const Uint32 u32Index, EntityWorld* pstWorld, BulletPool* pstPool)
+{
+    Scalar* apdPool[ENTITY_WORLD_POOLS] = {
+        pstWorld->pdPosX,      pstWorld->pdPosY,         pstWorld->pdVelocityX,
+        pstWorld->pdVelocityY, pstWorld->pdAcceleration, pstWorld->pdMaxVelocityX,
+        pstWorld->pdHalfWidth, pstWorld->pdHalfHeight,   pstWorld->pdBottom,
+        pstWorld->pdLeft,      pstWorld->pdRight,        pstWorld->pdTop,
+        pstWorld->pdAnimDelay, pstWorld->pdAnimSpeed
+    };
+    Uint8* apu8Pool[] = {
+        pstWorld->pu8Flags, pstWorld->pu8AnimFrame, pstWorld->pu8AnimStart, pstWorld->pu8AnimEnd
+    };
+    Uint32 u32Last;
+
+    if (u32Index >= pstWorld->u32Count)
+    {
+        return;
+    }
+
+    pstWorld->u32Count--;
+    u32Last = pstWorld->u32Count;
+
+    for (Uint8 u8Pool = 0; u8Pool < ENTITY_WORLD_POOLS; u8Pool++)
+    {
+        apdPool[u8Pool][u32Index] = apdPool[u8Pool][u32Last];
+    }
+
+    for (Uint8 u8Pool = 0; u8Pool < sizeof(apu8Pool) / sizeof(apu8Pool[0]); u8Pool++)
+    {
+        apu8Pool[u8Pool][u32Index] = apu8Pool[u8Pool][u32Last];
+    }
+
+    if (!pstPool)
+    {
+        return;
+    }
+
+    for (Uint32 u32Bullet = 0; u32Bullet < pstPool->u32Used; u32Bullet++)
+    {
+        if ((Sint32)u32Index == pstPool->ps32Owner[u32Bullet])
+        {
+            pstPool->ps32Owner[u32Bullet] = -1;
+        }
+        else if ((Sint32)u32Last == pstPool->ps32Owner[u32Bullet])
+        {
+            pstPool->ps32Owner[u32Bullet] = (Sint32)u32Index;
+        }
+    }
+}
+
 /**
  * @brief   Reset entity flags
  * @details Resets all flags of an entity
@@ -547,9 +1865,9 @@ void Entity_SetCameraTarget(
     if (Utils_IsFlagSet(IS_LOCKED, pstCamera->u16Flags))
     {
         pstCamera->dPosX = pstEntity->dPosX;
-        pstCamera->dPosX -= s32LogicalWindowWidth / 2.0;
+        pstCamera->dPosX -= Scalar_FromDouble(s32LogicalWindowWidth / 2.0);
         pstCamera->dPosY = pstEntity->dPosY;
-        pstCamera->dPosY -= s32LogicalWindowHeight / 2.0;
+        pstCamera->dPosY -= Scalar_FromDouble(s32LogicalWindowHeight / 2.0);
 
         if (pstCamera->dPosX < 0)
         {
@@ -576,7 +1894,7 @@ void Entity_SetAnimation(
     const double dAnimSpeed,
     Entity*      pstEntity)
 {
-    pstEntity->dAnimSpeed = dAnimSpeed;
+    pstEntity->dAnimSpeed = Scalar_FromDouble(dAnimSpeed);
 
     if (u8AnimStart <= u8AnimEnd)
     {
@@ -590,6 +1908,25 @@ void Entity_SetAnimation(
     }
 }
 
+/**
+ * @brief   Set bullet velocity
+ * @details Sets the velocity of a bullet
+ * @param   dVelocityX
+ *          Velocity along the x-axis in pixel per update
+ * @param   dVelocityY
+ *          Velocity along the y-axis in pixel per update
+ * @param   pstBullet
+ *          Pointer to bullet handle
+ */
+void Entity_SetBulletVelocity(
+    const double dVelocityX,
+    const double dVelocityY,
+    Bullet*      pstBullet)
+{
+    pstBullet->dVelocityX = Scalar_FromDouble(dVelocityX);
+    pstBullet->dVelocityY = Scalar_FromDouble(dVelocityY);
+}
+
 /**
  * @brief   Set camera boundaries to map size
  * @details Sets the camera's boundaries to size of the map
@@ -597,9 +1934,9 @@ void Entity_SetAnimation(
  *          Logical window width in pixel
  * @param   s32LogicalWindowHeight
  *          Logical window height in pixel
- * @param   u16MapWidth
+ * @param   u32MapWidth
  *          Map width in pixel
- * @param   u16MapHeight
+ * @param   u32MapHeight
  *          Map height in pixel
  * @param   pstCamera
  *          Pointer to camera handle
@@ -610,13 +1947,13 @@ void Entity_SetAnimation(
 int Entity_SetCameraBoundariesToMapSize(
     const Sint32 s32LogicalWindowWidth,
     const Sint32 s32LogicalWindowHeight,
-    const Uint16 u16MapWidth,
-    const Uint16 u16MapHeight,
+    const Uint32 u32MapWidth,
+    const Uint32 u32MapHeight,
     Camera*      pstCamera)
 {
     SDL_bool bReturnValue = 0;
-    pstCamera->s32MaxPosX = u16MapWidth - s32LogicalWindowWidth;
-    pstCamera->s32MaxPosY = u16MapHeight - s32LogicalWindowHeight;
+    pstCamera->s32MaxPosX = (Sint32)u32MapWidth - s32LogicalWindowWidth;
+    pstCamera->s32MaxPosY = (Sint32)u32MapHeight - s32LogicalWindowHeight;
 
     if (pstCamera->dPosX <= 0)
     {
@@ -629,15 +1966,15 @@ int Entity_SetCameraBoundariesToMapSize(
         pstCamera->dPosY = 0;
     }
 
-    if (pstCamera->dPosX > pstCamera->s32MaxPosX)
+    if (pstCamera->dPosX > Scalar_FromInt(pstCamera->s32MaxPosX))
     {
-        pstCamera->dPosX = pstCamera->s32MaxPosX;
+        pstCamera->dPosX = Scalar_FromInt(pstCamera->s32MaxPosX);
         bReturnValue     = 1;
     }
 
-    if (pstCamera->dPosY > pstCamera->s32MaxPosY)
+    if (pstCamera->dPosY > Scalar_FromInt(pstCamera->s32MaxPosY))
     {
-        pstCamera->dPosY = pstCamera->s32MaxPosY;
+        pstCamera->dPosY = Scalar_FromInt(pstCamera->s32MaxPosY);
     }
 
     return bReturnValue;
@@ -692,8 +2029,8 @@ void Entity_SetFrameOffset(const Uint8 u8OffsetX, const Uint8 u8OffsetY, Entity*
  */
 void Entity_SetPosition(const double dPosX, const double dPosY, Entity* pstEntity)
 {
-    pstEntity->dPosX = dPosX;
-    pstEntity->dPosY = dPosY;
+    pstEntity->dPosX = Scalar_FromDouble(dPosX);
+    pstEntity->dPosY = Scalar_FromDouble(dPosY);
 }
 
 /**
@@ -708,8 +2045,8 @@ void Entity_SetPosition(const double dPosX, const double dPosY, Entity* pstEntit
  */
 void Entity_SetSpawnPosition(const double dPosX, const double dPosY, Entity* pstEntity)
 {
-    pstEntity->dSpawnPosX = dPosX;
-    pstEntity->dSpawnPosY = dPosY;
+    pstEntity->dSpawnPosX = Scalar_FromDouble(dPosX);
+    pstEntity->dSpawnPosY = Scalar_FromDouble(dPosY);
 }
 
 /**
@@ -725,8 +2062,8 @@ void Entity_SetSpawnPosition(const double dPosX, const double dPosY, Entity* pst
  */
 void Entity_SetSpeed(const double dAcceleration, const double dMaxVelocityX, Entity* pstEntity)
 {
-    pstEntity->dAcceleration = dAcceleration;
-    pstEntity->dMaxVelocityX = dMaxVelocityX;
+    pstEntity->dAcceleration = Scalar_FromDouble(dAcceleration);
+    pstEntity->dMaxVelocityX = Scalar_FromDouble(dMaxVelocityX);
 }
 
 /**
@@ -770,8 +2107,10 @@ void Entity_Update(
     const Uint8  u8MeterInPixel,
     Entity*      pstEntity)
 {
-    double dPosX = pstEntity->dPosX;
-    double dPosY = pstEntity->dPosY;
+    Scalar dPosX      = pstEntity->dPosX;
+    Scalar dPosY      = pstEntity->dPosY;
+    Scalar dStepTime  = Scalar_FromDouble(DELTA_TIME);
+    Scalar dDeltaStep = Scalar_FromDouble(dDeltaTime);
 
     // Apply gravitation.
     if (0 != dGravitation)
@@ -783,8 +2122,8 @@ void Entity_Update(
 
         if (Utils_IsFlagSet(IS_IN_MID_AIR, pstEntity->u16Flags))
         {
-            double dG         = dGravitation * u8MeterInPixel;
-            double dDistanceY = dG * DELTA_TIME * DELTA_TIME;
+            Scalar dG         = Scalar_FromDouble(dGravitation * u8MeterInPixel);
+            Scalar dDistanceY = Scalar_Mul(Scalar_Mul(dG, dStepTime), dStepTime);
             pstEntity->dVelocityY += dDistanceY;
             dPosY += pstEntity->dVelocityY;
         }
@@ -792,21 +2131,21 @@ void Entity_Update(
         {
             pstEntity->bIsJumping = 0;
             // Correct position along the y-axis.
-            pstEntity->dVelocityY = 0.f;
-            dPosY                 = (16.f * Utils_Round(dPosY / 16.f));
+            pstEntity->dVelocityY = 0;
+            dPosY = Scalar_FromDouble(16.f * Utils_Round(Scalar_ToDouble(dPosY) / 16.f));
         }
     }
 
     // Calculate horizontal velocity.
     if (Utils_IsFlagSet(IS_MOVING, pstEntity->u16Flags))
     {
-        double dAccel     = pstEntity->dAcceleration * (double)u8MeterInPixel;
-        double dDistanceX = dAccel * DELTA_TIME * DELTA_TIME;
+        Scalar dAccel     = pstEntity->dAcceleration * u8MeterInPixel;
+        Scalar dDistanceX = Scalar_Mul(Scalar_Mul(dAccel, dStepTime), dStepTime);
         pstEntity->dVelocityX += dDistanceX;
     }
     else
     {
-        pstEntity->dVelocityX -= pstEntity->dAcceleration * DELTA_TIME;
+        pstEntity->dVelocityX -= Scalar_Mul(pstEntity->dAcceleration, dStepTime);
     }
 
     // Set horizontal velocity limits.
@@ -833,38 +2172,28 @@ void Entity_Update(
     }
 
     // Update position.
-    Entity_SetPosition(dPosX, dPosY, pstEntity);
+    pstEntity->dPosX = dPosX;
+    pstEntity->dPosY = dPosY;
 
     // Update axis-aligned bounding box.
-    pstEntity->stBB.dBottom = dPosY + (double)(pstEntity->u16Height / 2.f);
-    pstEntity->stBB.dLeft   = dPosX - (double)(pstEntity->u16Width / 2.f);
-    pstEntity->stBB.dRight  = dPosX + (double)(pstEntity->u16Width / 2.f);
-    pstEntity->stBB.dTop    = dPosY - (double)(pstEntity->u16Height / 2.f);
-
-    if (pstEntity->stBB.dLeft <= 0)
-    {
-        pstEntity->stBB.dLeft = 0;
-    }
-
-    if (pstEntity->stBB.dTop <= 0)
-    {
-        pstEntity->stBB.dTop = 0;
-    }
+    _UpdateBB(pstEntity);
 
     // Update animation frame.
     if (Utils_IsFlagSet(IS_ANIMATED, pstEntity->u16Flags))
     {
-        pstEntity->dAnimDelay += dDeltaTime;
+        pstEntity->dAnimDelay += dDeltaStep;
 
         if (pstEntity->u8AnimFrame < pstEntity->u8AnimStart)
         {
             pstEntity->u8AnimFrame = pstEntity->u8AnimStart;
         }
 
-        if (pstEntity->dAnimDelay > (1.f / pstEntity->dAnimSpeed - dDeltaTime))
+        if (0 != pstEntity->dAnimSpeed &&
+            pstEntity->dAnimDelay >
+                (Scalar_Div(Scalar_FromInt(1), pstEntity->dAnimSpeed) - dDeltaStep))
         {
             pstEntity->u8AnimFrame++;
-            pstEntity->dAnimDelay = 0.f;
+            pstEntity->dAnimDelay = 0;
         }
         // Loop animation.
         if (pstEntity->u8AnimFrame >= pstEntity->u8AnimEnd)
@@ -877,3 +2206,134 @@ void Entity_Update(
         pstEntity->u8AnimFrame = pstEntity->u8AnimStart;
     }
 }
+
+/**
+ * @brief   Update entity world
+ * @details Updates all entities of an entity world like
+ *          Entity_Update(), resolves their movement against the solid
+ *          tiles of the map and rebuilds their bounding boxes
+ * @remark  This function is usually called once per frame.  Entities
+ *          only fall while flagged ENTITY_IS_IN_MID_AIR.  With a map,
+ *          they land when their movement is stopped by a solid tile
+ *          below and start to fall once there is no solid tile
+ *          directly below them anymore.  Without gravitation, their
+ *          vertical position and velocity are left as they are.
+ * @param   dDeltaTime
+ *          Delta time since last call
+ * @param   dGravitation
+ *          Gravitational constant of entities
+ * @param   u8MeterInPixel
+ *          Definition of meter in pixel
+ * @param   u32SolidMask
+ *          Tile types to collide with, see Map_GetTypeMask()
+ * @param   pstMap
+ *          Pointer to map handle, NULL to skip collision
+ * @param   pstWorld
+ *          Pointer to entity world handle
+ * @param   pstContact
+ *          Array to store the resolved movement and contact normals per
+ *          entity, may be NULL
+ */
+void Entity_UpdateAll(
+    const double dDeltaTime,
+    const double dGravitation,
+    const Uint8  u8MeterInPixel,
+    const Uint32 u32SolidMask,
+    const Map*   pstMap,
+    EntityWorld* pstWorld,
+    TileContact* pstContact)
+{
+    EntityUpdate stUpdate;
+    Uint32       u32BlockCount = (pstWorld->u32Count + UPDATE_BLOCK_LEN - 1) / UPDATE_BLOCK_LEN;
+    Scalar       dG            = Scalar_FromDouble(dGravitation * u8MeterInPixel);
+    Scalar       dStepTime     = Scalar_FromDouble(DELTA_TIME);
+
+    stUpdate.dDeltaTime     = Scalar_FromDouble(dDeltaTime);
+    stUpdate.dGravitation   = Scalar_FromDouble(dGravitation);
+    stUpdate.dStepY         = Scalar_Mul(Scalar_Mul(dG, dStepTime), dStepTime);
+    stUpdate.u8MeterInPixel = u8MeterInPixel;
+    stUpdate.u32SolidMask   = u32SolidMask;
+    stUpdate.pstMap         = pstMap;
+    stUpdate.pstWorld       = pstWorld;
+    stUpdate.pstContact     = pstContact;
+
+    // Blocks are independent of each other; the map is only read.
+    Job_ParallelFor(u32BlockCount, 1, _UpdateBlocks, &stUpdate, Job_GetDefaultPool());
+}
+
+/**
+ * @brief   Update bullets
+ * @details Moves all live bullets of a bullet pool, stops them at the
+ *          first solid tile or entity on their way and releases bullets
+ *          that hit something or whose lifetime is over
+ * @remark  This function is usually called once per frame, after
+ *          Entity_UpdateAll() so the entity bounding boxes are
+ *          current.  The whole path of a bullet is tested, so fast
+ *          bullets cannot pass through thin walls or entities.
+ * @param   u32SolidMask
+ *          Tile types to collide with, see Map_GetTypeMask()
+ * @param   pstMap
+ *          Pointer to map handle, NULL to skip tile collision
+ * @param   pstWorld
+ *          Pointer to entity world handle, NULL to skip entity
+ *          collision.  Bullets never hit the entity that fired them.
+ * @param   pstHit
+ *          Array to store the hits, may be NULL
+ * @param   u32MaxHits
+ *          Capacity of the hit array; further hits are not reported,
+ *          but the bullets are released nonetheless
+ * @param   pstPool
+ *          Pointer to bullet pool handle
+ * @return  Number of hits stored
+ */
+Uint32 Entity_UpdateBullets(
+    const Uint32       u32SolidMask,
+    const Map*         pstMap,
+    const EntityWorld* pstWorld,
+    BulletHit*         pstHit,
+    const Uint32       u32MaxHits,
+    BulletPool*        pstPool)
+{
+    BulletUpdate stUpdate;
+    Uint32       u32BlockCount = (pstPool->u32Used + UPDATE_BLOCK_LEN - 1) / UPDATE_BLOCK_LEN;
+    Uint32       u32HitCount   = 0;
+
+    stUpdate.u32SolidMask = u32SolidMask;
+    stUpdate.pstMap       = pstMap;
+    stUpdate.pstWorld     = pstWorld;
+    stUpdate.pstPool      = pstPool;
+
+    // Blocks only touch their own slots; the free list is left alone.
+    Job_ParallelFor(u32BlockCount, 1, _UpdateBulletBlocks, &stUpdate, Job_GetDefaultPool());
+
+    for (Uint32 u32Index = 0; u32Index < pstPool->u32Used; u32Index++)
+    {
+        if (0 == pstPool->pu16Life[u32Index])
+        {
+            continue;
+        }
+
+        if (BULLET_HIT_NONE != pstPool->ps32Target[u32Index])
+        {
+            if (pstHit && u32HitCount < u32MaxHits)
+            {
+                pstHit[u32HitCount].u32Bullet = u32Index;
+                pstHit[u32HitCount].s32Target = pstPool->ps32Target[u32Index];
+                pstHit[u32HitCount].dPosX     = pstPool->pdPosX[u32Index];
+                pstHit[u32HitCount].dPosY     = pstPool->pdPosY[u32Index];
+                u32HitCount++;
+            }
+            _ReleaseBullet(u32Index, pstPool);
+        }
+        else
+        {
+            pstPool->pu16Life[u32Index]--;
+            if (0 == pstPool->pu16Life[u32Index])
+            {
+                _ReleaseBullet(u32Index, pstPool);
+            }
+        }
+    }
+
+    return u32HitCount;
+}
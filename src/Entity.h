@@ -9,6 +9,15 @@
 #include <SDL.h>
 #include "AABB.h"
 #include "Constants.h"
+#include "Scalar.h"
+
+// Only referenced through pointers; include the respective headers to use them.
+struct AssetRequest_t;
+struct AssetUploader_t;
+struct Map_t;
+struct SpriteAtlas_t;
+struct SpriteBatch_t;
+struct TileContact_t;
 
 /**
  * @typedef Bullet
@@ -18,15 +27,80 @@
  */
 typedef struct Bullet_t
 {
-    AABB     stBB;          ///< Axis-aligned bounding box
-    double   dPosX;         ///< Position along the x-axis
-    double   dPosY;         ///< Position along the y-axis
-    Uint8    u8Size;        ///< Bullet size in pixel
-    SDL_bool bOrientation;  ///< The bullet's orientation
-    double   dVelocity;     ///< Velocity
+    AABB   stBB;          ///< Axis-aligned bounding box
+    Scalar dPosX;         ///< Position along the x-axis
+    Scalar dPosY;         ///< Position along the y-axis
+    Scalar dVelocityX;    ///< Velocity along the x-axis in pixel per update
+    Scalar dVelocityY;    ///< Velocity along the y-axis in pixel per update
+    Uint8  u8Size;        ///< Bullet size in pixel
+    Uint16 u16Lifetime;   ///< Number of updates until the bullet expires
+    Sint32 s32Owner;      ///< Index of the entity that fired it, -1 if none
 
 } Bullet;
 
+/**
+ * @typedef BulletConstants
+ * @brief   Bullet constants handle type
+ * @enum    BulletConstants_t
+ * @brief   Bullet constants enumeration
+ */
+typedef enum BulletConstants_t
+{
+    BULLET_LIFETIME = 180,  ///< Default lifetime in updates
+    BULLET_SIZE     = 4,    ///< Default size in pixel
+    BULLET_HIT_NONE = -2,   ///< Bullet has not hit anything
+    BULLET_HIT_TILE = -1    ///< Bullet has hit a solid tile
+
+} BulletConstants;
+
+/**
+ * @typedef BulletHit
+ * @brief   Bullet hit handle type
+ * @struct  BulletHit_t
+ * @brief   Collision of a bullet, see Entity_UpdateBullets()
+ */
+typedef struct BulletHit_t
+{
+    Uint32 u32Bullet;  ///< Slot of the bullet, released already
+    Sint32 s32Target;  ///< Index of the entity hit or BULLET_HIT_TILE
+    Scalar dPosX;      ///< Impact position along the x-axis
+    Scalar dPosY;      ///< Impact position along the y-axis
+
+} BulletHit;
+
+/**
+ * @typedef BulletPool
+ * @brief   Bullet pool handle type
+ * @struct  BulletPool_t
+ * @brief   Bullets stored as structure of arrays
+ * @details Slots have a fixed capacity and are recycled through a free
+ *          list, so firing and releasing bullets never allocates.  A
+ *          slot keeps its index for the lifetime of its bullet.  Only
+ *          the slots up to the high-water mark are processed; free
+ *          slots below it are idle and have no velocity.
+ */
+typedef struct BulletPool_t
+{
+    Uint32      u32Capacity;   ///< Max. number of bullets
+    Uint32      u32Count;      ///< Number of live bullets
+    Uint32      u32Used;       ///< High-water mark, slots ever used since empty
+    Uint32      u32FreeHead;   ///< First free slot below u32Used, u32Capacity if none
+    Scalar*     pdPosX;        ///< Positions along the x-axis
+    Scalar*     pdPosY;        ///< Positions along the y-axis
+    Scalar*     pdVelocityX;   ///< Velocities along the x-axis
+    Scalar*     pdVelocityY;   ///< Velocities along the y-axis
+    Scalar*     pdHalfSize;    ///< Half sizes in pixel
+    Sint32*     ps32Owner;     ///< Entities that fired the bullets, -1 if none
+    Sint32*     ps32Target;    ///< Hit of the current update, see BulletConstants
+    Uint32*     pu32NextFree;  ///< Free list links
+    Uint16*     pu16Life;      ///< Remaining updates, 0 if the slot is free
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    SDL_Vertex* pstVertex;     ///< Vertex buffer for Entity_DrawBullets()
+    int*        piIndex;       ///< Index buffer for Entity_DrawBullets()
+#endif
+
+} BulletPool;
+
 /**
  * @typedef Camera
  * @brief   Camera handle type
@@ -36,8 +110,8 @@ typedef struct Bullet_t
 typedef struct Camera_t
 {
     Uint16 u16Flags;    ///< Camera flags
-    double dPosX;       ///< Position along the x-axis
-    double dPosY;       ///< Position along the y-axis
+    Scalar dPosX;       ///< Position along the x-axis
+    Scalar dPosY;       ///< Position along the y-axis
     Sint32 s32MaxPosX;  ///< Maximum position along the x-axis
     Sint32 s32MaxPosY;  ///< Maximum position along the y-axis
 
@@ -53,16 +127,16 @@ typedef struct Entity_t
 {
     AABB      stBB;            ///< Axis-aligned bounding box
     Uint16    u16Flags;        ///< Flag mask
-    double    dPosX;           ///< Position along the x-axis
-    double    dPosY;           ///< Position along the y-axis
-    double    dSpawnPosX;      ///< Spawn position along the x-axis
-    double    dSpawnPosY;      ///< Spawn position along the y-axis
+    Scalar    dPosX;           ///< Position along the x-axis
+    Scalar    dPosY;           ///< Position along the y-axis
+    Scalar    dSpawnPosX;      ///< Spawn position along the x-axis
+    Scalar    dSpawnPosY;      ///< Spawn position along the y-axis
     SDL_bool  bIsJumping;      ///< Current jumping-state
     Direction eDirection;      ///< Direction
-    double    dAcceleration;   ///< Acceleration
-    double    dVelocityX;      ///< Velocity along the x-axis
-    double    dMaxVelocityX;   ///< Max velocity along the x-axis
-    double    dVelocityY;      ///< Velocity along the y-axis
+    Scalar    dAcceleration;   ///< Acceleration
+    Scalar    dVelocityX;      ///< Velocity along the x-axis
+    Scalar    dMaxVelocityX;   ///< Max velocity along the x-axis
+    Scalar    dVelocityY;      ///< Velocity along the y-axis
     Uint16    u16Width;        ///< Entity width in pixel
     Uint16    u16Height;       ///< Entity height in pixel
     Uint8     u8FrameOffsetX;  ///< Frame x-offset in frames
@@ -70,11 +144,61 @@ typedef struct Entity_t
     Uint8     u8AnimFrame;     ///< Current animation frame
     Uint8     u8AnimStart;     ///< Animation start
     Uint8     u8AnimEnd;       ///< Animation end
-    double    dAnimDelay;      ///< Animation delay
-    double    dAnimSpeed;      ///< Animation speed
+    Scalar    dAnimDelay;      ///< Animation delay
+    Scalar    dAnimSpeed;      ///< Animation speed
 
 } Entity;
 
+/**
+ * @typedef EntityWorldFlags
+ * @brief   Entity world flags type
+ * @enum    EntityWorldFlags_t
+ * @brief   Entity world flags enumeration
+ */
+typedef enum EntityWorldFlags_t
+{
+    ENTITY_IS_ANIMATED   = 0x01,  ///< Entity is animated
+    ENTITY_IS_IN_MID_AIR = 0x02,  ///< Entity is in mid-air
+    ENTITY_IS_MOVING     = 0x04,  ///< Entity is moving
+    ENTITY_IS_JUMPING    = 0x08,  ///< Entity is jumping
+    ENTITY_FACES_LEFT    = 0x10   ///< Entity moves to the left
+
+} EntityWorldFlags;
+
+/**
+ * @typedef EntityWorld
+ * @brief   Entity world handle type
+ * @struct  EntityWorld_t
+ * @brief   Entities stored as structure of arrays
+ * @details Holds the state of many entities in parallel arrays so
+ *          that Entity_UpdateAll() can process them with SIMD.  The
+ *          arrays are padded to a multiple of SIMD_PADDING entries.
+ */
+typedef struct EntityWorld_t
+{
+    Uint32  u32Count;         ///< Number of entities
+    Uint32  u32Capacity;      ///< Max. number of entities
+    Scalar* pdPosX;           ///< Positions along the x-axis
+    Scalar* pdPosY;           ///< Positions along the y-axis
+    Scalar* pdVelocityX;      ///< Velocities along the x-axis, see ENTITY_FACES_LEFT
+    Scalar* pdVelocityY;      ///< Velocities along the y-axis
+    Scalar* pdAcceleration;   ///< Accelerations
+    Scalar* pdMaxVelocityX;   ///< Max. velocities along the x-axis
+    Scalar* pdHalfWidth;      ///< Half widths in pixel
+    Scalar* pdHalfHeight;     ///< Half heights in pixel
+    Scalar* pdBottom;         ///< Bounding box bottom edges
+    Scalar* pdLeft;           ///< Bounding box left edges
+    Scalar* pdRight;          ///< Bounding box right edges
+    Scalar* pdTop;            ///< Bounding box top edges
+    Scalar* pdAnimDelay;      ///< Animation delays
+    Scalar* pdAnimSpeed;      ///< Animation speeds
+    Uint8*  pu8Flags;         ///< Flag masks, see EntityWorldFlags
+    Uint8*  pu8AnimFrame;     ///< Current animation frames
+    Uint8*  pu8AnimStart;     ///< Animation starts
+    Uint8*  pu8AnimEnd;       ///< Animation ends
+
+} EntityWorld;
+
 /**
  * @typedef Sprite
  * @brief   Sprite handle type
@@ -83,23 +207,34 @@ typedef struct Entity_t
  */
 typedef struct Sprite_t
 {
-    SDL_Texture* pstTexture;       ///< SDL2 texture
-    Uint16       u16Width;         ///< Sprite width
-    Uint16       u16Height;        ///< Sprite height
-    Uint16       u16ImageOffsetX;  ///< Image x-offset in pixel
-    Uint16       u16ImageOffsetY;  ///< Image y-offset in pixel
+    SDL_Texture*           pstTexture;       ///< SDL2 texture
+    Uint16                 u16Width;         ///< Sprite width
+    Uint16                 u16Height;        ///< Sprite height
+    Uint16                 u16ImageOffsetX;  ///< Image x-offset in pixel
+    Uint16                 u16ImageOffsetY;  ///< Image y-offset in pixel
+    SDL_bool               bIsShared;        ///< Texture is an atlas page owned by a sprite atlas
+    struct AssetRequest_t* pstRequest;       ///< Texture loaded in the background, NULL otherwise
 
 } Sprite;
 
-void Entity_Animate(SDL_bool bAnimate, Entity* pstEntity);
-void Entity_ConnectHorizontalMapEnds(const Uint16 u16MapWidth, Entity* pstEntity);
+Sint8 Entity_AddToBatch(
+    const Entity*         pstEntity,
+    const Camera*         pstCamera,
+    const Sprite*         pstSprite,
+    const Sint16          s16Layer,
+    struct SpriteBatch_t* pstBatch);
+
+Sint32 Entity_AddToWorld(const Entity* pstEntity, EntityWorld* pstWorld);
+void   Entity_Animate(SDL_bool bAnimate, Entity* pstEntity);
+void   Entity_ConnectHorizontalMapEnds(const Uint32 u32MapWidth, Entity* pstEntity);
 
 void Entity_ConnectMapEnds(
-    const Uint16 u16MapWidth,
-    const Uint16 u16MapHeight,
+    const Uint32 u32MapWidth,
+    const Uint32 u32MapHeight,
     Entity*      pstEntity);
 
-void Entity_ConnectVerticalMapEnds(const Uint16 u16MapHeight, Entity* pstEntity);
+void Entity_ConnectVerticalMapEnds(const Uint32 u32MapHeight, Entity* pstEntity);
+int  Entity_CreateBullet(const double dPosX, const double dPosY, Bullet* pstBullet);
 
 int  Entity_Draw(
      const Entity* pstEntity,
@@ -107,10 +242,19 @@ int  Entity_Draw(
      const Sprite* pstSprite,
      SDL_Renderer* pstRenderer);
 
-void Entity_Drop(Entity* pstEntity);
-void Entity_Free(Entity* pstEntity);
-void Entity_FreeCamera(Camera* pstCamera);
-void Entity_FreeSprite(Sprite* pstSprite);
+int Entity_DrawBullets(
+    const BulletPool* pstPool,
+    const Camera*     pstCamera,
+    const Sprite*     pstSprite,
+    SDL_Renderer*     pstRenderer);
+
+void   Entity_Drop(Entity* pstEntity);
+Sint32 Entity_FireBullet(const Bullet* pstBullet, BulletPool* pstPool);
+void   Entity_Free(Entity* pstEntity);
+void   Entity_FreeBulletPool(BulletPool* pstPool);
+void   Entity_FreeCamera(Camera* pstCamera);
+void   Entity_FreeSprite(Sprite* pstSprite);
+void   Entity_FreeWorld(EntityWorld* pstWorld);
 
 int Entity_Init(
     const double dPosX,
@@ -119,6 +263,7 @@ int Entity_Init(
     const Uint16 u16Height,
     Entity**     pstEntity);
 
+int Entity_InitBulletPool(const Uint32 u32Capacity, BulletPool** pstPool);
 int Entity_InitCamera(Camera** pstCamera);
 
 int Entity_InitSprite(
@@ -130,6 +275,24 @@ int Entity_InitSprite(
     Sprite**      pstSprite,
     SDL_Renderer* pstRenderer);
 
+int Entity_InitSpriteAsync(
+    const char*             pacFileName,
+    const Uint16            u16Width,
+    const Uint16            u16Height,
+    const Uint16            u16ImageOffsetX,
+    const Uint16            u16ImageOffsetY,
+    Sprite**                pstSprite,
+    struct AssetUploader_t* pstUploader);
+
+int Entity_InitSpriteFromAtlas(
+    const Uint32                u32Entry,
+    const Uint16                u16Width,
+    const Uint16                u16Height,
+    const struct SpriteAtlas_t* pstAtlas,
+    Sprite**                    pstSprite);
+
+int Entity_InitWorld(const Uint32 u32Capacity, EntityWorld** pstWorld);
+
 SDL_bool Entity_IsCameraLocked(const Camera* pstCamera);
 SDL_bool Entity_IsMoving(const Entity* pstEntity);
 SDL_bool Entity_IsRising(const Entity* pstEntity);
@@ -147,14 +310,16 @@ void Entity_MoveFull(
     const Uint8     u8FrameOffsetY,
     Entity*         pstEntity);
 
+void Entity_RemoveBullet(const Uint32 u32Index, BulletPool* pstPool);
+void Entity_RemoveFromWorld(const Uint32 u32Index, EntityWorld* pstWorld, BulletPool* pstPool);
 void Entity_Reset(Entity* pstEntity);
 void Entity_ResetToSpawnPosition(Entity* pstEntity);
 
 int Entity_SetCameraBoundariesToMapSize(
     const Sint32 s32LogicalWindowWidth,
     const Sint32 s32LogicalWindowHeight,
-    const Uint16 u16MapWidth,
-    const Uint16 u16MapHeight,
+    const Uint32 u32MapWidth,
+    const Uint32 u32MapHeight,
     Camera*      pstCamera);
 
 void Entity_SetCameraTarget(
@@ -169,6 +334,11 @@ void Entity_SetAnimation(
     const double dAnimSpeed,
     Entity*      pstEntity);
 
+void Entity_SetBulletVelocity(
+    const double dVelocityX,
+    const double dVelocityY,
+    Bullet*      pstBullet);
+
 void Entity_SetDirection(const Direction eDirection, Entity* pstEntity);
 void Entity_SetFrameOffset(const Uint8 u8OffsetX, const Uint8 u8OffsetY, Entity* pstEntity);
 void Entity_SetPosition(const double dPosX, const double dPosY, Entity* pstEntity);
@@ -182,3 +352,20 @@ void Entity_Update(
     const double dGravitation,
     const Uint8  u8MeterInPixel,
     Entity*      pstEntity);
+
+void Entity_UpdateAll(
+    const double          dDeltaTime,
+    const double          dGravitation,
+    const Uint8           u8MeterInPixel,
+    const Uint32          u32SolidMask,
+    const struct Map_t*   pstMap,
+    EntityWorld*          pstWorld,
+    struct TileContact_t* pstContact);
+
+Uint32 Entity_UpdateBullets(
+    const Uint32        u32SolidMask,
+    const struct Map_t* pstMap,
+    const EntityWorld*  pstWorld,
+    BulletHit*          pstHit,
+    const Uint32        u32MaxHits,
+    BulletPool*         pstPool);
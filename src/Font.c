@@ -9,6 +9,7 @@
 
 #include <SDL.h>
 #include <SDL_ttf.h>
+#include "Asset.h"
 #include "Font.h"
 
 /**
@@ -19,6 +20,13 @@
  */
 void Font_Free(Font* pstFont)
 {
+    if (pstFont)
+    {
+        Asset_Release(ASSET_FONT, pstFont->pstTTF, Asset_GetDefaultCache());
+    }
+
+    // Fonts have to be closed before the library is shut down.
+    Asset_Purge(ASSET_FONT, Asset_GetDefaultCache());
     TTF_Quit();
 
     SDL_free(pstFont);
@@ -51,10 +59,9 @@ Sint8 Font_Init(const char* pacFileName, Font** pstFont)
         return -1;
     }
 
-    (*pstFont)->pstTTF = TTF_OpenFont(pacFileName, 16);
+    (*pstFont)->pstTTF = Asset_LoadFont(pacFileName, 16, Asset_GetDefaultCache());
     if (!(*pstFont)->pstTTF)
     {
-        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", TTF_GetError());
         return -1;
     }
 
@@ -0,0 +1,566 @@
+// SPDX-License-Identifier: Beerware
+/**
+ * @file      Job.c
+ * @ingroup   Job
+ * @defgroup  Job Work-stealing job system
+ * @author    Michael Fitzmayer
+ * @copyright "THE BEER-WARE LICENCE" (Revision 42)
+ */
+
+#include <SDL.h>
+#include "Job.h"
+
+static JobPool* _pstDefaultPool = NULL;
+
+static JobQueue* _GetQueue(const JobPool* pstPool)
+{
+    JobQueue* pstQueue = SDL_TLSGet(pstPool->uQueueId);
+
+    if (!pstQueue)
+    {
+        return &pstPool->pstQueue[0];
+    }
+
+    return pstQueue;
+}
+
+static SDL_bool _Pop(const SDL_bool bSteal, JobQueue* pstQueue, Job* pstJob)
+{
+    SDL_bool bIsFound = SDL_FALSE;
+
+    SDL_AtomicLock(&pstQueue->iLock);
+    if (pstQueue->u32Top != pstQueue->u32Bottom)
+    {
+        if (bSteal)
+        {
+            *pstJob = pstQueue->astJob[pstQueue->u32Top & (JOB_QUEUE_LEN - 1)];
+            pstQueue->u32Top++;
+        }
+        else
+        {
+            pstQueue->u32Bottom--;
+            *pstJob = pstQueue->astJob[pstQueue->u32Bottom & (JOB_QUEUE_LEN - 1)];
+        }
+        bIsFound = SDL_TRUE;
+    }
+    SDL_AtomicUnlock(&pstQueue->iLock);
+
+    return bIsFound;
+}
+
+static SDL_bool _Push(const Job* pstJob, const SDL_bool bAtTop, JobQueue* pstQueue)
+{
+    SDL_bool bIsPushed = SDL_FALSE;
+
+    SDL_AtomicLock(&pstQueue->iLock);
+    if (pstQueue->u32Bottom - pstQueue->u32Top < JOB_QUEUE_LEN)
+    {
+        if (bAtTop)
+        {
+            pstQueue->u32Top--;
+            pstQueue->astJob[pstQueue->u32Top & (JOB_QUEUE_LEN - 1)] = *pstJob;
+        }
+        else
+        {
+            pstQueue->astJob[pstQueue->u32Bottom & (JOB_QUEUE_LEN - 1)] = *pstJob;
+            pstQueue->u32Bottom++;
+        }
+        bIsPushed = SDL_TRUE;
+    }
+    SDL_AtomicUnlock(&pstQueue->iLock);
+
+    return bIsPushed;
+}
+
+static void _Notify(JobPool* pstPool)
+{
+    // Workers take one token each; threads in Job_Wait() are only
+    // woken if there are any.
+    SDL_AtomicAdd(&pstPool->stEvents, 1);
+    SDL_SemPost(pstPool->pstWake);
+
+    if (SDL_AtomicGet(&pstPool->stWaiters) > 0)
+    {
+        SDL_LockMutex(pstPool->pstLock);
+        SDL_CondBroadcast(pstPool->pstEvent);
+        SDL_UnlockMutex(pstPool->pstLock);
+    }
+}
+
+static void _Run(const Job* pstJob, JobPool* pstPool)
+{
+    pstJob->pFunction(pstJob->pData);
+
+    // A drained counter may make re-queued jobs ready.
+    if (pstJob->pstCounter && 1 == SDL_AtomicAdd(&pstJob->pstCounter->stPending, -1) && pstPool)
+    {
+        _Notify(pstPool);
+    }
+}
+
+static SDL_bool _RunFrom(const SDL_bool bSteal, JobQueue* pstQueue, JobPool* pstPool)
+{
+    SDL_bool bIsWorker = NULL != SDL_TLSGet(pstPool->uQueueId);
+    Job      stJob;
+    Uint32   u32Count;
+
+    SDL_AtomicLock(&pstQueue->iLock);
+    u32Count = pstQueue->u32Bottom - pstQueue->u32Top;
+    SDL_AtomicUnlock(&pstQueue->iLock);
+
+    for (Uint32 u32Index = 0; u32Index < u32Count && _Pop(bSteal, pstQueue, &stJob); u32Index++)
+    {
+        SDL_bool bIsReady =
+            !stJob.pstDependency || SDL_AtomicGet(&stJob.pstDependency->stPending) <= 0;
+
+        if (bIsReady && (bIsWorker || !stJob.bIsBackground))
+        {
+            _Run(&stJob, pstPool);
+            return SDL_TRUE;
+        }
+
+        // Not ready yet: put it back at the other end, so that every
+        // job is looked at once and the owner picks up the jobs it
+        // depends on first.
+        if (!_Push(&stJob, bSteal ? SDL_FALSE : SDL_TRUE, pstQueue))
+        {
+            if (stJob.pstDependency)
+            {
+                Job_Wait(stJob.pstDependency, pstPool);
+            }
+            _Run(&stJob, pstPool);
+            return SDL_TRUE;
+        }
+
+        // A worker may have missed the job while it was taken out.
+        if (bIsReady)
+        {
+            SDL_SemPost(pstPool->pstWake);
+        }
+    }
+
+    return SDL_FALSE;
+}
+
+static SDL_bool _RunNext(JobQueue* pstQueue, JobPool* pstPool)
+{
+    Uint8 u8QueueCount = pstPool->u8ThreadCount + 1;
+    Uint8 u8Own        = (Uint8)(pstQueue - pstPool->pstQueue);
+
+    if (_RunFrom(SDL_FALSE, pstQueue, pstPool))
+    {
+        return SDL_TRUE;
+    }
+
+    for (Uint8 u8Offset = 1; u8Offset < u8QueueCount; u8Offset++)
+    {
+        JobQueue* pstVictim = &pstPool->pstQueue[(u8Own + u8Offset) % u8QueueCount];
+
+        if (_RunFrom(SDL_TRUE, pstVictim, pstPool))
+        {
+            return SDL_TRUE;
+        }
+    }
+
+    return SDL_FALSE;
+}
+
+static void _RunRange(void* pData)
+{
+    JobRange* pstRange = pData;
+
+    while (1)
+    {
+        Uint32 u32First = (Uint32)SDL_AtomicAdd(&pstRange->stNext, (int)pstRange->u32BatchSize);
+        Uint32 u32Last;
+
+        if (u32First >= pstRange->u32Count)
+        {
+            break;
+        }
+
+        u32Last = SDL_min(u32First + pstRange->u32BatchSize, pstRange->u32Count);
+        pstRange->pFunction(u32First, u32Last, pstRange->pData);
+    }
+}
+
+static void _Submit(const Job* pstJob, JobPool* pstPool)
+{
+    if (pstJob->pstCounter)
+    {
+        SDL_AtomicAdd(&pstJob->pstCounter->stPending, 1);
+    }
+
+    if (pstPool && _Push(pstJob, SDL_FALSE, _GetQueue(pstPool)))
+    {
+        _Notify(pstPool);
+        return;
+    }
+
+    if (pstJob->pstDependency)
+    {
+        Job_Wait(pstJob->pstDependency, pstPool);
+    }
+    _Run(pstJob, pstPool);
+}
+
+static int _Work(void* pData)
+{
+    JobQueue* pstQueue = pData;
+    JobPool*  pstPool  = pstQueue->pstPool;
+
+    SDL_TLSSet(pstPool->uQueueId, pstQueue, NULL);
+
+    while (0 == SDL_AtomicGet(&pstPool->stQuit))
+    {
+        if (!_RunNext(pstQueue, pstPool))
+        {
+            // Woken once a job is queued or a counter drains, which
+            // may make a re-queued job ready.
+            SDL_SemWait(pstPool->pstWake);
+        }
+    }
+
+    SDL_TLSSet(pstPool->uQueueId, NULL, NULL);
+
+    return 0;
+}
+
+/**
+ * @brief   Free job pool
+ * @details Stops all worker threads and frees the job pool.  Jobs that
+ *          are still queued are discarded; wait for them first.
+ * @param   pstPool
+ *          Pointer to job pool handle, may be NULL
+ */
+void Job_Free(JobPool* pstPool)
+{
+    if (!pstPool)
+    {
+        return;
+    }
+
+    SDL_AtomicSet(&pstPool->stQuit, 1);
+    for (Uint8 u8Index = 0; u8Index < pstPool->u8ThreadCount; u8Index++)
+    {
+        SDL_SemPost(pstPool->pstWake);
+    }
+    for (Uint8 u8Index = 0; u8Index < pstPool->u8ThreadCount; u8Index++)
+    {
+        if (pstPool->apstThread[u8Index])
+        {
+            SDL_WaitThread(pstPool->apstThread[u8Index], NULL);
+        }
+    }
+
+    if (pstPool->pstWake)
+    {
+        SDL_DestroySemaphore(pstPool->pstWake);
+    }
+
+    if (pstPool->pstEvent)
+    {
+        SDL_DestroyCond(pstPool->pstEvent);
+    }
+
+    if (pstPool->pstLock)
+    {
+        SDL_DestroyMutex(pstPool->pstLock);
+    }
+
+    if (_pstDefaultPool == pstPool)
+    {
+        _pstDefaultPool = NULL;
+    }
+
+    SDL_free(pstPool->pstQueue);
+    SDL_free(pstPool);
+}
+
+/**
+ * @brief   Get default job pool
+ * @details Returns the first job pool that has been initialised.  The
+ *          framework uses it internally, e.g. in Map_Init() and
+ *          Entity_UpdateAll(), and falls back to sequential code if
+ *          there is none.
+ * @return  Pointer to job pool handle, NULL if there is none
+ */
+JobPool* Job_GetDefaultPool(void)
+{
+    return _pstDefaultPool;
+}
+
+/**
+ * @brief   Initialise job pool
+ * @details Starts a pool of worker threads.  Each worker owns a job
+ *          queue and steals jobs from the other queues once its own is
+ *          empty.
+ * @param   u8ThreadCount
+ *          Number of worker threads; 0 uses one thread less than there
+ *          are CPU cores, but at least one
+ * @param   pstPool
+ *          Pointer to job pool handle
+ * @return  Error code
+ * @retval  0:  OK
+ * @retval  -1: Error
+ */
+Sint8 Job_Init(const Uint8 u8ThreadCount, JobPool** pstPool)
+{
+    Uint8 u8Count = u8ThreadCount;
+
+    if (0 == u8Count)
+    {
+        int iCPUCount = SDL_GetCPUCount() - 1;
+
+        u8Count = (Uint8)SDL_max(1, SDL_min(iCPUCount, JOB_THREADS_MAX));
+    }
+    u8Count = SDL_min(u8Count, JOB_THREADS_MAX);
+
+    *pstPool = SDL_calloc(sizeof(struct JobPool_t), sizeof(Sint8));
+    if (!*pstPool)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InitJob(): error allocating memory.\n");
+        return -1;
+    }
+
+    (*pstPool)->pstQueue = SDL_calloc((size_t)u8Count + 1, sizeof(struct JobQueue_t));
+    if (!(*pstPool)->pstQueue)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InitJob(): error allocating memory.\n");
+        Job_Free(*pstPool);
+        *pstPool = NULL;
+        return -1;
+    }
+
+    (*pstPool)->uQueueId = SDL_TLSCreate();
+    (*pstPool)->pstWake  = SDL_CreateSemaphore(0);
+    (*pstPool)->pstLock  = SDL_CreateMutex();
+    (*pstPool)->pstEvent = SDL_CreateCond();
+    if (0 == (*pstPool)->uQueueId || !(*pstPool)->pstWake || !(*pstPool)->pstLock ||
+        !(*pstPool)->pstEvent)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+        Job_Free(*pstPool);
+        *pstPool = NULL;
+        return -1;
+    }
+
+    for (Uint8 u8Index = 0; u8Index <= u8Count; u8Index++)
+    {
+        (*pstPool)->pstQueue[u8Index].pstPool = *pstPool;
+    }
+
+    // Set before the first worker starts stealing; queues of workers
+    // that fail to start simply stay empty.
+    (*pstPool)->u8ThreadCount = u8Count;
+
+    for (Uint8 u8Index = 0; u8Index < u8Count; u8Index++)
+    {
+        JobQueue* pstQueue = &(*pstPool)->pstQueue[u8Index + 1];
+
+        (*pstPool)->apstThread[u8Index] = SDL_CreateThread(_Work, "Job", pstQueue);
+        if (!(*pstPool)->apstThread[u8Index])
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+            Job_Free(*pstPool);
+            *pstPool = NULL;
+            return -1;
+        }
+    }
+
+    if (!_pstDefaultPool)
+    {
+        _pstDefaultPool = *pstPool;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief   Run function over a range of indices in parallel
+ * @details Splits the range into batches that are processed by the
+ *          worker threads and the calling thread.  Returns once all
+ *          batches are done.
+ * @param   u32Count
+ *          Number of indices
+ * @param   u32BatchSize
+ *          Number of indices per batch
+ * @param   pFunction
+ *          Function to run per batch
+ * @param   pData
+ *          Data passed to the function
+ * @param   pstPool
+ *          Pointer to job pool handle; NULL runs the function once
+ *          over the whole range on the calling thread
+ */
+void Job_ParallelFor(
+    const Uint32           u32Count,
+    const Uint32           u32BatchSize,
+    const JobRangeFunction pFunction,
+    void*                  pData,
+    JobPool*               pstPool)
+{
+    JobRange   stRange;
+    JobCounter stCounter;
+    Uint32     u32BatchCount;
+    Uint32     u32JobCount;
+
+    if (0 == u32Count)
+    {
+        return;
+    }
+
+    stRange.pFunction    = pFunction;
+    stRange.pData        = pData;
+    stRange.u32Count     = u32Count;
+    stRange.u32BatchSize = SDL_max(1, u32BatchSize);
+    u32BatchCount        = (u32Count + stRange.u32BatchSize - 1) / stRange.u32BatchSize;
+
+    if (!pstPool || 1 == u32BatchCount)
+    {
+        pFunction(0, u32Count, pData);
+        return;
+    }
+
+    SDL_AtomicSet(&stRange.stNext, 0);
+    SDL_AtomicSet(&stCounter.stPending, 0);
+
+    // The calling thread takes part, so one batch needs no job.
+    u32JobCount = SDL_min(u32BatchCount - 1, pstPool->u8ThreadCount);
+    for (Uint32 u32Index = 0; u32Index < u32JobCount; u32Index++)
+    {
+        Job_Submit(_RunRange, &stRange, &stCounter, pstPool);
+    }
+
+    _RunRange(&stRange);
+    Job_Wait(&stCounter, pstPool);
+}
+
+/**
+ * @brief   Submit job
+ * @details Queues a job on the calling thread's queue.  If the queue
+ *          is full, the job is run right away.
+ * @param   pFunction
+ *          Function to run
+ * @param   pData
+ *          Data passed to the function
+ * @param   pstCounter
+ *          Pointer to counter that tracks the job, may be NULL
+ * @param   pstPool
+ *          Pointer to job pool handle; NULL runs the job right away
+ */
+void Job_Submit(const JobFunction pFunction, void* pData, JobCounter* pstCounter, JobPool* pstPool)
+{
+    Job_SubmitAfter(pFunction, pData, NULL, pstCounter, pstPool);
+}
+
+/**
+ * @brief   Submit background job
+ * @details Queues a long-running job, e.g. loading a map, that is only
+ *          run by the worker threads of the pool.  Threads that are not
+ *          part of the pool, e.g. the main thread, never pick it up
+ *          while they wait for other jobs, so it cannot stall them.
+ * @param   pFunction
+ *          Function to run
+ * @param   pData
+ *          Data passed to the function
+ * @param   pstCounter
+ *          Pointer to counter that tracks the job, may be NULL
+ * @param   pstPool
+ *          Pointer to job pool handle; NULL runs the job right away
+ * @remark  If the queue is full, the job is run right away as well.
+ */
+void Job_SubmitBackground(
+    const JobFunction pFunction,
+    void*             pData,
+    JobCounter*       pstCounter,
+    JobPool*          pstPool)
+{
+    Job stJob;
+
+    stJob.pFunction     = pFunction;
+    stJob.pData         = pData;
+    stJob.pstCounter    = pstCounter;
+    stJob.pstDependency = NULL;
+    stJob.bIsBackground = SDL_TRUE;
+
+    _Submit(&stJob, pstPool);
+}
+
+/**
+ * @brief   Submit job with dependency
+ * @details Queues a job that is not run before all jobs tracked by
+ *          another counter are done.  This allows simple task graphs:
+ *          every stage tracks its jobs with one counter and depends on
+ *          the counter of the previous stage.
+ * @param   pFunction
+ *          Function to run
+ * @param   pData
+ *          Data passed to the function
+ * @param   pstDependency
+ *          Pointer to counter that has to reach zero first, may be NULL
+ * @param   pstCounter
+ *          Pointer to counter that tracks the job, may be NULL
+ * @param   pstPool
+ *          Pointer to job pool handle; NULL runs the job right away
+ */
+void Job_SubmitAfter(
+    const JobFunction pFunction,
+    void*             pData,
+    JobCounter*       pstDependency,
+    JobCounter*       pstCounter,
+    JobPool*          pstPool)
+{
+    Job stJob;
+
+    stJob.pFunction     = pFunction;
+    stJob.pData         = pData;
+    stJob.pstCounter    = pstCounter;
+    stJob.pstDependency = pstDependency;
+    stJob.bIsBackground = SDL_FALSE;
+
+    _Submit(&stJob, pstPool);
+}
+
+/**
+ * @brief   Wait for jobs
+ * @details Blocks until all jobs tracked by the counter are done.  The
+ *          calling thread runs queued jobs in the meantime and sleeps
+ *          while there are none it could run.
+ * @param   pstCounter
+ *          Pointer to job counter
+ * @param   pstPool
+ *          Pointer to job pool handle, may be NULL
+ */
+void Job_Wait(JobCounter* pstCounter, JobPool* pstPool)
+{
+    while (SDL_AtomicGet(&pstCounter->stPending) > 0)
+    {
+        int iEvents;
+
+        // Without a pool, the jobs can only be run by other threads.
+        if (!pstPool)
+        {
+            SDL_Delay(1);
+            continue;
+        }
+
+        iEvents = SDL_AtomicGet(&pstPool->stEvents);
+        if (_RunNext(_GetQueue(pstPool), pstPool))
+        {
+            continue;
+        }
+
+        // Sleep until a job is queued or a counter drains.  Events
+        // after the snapshot above end the wait right away.
+        SDL_AtomicAdd(&pstPool->stWaiters, 1);
+        SDL_LockMutex(pstPool->pstLock);
+        while (SDL_AtomicGet(&pstCounter->stPending) > 0 &&
+               iEvents == SDL_AtomicGet(&pstPool->stEvents))
+        {
+            SDL_CondWait(pstPool->pstEvent, pstPool->pstLock);
+        }
+        SDL_UnlockMutex(pstPool->pstLock);
+        SDL_AtomicAdd(&pstPool->stWaiters, -1);
+    }
+}
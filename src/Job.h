@@ -0,0 +1,152 @@
+// SPDX-License-Identifier: Beerware
+/**
+ * @file    Job.h
+ * @brief   Job system include header
+ * @ingroup Job
+ */
+#pragma once
+
+#include <SDL.h>
+
+/**
+ * @typedef JobConstants
+ * @brief   Job constants handle type
+ * @enum    JobConstants_t
+ * @brief   Job constants enumeration
+ */
+typedef enum JobConstants_t
+{
+    JOB_QUEUE_LEN   = 256,  ///< Max. jobs per queue, power of two
+    JOB_THREADS_MAX = 32    ///< Max. number of worker threads
+
+} JobConstants;
+
+/**
+ * @typedef JobFunction
+ * @brief   Job function type
+ */
+typedef void (*JobFunction)(void* pData);
+
+/**
+ * @typedef JobRangeFunction
+ * @brief   Parallel-for function type
+ * @details Processes the indices from u32First up to, but not
+ *          including, u32Last
+ */
+typedef void (*JobRangeFunction)(const Uint32 u32First, const Uint32 u32Last, void* pData);
+
+/**
+ * @typedef JobCounter
+ * @brief   Job counter handle type
+ * @struct  JobCounter_t
+ * @brief   Number of pending jobs of a group
+ * @details Zero-initialise before first use.  Jobs submitted with a
+ *          counter increment it and decrement it once done; see
+ *          Job_Wait().
+ */
+typedef struct JobCounter_t
+{
+    SDL_atomic_t stPending;  ///< Number of pending jobs
+
+} JobCounter;
+
+/**
+ * @typedef Job
+ * @brief   Job handle type
+ * @struct  Job_t
+ * @brief   Job data
+ */
+typedef struct Job_t
+{
+    JobFunction pFunction;      ///< Function to run
+    void*       pData;          ///< Data passed to the function
+    JobCounter* pstCounter;     ///< Counter to decrement when done, may be NULL
+    JobCounter* pstDependency;  ///< Counter that has to reach zero first, may be NULL
+    SDL_bool    bIsBackground;  ///< Only run by worker threads, see Job_SubmitBackground()
+
+} Job;
+
+/**
+ * @typedef JobQueue
+ * @brief   Job queue handle type
+ * @struct  JobQueue_t
+ * @brief   Double-ended job queue
+ * @details The owning thread pushes and pops at the bottom; other
+ *          threads steal from the top.
+ */
+typedef struct JobQueue_t
+{
+    Job               astJob[JOB_QUEUE_LEN];  ///< Ring buffer
+    Uint32            u32Top;                 ///< Index of the oldest job
+    Uint32            u32Bottom;              ///< Index past the newest job
+    SDL_SpinLock      iLock;                  ///< Queue lock
+    struct JobPool_t* pstPool;                ///< Owning pool
+
+} JobQueue;
+
+/**
+ * @typedef JobRange
+ * @brief   Job range handle type
+ * @struct  JobRange_t
+ * @brief   Shared state of a parallel-for
+ */
+typedef struct JobRange_t
+{
+    JobRangeFunction pFunction;     ///< Function to run per batch
+    void*            pData;         ///< Data passed to the function
+    Uint32           u32Count;      ///< Number of indices
+    Uint32           u32BatchSize;  ///< Number of indices per batch
+    SDL_atomic_t     stNext;        ///< First index of the next batch
+
+} JobRange;
+
+/**
+ * @typedef JobPool
+ * @brief   Job pool handle type
+ * @struct  JobPool_t
+ * @brief   Work-stealing thread pool data
+ * @details Queue 0 is shared by all threads that are not part of the
+ *          pool, e.g. the main thread; queue n belongs to worker n.
+ */
+typedef struct JobPool_t
+{
+    SDL_Thread*  apstThread[JOB_THREADS_MAX];  ///< Worker threads
+    Uint8        u8ThreadCount;                ///< Number of worker threads
+    JobQueue*    pstQueue;                     ///< Job queues, u8ThreadCount + 1 entries
+    SDL_sem*     pstWake;                      ///< Signalled per queued job and drained counter
+    SDL_mutex*   pstLock;                      ///< Protects waiting on pstEvent
+    SDL_cond*    pstEvent;                     ///< Wakes threads blocked in Job_Wait()
+    SDL_atomic_t stEvents;                     ///< Number of queued jobs and drained counters
+    SDL_atomic_t stWaiters;                    ///< Number of threads blocked in Job_Wait()
+    SDL_TLSID    uQueueId;                     ///< Queue of the current worker thread
+    SDL_atomic_t stQuit;                       ///< Set to stop the workers
+
+} JobPool;
+
+void     Job_Free(JobPool* pstPool);
+JobPool* Job_GetDefaultPool(void);
+Sint8    Job_Init(const Uint8 u8ThreadCount, JobPool** pstPool);
+
+void Job_ParallelFor(
+    const Uint32           u32Count,
+    const Uint32           u32BatchSize,
+    const JobRangeFunction pFunction,
+    void*                  pData,
+    JobPool*               pstPool);
+
+void Job_Submit(const JobFunction pFunction, void* pData, JobCounter* pstCounter, JobPool* pstPool);
+
+void Job_SubmitBackground(
+    const JobFunction pFunction,
+    void*             pData,
+    JobCounter*       pstCounter,
+    JobPool*          pstPool);
+
+void Job_SubmitAfter(
+    const JobFunction pFunction,
+    void*             pData,
+    JobCounter*       pstDependency,
+    JobCounter*       pstCounter,
+    JobPool*          pstPool);
+
+void Job_Wait(JobCounter* pstCounter, JobPool* pstPool);
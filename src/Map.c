@@ -8,468 +8,3888 @@
  */
 
 #include <SDL.h>
-#include <SDL_image.h>
+#include "Asset.h"
 #include "Constants.h"
+#include "Job.h"
 #include "Map.h"
+#include "Pack.h"
+#include "Scalar.h"
+#include "Utils.h"
 
-static Uint16 _ClearGidFlags(Uint16 u16Gid)
+/**
+ * @def     SWEEP_EPSILON
+ * @brief   Tolerance in pixel below which a box edge does not reach
+ *          into the next tile
+ */
+#define SWEEP_EPSILON 0.0001
+
+/**
+ * @def     SWEEP_PUSH_CELLS
+ * @brief   Max. number of solid cells a box that starts inside solid
+ *          tiles is pushed through, see Map_SweepBox()
+ */
+#define SWEEP_PUSH_CELLS 8
+
+/**
+ * @typedef PropertyBuilder
+ * @brief   Property builder handle type
+ * @struct  PropertyBuilder_t
+ * @brief   State passed to tmx_property_foreach() while loading
+ *          properties
+ */
+typedef struct PropertyBuilder_t
 {
-    return u16Gid & TMX_FLIP_BITS_REMOVAL;
-}
+    Map*   pstMap;       ///< Map being loaded
+    Uint32 u32Owner;     ///< Owner of the properties being visited
+    Uint32 u32Count;     ///< Number of properties
+    Uint32 u32PoolSize;  ///< Property string pool size in bytes
+
+} PropertyBuilder;
 
-static void _GetObject(tmx_object* pstTmxObject, Uint16 u16Index, Object astObject[])
+/**
+ * @typedef TilesetDecode
+ * @brief   Tileset decode handle type
+ * @struct  TilesetDecode_t
+ * @brief   Tileset images decoded in parallel while composing the atlas
+ */
+typedef struct TilesetDecode_t
 {
-    if (pstTmxObject)
-    {
-        astObject[u16Index].u16Id     = pstTmxObject->id;
-        astObject[u16Index].u32PosX   = pstTmxObject->x;
-        astObject[u16Index].u32PosY   = pstTmxObject->y;
-        astObject[u16Index].u16Width  = pstTmxObject->width;
-        astObject[u16Index].u16Height = pstTmxObject->height;
+    const MapTileset* pstTileset;  ///< Tilesets
+    SDL_Surface**     ppstImage;   ///< Decoded image per tileset, NULL on error
 
-        SDL_strlcpy(astObject[u16Index].acName, pstTmxObject->name, OBJECT_NAME_LEN - 1);
-        SDL_strlcpy(astObject[u16Index].acType, pstTmxObject->type, OBJECT_TYPE_LEN - 1);
+} TilesetDecode;
 
-        astObject[u16Index].stBB.dBottom =
-            (double)astObject[u16Index].u32PosY + (double)astObject[u16Index].u16Height / 2.f;
-        astObject[u16Index].stBB.dLeft =
-            (double)astObject[u16Index].u32PosX - (double)astObject[u16Index].u16Width / 2.f;
-        astObject[u16Index].stBB.dRight =
-            (double)astObject[u16Index].u32PosX + (double)astObject[u16Index].u16Width / 2.f;
-        astObject[u16Index].stBB.dTop =
-            (double)astObject[u16Index].u32PosY - (double)astObject[u16Index].u16Height / 2.f;
+/**
+ * @typedef ObjectBatch
+ * @brief   Object batch handle type
+ * @struct  ObjectBatch_t
+ * @brief   Objects whose geometry is extracted in parallel
+ */
+typedef struct ObjectBatch_t
+{
+    ObjectStore* pstStore;       ///< Object store to fill
+    tmx_object** ppstTmxObject;  ///< TMX object per object index
 
-        if (astObject[u16Index].stBB.dLeft <= 0)
-        {
-            astObject[u16Index].stBB.dLeft = 0;
-        }
+} ObjectBatch;
 
-        if (astObject[u16Index].stBB.dTop <= 0)
-        {
-            astObject[u16Index].stBB.dTop = 0;
-        }
-    }
+static Uint32 _ClearGidFlags(Uint32 u32Gid)
+{
+    return u32Gid & TMX_FLIP_BITS_REMOVAL;
+}
 
-    if (pstTmxObject && pstTmxObject->next)
+static Uint32 _HashData(const Uint8* pu8Data, const size_t zSize, Uint32 u32Hash)
+{
+    for (size_t zIndex = 0; zIndex < zSize; zIndex++)
     {
-        u16Index++;
-        _GetObject(pstTmxObject->next, u16Index, &(*astObject));
+        u32Hash ^= pu8Data[zIndex];
+        u32Hash *= 16777619u;
     }
+
+    return u32Hash;
 }
 
-static void _GetObjectCount(tmx_object* pstObject, Uint16** pu16ObjectCount)
+static Uint32 _HashString(const char* pacString)
 {
-    if (pstObject)
-    {
-        (**pu16ObjectCount)++;
-    }
+    Uint32 u32Hash = 2166136261u;
 
-    if (pstObject && pstObject->next)
+    while (*pacString)
     {
-        _GetObjectCount(pstObject->next, pu16ObjectCount);
+        u32Hash ^= (Uint8)*pacString;
+        u32Hash *= 16777619u;
+        pacString++;
     }
+
+    return u32Hash;
 }
 
-static void _GetGravitation(tmx_property* pProperty, void* dGravitation)
+static Uint32 _InternString(
+    const char*  pacString,
+    Uint32*      pu32Table,
+    const Uint32 u32TableMask,
+    ObjectStore* pstStore)
 {
-    if (0 == SDL_strncmp(pProperty->name, "Gravitation", 11))
+    Uint32 u32Slot = _HashString(pacString) & u32TableMask;
+    Uint32 u32Handle;
+
+    // Slots hold handle + 1, 0 marks an empty slot.
+    while (pu32Table[u32Slot])
     {
-        if (PT_FLOAT == pProperty->type)
+        u32Handle = pu32Table[u32Slot] - 1;
+        if (0 == SDL_strcmp(pacString, &pstStore->pacStringPool[u32Handle]))
         {
-            *((double*)dGravitation) = pProperty->value.decimal;
+            return u32Handle;
         }
+        u32Slot = (u32Slot + 1) & u32TableMask;
     }
+
+    u32Handle = pstStore->u32StringPoolSize;
+    SDL_strlcpy(&pstStore->pacStringPool[u32Handle], pacString, SDL_strlen(pacString) + 1);
+    pstStore->u32StringPoolSize += SDL_strlen(pacString) + 1;
+    pu32Table[u32Slot] = u32Handle + 1;
+
+    return u32Handle;
 }
 
-/**
- * @brief   Draw Map
- * @details Draws the map on screen
- * @param   u16Index
- *          The texture index; the total amount of layers per map is
- *          defined by MAP_TEXTURES.
- * @param   bRenderAnimTiles
- *          If set to 1, all animated tiles will be rendered in this
- *          call.
- * @param   bRenderBgColour
- *          Determine if the map's background colour should be rendered
- * @param   pacLayerName
- *          Sub-string of the layer(s) to render
- * @param   dCameraPosX
- *          Camera position along the x-axis
- * @param   dCameraPosY
- *          Camera position along the y-axis
- * @param   pstMap
- *          Pointer to map handle
- * @param   pstRenderer
- *          Pointer to SDL2 rendering context
- * @return  Error code
- * @retval  0:  OK
- * @retval  -1: Error
- */
-Sint8 Map_Draw(
-    const Uint16   u16Index,
-    const SDL_bool bRenderAnimTiles,
-    const SDL_bool bRenderBgColour,
-    const char*    pacLayerName,
-    const double   dCameraPosX,
-    const double   dCameraPosY,
-    Map*           pstMap,
-    SDL_Renderer*  pstRenderer)
+static void _Free(void* pData, const Map* pstMap)
 {
-    double     dDeltaTime = (double)APPROX_TIME_PER_FRAME / (double)TIME_FACTOR;
-    tmx_layer* pstLayer   = pstMap->pstTmxMap->ly_head;
+    uintptr_t uBaked = (uintptr_t)pstMap->stBaked.pData;
+    uintptr_t uData  = (uintptr_t)pData;
 
-    // Load tileset image once.
-    if (!pstMap->pstTileset)
+    // Data used in place from a baked map is released with the file.
+    if (pstMap->stBaked.pData && uData >= uBaked && uData < uBaked + pstMap->stBaked.zSize)
     {
-        pstMap->pstTileset = IMG_LoadTexture(pstRenderer, pstMap->acTilesetImage);
-        if (!pstMap->pstTileset)
-        {
-            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", IMG_GetError());
-            return -1;
-        }
+        return;
     }
 
-    // Update and render animated tiles.
-    pstMap->dAnimDelay += dDeltaTime;
+    SDL_free(pData);
+}
+
+static void _FreeObjects(Map* pstMap)
+{
+    ObjectStore* pstStore = &pstMap->stObjects;
 
-    if (0 < pstMap->u16AnimTileSize &&
-        pstMap->dAnimDelay > (1.f / pstMap->dAnimSpeed - dDeltaTime) && bRenderAnimTiles)
+    _Free(pstStore->pu32Id, pstMap);
+    _Free(pstStore->ps32PosX, pstMap);
+    _Free(pstStore->ps32PosY, pstMap);
+    _Free(pstStore->pu32Width, pstMap);
+    _Free(pstStore->pu32Height, pstMap);
+    _Free(pstStore->pstBB, pstMap);
+    _Free(pstStore->pu32Name, pstMap);
+    _Free(pstStore->pu16Type, pstMap);
+    _Free(pstStore->pu32TypeName, pstMap);
+    _Free(pstStore->pu32TypeStart, pstMap);
+    _Free(pstStore->pu32TypeBucket, pstMap);
+    _Free(pstStore->pacStringPool, pstMap);
+    _Free(pstStore->pu32CellStart, pstMap);
+    _Free(pstStore->pu32CellObject, pstMap);
+}
+
+static Uint32 _FindRun(const Uint32 u32PosX, const Uint32 u32PosY, const MapLayer* pstLayer)
+{
+    Uint32 u32Low  = pstLayer->pu32RowStart[u32PosY];
+    Uint32 u32High = pstLayer->pu32RowStart[u32PosY + 1];
+
+    // Binary search for the first run of the row ending right of the
+    // column.
+    while (u32Low < u32High)
     {
-        if (!pstMap->pstAnimTexture)
-        {
-            pstMap->pstAnimTexture = SDL_CreateTexture(
-                pstRenderer,
-                SDL_PIXELFORMAT_ARGB8888,
-                SDL_TEXTUREACCESS_TARGET,
-                pstMap->pstTmxMap->width * pstMap->pstTmxMap->tile_width,
-                pstMap->pstTmxMap->height * pstMap->pstTmxMap->tile_height);
-        }
+        Uint32        u32Mid = u32Low + ((u32High - u32Low) / 2);
+        const MapRun* pstRun = &pstLayer->pstRun[u32Mid];
 
-        if (!pstMap->pstAnimTexture)
+        if (pstRun->u32Column + pstRun->u32Length <= u32PosX)
         {
-            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
-            return -1;
+            u32Low = u32Mid + 1;
         }
-
-        if (0 != SDL_SetRenderTarget(pstRenderer, pstMap->pstAnimTexture))
+        else
         {
-            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
-            return -1;
+            u32High = u32Mid;
         }
+    }
 
-        for (Uint16 u16Idx = 0; u16Idx < pstMap->u16AnimTileSize; u16Idx++)
-        {
-            Uint16       u16Gid        = pstMap->acAnimTile[u16Idx].u16Gid;
-            Uint16       u16TileId     = pstMap->acAnimTile[u16Idx].u16TileId + 1;
-            Uint16       u16NextTileId = 0;
-            SDL_Rect     stDst;
-            SDL_Rect     stSrc;
-            tmx_tileset* pstTS;
+    return u32Low;
+}
 
-            pstTS   = pstMap->pstTmxMap->tiles[1]->tileset;
-            stSrc.x = pstMap->pstTmxMap->tiles[u16TileId]->ul_x;
-            stSrc.y = pstMap->pstTmxMap->tiles[u16TileId]->ul_y;
-            stSrc.w = stDst.w = pstTS->tile_width;
-            stSrc.h = stDst.h = pstTS->tile_height;
-            stDst.x           = pstMap->acAnimTile[u16Idx].s16DstX;
-            stDst.y           = pstMap->acAnimTile[u16Idx].s16DstY;
-            SDL_RenderCopy(pstRenderer, pstMap->pstTileset, &stSrc, &stDst);
+static Uint32 _GetGid(const Uint32 u32PosX, const Uint32 u32PosY, const MapLayer* pstLayer)
+{
+    Uint32        u32Run = _FindRun(u32PosX, u32PosY, pstLayer);
+    const MapRun* pstRun;
 
-            pstMap->acAnimTile[u16Idx].u8FrameCount++;
-            if (pstMap->acAnimTile[u16Idx].u8FrameCount >= pstMap->acAnimTile[u16Idx].u8AnimLen)
-            {
-                pstMap->acAnimTile[u16Idx].u8FrameCount = 0;
-            }
+    if (u32Run >= pstLayer->pu32RowStart[u32PosY + 1])
+    {
+        return 0;
+    }
 
-            u16NextTileId = pstMap->pstTmxMap->tiles[u16Gid]
-                                ->animation[pstMap->acAnimTile[u16Idx].u8FrameCount]
-                                .tile_id;
-            pstMap->acAnimTile[u16Idx].u16TileId = u16NextTileId;
-        }
+    pstRun = &pstLayer->pstRun[u32Run];
+    if (pstRun->u32Column > u32PosX)
+    {
+        return 0;
+    }
 
-        if (pstMap->dAnimDelay > 1.f / pstMap->dAnimSpeed)
-        {
-            pstMap->dAnimDelay = 0.f;
-        }
+    return pstLayer->pu32Gid[pstRun->u32Offset + (u32PosX - pstRun->u32Column)];
+}
 
-        // Switch back to default render target.
-        if (0 != SDL_SetRenderTarget(pstRenderer, NULL))
-        {
-            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
-            return -1;
-        }
+static void* _Grow(
+    void*        pData,
+    const Uint32 u32Count,
+    const size_t zElement,
+    Uint32*      pu32Size,
+    const Map*   pstMap)
+{
+    Uint32 u32Size = 16;
+    void*  pNew;
 
-        if (0 != SDL_SetTextureBlendMode(pstMap->pstAnimTexture, SDL_BLENDMODE_BLEND))
-        {
-            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
-            return -1;
-        }
+    if (u32Count < *pu32Size)
+    {
+        return pData;
     }
 
-    // The texture has already been rendered and can be drawn.
-    if (pstMap->pstTexture[u16Index])
+    if (*pu32Size > 0)
     {
-        double   dRenderPosX = pstMap->dPosX - dCameraPosX;
-        double   dRenderPosY = pstMap->dPosY - dCameraPosY;
-        SDL_Rect stDst       = { dRenderPosX,
-                           dRenderPosY,
-                           pstMap->pstTmxMap->width * pstMap->pstTmxMap->tile_width,
-                           pstMap->pstTmxMap->height * pstMap->pstTmxMap->tile_height };
-
-        if (-1 ==
-            SDL_RenderCopyEx(
-                pstRenderer, pstMap->pstTexture[u16Index], NULL, &stDst, 0, NULL, SDL_FLIP_NONE))
-        {
-            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
-            return -1;
-        }
+        u32Size = *pu32Size * 2;
+    }
 
-        if (bRenderAnimTiles)
-        {
-            if (pstMap->pstAnimTexture)
-            {
-                if (-1 ==
-                    SDL_RenderCopyEx(
-                        pstRenderer, pstMap->pstAnimTexture, NULL, &stDst, 0, NULL, SDL_FLIP_NONE))
-                {
-                    SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
-                    return -1;
-                }
-            }
-        }
+    // Copy instead of realloc: the data may be part of a baked map.
+    pNew = SDL_malloc(u32Size * zElement);
+    if (!pNew)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "SetTile(): error allocating memory.\n");
+        return NULL;
+    }
 
-        return 0;
+    if (u32Count > 0)
+    {
+        SDL_memcpy(pNew, pData, u32Count * zElement);
     }
+    _Free(pData, pstMap);
+    *pu32Size = u32Size;
 
-    // Otherwise render the texture once.
-    pstMap->pstTexture[u16Index] = SDL_CreateTexture(
-        pstRenderer,
-        SDL_PIXELFORMAT_ARGB8888,
-        SDL_TEXTUREACCESS_TARGET,
-        pstMap->pstTmxMap->width * pstMap->pstTmxMap->tile_width,
-        pstMap->pstTmxMap->height * pstMap->pstTmxMap->tile_height);
+    return pNew;
+}
+
+static Sint8 _InsertRun(
+    const Uint32  u32PosY,
+    const Uint32  u32Run,
+    const MapRun* pstNew,
+    MapLayer*     pstLayer,
+    const Map*    pstMap)
+{
+    MapRun* pstRun = _Grow(
+        pstLayer->pstRun,
+        pstLayer->u32RunCount,
+        sizeof(struct MapRun_t),
+        &pstLayer->u32RunSize,
+        pstMap);
 
-    if (!pstMap->pstTexture[u16Index])
+    if (!pstRun)
     {
-        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
         return -1;
     }
+    pstLayer->pstRun = pstRun;
 
-    if (0 != SDL_SetRenderTarget(pstRenderer, pstMap->pstTexture[u16Index]))
+    SDL_memmove(
+        &pstRun[u32Run + 1],
+        &pstRun[u32Run],
+        (pstLayer->u32RunCount - u32Run) * sizeof(struct MapRun_t));
+
+    pstRun[u32Run] = *pstNew;
+    pstLayer->u32RunCount++;
+
+    for (Uint32 u32Row = u32PosY + 1; u32Row <= pstMap->u32Rows; u32Row++)
     {
-        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
-        return -1;
+        pstLayer->pu32RowStart[u32Row]++;
     }
 
-    if (bRenderBgColour)
+    return 0;
+}
+
+static void _RemoveRun(
+    const Uint32 u32PosY,
+    const Uint32 u32Run,
+    MapLayer*    pstLayer,
+    const Map*   pstMap)
+{
+    SDL_memmove(
+        &pstLayer->pstRun[u32Run],
+        &pstLayer->pstRun[u32Run + 1],
+        (pstLayer->u32RunCount - u32Run - 1) * sizeof(struct MapRun_t));
+
+    pstLayer->u32RunCount--;
+
+    for (Uint32 u32Row = u32PosY + 1; u32Row <= pstMap->u32Rows; u32Row++)
     {
-        SDL_SetRenderDrawColor(
-            pstRenderer,
-            (pstMap->pstTmxMap->backgroundcolor >> 16) & 0xFF,
-            (pstMap->pstTmxMap->backgroundcolor >> 8) & 0xFF,
-            (pstMap->pstTmxMap->backgroundcolor) & 0xFF,
-            255);
+        pstLayer->pu32RowStart[u32Row]--;
     }
+}
 
-    while (pstLayer)
+static Sint8 _InsertCell(
+    const Uint32 u32PosX,
+    const Uint32 u32PosY,
+    const Uint32 u32Run,
+    const Uint32 u32Gid,
+    MapLayer*    pstLayer,
+    const Map*   pstMap)
+{
+    Uint32   u32Start  = pstLayer->pu32RowStart[u32PosY];
+    Uint32   u32End    = pstLayer->pu32RowStart[u32PosY + 1];
+    Uint32   u32Pos    = pstLayer->u32GidCount;
+    SDL_bool bJoinPrev = SDL_FALSE;
+    SDL_bool bJoinNext = SDL_FALSE;
+    Uint32*  pu32Gid;
+
+    if (u32Run > u32Start &&
+        pstLayer->pstRun[u32Run - 1].u32Column + pstLayer->pstRun[u32Run - 1].u32Length == u32PosX)
     {
-        SDL_bool     bRenderLayer = 1;
-        Uint16       u16Gid;
-        SDL_Rect     stDst;
-        SDL_Rect     stSrc;
-        tmx_tileset* pstTS;
+        bJoinPrev = SDL_TRUE;
+    }
 
-        if (L_LAYER == pstLayer->type)
-        {
-            if (pacLayerName)
-            {
-                if (!SDL_strstr(pstLayer->name, pacLayerName))
-                {
-                    bRenderLayer = 0;
-                }
-            }
-            if (pstLayer->visible && bRenderLayer)
-            {
-                for (Uint16 u16IndexH = 0; u16IndexH < pstMap->pstTmxMap->height; u16IndexH++)
-                {
-                    for (Uint32 u16IndexW = 0; u16IndexW < pstMap->pstTmxMap->width; u16IndexW++)
-                    {
-                        u16Gid = _ClearGidFlags(
-                            pstLayer->content
-                                .gids[(u16IndexH * pstMap->pstTmxMap->width) + u16IndexW]);
-                        if (pstMap->pstTmxMap->tiles[u16Gid])
-                        {
-                            pstTS   = pstMap->pstTmxMap->tiles[1]->tileset;
-                            stSrc.x = pstMap->pstTmxMap->tiles[u16Gid]->ul_x;
-                            stSrc.y = pstMap->pstTmxMap->tiles[u16Gid]->ul_y;
-                            stSrc.w = stDst.w = pstTS->tile_width;
-                            stSrc.h = stDst.h = pstTS->tile_height;
-                            stDst.x           = u16IndexW * pstTS->tile_width;
-                            stDst.y           = u16IndexH * pstTS->tile_height;
-                            SDL_RenderCopy(pstRenderer, pstMap->pstTileset, &stSrc, &stDst);
-
-                            if (bRenderAnimTiles && pstMap->pstTmxMap->tiles[u16Gid]->animation)
-                            {
-                                Uint8  u8AnimLen;
-                                Uint16 u16TileId;
-                                u8AnimLen = pstMap->pstTmxMap->tiles[u16Gid]->animation_len;
-                                u16TileId = pstMap->pstTmxMap->tiles[u16Gid]->animation[0].tile_id;
-                                pstMap->acAnimTile[pstMap->u16AnimTileSize].u16Gid    = u16Gid;
-                                pstMap->acAnimTile[pstMap->u16AnimTileSize].u16TileId = u16TileId;
-                                pstMap->acAnimTile[pstMap->u16AnimTileSize].s16DstX   = stDst.x;
-                                pstMap->acAnimTile[pstMap->u16AnimTileSize].s16DstY   = stDst.y;
-                                pstMap->acAnimTile[pstMap->u16AnimTileSize].u8FrameCount = 0;
-                                pstMap->acAnimTile[pstMap->u16AnimTileSize].u8AnimLen = u8AnimLen;
-                                pstMap->u16AnimTileSize++;
-
-                                // Prevent buffer overflow.
-                                if (pstMap->u16AnimTileSize >= ANIM_TILE_MAX)
-                                {
-                                    pstMap->u16AnimTileSize = ANIM_TILE_MAX;
-                                }
-                            }
-                        }
-                    }
-                }
-                SDL_Log("Render TMX map layer: %s\n", pstLayer->name);
-            }
-        }
-        pstLayer = pstLayer->next;
+    if (u32Run < u32End && pstLayer->pstRun[u32Run].u32Column == u32PosX + 1)
+    {
+        bJoinNext = SDL_TRUE;
     }
-    // Switch back to default render target.
-    if (0 != SDL_SetRenderTarget(pstRenderer, NULL))
+
+    // The GID goes behind the previous run or in front of the next one.
+    if (bJoinPrev)
     {
-        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
-        return -1;
+        u32Pos = pstLayer->pstRun[u32Run - 1].u32Offset + pstLayer->pstRun[u32Run - 1].u32Length;
+    }
+    else if (u32Run < pstLayer->u32RunCount)
+    {
+        u32Pos = pstLayer->pstRun[u32Run].u32Offset;
     }
 
-    if (0 != SDL_SetTextureBlendMode(pstMap->pstTexture[u16Index], SDL_BLENDMODE_BLEND))
+    pu32Gid = _Grow(
+        pstLayer->pu32Gid, pstLayer->u32GidCount, sizeof(Uint32), &pstLayer->u32GidSize, pstMap);
+    if (!pu32Gid)
     {
-        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
         return -1;
     }
+    pstLayer->pu32Gid = pu32Gid;
 
-    return 0;
-}
+    SDL_memmove(
+        &pu32Gid[u32Pos + 1], &pu32Gid[u32Pos], (pstLayer->u32GidCount - u32Pos) * sizeof(Uint32));
+    pu32Gid[u32Pos] = u32Gid;
+    pstLayer->u32GidCount++;
 
-/**
- * @brief   Free map
- * @details Frees up allocated memory and unloads map
- * @param   pstMap
- *          Pointer to map handle
- */
-void Map_Free(Map* pstMap)
-{
-    if (pstMap)
+    for (Uint32 u32Index = u32Run; u32Index < pstLayer->u32RunCount; u32Index++)
     {
-        if (!pstMap->pstTmxMap)
-        {
-            tmx_map_free(pstMap->pstTmxMap);
-        }
-
-        if (pstMap->pstTileset)
-        {
-            SDL_DestroyTexture(pstMap->pstTileset);
-        }
+        pstLayer->pstRun[u32Index].u32Offset++;
+    }
 
-        for (Uint8 u8Index = 0; u8Index < MAP_TEXTURES; u8Index++)
-        {
-            if (pstMap->pstTexture[u8Index])
-            {
-                SDL_DestroyTexture(pstMap->pstTexture[u8Index]);
-            }
-        }
+    if (bJoinPrev)
+    {
+        pstLayer->pstRun[u32Run - 1].u32Length++;
 
-        if (pstMap->pstAnimTexture)
+        if (bJoinNext)
         {
-            SDL_DestroyTexture(pstMap->pstAnimTexture);
+            pstLayer->pstRun[u32Run - 1].u32Length += pstLayer->pstRun[u32Run].u32Length;
+            _RemoveRun(u32PosY, u32Run, pstLayer, pstMap);
         }
+    }
+    else if (bJoinNext)
+    {
+        pstLayer->pstRun[u32Run].u32Column--;
+        pstLayer->pstRun[u32Run].u32Length++;
+        pstLayer->pstRun[u32Run].u32Offset--;
+    }
+    else
+    {
+        MapRun stRun = { u32PosX, 1, u32Pos };
 
-        SDL_free(pstMap);
-        SDL_Log("Unload TMX map.\n");
+        return _InsertRun(u32PosY, u32Run, &stRun, pstLayer, pstMap);
     }
+
+    return 0;
 }
 
-/**
- * @brief   Get objects
- * @details Retreive objects from map
- * @param   pstMap
- *          Pointer to map handle
- * @param   astObject
- *          Array to store the objects
- */
-void Map_GetObjects(const Map* pstMap, Object astObject[])
+static Sint8 _RemoveCell(
+    const Uint32 u32PosX,
+    const Uint32 u32PosY,
+    const Uint32 u32Run,
+    MapLayer*    pstLayer,
+    const Map*   pstMap)
 {
-    tmx_layer*  pstLayer = pstMap->pstTmxMap->ly_head;
-    tmx_object* pstTmxObject;
+    MapRun* pstRun  = &pstLayer->pstRun[u32Run];
+    Uint32  u32Head = u32PosX - pstRun->u32Column;
+    Uint32  u32Tail = pstRun->u32Length - u32Head - 1;
+    Uint32  u32Pos  = pstRun->u32Offset + u32Head;
 
-    while (pstLayer)
+    if (u32Head > 0 && u32Tail > 0)
     {
-        if (L_OBJGR == pstLayer->type)
+        // Split the run, the tail's offset is corrected below.  The
+        // head is only shrunk once the tail is in place, so a failed
+        // insert leaves the layer untouched; the insert may move the
+        // run array.
+        MapRun stTail = { u32PosX + 1, u32Tail, u32Pos + 1 };
+
+        if (-1 == _InsertRun(u32PosY, u32Run + 1, &stTail, pstLayer, pstMap))
         {
-            pstTmxObject = pstLayer->content.objgr->head;
-            _GetObject(pstTmxObject, 0, &(*astObject));
+            return -1;
+        }
+        pstLayer->pstRun[u32Run].u32Length = u32Head;
+    }
+    else if (u32Head > 0)
+    {
+        pstRun->u32Length--;
+    }
+    else if (u32Tail > 0)
+    {
+        pstRun->u32Column++;
+        pstRun->u32Length--;
+    }
+    else
+    {
+        _RemoveRun(u32PosY, u32Run, pstLayer, pstMap);
+    }
+
+    SDL_memmove(
+        &pstLayer->pu32Gid[u32Pos],
+        &pstLayer->pu32Gid[u32Pos + 1],
+        (pstLayer->u32GidCount - u32Pos - 1) * sizeof(Uint32));
+    pstLayer->u32GidCount--;
+
+    for (Uint32 u32Index = u32Run; u32Index < pstLayer->u32RunCount; u32Index++)
+    {
+        if (pstLayer->pstRun[u32Index].u32Offset > u32Pos)
+        {
+            pstLayer->pstRun[u32Index].u32Offset--;
         }
-        pstLayer = pstLayer->next;
     }
+
+    return 0;
 }
 
-/**
- * @brief   Get object count
- * @details Return total object count of map
- * @param   pstMap
- *          Pointer to map handle
- * @return  Number of objects in the map
- */
-Uint16 Map_GetObjectCount(Map* pstMap)
+static Sint8 _SetGid(
+    const Uint32 u32PosX,
+    const Uint32 u32PosY,
+    const Uint32 u32Gid,
+    MapLayer*    pstLayer,
+    const Map*   pstMap)
 {
-    Uint16     u16ObjectCount  = 0;
-    Uint16*    pu16ObjectCount = &u16ObjectCount;
-    tmx_layer* pstLayer;
+    Uint32  u32Run = _FindRun(u32PosX, u32PosY, pstLayer);
+    MapRun* pstRun = NULL;
 
-    if (pstMap->u16ObjectCount)
+    if (u32Run < pstLayer->pu32RowStart[u32PosY + 1])
     {
-        return pstMap->u16ObjectCount;
+        pstRun = &pstLayer->pstRun[u32Run];
     }
 
-    pstLayer = pstMap->pstTmxMap->ly_head;
-    while (pstLayer)
+    if (pstRun && pstRun->u32Column <= u32PosX)
     {
-        if (L_OBJGR == pstLayer->type)
+        if (0 == u32Gid)
         {
-            _GetObjectCount(pstLayer->content.objgr->head, &pu16ObjectCount);
+            return _RemoveCell(u32PosX, u32PosY, u32Run, pstLayer, pstMap);
         }
 
-        pstLayer = pstLayer->next;
+        pstLayer->pu32Gid[pstRun->u32Offset + (u32PosX - pstRun->u32Column)] = u32Gid;
+        return 0;
     }
-    pstMap->u16ObjectCount = u16ObjectCount;
 
-    return u16ObjectCount;
+    if (0 == u32Gid)
+    {
+        return 0;
+    }
+
+    return _InsertCell(u32PosX, u32PosY, u32Run, u32Gid, pstLayer, pstMap);
+}
+
+static Sint8 _LoadLayers(Map* pstMap)
+{
+    tmx_layer* pstTmxLayer = pstMap->pstTmxMap->ly_head;
+    Uint16     u16Index    = 0;
+
+    while (pstTmxLayer)
+    {
+        if (L_LAYER == pstTmxLayer->type)
+        {
+            pstMap->u16LayerCount++;
+        }
+        pstTmxLayer = pstTmxLayer->next;
+    }
+
+    if (0 == pstMap->u16LayerCount)
+    {
+        return 0;
+    }
+
+    pstMap->pstLayer = SDL_calloc(pstMap->u16LayerCount, sizeof(struct MapLayer_t));
+    if (!pstMap->pstLayer)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InitMap(): error allocating memory.\n");
+        return -1;
+    }
+
+    for (pstTmxLayer = pstMap->pstTmxMap->ly_head; pstTmxLayer; pstTmxLayer = pstTmxLayer->next)
+    {
+        MapLayer* pstLayer = &pstMap->pstLayer[u16Index];
+        Uint32*   pu32Cell = (Uint32*)pstTmxLayer->content.gids;
+
+        if (L_LAYER != pstTmxLayer->type)
+        {
+            continue;
+        }
+
+        // Count runs and non-empty cells first.
+        for (Uint32 u32PosY = 0; u32PosY < pstMap->u32Rows; u32PosY++)
+        {
+            Uint32* pu32Row = &pu32Cell[u32PosY * pstMap->u32Columns];
+
+            for (Uint32 u32PosX = 0; u32PosX < pstMap->u32Columns; u32PosX++)
+            {
+                if (_ClearGidFlags(pu32Row[u32PosX]))
+                {
+                    if (0 == u32PosX || !_ClearGidFlags(pu32Row[u32PosX - 1]))
+                    {
+                        pstLayer->u32RunCount++;
+                    }
+                    pstLayer->u32GidCount++;
+                }
+            }
+        }
+
+        pstLayer->u32RunSize   = pstLayer->u32RunCount;
+        pstLayer->u32GidSize   = pstLayer->u32GidCount;
+        pstLayer->pu32RowStart = SDL_calloc(pstMap->u32Rows + 1, sizeof(Uint32));
+        pstLayer->pstRun       = SDL_calloc(pstLayer->u32RunCount + 1, sizeof(struct MapRun_t));
+        pstLayer->pu32Gid      = SDL_calloc(pstLayer->u32GidCount + 1, sizeof(Uint32));
+        if (!pstLayer->pu32RowStart || !pstLayer->pstRun || !pstLayer->pu32Gid)
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InitMap(): error allocating memory.\n");
+            return -1;
+        }
+
+        pstLayer->u32RunCount = 0;
+        pstLayer->u32GidCount = 0;
+
+        for (Uint32 u32PosY = 0; u32PosY < pstMap->u32Rows; u32PosY++)
+        {
+            Uint32* pu32Row = &pu32Cell[u32PosY * pstMap->u32Columns];
+
+            pstLayer->pu32RowStart[u32PosY] = pstLayer->u32RunCount;
+
+            for (Uint32 u32PosX = 0; u32PosX < pstMap->u32Columns; u32PosX++)
+            {
+                if (!_ClearGidFlags(pu32Row[u32PosX]))
+                {
+                    continue;
+                }
+
+                if (0 == u32PosX || !_ClearGidFlags(pu32Row[u32PosX - 1]))
+                {
+                    MapRun* pstRun = &pstLayer->pstRun[pstLayer->u32RunCount];
+
+                    pstRun->u32Column = u32PosX;
+                    pstRun->u32Offset = pstLayer->u32GidCount;
+                    pstLayer->u32RunCount++;
+                }
+
+                pstLayer->pstRun[pstLayer->u32RunCount - 1].u32Length++;
+                pstLayer->pu32Gid[pstLayer->u32GidCount] = pu32Row[u32PosX];
+                pstLayer->u32GidCount++;
+            }
+        }
+        pstLayer->pu32RowStart[pstMap->u32Rows] = pstLayer->u32RunCount;
+
+        SDL_strlcpy(pstLayer->acName, pstTmxLayer->name, LAYER_NAME_LEN);
+        pstLayer->bIsVisible = pstTmxLayer->visible ? SDL_TRUE : SDL_FALSE;
+        u16Index++;
+    }
+
+    return 0;
+}
+
+static void _ExtractObjects(const Uint32 u32First, const Uint32 u32Last, void* pData)
+{
+    ObjectBatch* pstBatch = pData;
+    ObjectStore* pstStore = pstBatch->pstStore;
+
+    for (Uint32 u32Index = u32First; u32Index < u32Last; u32Index++)
+    {
+        const tmx_object* pstTmxObject = pstBatch->ppstTmxObject[u32Index];
+        AABB*             pstBB        = &pstStore->pstBB[u32Index];
+
+        pstStore->pu32Id[u32Index]     = pstTmxObject->id;
+        pstStore->ps32PosX[u32Index]   = (Sint32)pstTmxObject->x;
+        pstStore->ps32PosY[u32Index]   = (Sint32)pstTmxObject->y;
+        pstStore->pu32Width[u32Index]  = pstTmxObject->width;
+        pstStore->pu32Height[u32Index] = pstTmxObject->height;
+
+        pstBB->dBottom = Scalar_FromDouble(pstTmxObject->y + pstTmxObject->height / 2.f);
+        pstBB->dLeft   = Scalar_FromDouble(pstTmxObject->x - pstTmxObject->width / 2.f);
+        pstBB->dRight  = Scalar_FromDouble(pstTmxObject->x + pstTmxObject->width / 2.f);
+        pstBB->dTop    = Scalar_FromDouble(pstTmxObject->y - pstTmxObject->height / 2.f);
+
+        if (pstBB->dLeft <= 0)
+        {
+            pstBB->dLeft = 0;
+        }
+
+        if (pstBB->dTop <= 0)
+        {
+            pstBB->dTop = 0;
+        }
+    }
+}
+
+static Sint8 _LoadObjects(Map* pstMap)
+{
+    ObjectStore* pstStore      = &pstMap->stObjects;
+    tmx_layer*   pstLayer      = pstMap->pstTmxMap->ly_head;
+    ObjectBatch  stBatch       = { pstStore, NULL };
+    Uint32*      pu32Table     = NULL;
+    Uint32*      pu32TypeTable = NULL;
+    Uint32*      pu32TypeFill  = NULL;
+    Uint32       u32PoolSize   = 1;
+    Uint32       u32TableMask  = 1;
+    Uint32       u32Count      = 0;
+    Sint8        s8ReturnValue = 0;
+    Uint32       u32Index;
+
+    // Count objects and determine the upper bound of the string pool.
+    while (pstLayer)
+    {
+        if (L_OBJGR == pstLayer->type)
+        {
+            for (tmx_object* pstTmxObject = pstLayer->content.objgr->head; pstTmxObject;
+                 pstTmxObject             = pstTmxObject->next)
+            {
+                u32Count++;
+                u32PoolSize += pstTmxObject->name ? SDL_strlen(pstTmxObject->name) + 1 : 1;
+                u32PoolSize += pstTmxObject->type ? SDL_strlen(pstTmxObject->type) + 1 : 1;
+            }
+        }
+        pstLayer = pstLayer->next;
+    }
+
+    pstStore->u32Count = u32Count;
+    if (0 == u32Count)
+    {
+        return 0;
+    }
+
+    while (u32TableMask + 1 < u32Count * 4)
+    {
+        u32TableMask = (u32TableMask << 1) | 1;
+    }
+
+    pstStore->pu32Id         = SDL_malloc(u32Count * sizeof(Uint32));
+    pstStore->ps32PosX       = SDL_malloc(u32Count * sizeof(Sint32));
+    pstStore->ps32PosY       = SDL_malloc(u32Count * sizeof(Sint32));
+    pstStore->pu32Width      = SDL_malloc(u32Count * sizeof(Uint32));
+    pstStore->pu32Height     = SDL_malloc(u32Count * sizeof(Uint32));
+    pstStore->pstBB          = SDL_malloc(u32Count * sizeof(struct AABB_t));
+    pstStore->pu32Name       = SDL_malloc(u32Count * sizeof(Uint32));
+    pstStore->pu16Type       = SDL_malloc(u32Count * sizeof(Uint16));
+    pstStore->pu32TypeName   = SDL_malloc(u32Count * sizeof(Uint32));
+    pstStore->pu32TypeBucket = SDL_malloc(u32Count * sizeof(Uint32));
+    pstStore->pacStringPool  = SDL_malloc(u32PoolSize);
+    pu32Table                = SDL_calloc(u32TableMask + 1, sizeof(Uint32));
+    pu32TypeTable            = SDL_calloc(u32TableMask + 1, sizeof(Uint32));
+    stBatch.ppstTmxObject    = SDL_malloc(u32Count * sizeof(tmx_object*));
+
+    if (!pstStore->pu32Id || !pstStore->ps32PosX || !pstStore->ps32PosY || !pstStore->pu32Width ||
+        !pstStore->pu32Height || !pstStore->pstBB || !pstStore->pu32Name || !pstStore->pu16Type ||
+        !pstStore->pu32TypeName || !pstStore->pu32TypeBucket || !pstStore->pacStringPool ||
+        !pu32Table || !pu32TypeTable || !stBatch.ppstTmxObject)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InitMap(): error allocating memory.\n");
+        s8ReturnValue = -1;
+        goto exit;
+    }
+
+    // Handle 0 is reserved for the empty string.
+    pstStore->pacStringPool[0]  = '\0';
+    pstStore->u32StringPoolSize = 1;
+
+    u32Index = 0;
+    pstLayer = pstMap->pstTmxMap->ly_head;
+    while (pstLayer)
+    {
+        if (L_OBJGR == pstLayer->type)
+        {
+            for (tmx_object* pstTmxObject = pstLayer->content.objgr->head; pstTmxObject;
+                 pstTmxObject             = pstTmxObject->next)
+            {
+                Uint32 u32TypeName = 0;
+                Uint32 u32Slot;
+
+                stBatch.ppstTmxObject[u32Index] = pstTmxObject;
+                pstStore->pu32Name[u32Index]    = 0;
+
+                if (pstTmxObject->name && pstTmxObject->name[0])
+                {
+                    pstStore->pu32Name[u32Index] =
+                        _InternString(pstTmxObject->name, pu32Table, u32TableMask, pstStore);
+                }
+
+                if (pstTmxObject->type && pstTmxObject->type[0])
+                {
+                    u32TypeName =
+                        _InternString(pstTmxObject->type, pu32Table, u32TableMask, pstStore);
+                }
+
+                // Interned names are unique, so types are looked up by
+                // name handle.  Slots hold type ID + 1, 0 marks an empty
+                // slot.
+                u32Slot = (u32TypeName * 2654435761u) & u32TableMask;
+                while (pu32TypeTable[u32Slot] &&
+                       u32TypeName != pstStore->pu32TypeName[pu32TypeTable[u32Slot] - 1])
+                {
+                    u32Slot = (u32Slot + 1) & u32TableMask;
+                }
+
+                if (!pu32TypeTable[u32Slot])
+                {
+                    if (SDL_MAX_UINT16 == pstStore->u16TypeCount)
+                    {
+                        SDL_LogError(
+                            SDL_LOG_CATEGORY_APPLICATION, "InitMap(): too many object types.\n");
+                        s8ReturnValue = -1;
+                        goto exit;
+                    }
+
+                    pstStore->pu32TypeName[pstStore->u16TypeCount] = u32TypeName;
+                    pstStore->u16TypeCount++;
+                    pu32TypeTable[u32Slot] = pstStore->u16TypeCount;
+                }
+                pstStore->pu16Type[u32Index] = (Uint16)(pu32TypeTable[u32Slot] - 1);
+
+                u32Index++;
+            }
+        }
+        pstLayer = pstLayer->next;
+    }
+
+    // Interning has to stay in order; the geometry does not.
+    Job_ParallelFor(u32Count, OBJECT_BATCH, _ExtractObjects, &stBatch, Job_GetDefaultPool());
+
+    // Group object indices by type (counting sort).
+    pstStore->pu32TypeStart = SDL_calloc(pstStore->u16TypeCount + 1, sizeof(Uint32));
+    pu32TypeFill            = SDL_calloc(pstStore->u16TypeCount, sizeof(Uint32));
+    if (!pstStore->pu32TypeStart || !pu32TypeFill)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InitMap(): error allocating memory.\n");
+        s8ReturnValue = -1;
+        goto exit;
+    }
+
+    for (u32Index = 0; u32Index < u32Count; u32Index++)
+    {
+        pstStore->pu32TypeStart[pstStore->pu16Type[u32Index] + 1]++;
+    }
+
+    for (Uint16 u16TypeId = 0; u16TypeId < pstStore->u16TypeCount; u16TypeId++)
+    {
+        pstStore->pu32TypeStart[u16TypeId + 1] += pstStore->pu32TypeStart[u16TypeId];
+    }
+
+    for (u32Index = 0; u32Index < u32Count; u32Index++)
+    {
+        Uint16 u16TypeId = pstStore->pu16Type[u32Index];
+        Uint32 u32Slot   = pstStore->pu32TypeStart[u16TypeId] + pu32TypeFill[u16TypeId];
+
+        pstStore->pu32TypeBucket[u32Slot] = u32Index;
+        pu32TypeFill[u16TypeId]++;
+    }
+
+exit:
+    SDL_free(pu32Table);
+    SDL_free(pu32TypeTable);
+    SDL_free(pu32TypeFill);
+    SDL_free(stBatch.ppstTmxObject);
+
+    return s8ReturnValue;
+}
+
+static void _GetObjectCells(
+    const AABB         stBB,
+    const ObjectStore* pstStore,
+    Uint32*            pu32CellX0,
+    Uint32*            pu32CellY0,
+    Uint32*            pu32CellX1,
+    Uint32*            pu32CellY1)
+{
+    double dCellX0 = SDL_floor(Scalar_ToDouble(stBB.dLeft) / OBJECT_CELL_LEN);
+    double dCellY0 = SDL_floor(Scalar_ToDouble(stBB.dTop) / OBJECT_CELL_LEN);
+    double dCellX1 = SDL_floor(Scalar_ToDouble(stBB.dRight) / OBJECT_CELL_LEN);
+    double dCellY1 = SDL_floor(Scalar_ToDouble(stBB.dBottom) / OBJECT_CELL_LEN);
+    double dMaxX   = pstStore->u32GridWidth - 1;
+    double dMaxY   = pstStore->u32GridHeight - 1;
+
+    // Objects (partially) outside of the map are clamped to the edge cells.
+    *pu32CellX0 = SDL_max(0, SDL_min(dCellX0, dMaxX));
+    *pu32CellY0 = SDL_max(0, SDL_min(dCellY0, dMaxY));
+    *pu32CellX1 = SDL_max(0, SDL_min(dCellX1, dMaxX));
+    *pu32CellY1 = SDL_max(0, SDL_min(dCellY1, dMaxY));
+}
+
+static Sint8 _BuildObjectIndex(Map* pstMap)
+{
+    ObjectStore* pstStore     = &pstMap->stObjects;
+    Uint32       u32MapWidth  = pstMap->u32Columns * pstMap->u16TileWidth;
+    Uint32       u32MapHeight = pstMap->u32Rows * pstMap->u16TileHeight;
+    Uint32       u32Cells;
+    Uint32       u32CellX0;
+    Uint32       u32CellY0;
+    Uint32       u32CellX1;
+    Uint32       u32CellY1;
+
+    pstStore->u32GridWidth  = (u32MapWidth + OBJECT_CELL_LEN - 1) / OBJECT_CELL_LEN;
+    pstStore->u32GridHeight = (u32MapHeight + OBJECT_CELL_LEN - 1) / OBJECT_CELL_LEN;
+    pstStore->u32GridWidth  = SDL_max(pstStore->u32GridWidth, 1);
+    pstStore->u32GridHeight = SDL_max(pstStore->u32GridHeight, 1);
+    u32Cells                = pstStore->u32GridWidth * pstStore->u32GridHeight;
+
+    pstStore->pu32CellStart = SDL_calloc(u32Cells + 1, sizeof(Uint32));
+    if (!pstStore->pu32CellStart)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InitMap(): error allocating memory.\n");
+        return -1;
+    }
+
+    // Count entries per cell, the start of cell n + 1 is used as counter.
+    for (Uint32 u32Index = 0; u32Index < pstStore->u32Count; u32Index++)
+    {
+        _GetObjectCells(
+            pstStore->pstBB[u32Index], pstStore, &u32CellX0, &u32CellY0, &u32CellX1, &u32CellY1);
+
+        for (Uint32 u32CellY = u32CellY0; u32CellY <= u32CellY1; u32CellY++)
+        {
+            for (Uint32 u32CellX = u32CellX0; u32CellX <= u32CellX1; u32CellX++)
+            {
+                pstStore->pu32CellStart[(u32CellY * pstStore->u32GridWidth) + u32CellX + 1]++;
+            }
+        }
+    }
+
+    for (Uint32 u32Cell = 0; u32Cell < u32Cells; u32Cell++)
+    {
+        pstStore->pu32CellStart[u32Cell + 1] += pstStore->pu32CellStart[u32Cell];
+    }
+
+    if (0 == pstStore->pu32CellStart[u32Cells])
+    {
+        return 0;
+    }
+
+    pstStore->pu32CellObject = SDL_malloc(pstStore->pu32CellStart[u32Cells] * sizeof(Uint32));
+    if (!pstStore->pu32CellObject)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InitMap(): error allocating memory.\n");
+        return -1;
+    }
+
+    // Fill cells; the start of cell n is used as fill counter and
+    // restored afterwards.
+    for (Uint32 u32Index = 0; u32Index < pstStore->u32Count; u32Index++)
+    {
+        _GetObjectCells(
+            pstStore->pstBB[u32Index], pstStore, &u32CellX0, &u32CellY0, &u32CellX1, &u32CellY1);
+
+        for (Uint32 u32CellY = u32CellY0; u32CellY <= u32CellY1; u32CellY++)
+        {
+            for (Uint32 u32CellX = u32CellX0; u32CellX <= u32CellX1; u32CellX++)
+            {
+                Uint32 u32Cell = (u32CellY * pstStore->u32GridWidth) + u32CellX;
+                pstStore->pu32CellObject[pstStore->pu32CellStart[u32Cell]] = u32Index;
+                pstStore->pu32CellStart[u32Cell]++;
+            }
+        }
+    }
+
+    for (Uint32 u32Cell = u32Cells; u32Cell > 0; u32Cell--)
+    {
+        pstStore->pu32CellStart[u32Cell] = pstStore->pu32CellStart[u32Cell - 1];
+    }
+    pstStore->pu32CellStart[0] = 0;
+
+    return 0;
+}
+
+static Sint8 _InternType(const char* pacType, Map* pstMap)
+{
+    Sint8 s8TypeId = Map_GetTypeId(pacType, pstMap);
+
+    if (-1 != s8TypeId)
+    {
+        return s8TypeId;
+    }
+
+    if (pstMap->u8TypeCount >= TILE_TYPE_MAX)
+    {
+        SDL_LogWarn(
+            SDL_LOG_CATEGORY_APPLICATION,
+            "Ignore tile type %s: more than %d tile types.\n",
+            pacType,
+            TILE_TYPE_MAX);
+        return -1;
+    }
+
+    SDL_strlcpy(pstMap->acTypeName[pstMap->u8TypeCount], pacType, TILE_TYPE_LEN);
+    s8TypeId = pstMap->u8TypeCount;
+    pstMap->u8TypeCount++;
+
+    return s8TypeId;
+}
+
+static void _BakeTypeRows(const Uint32 u32First, const Uint32 u32Last, void* pData)
+{
+    Map* pstMap = pData;
+
+    for (Uint16 u16Layer = 0; u16Layer < pstMap->u16LayerCount; u16Layer++)
+    {
+        const MapLayer* pstLayer = &pstMap->pstLayer[u16Layer];
+
+        for (Uint32 u32PosY = u32First; u32PosY < u32Last; u32PosY++)
+        {
+            Uint32* pu32Type = &pstMap->pu32TypeGrid[u32PosY * pstMap->u32Columns];
+
+            for (Uint32 u32Run = pstLayer->pu32RowStart[u32PosY];
+                 u32Run < pstLayer->pu32RowStart[u32PosY + 1];
+                 u32Run++)
+            {
+                const MapRun* pstRun = &pstLayer->pstRun[u32Run];
+
+                for (Uint32 u32Index = 0; u32Index < pstRun->u32Length; u32Index++)
+                {
+                    Uint32 u32Gid = _ClearGidFlags(pstLayer->pu32Gid[pstRun->u32Offset + u32Index]);
+
+                    if (u32Gid < pstMap->u32TileInfoCount &&
+                        -1 != pstMap->pstTileInfo[u32Gid].s8TypeId)
+                    {
+                        pu32Type[pstRun->u32Column + u32Index] |=
+                            (Uint32)1 << pstMap->pstTileInfo[u32Gid].s8TypeId;
+                    }
+                }
+            }
+        }
+    }
+}
+
+static Sint8 _BakeTypeGrid(Map* pstMap)
+{
+    tmx_map* pstTmxMap = pstMap->pstTmxMap;
+    Uint32   u32Cells  = pstMap->u32Columns * pstMap->u32Rows;
+
+    pstMap->pu32TypeGrid = SDL_calloc(u32Cells, sizeof(Uint32));
+    if (!pstMap->pu32TypeGrid)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InitMap(): error allocating memory.\n");
+        return -1;
+    }
+
+    // Resolve the type of each GID once.
+    for (Uint32 u32Gid = 0; u32Gid < pstMap->u32TileInfoCount; u32Gid++)
+    {
+        pstMap->pstTileInfo[u32Gid].s8TypeId = -1;
+
+        if (pstTmxMap->tiles[u32Gid] && pstTmxMap->tiles[u32Gid]->type)
+        {
+            pstMap->pstTileInfo[u32Gid].s8TypeId =
+                _InternType(pstTmxMap->tiles[u32Gid]->type, pstMap);
+        }
+    }
+
+    // Rows are independent of each other.
+    Job_ParallelFor(pstMap->u32Rows, GRID_ROW_BATCH, _BakeTypeRows, pstMap, Job_GetDefaultPool());
+
+    return 0;
+}
+
+static Sint8 _PackAtlas(Map* pstMap)
+{
+    Uint16* pu16Order = NULL;
+    Sint16  s16Page   = -1;
+    Uint16  u16ShelfX = 0;
+    Uint16  u16ShelfY = 0;
+    Uint16  u16ShelfH = 0;
+
+    pu16Order = SDL_malloc(pstMap->u16TilesetCount * sizeof(Uint16));
+    if (!pu16Order)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InitMap(): error allocating memory.\n");
+        return -1;
+    }
+
+    // Sort tilesets by height, tallest first (insertion sort, few tilesets).
+    for (Uint16 u16Index = 0; u16Index < pstMap->u16TilesetCount; u16Index++)
+    {
+        Uint16 u16Pos = u16Index;
+
+        while (u16Pos > 0 && pstMap->pstTileset[pu16Order[u16Pos - 1]].u16Height <
+                                 pstMap->pstTileset[u16Index].u16Height)
+        {
+            pu16Order[u16Pos] = pu16Order[u16Pos - 1];
+            u16Pos--;
+        }
+        pu16Order[u16Pos] = u16Index;
+    }
+
+    // Simple shelf packer.
+    for (Uint16 u16Index = 0; u16Index < pstMap->u16TilesetCount; u16Index++)
+    {
+        MapTileset* pstTS       = &pstMap->pstTileset[pu16Order[u16Index]];
+        SDL_bool    bIsOversize = SDL_FALSE;
+
+        if (pstTS->u16Width > ATLAS_PAGE_LEN || pstTS->u16Height > ATLAS_PAGE_LEN)
+        {
+            bIsOversize = SDL_TRUE;
+        }
+
+        if (!bIsOversize && -1 != s16Page)
+        {
+            if (u16ShelfX + pstTS->u16Width > ATLAS_PAGE_LEN)
+            {
+                u16ShelfY += u16ShelfH;
+                u16ShelfX = 0;
+                u16ShelfH = 0;
+            }
+
+            if (u16ShelfY + pstTS->u16Height <= ATLAS_PAGE_LEN)
+            {
+                AtlasPage* pstPage = &pstMap->astAtlas[s16Page];
+
+                pstTS->u8Atlas = s16Page;
+                pstTS->u16PosX = u16ShelfX;
+                pstTS->u16PosY = u16ShelfY;
+                u16ShelfX += pstTS->u16Width;
+                u16ShelfH = SDL_max(u16ShelfH, pstTS->u16Height);
+                pstPage->u16Width  = SDL_max(pstPage->u16Width, u16ShelfX);
+                pstPage->u16Height = SDL_max(pstPage->u16Height, u16ShelfY + u16ShelfH);
+                continue;
+            }
+        }
+
+        // Open a new page.
+        if (pstMap->u8AtlasCount >= ATLAS_PAGES_MAX)
+        {
+            SDL_LogError(
+                SDL_LOG_CATEGORY_APPLICATION,
+                "InitMap(): tilesets exceed %d atlas pages.\n",
+                ATLAS_PAGES_MAX);
+            SDL_free(pu16Order);
+            return -1;
+        }
+
+        pstTS->u8Atlas = pstMap->u8AtlasCount;
+        pstTS->u16PosX = 0;
+        pstTS->u16PosY = 0;
+        pstMap->astAtlas[pstMap->u8AtlasCount].u16Width  = pstTS->u16Width;
+        pstMap->astAtlas[pstMap->u8AtlasCount].u16Height = pstTS->u16Height;
+
+        // Oversized tilesets get a page of their own.
+        if (!bIsOversize)
+        {
+            s16Page   = pstMap->u8AtlasCount;
+            u16ShelfX = pstTS->u16Width;
+            u16ShelfY = 0;
+            u16ShelfH = pstTS->u16Height;
+        }
+        pstMap->u8AtlasCount++;
+    }
+
+    SDL_free(pu16Order);
+
+    return 0;
+}
+
+static void _UpdateTileExtents(Map* pstMap)
+{
+    pstMap->u16MaxTileWidth  = pstMap->u16TileWidth;
+    pstMap->u16MaxTileHeight = pstMap->u16TileHeight;
+
+    // Diagonally flipped tiles swap width and height, so either may
+    // extend along both axes.
+    for (Uint32 u32Gid = 0; u32Gid < pstMap->u32TileInfoCount; u32Gid++)
+    {
+        TileInfo* pstInfo = &pstMap->pstTileInfo[u32Gid];
+        Uint16    u16Extent;
+
+        if (pstInfo->u8Flags & TILE_IS_VALID)
+        {
+            u16Extent                = SDL_max(pstInfo->u16Width, pstInfo->u16Height);
+            pstMap->u16MaxTileWidth  = SDL_max(pstMap->u16MaxTileWidth, u16Extent);
+            pstMap->u16MaxTileHeight = SDL_max(pstMap->u16MaxTileHeight, u16Extent);
+        }
+    }
+}
+
+static Sint8 _LoadTilesets(const char* pacFileName, const char* pacTilesetImage, Map* pstMap)
+{
+    tmx_map*      pstTmxMap    = pstMap->pstTmxMap;
+    tmx_tileset** ppstTmxTS    = NULL;
+    const char*   pacSeparator = NULL;
+    size_t        zDirLen      = 0;
+    Uint16        u16Tileset   = 0;
+
+    pstMap->u32TileInfoCount = pstTmxMap->tilecount;
+    pstMap->pstTileInfo      = SDL_calloc(pstTmxMap->tilecount, sizeof(struct TileInfo_t));
+    ppstTmxTS                = SDL_calloc(pstTmxMap->tilecount, sizeof(tmx_tileset*));
+    if (!pstMap->pstTileInfo || !ppstTmxTS)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InitMap(): error allocating memory.\n");
+        SDL_free(ppstTmxTS);
+        return -1;
+    }
+
+    // Collect tilesets in order of appearance and fill in the tile info.
+    for (Uint32 u32Gid = 0; u32Gid < pstTmxMap->tilecount; u32Gid++)
+    {
+        tmx_tile* pstTile = pstTmxMap->tiles[u32Gid];
+        TileInfo* pstInfo = &pstMap->pstTileInfo[u32Gid];
+
+        if (!pstTile || !pstTile->tileset->image)
+        {
+            continue;
+        }
+
+        if (0 == pstMap->u16TilesetCount || ppstTmxTS[u16Tileset] != pstTile->tileset)
+        {
+            for (u16Tileset = 0; u16Tileset < pstMap->u16TilesetCount; u16Tileset++)
+            {
+                if (ppstTmxTS[u16Tileset] == pstTile->tileset)
+                {
+                    break;
+                }
+            }
+
+            if (u16Tileset == pstMap->u16TilesetCount)
+            {
+                ppstTmxTS[u16Tileset] = pstTile->tileset;
+                pstMap->u16TilesetCount++;
+            }
+        }
+
+        pstInfo->u16SrcX    = pstTile->ul_x;
+        pstInfo->u16SrcY    = pstTile->ul_y;
+        pstInfo->u16Width   = pstTile->tileset->tile_width;
+        pstInfo->u16Height  = pstTile->tileset->tile_height;
+        pstInfo->u16Tileset = u16Tileset;
+        pstInfo->u8Flags    = TILE_IS_VALID;
+    }
+
+    if (0 == pstMap->u16TilesetCount)
+    {
+        SDL_free(ppstTmxTS);
+        return 0;
+    }
+
+    pstMap->pstTileset = SDL_calloc(pstMap->u16TilesetCount, sizeof(struct MapTileset_t));
+    if (!pstMap->pstTileset)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InitMap(): error allocating memory.\n");
+        SDL_free(ppstTmxTS);
+        return -1;
+    }
+
+    // Tileset image paths are relative to the map file.
+    pacSeparator = SDL_strrchr(pacFileName, '/');
+    if (pacSeparator)
+    {
+        zDirLen = pacSeparator - pacFileName + 1;
+    }
+
+    for (u16Tileset = 0; u16Tileset < pstMap->u16TilesetCount; u16Tileset++)
+    {
+        MapTileset* pstTS  = &pstMap->pstTileset[u16Tileset];
+        tmx_image*  pstImg = ppstTmxTS[u16Tileset]->image;
+
+        if (0 == u16Tileset && pacTilesetImage)
+        {
+            SDL_strlcpy(pstTS->acImage, pacTilesetImage, TS_IMG_PATH_LEN);
+        }
+        else
+        {
+            if ('/' != pstImg->source[0])
+            {
+                SDL_strlcpy(pstTS->acImage, pacFileName, SDL_min(zDirLen + 1, TS_IMG_PATH_LEN));
+            }
+            SDL_strlcat(pstTS->acImage, pstImg->source, TS_IMG_PATH_LEN);
+        }
+
+        pstTS->u16Width  = pstImg->width;
+        pstTS->u16Height = pstImg->height;
+    }
+
+    // Fall back to the tile extents if the image size is not known.
+    for (Uint32 u32Gid = 0; u32Gid < pstTmxMap->tilecount; u32Gid++)
+    {
+        TileInfo*   pstInfo = &pstMap->pstTileInfo[u32Gid];
+        MapTileset* pstTS   = &pstMap->pstTileset[pstInfo->u16Tileset];
+
+        if (pstInfo->u8Flags & TILE_IS_VALID)
+        {
+            pstTS->u16Width  = SDL_max(pstTS->u16Width, pstInfo->u16SrcX + pstInfo->u16Width);
+            pstTS->u16Height = SDL_max(pstTS->u16Height, pstInfo->u16SrcY + pstInfo->u16Height);
+        }
+    }
+
+    SDL_free(ppstTmxTS);
+
+    if (-1 == _PackAtlas(pstMap))
+    {
+        return -1;
+    }
+
+    // Translate source rectangles into atlas page coordinates.
+    for (Uint32 u32Gid = 0; u32Gid < pstTmxMap->tilecount; u32Gid++)
+    {
+        TileInfo*   pstInfo = &pstMap->pstTileInfo[u32Gid];
+        MapTileset* pstTS   = &pstMap->pstTileset[pstInfo->u16Tileset];
+
+        if (pstInfo->u8Flags & TILE_IS_VALID)
+        {
+            pstInfo->u16SrcX += pstTS->u16PosX;
+            pstInfo->u16SrcY += pstTS->u16PosY;
+            pstInfo->u8Atlas  = pstTS->u8Atlas;
+        }
+    }
+
+    SDL_Log(
+        "Pack %d tileset(s) into %d atlas page(s).\n",
+        pstMap->u16TilesetCount,
+        pstMap->u8AtlasCount);
+
+    return 0;
+}
+
+static void _FreeAtlasSurfaces(Map* pstMap)
+{
+    for (Uint8 u8Page = 0; u8Page < pstMap->u8AtlasCount; u8Page++)
+    {
+        if (pstMap->astAtlas[u8Page].pstSurface)
+        {
+            SDL_FreeSurface(pstMap->astAtlas[u8Page].pstSurface);
+            pstMap->astAtlas[u8Page].pstSurface = NULL;
+        }
+    }
+}
+
+static void _DecodeTilesets(const Uint32 u32First, const Uint32 u32Last, void* pData)
+{
+    TilesetDecode* pstDecode = pData;
+
+    for (Uint32 u32Index = u32First; u32Index < u32Last; u32Index++)
+    {
+        pstDecode->ppstImage[u32Index] =
+            Asset_LoadImage(pstDecode->pstTileset[u32Index].acImage, Asset_GetDefaultCache());
+    }
+}
+
+static Sint8 _ComposeAtlas(Map* pstMap)
+{
+    TilesetDecode stDecode;
+    Sint8         s8ReturnValue = 0;
+
+    stDecode.pstTileset = pstMap->pstTileset;
+    stDecode.ppstImage  = SDL_calloc(pstMap->u16TilesetCount, sizeof(SDL_Surface*));
+    if (!stDecode.ppstImage && pstMap->u16TilesetCount)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InitMap(): error allocating memory.\n");
+        return -1;
+    }
+
+    // Decoding dominates; the images are independent of each other.
+    Job_ParallelFor(pstMap->u16TilesetCount, 1, _DecodeTilesets, &stDecode, Job_GetDefaultPool());
+
+    for (Uint8 u8Page = 0; u8Page < pstMap->u8AtlasCount; u8Page++)
+    {
+        AtlasPage* pstPage = &pstMap->astAtlas[u8Page];
+
+        pstPage->pstSurface = SDL_CreateRGBSurfaceWithFormat(
+            0, pstPage->u16Width, pstPage->u16Height, 32, SDL_PIXELFORMAT_ARGB8888);
+
+        if (!pstPage->pstSurface)
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+            s8ReturnValue = -1;
+            goto exit;
+        }
+
+        for (Uint16 u16Tileset = 0; u16Tileset < pstMap->u16TilesetCount; u16Tileset++)
+        {
+            MapTileset*  pstTS    = &pstMap->pstTileset[u16Tileset];
+            SDL_Surface* pstImage = stDecode.ppstImage[u16Tileset];
+
+            if (u8Page != pstTS->u8Atlas)
+            {
+                continue;
+            }
+
+            if (!pstImage)
+            {
+                s8ReturnValue = -1;
+                goto exit;
+            }
+
+            // The image is shared through the asset cache and may be
+            // in use by other threads, so it is only read.
+            if (0 != Utils_CopySurfaceArea(
+                         pstImage, NULL, pstTS->u16PosX, pstTS->u16PosY, pstPage->pstSurface))
+            {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+                s8ReturnValue = -1;
+                goto exit;
+            }
+
+            SDL_Log("Load tileset image file: %s.\n", pstTS->acImage);
+        }
+    }
+
+exit:
+    for (Uint16 u16Tileset = 0; u16Tileset < pstMap->u16TilesetCount; u16Tileset++)
+    {
+        Asset_Release(ASSET_IMAGE, stDecode.ppstImage[u16Tileset], Asset_GetDefaultCache());
+    }
+    SDL_free(stDecode.ppstImage);
+
+    if (-1 == s8ReturnValue)
+    {
+        _FreeAtlasSurfaces(pstMap);
+    }
+
+    return s8ReturnValue;
+}
+
+static Sint8 _UploadAtlas(Map* pstMap, SDL_Renderer* pstRenderer)
+{
+    // Maps loaded synchronously compose the atlas on first use.
+    if (pstMap->u8AtlasCount > 0 && !pstMap->astAtlas[0].pstSurface)
+    {
+        if (-1 == _ComposeAtlas(pstMap))
+        {
+            return -1;
+        }
+    }
+
+    for (Uint8 u8Page = 0; u8Page < pstMap->u8AtlasCount; u8Page++)
+    {
+        AtlasPage* pstPage = &pstMap->astAtlas[u8Page];
+
+        pstPage->pstTexture = SDL_CreateTextureFromSurface(pstRenderer, pstPage->pstSurface);
+        if (!pstPage->pstTexture)
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+            return -1;
+        }
+
+        if (0 != SDL_SetTextureBlendMode(pstPage->pstTexture, SDL_BLENDMODE_BLEND))
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+            return -1;
+        }
+    }
+
+    _FreeAtlasSurfaces(pstMap);
+
+    return 0;
+}
+
+static Sint8 _LoadAnimTiles(Map* pstMap)
+{
+    tmx_map* pstTmxMap = pstMap->pstTmxMap;
+    Uint32   u32Index  = 0;
+    Uint32   u32Frame  = 0;
+
+    for (Uint32 u32Gid = 0; u32Gid < pstTmxMap->tilecount; u32Gid++)
+    {
+        if (pstTmxMap->tiles[u32Gid] && pstTmxMap->tiles[u32Gid]->animation_len > 0)
+        {
+            pstMap->u32AnimTileCount++;
+            pstMap->u32AnimFrameCount += pstTmxMap->tiles[u32Gid]->animation_len;
+        }
+    }
+
+    if (0 == pstMap->u32AnimTileCount)
+    {
+        return 0;
+    }
+
+    pstMap->pstAnimTile  = SDL_calloc(pstMap->u32AnimTileCount, sizeof(struct AnimTile_t));
+    pstMap->pstAnimFrame = SDL_calloc(pstMap->u32AnimFrameCount, sizeof(struct AnimFrame_t));
+    if (!pstMap->pstAnimTile || !pstMap->pstAnimFrame)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InitMap(): error allocating memory.\n");
+        return -1;
+    }
+
+    for (Uint32 u32Gid = 0; u32Gid < pstTmxMap->tilecount; u32Gid++)
+    {
+        tmx_tile* pstTile = pstTmxMap->tiles[u32Gid];
+        Uint32    u32FirstGid;
+
+        if (!pstTile || 0 == pstTile->animation_len)
+        {
+            continue;
+        }
+
+        // Frame tile IDs are local to the tileset of the animated tile.
+        u32FirstGid = u32Gid - pstTile->id;
+
+        pstMap->pstAnimTile[u32Index].u32Gid        = u32Gid;
+        pstMap->pstAnimTile[u32Index].u32FirstFrame = u32Frame;
+        pstMap->pstAnimTile[u32Index].u16FrameCount = pstTile->animation_len;
+
+        for (Uint32 u32Step = 0; u32Step < pstTile->animation_len; u32Step++)
+        {
+            AnimFrame* pstFrame = &pstMap->pstAnimFrame[u32Frame];
+
+            pstFrame->u32Gid      = u32FirstGid + pstTile->animation[u32Step].tile_id;
+            pstFrame->u32Duration = pstTile->animation[u32Step].duration;
+            u32Frame++;
+        }
+
+        u32Index++;
+        pstMap->pstTileInfo[u32Gid].u32AnimIndex = u32Index;
+        pstMap->pstTileInfo[u32Gid].u8Flags |= TILE_IS_ANIMATED;
+    }
+
+    return 0;
+}
+
+static SDL_bool _IsSolidSpan(
+    const Sint32   s32Cell,
+    const Sint32   s32First,
+    const Sint32   s32Last,
+    const SDL_bool bIsColumn,
+    const Uint32   u32SolidMask,
+    const Map*     pstMap)
+{
+    for (Sint32 s32Index = s32First; s32Index <= s32Last; s32Index++)
+    {
+        Uint32 u32Cell;
+
+        if (bIsColumn)
+        {
+            u32Cell = ((Uint32)s32Index * pstMap->u32Columns) + (Uint32)s32Cell;
+        }
+        else
+        {
+            u32Cell = ((Uint32)s32Cell * pstMap->u32Columns) + (Uint32)s32Index;
+        }
+
+        if (pstMap->pu32TypeGrid[u32Cell] & u32SolidMask)
+        {
+            return SDL_TRUE;
+        }
+    }
+
+    return SDL_FALSE;
+}
+
+static double _SweepAxis(
+    const double   dMin,
+    const double   dMax,
+    const double   dDelta,
+    const double   dSpanMin,
+    const double   dSpanMax,
+    const SDL_bool bAlongX,
+    const Uint32   u32SolidMask,
+    const Map*     pstMap,
+    Sint8*         ps8Normal)
+{
+    double dTileSize = bAlongX ? pstMap->u16TileWidth : pstMap->u16TileHeight;
+    double dSpanSize = bAlongX ? pstMap->u16TileHeight : pstMap->u16TileWidth;
+    Sint32 s32Cells  = (Sint32)(bAlongX ? pstMap->u32Columns : pstMap->u32Rows);
+    Sint32 s32Span   = (Sint32)(bAlongX ? pstMap->u32Rows : pstMap->u32Columns);
+    Sint32 s32First  = (Sint32)SDL_floor(dSpanMin / dSpanSize);
+    Sint32 s32Last   = (Sint32)SDL_floor((dSpanMax - SWEEP_EPSILON) / dSpanSize);
+    Sint32 s32From;
+    Sint32 s32To;
+
+    // Cells outside the map are never solid.
+    s32First = SDL_max(s32First, 0);
+    s32Last  = SDL_min(s32Last, s32Span - 1);
+    if (0 == dDelta || s32First > s32Last)
+    {
+        return dDelta;
+    }
+
+    // Visit every cell the leading edge enters, in order, so fast
+    // boxes cannot tunnel through thin walls.
+    if (dDelta > 0)
+    {
+        s32From = (Sint32)SDL_floor((dMax - SWEEP_EPSILON) / dTileSize) + 1;
+        s32To   = (Sint32)SDL_floor((dMax + dDelta - SWEEP_EPSILON) / dTileSize);
+        s32From = SDL_max(s32From, 0);
+        s32To   = SDL_min(s32To, s32Cells - 1);
+
+        for (Sint32 s32Cell = s32From; s32Cell <= s32To; s32Cell++)
+        {
+            if (_IsSolidSpan(s32Cell, s32First, s32Last, bAlongX, u32SolidMask, pstMap))
+            {
+                *ps8Normal = -1;
+                return SDL_max(s32Cell * dTileSize - dMax, 0);
+            }
+        }
+    }
+    else
+    {
+        s32From = (Sint32)SDL_floor(dMin / dTileSize) - 1;
+        s32To   = (Sint32)SDL_floor((dMin + dDelta) / dTileSize);
+        s32From = SDL_min(s32From, s32Cells - 1);
+        s32To   = SDL_max(s32To, 0);
+
+        for (Sint32 s32Cell = s32From; s32Cell >= s32To; s32Cell--)
+        {
+            if (_IsSolidSpan(s32Cell, s32First, s32Last, bAlongX, u32SolidMask, pstMap))
+            {
+                *ps8Normal = 1;
+                return SDL_min((s32Cell + 1) * dTileSize - dMin, 0);
+            }
+        }
+    }
+
+    return dDelta;
+}
+
+static Sint8 _PushAxis(
+    const double   dMin,
+    const double   dMax,
+    const Sint8    s8Direction,
+    const double   dSpanMin,
+    const double   dSpanMax,
+    const SDL_bool bAlongX,
+    const Uint32   u32SolidMask,
+    const Map*     pstMap,
+    double*        pdShift)
+{
+    double dTileSize = bAlongX ? pstMap->u16TileWidth : pstMap->u16TileHeight;
+    double dSpanSize = bAlongX ? pstMap->u16TileHeight : pstMap->u16TileWidth;
+    Sint32 s32Cells  = (Sint32)(bAlongX ? pstMap->u32Columns : pstMap->u32Rows);
+    Sint32 s32Span   = (Sint32)(bAlongX ? pstMap->u32Rows : pstMap->u32Columns);
+    Sint32 s32First  = (Sint32)SDL_floor(dSpanMin / dSpanSize);
+    Sint32 s32Last   = (Sint32)SDL_floor((dSpanMax - SWEEP_EPSILON) / dSpanSize);
+
+    *pdShift = 0;
+
+    s32First = SDL_max(s32First, 0);
+    s32Last  = SDL_min(s32Last, s32Span - 1);
+    if (s32First > s32Last)
+    {
+        return 0;
+    }
+
+    // Move the box past the solid cell it overlaps furthest in the
+    // push direction until it overlaps none.
+    for (Uint8 u8Step = 0; u8Step < SWEEP_PUSH_CELLS; u8Step++)
+    {
+        Sint32   s32From = (Sint32)SDL_floor((dMin + *pdShift + SWEEP_EPSILON) / dTileSize);
+        Sint32   s32To   = (Sint32)SDL_floor((dMax + *pdShift - SWEEP_EPSILON) / dTileSize);
+        Sint32   s32Hit  = 0;
+        SDL_bool bIsHit  = SDL_FALSE;
+
+        s32From = SDL_max(s32From, 0);
+        s32To   = SDL_min(s32To, s32Cells - 1);
+
+        for (Sint32 s32Cell = s32From; s32Cell <= s32To; s32Cell++)
+        {
+            if (_IsSolidSpan(s32Cell, s32First, s32Last, bAlongX, u32SolidMask, pstMap))
+            {
+                s32Hit = s32Cell;
+                bIsHit = SDL_TRUE;
+
+                if (s8Direction < 0)
+                {
+                    break;
+                }
+            }
+        }
+
+        if (!bIsHit)
+        {
+            return 0;
+        }
+
+        if (s8Direction < 0)
+        {
+            *pdShift = s32Hit * dTileSize - dMax;
+        }
+        else
+        {
+            *pdShift = (s32Hit + 1) * dTileSize - dMin;
+        }
+    }
+
+    return -1;
+}
+
+static void _PushOut(
+    const double dLeft,
+    const double dRight,
+    const double dTop,
+    const double dBottom,
+    const Uint32 u32SolidMask,
+    const Map*   pstMap,
+    TileContact* pstContact)
+{
+    double dBest = 0;
+
+    pstContact->dDeltaX = 0;
+    pstContact->dDeltaY = 0;
+
+    // Left, right, up and down.
+    for (Uint8 u8Push = 0; u8Push < 4; u8Push++)
+    {
+        SDL_bool bAlongX     = u8Push < 2 ? SDL_TRUE : SDL_FALSE;
+        Sint8    s8Direction = (u8Push & 1) ? 1 : -1;
+        double   dShift;
+
+        if (-1 == _PushAxis(
+                bAlongX ? dLeft : dTop,
+                bAlongX ? dRight : dBottom,
+                s8Direction,
+                bAlongX ? dTop : dLeft,
+                bAlongX ? dBottom : dRight,
+                bAlongX,
+                u32SolidMask,
+                pstMap,
+                &dShift))
+        {
+            continue;
+        }
+
+        // The box does not overlap any solid tile.
+        if (0 == dShift)
+        {
+            return;
+        }
+
+        if (0 == dBest || SDL_fabs(dShift) < SDL_fabs(dBest))
+        {
+            dBest                 = dShift;
+            pstContact->dDeltaX   = bAlongX ? dShift : 0;
+            pstContact->dDeltaY   = bAlongX ? 0 : dShift;
+            pstContact->s8NormalX = bAlongX ? s8Direction : 0;
+            pstContact->s8NormalY = bAlongX ? 0 : s8Direction;
+        }
+    }
+}
+
+static Uint32 _GetPropertyOwner(const PropertyOwner eOwner, const Uint32 u32Index)
+{
+    return ((Uint32)eOwner << 30) | (u32Index & 0x3fffffff);
+}
+
+static MapProperty* _FindProperty(
+    const Uint32         u32Owner,
+    const MapPropertyKey stKey,
+    const Map*           pstMap)
+{
+    Uint32 u32Mask = pstMap->u32PropertySize - 1;
+    Uint32 u32Slot = (stKey.u32Hash ^ (u32Owner * 2654435761u)) & u32Mask;
+
+    // The table is at most half full, so probing ends at a free slot.
+    // Names are only compared once the hash matches.
+    while (PROPERTY_NONE != pstMap->pstProperty[u32Slot].u8Type)
+    {
+        MapProperty* pstProperty = &pstMap->pstProperty[u32Slot];
+
+        if (u32Owner == pstProperty->u32Owner && stKey.u32Hash == pstProperty->u32NameHash &&
+            0 == SDL_strcmp(stKey.pacName, &pstMap->pacPropertyPool[pstProperty->u32Name]))
+        {
+            return pstProperty;
+        }
+        u32Slot = (u32Slot + 1) & u32Mask;
+    }
+
+    return &pstMap->pstProperty[u32Slot];
+}
+
+static void _CountProperty(tmx_property* pstTmxProperty, void* pData)
+{
+    PropertyBuilder* pstBuilder = pData;
+
+    switch (pstTmxProperty->type)
+    {
+        case PT_NONE:
+            return;
+        case PT_STRING:
+        case PT_FILE:
+            if (pstTmxProperty->value.string)
+            {
+                pstBuilder->u32PoolSize += SDL_strlen(pstTmxProperty->value.string) + 1;
+            }
+            break;
+        default:
+            break;
+    }
+
+    pstBuilder->u32PoolSize += SDL_strlen(pstTmxProperty->name) + 1;
+    pstBuilder->u32Count++;
+}
+
+static void _AddProperty(tmx_property* pstTmxProperty, void* pData)
+{
+    PropertyBuilder* pstBuilder = pData;
+    Map*             pstMap     = pstBuilder->pstMap;
+    MapPropertyKey   stKey      = Map_GetPropertyKey(pstTmxProperty->name);
+    MapProperty*     pstProperty;
+    size_t           zLength;
+
+    if (PT_NONE == pstTmxProperty->type)
+    {
+        return;
+    }
+
+    pstProperty = _FindProperty(pstBuilder->u32Owner, stKey, pstMap);
+    if (PROPERTY_NONE != pstProperty->u8Type)
+    {
+        SDL_LogWarn(
+            SDL_LOG_CATEGORY_APPLICATION,
+            "InitMap(): property %s is defined twice for its owner.\n",
+            pstTmxProperty->name);
+        return;
+    }
+
+    zLength = SDL_strlen(pstTmxProperty->name) + 1;
+    SDL_memcpy(
+        &pstMap->pacPropertyPool[pstMap->u32PropertyPoolSize], pstTmxProperty->name, zLength);
+
+    pstProperty->u32NameHash = stKey.u32Hash;
+    pstProperty->u32Name     = pstMap->u32PropertyPoolSize;
+    pstProperty->u32Owner    = pstBuilder->u32Owner;
+    pstProperty->u32String   = 0;
+    pstProperty->dValue      = 0.f;
+    pstMap->u32PropertyPoolSize += zLength;
+
+    switch (pstTmxProperty->type)
+    {
+        case PT_INT:
+            pstProperty->u8Type = PROPERTY_INT;
+            pstProperty->dValue = pstTmxProperty->value.integer;
+            break;
+        case PT_FLOAT:
+            pstProperty->u8Type = PROPERTY_FLOAT;
+            pstProperty->dValue = pstTmxProperty->value.decimal;
+            break;
+        case PT_BOOL:
+            pstProperty->u8Type = PROPERTY_BOOL;
+            pstProperty->dValue = pstTmxProperty->value.boolean ? 1.f : 0.f;
+            break;
+        case PT_COLOR:
+            pstProperty->u8Type = PROPERTY_COLOUR;
+            pstProperty->dValue = pstTmxProperty->value.color;
+            break;
+        default:
+            pstProperty->u8Type = (PT_FILE == pstTmxProperty->type) ? PROPERTY_FILE
+                                                                     : PROPERTY_STRING;
+            if (pstTmxProperty->value.string && pstTmxProperty->value.string[0])
+            {
+                zLength                = SDL_strlen(pstTmxProperty->value.string) + 1;
+                pstProperty->u32String = pstMap->u32PropertyPoolSize;
+                SDL_memcpy(
+                    &pstMap->pacPropertyPool[pstMap->u32PropertyPoolSize],
+                    pstTmxProperty->value.string,
+                    zLength);
+                pstMap->u32PropertyPoolSize += zLength;
+            }
+            break;
+    }
+}
+
+static void _VisitProperties(tmx_property_functor pCallback, PropertyBuilder* pstBuilder)
+{
+    tmx_map* pstTmxMap = pstBuilder->pstMap->pstTmxMap;
+    Uint32   u32Layer  = 0;
+    Uint32   u32Object = 0;
+
+    if (pstTmxMap->properties)
+    {
+        pstBuilder->u32Owner = _GetPropertyOwner(PROPERTY_OF_MAP, 0);
+        tmx_property_foreach(pstTmxMap->properties, pCallback, pstBuilder);
+    }
+
+    // Layers and objects are numbered in the order _LoadLayers() and
+    // _LoadObjects() store them.
+    for (tmx_layer* pstLayer = pstTmxMap->ly_head; pstLayer; pstLayer = pstLayer->next)
+    {
+        if (L_LAYER == pstLayer->type)
+        {
+            if (pstLayer->properties)
+            {
+                pstBuilder->u32Owner = _GetPropertyOwner(PROPERTY_OF_LAYER, u32Layer);
+                tmx_property_foreach(pstLayer->properties, pCallback, pstBuilder);
+            }
+            u32Layer++;
+        }
+        else if (L_OBJGR == pstLayer->type)
+        {
+            for (tmx_object* pstTmxObject = pstLayer->content.objgr->head; pstTmxObject;
+                 pstTmxObject             = pstTmxObject->next)
+            {
+                if (pstTmxObject->properties)
+                {
+                    pstBuilder->u32Owner = _GetPropertyOwner(PROPERTY_OF_OBJECT, u32Object);
+                    tmx_property_foreach(pstTmxObject->properties, pCallback, pstBuilder);
+                }
+                u32Object++;
+            }
+        }
+    }
+
+    for (Uint32 u32Gid = 0; u32Gid < pstTmxMap->tilecount; u32Gid++)
+    {
+        if (pstTmxMap->tiles[u32Gid] && pstTmxMap->tiles[u32Gid]->properties)
+        {
+            pstBuilder->u32Owner = _GetPropertyOwner(PROPERTY_OF_TILE, u32Gid);
+            tmx_property_foreach(pstTmxMap->tiles[u32Gid]->properties, pCallback, pstBuilder);
+        }
+    }
+}
+
+static Sint8 _LoadProperties(Map* pstMap)
+{
+    PropertyBuilder stBuilder = { pstMap, 0, 0, 1 };
+    Uint32          u32Size   = 2;
+
+    _VisitProperties(_CountProperty, &stBuilder);
+    if (0 == stBuilder.u32Count)
+    {
+        return 0;
+    }
+
+    // Keep the load factor at or below one half.
+    while (u32Size < stBuilder.u32Count * 2)
+    {
+        u32Size <<= 1;
+    }
+
+    pstMap->pstProperty     = SDL_calloc(u32Size, sizeof(struct MapProperty_t));
+    pstMap->pacPropertyPool = SDL_malloc(stBuilder.u32PoolSize);
+    if (!pstMap->pstProperty || !pstMap->pacPropertyPool)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InitMap(): error allocating memory.\n");
+        return -1;
+    }
+
+    // Handle 0 is reserved for the empty string.
+    pstMap->u32PropertySize     = u32Size;
+    pstMap->pacPropertyPool[0]  = '\0';
+    pstMap->u32PropertyPoolSize = 1;
+
+    _VisitProperties(_AddProperty, &stBuilder);
+
+    return 0;
+}
+
+static SDL_bool _IsAnimated(const Uint32 u32Gid, const Map* pstMap)
+{
+    if (u32Gid < pstMap->u32TileInfoCount &&
+        (pstMap->pstTileInfo[u32Gid].u8Flags & TILE_IS_ANIMATED))
+    {
+        return SDL_TRUE;
+    }
+
+    return SDL_FALSE;
+}
+
+static int _RenderTile(
+    const Uint32    u32Gid,
+    const TileInfo* pstInfo,
+    const Sint32    s32PosX,
+    const Sint32    s32PosY,
+    const Map*      pstMap,
+    SDL_Renderer*   pstRenderer)
+{
+    SDL_Texture*     pstTexture = pstMap->astAtlas[pstInfo->u8Atlas].pstTexture;
+    SDL_RendererFlip eFlip      = SDL_FLIP_NONE;
+    double           dAngle     = 0.f;
+    SDL_Rect         stSrc;
+    SDL_Rect         stDst;
+
+    // Tiles are anchored at the bottom-left corner of their cell.
+    stSrc.x = pstInfo->u16SrcX;
+    stSrc.y = pstInfo->u16SrcY;
+    stSrc.w = stDst.w = pstInfo->u16Width;
+    stSrc.h = stDst.h = pstInfo->u16Height;
+    stDst.x = s32PosX;
+    stDst.y = s32PosY - pstInfo->u16Height;
+
+    if (u32Gid == _ClearGidFlags(u32Gid))
+    {
+        return SDL_RenderCopy(pstRenderer, pstTexture, &stSrc, &stDst);
+    }
+
+    if (u32Gid & TMX_FLIPPED_DIAGONALLY)
+    {
+        // SDL flips before rotating around the centre of the target
+        // rectangle, which is moved so the rotated tile keeps its anchor.
+        switch (u32Gid & (TMX_FLIPPED_HORIZONTALLY | TMX_FLIPPED_VERTICALLY))
+        {
+            case 0:
+                dAngle = 90.f;
+                eFlip  = SDL_FLIP_VERTICAL;
+                break;
+            case TMX_FLIPPED_HORIZONTALLY:
+                dAngle = 90.f;
+                break;
+            case TMX_FLIPPED_VERTICALLY:
+                dAngle = 270.f;
+                break;
+            default:
+                dAngle = 90.f;
+                eFlip  = SDL_FLIP_HORIZONTAL;
+                break;
+        }
+
+        stDst.x = s32PosX + ((pstInfo->u16Height - pstInfo->u16Width) / 2);
+        stDst.y = s32PosY - ((pstInfo->u16Width + pstInfo->u16Height) / 2);
+    }
+    else if (u32Gid & TMX_FLIPPED_HORIZONTALLY && u32Gid & TMX_FLIPPED_VERTICALLY)
+    {
+        eFlip = (SDL_RendererFlip)(SDL_FLIP_HORIZONTAL | SDL_FLIP_VERTICAL);
+    }
+    else if (u32Gid & TMX_FLIPPED_HORIZONTALLY)
+    {
+        eFlip = SDL_FLIP_HORIZONTAL;
+    }
+    else if (u32Gid & TMX_FLIPPED_VERTICALLY)
+    {
+        eFlip = SDL_FLIP_VERTICAL;
+    }
+
+    return SDL_RenderCopyEx(pstRenderer, pstTexture, &stSrc, &stDst, dAngle, NULL, eFlip);
+}
+
+static void _RenderTiles(
+    const SDL_bool bSkipAnimTiles,
+    const char*    pacLayerName,
+    const Sint32   s32CellX,
+    const Sint32   s32CellY,
+    const Sint32   s32CellW,
+    const Sint32   s32CellH,
+    const Sint32   s32OriginX,
+    const Sint32   s32OriginY,
+    Map*           pstMap,
+    SDL_Renderer*  pstRenderer)
+{
+    Uint32 u32LastX = s32CellX + s32CellW - 1;
+
+    if (s32CellW <= 0 || s32CellH <= 0)
+    {
+        return;
+    }
+
+    for (Uint16 u16Layer = 0; u16Layer < pstMap->u16LayerCount; u16Layer++)
+    {
+        MapLayer* pstLayer = &pstMap->pstLayer[u16Layer];
+
+        if (!pstLayer->bIsVisible ||
+            (pacLayerName && !SDL_strstr(pstLayer->acName, pacLayerName)))
+        {
+            continue;
+        }
+
+        // Only the runs overlapping the cell range are visited.
+        for (Sint32 s32IndexH = s32CellY; s32IndexH < s32CellY + s32CellH; s32IndexH++)
+        {
+            Uint32 u32End = pstLayer->pu32RowStart[s32IndexH + 1];
+            Sint32 s32PosY = (s32IndexH - s32OriginY + 1) * pstMap->u16TileHeight;
+
+            for (Uint32 u32Run = _FindRun(s32CellX, s32IndexH, pstLayer);
+                 u32Run < u32End && pstLayer->pstRun[u32Run].u32Column <= u32LastX;
+                 u32Run++)
+            {
+                const MapRun* pstRun  = &pstLayer->pstRun[u32Run];
+                const Uint32* pu32Gid = &pstLayer->pu32Gid[pstRun->u32Offset];
+                Uint32        u32Last = pstRun->u32Column + pstRun->u32Length - 1;
+                Uint32        u32IndexW;
+
+                u32IndexW = SDL_max(pstRun->u32Column, (Uint32)s32CellX);
+                u32Last   = SDL_min(u32Last, u32LastX);
+
+                for (; u32IndexW <= u32Last; u32IndexW++)
+                {
+                    Uint32    u32Gid = pu32Gid[u32IndexW - pstRun->u32Column];
+                    TileInfo* pstInfo;
+
+                    if (_ClearGidFlags(u32Gid) >= pstMap->u32TileInfoCount)
+                    {
+                        continue;
+                    }
+
+                    pstInfo = &pstMap->pstTileInfo[_ClearGidFlags(u32Gid)];
+
+                    // Animated tiles are drawn separately by _DrawAnimTiles().
+                    if (!(pstInfo->u8Flags & TILE_IS_VALID) ||
+                        (bSkipAnimTiles && (pstInfo->u8Flags & TILE_IS_ANIMATED)))
+                    {
+                        continue;
+                    }
+
+                    _RenderTile(
+                        u32Gid,
+                        pstInfo,
+                        (u32IndexW - s32OriginX) * pstMap->u16TileWidth,
+                        s32PosY,
+                        pstMap,
+                        pstRenderer);
+                }
+            }
+        }
+    }
+}
+
+static void _GetTileOverlap(const Map* pstMap, Sint32* ps32CellsX, Sint32* ps32CellsY)
+{
+    // Tiles larger than the map grid are anchored at the bottom-left
+    // corner of their cell and reach into the cells right and above.
+    *ps32CellsX = (pstMap->u16MaxTileWidth + pstMap->u16TileWidth - 1) / pstMap->u16TileWidth - 1;
+    *ps32CellsY =
+        (pstMap->u16MaxTileHeight + pstMap->u16TileHeight - 1) / pstMap->u16TileHeight - 1;
+}
+
+static void _RedrawRect(
+    const SDL_Rect* pstRect,
+    const Sint32    s32OriginX,
+    const Sint32    s32OriginY,
+    const SDL_bool  bSkipAnimTiles,
+    const SDL_bool  bRenderBgColour,
+    const char*     pacLayerName,
+    Map*            pstMap,
+    SDL_Renderer*   pstRenderer)
+{
+    SDL_Rect      stClip    = *pstRect;
+    SDL_BlendMode eBlendMode;
+    Uint8         u8BgAlpha = 0;
+    Sint32        s32OverlapX;
+    Sint32        s32OverlapY;
+    Sint32        s32FirstX;
+    Sint32        s32FirstY;
+    Sint32        s32LastX;
+    Sint32        s32LastY;
+
+    stClip.x -= s32OriginX * pstMap->u16TileWidth;
+    stClip.y -= s32OriginY * pstMap->u16TileHeight;
+
+    if (bRenderBgColour)
+    {
+        u8BgAlpha = 255;
+    }
+
+    // Determine all cells whose tiles may reach into the rectangle.
+    _GetTileOverlap(pstMap, &s32OverlapX, &s32OverlapY);
+
+    s32FirstX = pstRect->x / pstMap->u16TileWidth - s32OverlapX;
+    s32FirstY = pstRect->y / pstMap->u16TileHeight;
+    s32LastX  = (pstRect->x + pstRect->w - 1) / pstMap->u16TileWidth;
+    s32LastY  = (pstRect->y + pstRect->h - 1) / pstMap->u16TileHeight + s32OverlapY;
+
+    s32FirstX = SDL_max(s32FirstX, 0);
+    s32FirstY = SDL_max(s32FirstY, 0);
+    s32LastX  = SDL_min(s32LastX, (Sint32)pstMap->u32Columns - 1);
+    s32LastY  = SDL_min(s32LastY, (Sint32)pstMap->u32Rows - 1);
+
+    SDL_RenderSetClipRect(pstRenderer, &stClip);
+
+    SDL_GetRenderDrawBlendMode(pstRenderer, &eBlendMode);
+    SDL_SetRenderDrawBlendMode(pstRenderer, SDL_BLENDMODE_NONE);
+    SDL_SetRenderDrawColor(
+        pstRenderer,
+        (pstMap->u32BgColour >> 16) & 0xFF,
+        (pstMap->u32BgColour >> 8) & 0xFF,
+        (pstMap->u32BgColour) & 0xFF,
+        u8BgAlpha);
+    SDL_RenderFillRect(pstRenderer, &stClip);
+    SDL_SetRenderDrawBlendMode(pstRenderer, eBlendMode);
+
+    _RenderTiles(
+        bSkipAnimTiles,
+        pacLayerName,
+        s32FirstX,
+        s32FirstY,
+        s32LastX - s32FirstX + 1,
+        s32LastY - s32FirstY + 1,
+        s32OriginX,
+        s32OriginY,
+        pstMap,
+        pstRenderer);
+
+    SDL_RenderSetClipRect(pstRenderer, NULL);
+}
+
+static Sint8 _PatchTexture(
+    const Uint16   u16Index,
+    const SDL_bool bSkipAnimTiles,
+    const SDL_bool bRenderBgColour,
+    const char*    pacLayerName,
+    Map*           pstMap,
+    SDL_Renderer*  pstRenderer)
+{
+    Uint8  u8Bit   = 1 << u16Index;
+    Uint32 u32Kept = 0;
+
+    if (0 != SDL_SetRenderTarget(pstRenderer, pstMap->pstTexture[u16Index]))
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+        return -1;
+    }
+
+    // Redraw pending areas and drop those patched in all textures.
+    for (Uint32 u32Index = 0; u32Index < pstMap->u32DirtyCount; u32Index++)
+    {
+        MapDirtyRect stDirty = pstMap->pstDirty[u32Index];
+
+        if (stDirty.u8Pending & u8Bit)
+        {
+            _RedrawRect(
+                &stDirty.stRect,
+                0,
+                0,
+                bSkipAnimTiles,
+                bRenderBgColour,
+                pacLayerName,
+                pstMap,
+                pstRenderer);
+
+            stDirty.u8Pending &= ~u8Bit;
+        }
+
+        if (stDirty.u8Pending)
+        {
+            pstMap->pstDirty[u32Kept] = stDirty;
+            u32Kept++;
+        }
+    }
+    pstMap->u32DirtyCount = u32Kept;
+
+    if (0 != SDL_SetRenderTarget(pstRenderer, NULL))
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+        return -1;
+    }
+
+    return 0;
+}
+
+static void _UpdateAnimTiles(const double dDeltaTime, Map* pstMap)
+{
+    double dDefaultDuration = 1000.f / pstMap->dAnimSpeed;
+
+    for (Uint32 u32Index = 0; u32Index < pstMap->u32AnimTileCount; u32Index++)
+    {
+        AnimTile* pstAnimTile = &pstMap->pstAnimTile[u32Index];
+
+        pstAnimTile->dFrameTime += dDeltaTime * 1000.f;
+
+        // Advance as many frames as have elapsed; frames without a
+        // duration fall back to the map's animation speed.
+        while (1)
+        {
+            AnimFrame* pstFrame =
+                &pstMap->pstAnimFrame[pstAnimTile->u32FirstFrame + pstAnimTile->u16Frame];
+            double     dDuration = pstFrame->u32Duration;
+
+            if (0 == pstFrame->u32Duration)
+            {
+                dDuration = dDefaultDuration;
+            }
+
+            if (pstAnimTile->dFrameTime < dDuration || dDuration <= 0.f)
+            {
+                break;
+            }
+
+            pstAnimTile->dFrameTime -= dDuration;
+            pstAnimTile->u16Frame++;
+            if (pstAnimTile->u16Frame >= pstAnimTile->u16FrameCount)
+            {
+                pstAnimTile->u16Frame = 0;
+            }
+        }
+    }
+}
+
+static Sint8 _DrawAnimTiles(
+    const char*   pacLayerName,
+    const double  dCameraPosX,
+    const double  dCameraPosY,
+    Map*          pstMap,
+    SDL_Renderer* pstRenderer)
+{
+    double dRenderPosX   = pstMap->dPosX - dCameraPosX;
+    double dRenderPosY   = pstMap->dPosY - dCameraPosY;
+    Sint32 s32ViewWidth  = 0;
+    Sint32 s32ViewHeight = 0;
+    Sint32 s32FirstX;
+    Sint32 s32FirstY;
+    Sint32 s32LastX;
+    Sint32 s32LastY;
+
+    if (0 == pstMap->u32AnimTileCount)
+    {
+        return 0;
+    }
+
+    if (-1 == Utils_GetViewSize(pstRenderer, &s32ViewWidth, &s32ViewHeight))
+    {
+        return -1;
+    }
+
+    // Determine the range of cells visible to the camera.
+    s32FirstX = SDL_floor(-dRenderPosX / pstMap->u16TileWidth);
+    s32FirstY = SDL_floor(-dRenderPosY / pstMap->u16TileHeight);
+    s32LastX  = SDL_floor((-dRenderPosX + s32ViewWidth - 1) / pstMap->u16TileWidth);
+    s32LastY  = SDL_floor((-dRenderPosY + s32ViewHeight - 1) / pstMap->u16TileHeight);
+
+    s32FirstX = SDL_max(s32FirstX, 0);
+    s32FirstY = SDL_max(s32FirstY, 0);
+    s32LastX  = SDL_min(s32LastX, (Sint32)pstMap->u32Columns - 1);
+    s32LastY  = SDL_min(s32LastY, (Sint32)pstMap->u32Rows - 1);
+
+    if (s32FirstX > s32LastX)
+    {
+        return 0;
+    }
+
+    for (Uint16 u16Layer = 0; u16Layer < pstMap->u16LayerCount; u16Layer++)
+    {
+        MapLayer* pstLayer = &pstMap->pstLayer[u16Layer];
+
+        if (!pstLayer->bIsVisible ||
+            (pacLayerName && !SDL_strstr(pstLayer->acName, pacLayerName)))
+        {
+            continue;
+        }
+
+        for (Sint32 s32IndexH = s32FirstY; s32IndexH <= s32LastY; s32IndexH++)
+        {
+            Uint32 u32End = pstLayer->pu32RowStart[s32IndexH + 1];
+
+            for (Uint32 u32Run = _FindRun(s32FirstX, s32IndexH, pstLayer);
+                 u32Run < u32End && pstLayer->pstRun[u32Run].u32Column <= (Uint32)s32LastX;
+                 u32Run++)
+            {
+                const MapRun* pstRun  = &pstLayer->pstRun[u32Run];
+                const Uint32* pu32Gid = &pstLayer->pu32Gid[pstRun->u32Offset];
+                Uint32        u32Last = pstRun->u32Column + pstRun->u32Length - 1;
+                Uint32        u32IndexW;
+
+                u32IndexW = SDL_max(pstRun->u32Column, (Uint32)s32FirstX);
+                u32Last   = SDL_min(u32Last, (Uint32)s32LastX);
+
+                for (; u32IndexW <= u32Last; u32IndexW++)
+                {
+                    Uint32    u32Gid     = pu32Gid[u32IndexW - pstRun->u32Column];
+                    Uint32    u32TileGid = _ClearGidFlags(u32Gid);
+                    AnimTile* pstAnimTile;
+                    TileInfo* pstInfo;
+                    Uint32    u32FrameGid;
+
+                    if (!_IsAnimated(u32TileGid, pstMap))
+                    {
+                        continue;
+                    }
+
+                    pstAnimTile =
+                        &pstMap->pstAnimTile[pstMap->pstTileInfo[u32TileGid].u32AnimIndex - 1];
+                    u32FrameGid =
+                        pstMap->pstAnimFrame[pstAnimTile->u32FirstFrame + pstAnimTile->u16Frame]
+                            .u32Gid;
+
+                    if (u32FrameGid >= pstMap->u32TileInfoCount)
+                    {
+                        continue;
+                    }
+
+                    pstInfo = &pstMap->pstTileInfo[u32FrameGid];
+                    if (!(pstInfo->u8Flags & TILE_IS_VALID))
+                    {
+                        continue;
+                    }
+
+                    // The frame is drawn with the flip flags of the cell.
+                    if (-1 == _RenderTile(
+                            u32FrameGid | (u32Gid & ~TMX_FLIP_BITS_REMOVAL),
+                            pstInfo,
+                            dRenderPosX + (u32IndexW * pstMap->u16TileWidth),
+                            dRenderPosY + ((s32IndexH + 1) * pstMap->u16TileHeight),
+                            pstMap,
+                            pstRenderer))
+                    {
+                        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+                        return -1;
+                    }
+                }
+            }
+        }
+    }
+
+    return 0;
+}
+
+static void _FreeChunks(Map* pstMap)
+{
+    if (pstMap->pstChunk)
+    {
+        for (Uint16 u16Index = 0; u16Index < pstMap->u16ChunkCount; u16Index++)
+        {
+            if (pstMap->pstChunk[u16Index].pstTexture)
+            {
+                SDL_DestroyTexture(pstMap->pstChunk[u16Index].pstTexture);
+            }
+        }
+
+        SDL_free(pstMap->pstChunk);
+        pstMap->pstChunk      = NULL;
+        pstMap->u16ChunkCount = 0;
+    }
+}
+
+static MapChunk* _GetChunk(
+    const Uint16   u16Index,
+    const Sint32   s32ChunkX,
+    const Sint32   s32ChunkY,
+    const SDL_bool bSkipAnimTiles,
+    const SDL_bool bRenderBgColour,
+    const char*    pacLayerName,
+    Map*           pstMap,
+    SDL_Renderer*  pstRenderer)
+{
+    MapChunk* pstChunk  = NULL;
+    Sint32    s32CellX  = s32ChunkX * pstMap->u16ChunkSize;
+    Sint32    s32CellY  = s32ChunkY * pstMap->u16ChunkSize;
+    Uint8     u8BgAlpha = 0;
+    Sint32    s32OverlapX;
+    Sint32    s32OverlapY;
+    Sint32    s32FirstX;
+    Sint32    s32LastX;
+    Sint32    s32LastY;
+
+    // Look up chunk and determine least recently used slot.
+    for (Uint16 u16Slot = 0; u16Slot < pstMap->u16ChunkCount; u16Slot++)
+    {
+        MapChunk* pstSlot = &pstMap->pstChunk[u16Slot];
+
+        if (pstSlot->bIsValid && u16Index == pstSlot->u16Index &&
+            s32ChunkX == pstSlot->s32ChunkX && s32ChunkY == pstSlot->s32ChunkY)
+        {
+            pstSlot->u32LastUsed = pstMap->u32ChunkFrame;
+
+            // Redraw tiles changed since the chunk has been rendered.
+            if (!SDL_RectEmpty(&pstSlot->stDirty))
+            {
+                if (0 != SDL_SetRenderTarget(pstRenderer, pstSlot->pstTexture))
+                {
+                    SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+                    return NULL;
+                }
+
+                _RedrawRect(
+                    &pstSlot->stDirty,
+                    s32CellX,
+                    s32CellY,
+                    bSkipAnimTiles,
+                    bRenderBgColour,
+                    pacLayerName,
+                    pstMap,
+                    pstRenderer);
+
+                if (0 != SDL_SetRenderTarget(pstRenderer, NULL))
+                {
+                    SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+                    return NULL;
+                }
+
+                SDL_memset(&pstSlot->stDirty, 0, sizeof(SDL_Rect));
+            }
+
+            return pstSlot;
+        }
+
+        if (!pstChunk || !pstSlot->bIsValid ||
+            (pstChunk->bIsValid && pstSlot->u32LastUsed < pstChunk->u32LastUsed))
+        {
+            pstChunk = pstSlot;
+        }
+    }
+
+    // Evict the least recently used chunk and render the new one.
+    if (!pstChunk->pstTexture)
+    {
+        pstChunk->pstTexture = SDL_CreateTexture(
+            pstRenderer,
+            SDL_PIXELFORMAT_ARGB8888,
+            SDL_TEXTUREACCESS_TARGET,
+            pstMap->u16ChunkSize * pstMap->u16TileWidth,
+            pstMap->u16ChunkSize * pstMap->u16TileHeight);
+
+        if (!pstChunk->pstTexture)
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+            return NULL;
+        }
+
+        if (0 != SDL_SetTextureBlendMode(pstChunk->pstTexture, SDL_BLENDMODE_BLEND))
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+            return NULL;
+        }
+    }
+
+    SDL_memset(&pstChunk->stDirty, 0, sizeof(SDL_Rect));
+    pstChunk->bIsValid    = SDL_FALSE;
+    pstChunk->u16Index    = u16Index;
+    pstChunk->s32ChunkX   = s32ChunkX;
+    pstChunk->s32ChunkY   = s32ChunkY;
+    pstChunk->u32LastUsed = pstMap->u32ChunkFrame;
+
+    if (0 != SDL_SetRenderTarget(pstRenderer, pstChunk->pstTexture))
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+        return NULL;
+    }
+
+    if (bRenderBgColour)
+    {
+        u8BgAlpha = 255;
+    }
+
+    SDL_SetRenderDrawColor(
+        pstRenderer,
+        (pstMap->u32BgColour >> 16) & 0xFF,
+        (pstMap->u32BgColour >> 8) & 0xFF,
+        (pstMap->u32BgColour) & 0xFF,
+        u8BgAlpha);
+    SDL_RenderClear(pstRenderer);
+
+    // Include cells left of and below the chunk whose tiles reach into
+    // it; clip at the map edges.
+    _GetTileOverlap(pstMap, &s32OverlapX, &s32OverlapY);
+
+    s32FirstX = SDL_max(s32CellX - s32OverlapX, 0);
+    s32LastX  = SDL_min(s32CellX + pstMap->u16ChunkSize, (Sint32)pstMap->u32Columns) - 1;
+    s32LastY  = SDL_min(
+        s32CellY + pstMap->u16ChunkSize + s32OverlapY, (Sint32)pstMap->u32Rows) - 1;
+
+    _RenderTiles(
+        bSkipAnimTiles,
+        pacLayerName,
+        s32FirstX,
+        s32CellY,
+        s32LastX - s32FirstX + 1,
+        s32LastY - s32CellY + 1,
+        s32CellX,
+        s32CellY,
+        pstMap,
+        pstRenderer);
+
+    if (0 != SDL_SetRenderTarget(pstRenderer, NULL))
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+        return NULL;
+    }
+
+    pstChunk->bIsValid = SDL_TRUE;
+
+    return pstChunk;
+}
+
+static Sint8 _DrawChunks(
+    const Uint16   u16Index,
+    const SDL_bool bSkipAnimTiles,
+    const SDL_bool bRenderBgColour,
+    const char*    pacLayerName,
+    const double   dCameraPosX,
+    const double   dCameraPosY,
+    Map*           pstMap,
+    SDL_Renderer*  pstRenderer)
+{
+    Uint16 u16Size       = pstMap->u16ChunkSize;
+    Sint32 s32ChunkW     = u16Size * pstMap->u16TileWidth;
+    Sint32 s32ChunkH     = u16Size * pstMap->u16TileHeight;
+    Sint32 s32ChunksX    = (pstMap->u32Columns + u16Size - 1) / u16Size;
+    Sint32 s32ChunksY    = (pstMap->u32Rows + u16Size - 1) / u16Size;
+    double dRenderPosX   = pstMap->dPosX - dCameraPosX;
+    double dRenderPosY   = pstMap->dPosY - dCameraPosY;
+    Sint32 s32ViewWidth  = 0;
+    Sint32 s32ViewHeight = 0;
+    Sint32 s32FirstX;
+    Sint32 s32FirstY;
+    Sint32 s32LastX;
+    Sint32 s32LastY;
+
+    if (-1 == Utils_GetViewSize(pstRenderer, &s32ViewWidth, &s32ViewHeight))
+    {
+        return -1;
+    }
+
+    // Determine the range of chunks visible to the camera.
+    s32FirstX = SDL_floor(-dRenderPosX / s32ChunkW);
+    s32FirstY = SDL_floor(-dRenderPosY / s32ChunkH);
+    s32LastX  = SDL_floor((-dRenderPosX + s32ViewWidth - 1) / s32ChunkW);
+    s32LastY  = SDL_floor((-dRenderPosY + s32ViewHeight - 1) / s32ChunkH);
+
+    s32FirstX = SDL_max(s32FirstX, 0);
+    s32FirstY = SDL_max(s32FirstY, 0);
+    s32LastX  = SDL_min(s32LastX, s32ChunksX - 1);
+    s32LastY  = SDL_min(s32LastY, s32ChunksY - 1);
+
+    for (Sint32 s32ChunkY = s32FirstY; s32ChunkY <= s32LastY; s32ChunkY++)
+    {
+        for (Sint32 s32ChunkX = s32FirstX; s32ChunkX <= s32LastX; s32ChunkX++)
+        {
+            SDL_Rect  stDst;
+            MapChunk* pstChunk = _GetChunk(
+                u16Index,
+                s32ChunkX,
+                s32ChunkY,
+                bSkipAnimTiles,
+                bRenderBgColour,
+                pacLayerName,
+                pstMap,
+                pstRenderer);
+
+            if (!pstChunk)
+            {
+                return -1;
+            }
+
+            stDst.x = dRenderPosX + (s32ChunkX * s32ChunkW);
+            stDst.y = dRenderPosY + (s32ChunkY * s32ChunkH);
+            stDst.w = s32ChunkW;
+            stDst.h = s32ChunkH;
+
+            if (-1 == SDL_RenderCopy(pstRenderer, pstChunk->pstTexture, NULL, &stDst))
+            {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+static Sint8 _HashFile(const char* pacFileName, Uint32* pu32Hash)
+{
+    MappedFile stFile;
+
+    if (-1 == Utils_MapFile(pacFileName, &stFile))
+    {
+        return -1;
+    }
+
+    *pu32Hash = _HashData(stFile.pData, stFile.zSize, 2166136261u);
+    Utils_UnmapFile(&stFile);
+
+    return 0;
+}
+
+static Sint8 _LoadTmx(const char* pacFileName, Map* pstMap)
+{
+    MappedFile stFile;
+
+    if (-1 == Utils_MapFile(pacFileName, &stFile))
+    {
+        return -1;
+    }
+
+    pstMap->u32SourceHash = _HashData(stFile.pData, stFile.zSize, 2166136261u);
+
+    // Maps from the asset archive are parsed from memory, loose ones by
+    // path so that external tilesets are found relative to the map.
+    if (Pack_Contains(pacFileName, Pack_GetDefaultPack()))
+    {
+        pstMap->pstTmxMap = tmx_load_buffer(stFile.pData, (int)stFile.zSize);
+    }
+    else
+    {
+        pstMap->pstTmxMap = tmx_load(pacFileName);
+    }
+
+    Utils_UnmapFile(&stFile);
+
+    if (!pstMap->pstTmxMap)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", tmx_strerr());
+        return -1;
+    }
+
+    return 0;
+}
+
+static Uint32 _GetLayoutKey(void)
+{
+    // The byte order marker makes the key differ between endiannesses,
+    // the scalar mode between float and fixed-point boxes of equal size.
+    Uint32 au32Layout[] = { 0x01020304,
+                            sizeof(struct BakedMapHeader_t),
+                            sizeof(struct MapLayer_t),
+                            sizeof(struct MapTileset_t),
+                            sizeof(struct TileInfo_t),
+                            sizeof(struct AnimTile_t),
+                            sizeof(struct AnimFrame_t),
+                            sizeof(struct AABB_t),
+                            sizeof(struct MapProperty_t),
+                            SCALAR_MODE };
+
+    return _HashData((const Uint8*)au32Layout, sizeof(au32Layout), 2166136261u);
+}
+
+static void _GetBakedSizes(
+    const BakedMapHeader* pstHeader,
+    Uint64                au64Size[BAKED_SECTIONS],
+    const Map*            pstMap)
+{
+    // Computed in 64 bits so that bogus counts cannot wrap around to a
+    // size that matches the header.  The cell counts themselves are
+    // limited to 32 bits by the caller.
+    const ObjectStore* pstStore      = &pstMap->stObjects;
+    Uint64             u64Cells      = (Uint64)pstMap->u32Columns * pstMap->u32Rows;
+    Uint64             u64Objects    = pstStore->u32Count;
+    Uint64             u64Grid       = (Uint64)pstStore->u32GridWidth * pstStore->u32GridHeight;
+    Uint64             u64Rows       = pstMap->u16LayerCount * ((Uint64)pstMap->u32Rows + 1);
+    Uint64             u64Properties = pstHeader->u32PropertySize;
+
+    au64Size[BAKED_LAYERS]            = pstMap->u16LayerCount * sizeof(struct MapLayer_t);
+    au64Size[BAKED_ROW_START]         = u64Rows * sizeof(Uint32);
+    au64Size[BAKED_RUNS]              = (Uint64)pstHeader->u32RunCount * sizeof(struct MapRun_t);
+    au64Size[BAKED_GIDS]              = (Uint64)pstHeader->u32GidCount * sizeof(Uint32);
+    au64Size[BAKED_TILESETS]          = pstMap->u16TilesetCount * sizeof(struct MapTileset_t);
+    au64Size[BAKED_TILE_INFO]         =
+        (Uint64)pstMap->u32TileInfoCount * sizeof(struct TileInfo_t);
+    au64Size[BAKED_ANIM_TILES]        =
+        (Uint64)pstMap->u32AnimTileCount * sizeof(struct AnimTile_t);
+    au64Size[BAKED_ANIM_FRAMES]       =
+        (Uint64)pstMap->u32AnimFrameCount * sizeof(struct AnimFrame_t);
+    au64Size[BAKED_TYPE_GRID]         = u64Cells * sizeof(Uint32);
+    au64Size[BAKED_TYPE_NAMES]        = sizeof(pstMap->acTypeName);
+    au64Size[BAKED_OBJECT_ID]         = u64Objects * sizeof(Uint32);
+    au64Size[BAKED_OBJECT_POS_X]      = u64Objects * sizeof(Sint32);
+    au64Size[BAKED_OBJECT_POS_Y]      = u64Objects * sizeof(Sint32);
+    au64Size[BAKED_OBJECT_WIDTH]      = u64Objects * sizeof(Uint32);
+    au64Size[BAKED_OBJECT_HEIGHT]     = u64Objects * sizeof(Uint32);
+    au64Size[BAKED_OBJECT_BB]         = u64Objects * sizeof(struct AABB_t);
+    au64Size[BAKED_OBJECT_NAME]       = u64Objects * sizeof(Uint32);
+    au64Size[BAKED_OBJECT_TYPE]       = u64Objects * sizeof(Uint16);
+    au64Size[BAKED_OBJECT_TYPE_NAME]  = pstStore->u16TypeCount * sizeof(Uint32);
+    au64Size[BAKED_OBJECT_TYPE_START] = 0;
+    au64Size[BAKED_OBJECT_BUCKET]     = u64Objects * sizeof(Uint32);
+    au64Size[BAKED_STRING_POOL]       = u64Objects ? pstStore->u32StringPoolSize : 0;
+    au64Size[BAKED_CELL_START]        = u64Grid ? (u64Grid + 1) * sizeof(Uint32) : 0;
+    au64Size[BAKED_CELL_OBJECT]       = (Uint64)pstHeader->u32CellObjectCount * sizeof(Uint32);
+    au64Size[BAKED_PROPERTIES]        = u64Properties * sizeof(struct MapProperty_t);
+    au64Size[BAKED_PROPERTY_POOL]     = u64Properties ? pstHeader->u32PropertyPoolSize : 0;
+
+    if (pstStore->u16TypeCount > 0)
+    {
+        au64Size[BAKED_OBJECT_TYPE_START] = (pstStore->u16TypeCount + 1) * sizeof(Uint32);
+    }
+}
+
+static void* _GetBakedSection(
+    const BakedSection    eSection,
+    const BakedMapHeader* pstHeader,
+    const Map*            pstMap)
+{
+    if (0 == pstHeader->au32Size[eSection])
+    {
+        return NULL;
+    }
+
+    return (Uint8*)pstMap->stBaked.pData + pstHeader->au32Offset[eSection];
+}
+
+static Sint8 _CheckLayer(const MapLayer* pstLayer, const Map* pstMap)
+{
+    Uint32 u32Offset = 0;
+
+    if ('\0' != pstLayer->acName[LAYER_NAME_LEN - 1] || 0 != pstLayer->pu32RowStart[0] ||
+        pstLayer->u32RunCount != pstLayer->pu32RowStart[pstMap->u32Rows])
+    {
+        return -1;
+    }
+
+    for (Uint32 u32PosY = 0; u32PosY < pstMap->u32Rows; u32PosY++)
+    {
+        Uint32 u32Column = 0;
+
+        if (pstLayer->pu32RowStart[u32PosY] > pstLayer->pu32RowStart[u32PosY + 1])
+        {
+            return -1;
+        }
+
+        // Runs must be sorted, must not touch and must not exceed the
+        // row or the GID array.
+        for (Uint32 u32Run = pstLayer->pu32RowStart[u32PosY];
+             u32Run < pstLayer->pu32RowStart[u32PosY + 1];
+             u32Run++)
+        {
+            const MapRun* pstRun = &pstLayer->pstRun[u32Run];
+
+            if (pstRun->u32Column < u32Column || pstRun->u32Column >= pstMap->u32Columns ||
+                0 == pstRun->u32Length ||
+                pstRun->u32Length > pstMap->u32Columns - pstRun->u32Column ||
+                pstRun->u32Offset < u32Offset || pstRun->u32Offset > pstLayer->u32GidCount ||
+                pstRun->u32Length > pstLayer->u32GidCount - pstRun->u32Offset)
+            {
+                return -1;
+            }
+
+            u32Column = pstRun->u32Column + pstRun->u32Length + 1;
+            u32Offset = pstRun->u32Offset + pstRun->u32Length;
+        }
+    }
+
+    return 0;
+}
+
+static Sint8 _CheckProperties(const Map* pstMap)
+{
+    Uint32 u32Free = 0;
+
+    if (0 == pstMap->u32PropertySize)
+    {
+        return 0;
+    }
+
+    if ((pstMap->u32PropertySize & (pstMap->u32PropertySize - 1)) ||
+        0 == pstMap->u32PropertyPoolSize ||
+        '\0' != pstMap->pacPropertyPool[pstMap->u32PropertyPoolSize - 1])
+    {
+        return -1;
+    }
+
+    for (Uint32 u32Slot = 0; u32Slot < pstMap->u32PropertySize; u32Slot++)
+    {
+        const MapProperty* pstProperty = &pstMap->pstProperty[u32Slot];
+
+        if (pstProperty->u8Type > PROPERTY_FILE ||
+            pstProperty->u32Name >= pstMap->u32PropertyPoolSize ||
+            pstProperty->u32String >= pstMap->u32PropertyPoolSize)
+        {
+            return -1;
+        }
+
+        if (PROPERTY_NONE == pstProperty->u8Type)
+        {
+            u32Free++;
+        }
+    }
+
+    // Lookups rely on a free slot to terminate probing.
+    return u32Free ? 0 : -1;
+}
+
+static Sint8 _CheckTiles(const Map* pstMap)
+{
+    for (Uint16 u16Tileset = 0; u16Tileset < pstMap->u16TilesetCount; u16Tileset++)
+    {
+        const MapTileset* pstTS = &pstMap->pstTileset[u16Tileset];
+
+        if (pstTS->u8Atlas >= pstMap->u8AtlasCount || '\0' != pstTS->acImage[TS_IMG_PATH_LEN - 1])
+        {
+            return -1;
+        }
+    }
+
+    for (Uint32 u32Gid = 0; u32Gid < pstMap->u32TileInfoCount; u32Gid++)
+    {
+        const TileInfo* pstInfo = &pstMap->pstTileInfo[u32Gid];
+
+        if (pstInfo->s8TypeId < -1 || pstInfo->s8TypeId >= pstMap->u8TypeCount ||
+            pstInfo->u32AnimIndex > pstMap->u32AnimTileCount)
+        {
+            return -1;
+        }
+
+        if ((pstInfo->u8Flags & TILE_IS_VALID) &&
+            (pstInfo->u8Atlas >= pstMap->u8AtlasCount ||
+             pstInfo->u16Tileset >= pstMap->u16TilesetCount))
+        {
+            return -1;
+        }
+
+        if ((pstInfo->u8Flags & TILE_IS_ANIMATED) && 0 == pstInfo->u32AnimIndex)
+        {
+            return -1;
+        }
+    }
+
+    // Every animation needs at least one frame within the frame table.
+    for (Uint32 u32Index = 0; u32Index < pstMap->u32AnimTileCount; u32Index++)
+    {
+        const AnimTile* pstAnimTile = &pstMap->pstAnimTile[u32Index];
+
+        if (pstAnimTile->u32Gid >= pstMap->u32TileInfoCount || 0 == pstAnimTile->u16FrameCount ||
+            pstAnimTile->u32FirstFrame > pstMap->u32AnimFrameCount ||
+            pstAnimTile->u16FrameCount > pstMap->u32AnimFrameCount - pstAnimTile->u32FirstFrame)
+        {
+            return -1;
+        }
+    }
+
+    for (Uint32 u32Frame = 0; u32Frame < pstMap->u32AnimFrameCount; u32Frame++)
+    {
+        if (pstMap->pstAnimFrame[u32Frame].u32Gid >= pstMap->u32TileInfoCount)
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static Sint8 _CheckObjects(const Uint32 u32CellObjectCount, const Map* pstMap)
+{
+    const ObjectStore* pstStore = &pstMap->stObjects;
+    Uint32             u32Cells = pstStore->u32GridWidth * pstStore->u32GridHeight;
+
+    // Bucket and cell start tables must be ascending and end with the
+    // size of the array they index.
+    if (0 == u32Cells || 0 != pstStore->pu32CellStart[0] ||
+        u32CellObjectCount != pstStore->pu32CellStart[u32Cells])
+    {
+        return -1;
+    }
+
+    for (Uint32 u32Cell = 0; u32Cell < u32Cells; u32Cell++)
+    {
+        if (pstStore->pu32CellStart[u32Cell] > pstStore->pu32CellStart[u32Cell + 1])
+        {
+            return -1;
+        }
+    }
+
+    for (Uint32 u32Entry = 0; u32Entry < u32CellObjectCount; u32Entry++)
+    {
+        if (pstStore->pu32CellObject[u32Entry] >= pstStore->u32Count)
+        {
+            return -1;
+        }
+    }
+
+    if (0 == pstStore->u32Count)
+    {
+        return 0 == pstStore->u16TypeCount ? 0 : -1;
+    }
+
+    // Every object has a type, names and types are handles into the
+    // string pool.
+    if (0 == pstStore->u16TypeCount || 0 != pstStore->pu32TypeStart[0] ||
+        pstStore->u32Count != pstStore->pu32TypeStart[pstStore->u16TypeCount] ||
+        0 == pstStore->u32StringPoolSize ||
+        '\0' != pstStore->pacStringPool[pstStore->u32StringPoolSize - 1])
+    {
+        return -1;
+    }
+
+    for (Uint16 u16TypeId = 0; u16TypeId < pstStore->u16TypeCount; u16TypeId++)
+    {
+        if (pstStore->pu32TypeName[u16TypeId] >= pstStore->u32StringPoolSize ||
+            pstStore->pu32TypeStart[u16TypeId] > pstStore->pu32TypeStart[u16TypeId + 1])
+        {
+            return -1;
+        }
+    }
+
+    for (Uint32 u32Index = 0; u32Index < pstStore->u32Count; u32Index++)
+    {
+        if (pstStore->pu32Name[u32Index] >= pstStore->u32StringPoolSize ||
+            pstStore->pu16Type[u32Index] >= pstStore->u16TypeCount ||
+            pstStore->pu32TypeBucket[u32Index] >= pstStore->u32Count)
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static Sint8 _WriteBaked(const void* pData, const size_t zSize, SDL_RWops* pstRW)
+{
+    if (0 == zSize)
+    {
+        return 0;
+    }
+
+    if (1 != SDL_RWwrite(pstRW, pData, zSize, 1))
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+        return -1;
+    }
+
+    return 0;
+}
+
+static Sint8 _WriteBakedLayers(
+    const BakedSection eSection,
+    const Map*         pstMap,
+    SDL_RWops*         pstRW)
+{
+    // Layer data is stored per layer and written back to back.
+    for (Uint16 u16Layer = 0; u16Layer < pstMap->u16LayerCount; u16Layer++)
+    {
+        const MapLayer* pstLayer = &pstMap->pstLayer[u16Layer];
+        Sint8           s8Error  = 0;
+
+        switch (eSection)
+        {
+            case BAKED_ROW_START:
+                s8Error = _WriteBaked(
+                    pstLayer->pu32RowStart, (pstMap->u32Rows + 1) * sizeof(Uint32), pstRW);
+                break;
+            case BAKED_RUNS:
+                s8Error = _WriteBaked(
+                    pstLayer->pstRun, pstLayer->u32RunCount * sizeof(struct MapRun_t), pstRW);
+                break;
+            default:
+                s8Error = _WriteBaked(
+                    pstLayer->pu32Gid, pstLayer->u32GidCount * sizeof(Uint32), pstRW);
+                break;
+        }
+
+        if (-1 == s8Error)
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static void _LoadAsync(void* pData)
+{
+    MapLoader*  pstLoader       = pData;
+    const char* pacTilesetImage = NULL;
+    Sint8       s8ReturnValue   = -1;
+
+    if (pstLoader->acTilesetImage[0])
+    {
+        pacTilesetImage = pstLoader->acTilesetImage;
+    }
+
+    if (pstLoader->acBakedFile[0])
+    {
+        s8ReturnValue = Map_InitFromBaked(
+            pstLoader->acBakedFile,
+            pstLoader->acFileName,
+            pstLoader->u8MeterInPixel,
+            &pstLoader->pstMap);
+    }
+
+    if (-1 == s8ReturnValue)
+    {
+        s8ReturnValue = Map_Init(
+            pstLoader->acFileName,
+            pacTilesetImage,
+            pstLoader->u8MeterInPixel,
+            &pstLoader->pstMap);
+
+        // Failing to (re-)bake the map is not fatal.
+        if (0 == s8ReturnValue && pstLoader->acBakedFile[0])
+        {
+            Map_Bake(pstLoader->acBakedFile, pstLoader->pstMap);
+        }
+    }
+
+    if (0 == s8ReturnValue)
+    {
+        s8ReturnValue = _ComposeAtlas(pstLoader->pstMap);
+    }
+
+    if (0 == s8ReturnValue)
+    {
+        SDL_AtomicSet(&pstLoader->stState, MAP_LOAD_DONE);
+    }
+    else
+    {
+        SDL_AtomicSet(&pstLoader->stState, MAP_LOAD_FAILED);
+    }
+}
+
+/**
+ * @brief   Bake map
+ * @details Writes the map to a binary file that can be loaded without
+ *          parsing XML using Map_InitFromBaked()
+ * @param   pacFileName
+ *          Path and filename of the baked map to write
+ * @param   pstMap
+ *          Pointer to map handle
+ * @return  Error code
+ * @retval  0:  OK
+ * @retval  -1: Error
+ * @remark  The format stores the in-memory layout of the map data and
+ *          is only meant to be read by the same build of the framework
+ *          on the same platform.  Bake the map right after loading it
+ *          with Map_Init(), before tiles or animations are modified.
+ */
+Sint8 Map_Bake(const char* pacFileName, const Map* pstMap)
+{
+    const ObjectStore* pstStore      = &pstMap->stObjects;
+    Uint8              au8Padding[8] = { 0 };
+    const void*        apData[BAKED_SECTIONS];
+    Uint64             au64Size[BAKED_SECTIONS];
+    BakedMapHeader     stHeader;
+    SDL_RWops*         pstRW;
+    Uint32             u32Offset;
+
+    SDL_memset(&stHeader, 0, sizeof(struct BakedMapHeader_t));
+    SDL_memcpy(stHeader.acMagic, "ESZM", sizeof(stHeader.acMagic));
+
+    stHeader.u32Version          = BAKED_VERSION;
+    stHeader.u32LayoutKey        = _GetLayoutKey();
+    stHeader.u32SourceHash       = pstMap->u32SourceHash;
+    stHeader.u32Columns          = pstMap->u32Columns;
+    stHeader.u32Rows             = pstMap->u32Rows;
+    stHeader.u16TileWidth        = pstMap->u16TileWidth;
+    stHeader.u16TileHeight       = pstMap->u16TileHeight;
+    stHeader.u32BgColour         = pstMap->u32BgColour;
+    stHeader.dTmxGravitation     = pstMap->dTmxGravitation;
+    stHeader.u16LayerCount       = pstMap->u16LayerCount;
+    stHeader.u16TilesetCount     = pstMap->u16TilesetCount;
+    stHeader.u32TileInfoCount    = pstMap->u32TileInfoCount;
+    stHeader.u32AnimTileCount    = pstMap->u32AnimTileCount;
+    stHeader.u32AnimFrameCount   = pstMap->u32AnimFrameCount;
+    stHeader.u8TypeCount         = pstMap->u8TypeCount;
+    stHeader.u8AtlasCount        = pstMap->u8AtlasCount;
+    stHeader.u16ObjectTypeCount  = pstStore->u16TypeCount;
+    stHeader.u32ObjectCount      = pstStore->u32Count;
+    stHeader.u32StringPoolSize   = pstStore->u32StringPoolSize;
+    stHeader.u32GridWidth        = pstStore->u32GridWidth;
+    stHeader.u32GridHeight       = pstStore->u32GridHeight;
+    stHeader.u32PropertySize     = pstMap->u32PropertySize;
+    stHeader.u32PropertyPoolSize = pstMap->u32PropertyPoolSize;
+
+    for (Uint8 u8Page = 0; u8Page < pstMap->u8AtlasCount; u8Page++)
+    {
+        stHeader.au16AtlasWidth[u8Page]  = pstMap->astAtlas[u8Page].u16Width;
+        stHeader.au16AtlasHeight[u8Page] = pstMap->astAtlas[u8Page].u16Height;
+    }
+
+    if (pstStore->pu32CellStart)
+    {
+        stHeader.u32CellObjectCount =
+            pstStore->pu32CellStart[pstStore->u32GridWidth * pstStore->u32GridHeight];
+    }
+
+    for (Uint16 u16Layer = 0; u16Layer < pstMap->u16LayerCount; u16Layer++)
+    {
+        stHeader.u32RunCount += pstMap->pstLayer[u16Layer].u32RunCount;
+        stHeader.u32GidCount += pstMap->pstLayer[u16Layer].u32GidCount;
+    }
+
+    apData[BAKED_LAYERS]            = pstMap->pstLayer;
+    apData[BAKED_ROW_START]         = NULL;
+    apData[BAKED_RUNS]              = NULL;
+    apData[BAKED_GIDS]              = NULL;
+    apData[BAKED_TILESETS]          = pstMap->pstTileset;
+    apData[BAKED_TILE_INFO]         = pstMap->pstTileInfo;
+    apData[BAKED_ANIM_TILES]        = pstMap->pstAnimTile;
+    apData[BAKED_ANIM_FRAMES]       = pstMap->pstAnimFrame;
+    apData[BAKED_TYPE_GRID]         = pstMap->pu32TypeGrid;
+    apData[BAKED_TYPE_NAMES]        = pstMap->acTypeName;
+    apData[BAKED_OBJECT_ID]         = pstStore->pu32Id;
+    apData[BAKED_OBJECT_POS_X]      = pstStore->ps32PosX;
+    apData[BAKED_OBJECT_POS_Y]      = pstStore->ps32PosY;
+    apData[BAKED_OBJECT_WIDTH]      = pstStore->pu32Width;
+    apData[BAKED_OBJECT_HEIGHT]     = pstStore->pu32Height;
+    apData[BAKED_OBJECT_BB]         = pstStore->pstBB;
+    apData[BAKED_OBJECT_NAME]       = pstStore->pu32Name;
+    apData[BAKED_OBJECT_TYPE]       = pstStore->pu16Type;
+    apData[BAKED_OBJECT_TYPE_NAME]  = pstStore->pu32TypeName;
+    apData[BAKED_OBJECT_TYPE_START] = pstStore->pu32TypeStart;
+    apData[BAKED_OBJECT_BUCKET]     = pstStore->pu32TypeBucket;
+    apData[BAKED_STRING_POOL]       = pstStore->pacStringPool;
+    apData[BAKED_CELL_START]        = pstStore->pu32CellStart;
+    apData[BAKED_CELL_OBJECT]       = pstStore->pu32CellObject;
+    apData[BAKED_PROPERTIES]        = pstMap->pstProperty;
+    apData[BAKED_PROPERTY_POOL]     = pstMap->pacPropertyPool;
+
+    _GetBakedSizes(&stHeader, au64Size, pstMap);
+
+    // Sections are 8-byte aligned so they can be used in place.
+    u32Offset = (sizeof(struct BakedMapHeader_t) + 7) & ~7u;
+    for (Uint8 u8Section = 0; u8Section < BAKED_SECTIONS; u8Section++)
+    {
+        stHeader.au32Size[u8Section]   = (Uint32)au64Size[u8Section];
+        stHeader.au32Offset[u8Section] = u32Offset;
+        u32Offset += (stHeader.au32Size[u8Section] + 7) & ~7u;
+    }
+
+    pstRW = SDL_RWFromFile(pacFileName, "wb");
+    if (!pstRW)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+        return -1;
+    }
+
+    u32Offset = sizeof(struct BakedMapHeader_t);
+    if (-1 == _WriteBaked(&stHeader, sizeof(struct BakedMapHeader_t), pstRW))
+    {
+        SDL_RWclose(pstRW);
+        return -1;
+    }
+
+    for (Uint8 u8Section = 0; u8Section < BAKED_SECTIONS; u8Section++)
+    {
+        if (-1 == _WriteBaked(au8Padding, stHeader.au32Offset[u8Section] - u32Offset, pstRW))
+        {
+            SDL_RWclose(pstRW);
+            return -1;
+        }
+
+        if (BAKED_ROW_START == u8Section || BAKED_RUNS == u8Section || BAKED_GIDS == u8Section)
+        {
+            if (-1 == _WriteBakedLayers((BakedSection)u8Section, pstMap, pstRW))
+            {
+                SDL_RWclose(pstRW);
+                return -1;
+            }
+        }
+        else if (-1 == _WriteBaked(apData[u8Section], stHeader.au32Size[u8Section], pstRW))
+        {
+            SDL_RWclose(pstRW);
+            return -1;
+        }
+
+        u32Offset = stHeader.au32Offset[u8Section] + stHeader.au32Size[u8Section];
+    }
+
+    SDL_RWclose(pstRW);
+    SDL_Log("Bake map file: %s (%u bytes).\n", pacFileName, u32Offset);
+
+    return 0;
+}
+
+/**
+ * @brief   Cancel asynchronous map load
+ * @details Waits for a map load started with Map_InitAsync() to end and
+ *          discards the loaded map
+ * @param   pstLoader
+ *          Pointer to map loader handle, freed by this function
+ */
+void Map_CancelAsync(MapLoader* pstLoader)
+{
+    Job_Wait(&pstLoader->stJob, pstLoader->pstPool);
+    Map_Free(pstLoader->pstMap);
+    SDL_free(pstLoader);
+}
+
+/**
+ * @brief   Draw Map
+ * @details Draws the map on screen
+ * @param   u16Index
+ *          The texture index; the total amount of layers per map is
+ *          defined by MAP_TEXTURES.
+ * @param   bRenderAnimTiles
+ *          If set to 1, all animated tiles will be updated and
+ *          rendered in this call.
+ * @param   bRenderBgColour
+ *          Determine if the map's background colour should be rendered
+ * @param   pacLayerName
+ *          Sub-string of the layer(s) to render
+ * @param   dCameraPosX
+ *          Camera position along the x-axis
+ * @param   dCameraPosY
+ *          Camera position along the y-axis
+ * @param   pstMap
+ *          Pointer to map handle
+ * @param   pstRenderer
+ *          Pointer to SDL2 rendering context
+ * @return  Error code
+ * @retval  0:  OK
+ * @retval  -1: Error
+ * @remark  If the chunk cache has been enabled using
+ *          Map_EnableChunkCache(), only the chunks visible to the
+ *          camera are rendered (on demand) and drawn.  Animated tiles
+ *          are never pre-rendered: only the instances visible to the
+ *          camera are drawn directly into the frame.
+ */
+Sint8 Map_Draw(
+    const Uint16   u16Index,
+    const SDL_bool bRenderAnimTiles,
+    const SDL_bool bRenderBgColour,
+    const char*    pacLayerName,
+    const double   dCameraPosX,
+    const double   dCameraPosY,
+    Map*           pstMap,
+    SDL_Renderer*  pstRenderer)
+{
+    double dDeltaTime = (double)APPROX_TIME_PER_FRAME / (double)TIME_FACTOR;
+
+    // Upload tileset atlas once.
+    if (pstMap->u8AtlasCount > 0 && !pstMap->astAtlas[0].pstTexture)
+    {
+        if (-1 == _UploadAtlas(pstMap, pstRenderer))
+        {
+            return -1;
+        }
+    }
+
+    if (pstMap->pstChunk)
+    {
+        pstMap->u32ChunkFrame++;
+        if (-1 == _DrawChunks(
+                u16Index,
+                bRenderAnimTiles,
+                bRenderBgColour,
+                pacLayerName,
+                dCameraPosX,
+                dCameraPosY,
+                pstMap,
+                pstRenderer))
+        {
+            return -1;
+        }
+    }
+    else
+    {
+        double   dRenderPosX = pstMap->dPosX - dCameraPosX;
+        double   dRenderPosY = pstMap->dPosY - dCameraPosY;
+        SDL_Rect stDst       = { dRenderPosX,
+                           dRenderPosY,
+                           pstMap->u32Columns * pstMap->u16TileWidth,
+                           pstMap->u32Rows * pstMap->u16TileHeight };
+
+        // Render the texture once.
+        if (!pstMap->pstTexture[u16Index])
+        {
+            pstMap->pstTexture[u16Index] = SDL_CreateTexture(
+                pstRenderer,
+                SDL_PIXELFORMAT_ARGB8888,
+                SDL_TEXTUREACCESS_TARGET,
+                pstMap->u32Columns * pstMap->u16TileWidth,
+                pstMap->u32Rows * pstMap->u16TileHeight);
+
+            if (!pstMap->pstTexture[u16Index])
+            {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+                return -1;
+            }
+
+            if (0 != SDL_SetRenderTarget(pstRenderer, pstMap->pstTexture[u16Index]))
+            {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+                return -1;
+            }
+
+            SDL_SetRenderDrawColor(
+                pstRenderer,
+                (pstMap->u32BgColour >> 16) & 0xFF,
+                (pstMap->u32BgColour >> 8) & 0xFF,
+                (pstMap->u32BgColour) & 0xFF,
+                bRenderBgColour ? 255 : 0);
+            SDL_RenderClear(pstRenderer);
+
+            _RenderTiles(
+                bRenderAnimTiles,
+                pacLayerName,
+                0,
+                0,
+                pstMap->u32Columns,
+                pstMap->u32Rows,
+                0,
+                0,
+                pstMap,
+                pstRenderer);
+
+            // Switch back to default render target.
+            if (0 != SDL_SetRenderTarget(pstRenderer, NULL))
+            {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+                return -1;
+            }
+
+            if (0 != SDL_SetTextureBlendMode(pstMap->pstTexture[u16Index], SDL_BLENDMODE_BLEND))
+            {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+                return -1;
+            }
+
+            SDL_Log("Render map texture: %u\n", u16Index);
+        }
+        else if (pstMap->u32DirtyCount > 0)
+        {
+            if (-1 == _PatchTexture(
+                    u16Index,
+                    bRenderAnimTiles,
+                    bRenderBgColour,
+                    pacLayerName,
+                    pstMap,
+                    pstRenderer))
+            {
+                return -1;
+            }
+        }
+
+        if (-1 ==
+            SDL_RenderCopyEx(
+                pstRenderer, pstMap->pstTexture[u16Index], NULL, &stDst, 0, NULL, SDL_FLIP_NONE))
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+            return -1;
+        }
+    }
+
+    // Update and render animated tiles.
+    if (bRenderAnimTiles)
+    {
+        _UpdateAnimTiles(dDeltaTime, pstMap);
+
+        if (-1 == _DrawAnimTiles(pacLayerName, dCameraPosX, dCameraPosY, pstMap, pstRenderer))
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief   Enable chunk cache
+ * @details Switches the map to chunked rendering: instead of
+ *          pre-rendering each texture index into a single texture of
+ *          the size of the entire map, fixed-size chunks of tiles are
+ *          rendered on demand around the camera and kept in a cache
+ *          with least recently used eviction
+ * @param   u16ChunkSize
+ *          Chunk edge length in tiles
+ * @param   u32MemoryBudget
+ *          Max. texture memory used by the chunk cache in bytes
+ * @param   pstMap
+ *          Pointer to map handle
+ * @return  Error code
+ * @retval  0:  OK
+ * @retval  -1: Error
+ */
+Sint8 Map_EnableChunkCache(const Uint16 u16ChunkSize, const Uint32 u32MemoryBudget, Map* pstMap)
+{
+    Uint16 u16Size       = SDL_max(u16ChunkSize, CHUNK_SIZE_MIN);
+    Uint32 u32ChunkBytes =
+        u16Size * pstMap->u16TileWidth * u16Size * pstMap->u16TileHeight * sizeof(Uint32);
+    Uint32 u32ChunkCount = u32MemoryBudget / u32ChunkBytes;
+
+    if (0 == u32ChunkCount)
+    {
+        SDL_LogError(
+            SDL_LOG_CATEGORY_APPLICATION,
+            "EnableChunkCache(): memory budget too small for a single chunk.\n");
+        return -1;
+    }
+
+    if (u32ChunkCount > 0xFFFF)
+    {
+        u32ChunkCount = 0xFFFF;
+    }
+
+    _FreeChunks(pstMap);
+
+    pstMap->pstChunk = SDL_calloc(u32ChunkCount, sizeof(struct MapChunk_t));
+    if (!pstMap->pstChunk)
+    {
+        SDL_LogError(
+            SDL_LOG_CATEGORY_APPLICATION, "EnableChunkCache(): error allocating memory.\n");
+        return -1;
+    }
+
+    pstMap->u16ChunkCount = u32ChunkCount;
+    pstMap->u16ChunkSize  = u16Size;
+    pstMap->u32ChunkFrame = 0;
+
+    // Whole-map textures are no longer used.
+    for (Uint8 u8Index = 0; u8Index < MAP_TEXTURES; u8Index++)
+    {
+        if (pstMap->pstTexture[u8Index])
+        {
+            SDL_DestroyTexture(pstMap->pstTexture[u8Index]);
+            pstMap->pstTexture[u8Index] = NULL;
+        }
+    }
+    pstMap->u32DirtyCount = 0;
+
+    SDL_Log(
+        "Enable map chunk cache: %d chunk(s) of %dx%d tiles.\n",
+        pstMap->u16ChunkCount,
+        u16Size,
+        u16Size);
+
+    return 0;
+}
+
+/**
+ * @brief   Finalise asynchronous map load
+ * @details Waits for a map load started with Map_InitAsync() to
+ *          complete, uploads the tileset atlas and replaces the
+ *          current map with the new one
+ * @param   pstLoader
+ *          Pointer to map loader handle; the handle is freed by this
+ *          function in any case
+ * @param   pstMap
+ *          Pointer to the map handle to replace.  The map it points to
+ *          (if any) is freed once the new map is ready and kept if the
+ *          new map could not be loaded.
+ * @param   pstRenderer
+ *          Pointer to SDL2 rendering context
+ * @return  Error code
+ * @retval  0:  OK
+ * @retval  -1: Error
+ * @remark  Call Map_IsAsyncDone() first to avoid blocking the main
+ *          thread.
+ */
+Sint8 Map_FinalizeAsync(MapLoader* pstLoader, Map** pstMap, SDL_Renderer* pstRenderer)
+{
+    Map* pstNewMap = NULL;
+    int  iState;
+
+    Job_Wait(&pstLoader->stJob, pstLoader->pstPool);
+    iState    = SDL_AtomicGet(&pstLoader->stState);
+    pstNewMap = pstLoader->pstMap;
+    SDL_free(pstLoader);
+
+    if (MAP_LOAD_DONE != iState)
+    {
+        Map_Free(pstNewMap);
+        return -1;
+    }
+
+    if (-1 == _UploadAtlas(pstNewMap, pstRenderer))
+    {
+        Map_Free(pstNewMap);
+        return -1;
+    }
+
+    Map_Free(*pstMap);
+    *pstMap = pstNewMap;
+
+    return 0;
+}
+
+/**
+ * @brief   Free map
+ * @details Frees up allocated memory and unloads map
+ * @param   pstMap
+ *          Pointer to map handle
+ */
+void Map_Free(Map* pstMap)
+{
+    if (pstMap)
+    {
+        if (pstMap->pstTmxMap)
+        {
+            tmx_map_free(pstMap->pstTmxMap);
+        }
+
+        for (Uint8 u8Index = 0; u8Index < pstMap->u8AtlasCount; u8Index++)
+        {
+            if (pstMap->astAtlas[u8Index].pstTexture)
+            {
+                SDL_DestroyTexture(pstMap->astAtlas[u8Index].pstTexture);
+            }
+        }
+
+        _FreeAtlasSurfaces(pstMap);
+
+        for (Uint8 u8Index = 0; u8Index < MAP_TEXTURES; u8Index++)
+        {
+            if (pstMap->pstTexture[u8Index])
+            {
+                SDL_DestroyTexture(pstMap->pstTexture[u8Index]);
+            }
+        }
+
+        _FreeChunks(pstMap);
+        SDL_free(pstMap->pstDirty);
+
+        for (Uint16 u16Layer = 0; pstMap->pstLayer && u16Layer < pstMap->u16LayerCount; u16Layer++)
+        {
+            _Free(pstMap->pstLayer[u16Layer].pu32RowStart, pstMap);
+            _Free(pstMap->pstLayer[u16Layer].pstRun, pstMap);
+            _Free(pstMap->pstLayer[u16Layer].pu32Gid, pstMap);
+        }
+
+        _Free(pstMap->pstLayer, pstMap);
+        _Free(pstMap->pstAnimTile, pstMap);
+        _Free(pstMap->pstAnimFrame, pstMap);
+        _Free(pstMap->pstTileset, pstMap);
+        _Free(pstMap->pstTileInfo, pstMap);
+
+        _FreeObjects(pstMap);
+        _Free(pstMap->pstProperty, pstMap);
+        _Free(pstMap->pacPropertyPool, pstMap);
+        _Free(pstMap->pu32TypeGrid, pstMap);
+        Utils_UnmapFile(&pstMap->stBaked);
+        SDL_free(pstMap);
+        SDL_Log("Unload map.\n");
+    }
+}
+
+/**
+ * @brief   Get layer index
+ * @details Resolves a layer name to its index
+ * @param   pacName
+ *          Name of the layer
+ * @param   pstMap
+ *          Pointer to map handle
+ * @return  Layer index
+ * @retval  -1: Layer does not exist
+ */
+Sint32 Map_GetLayerIndex(const char* pacName, const Map* pstMap)
+{
+    for (Uint16 u16Layer = 0; u16Layer < pstMap->u16LayerCount; u16Layer++)
+    {
+        if (0 == SDL_strncmp(pacName, pstMap->pstLayer[u16Layer].acName, LAYER_NAME_LEN))
+        {
+            return u16Layer;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * @brief   Get object count
+ * @details Return total object count of map
+ * @param   pstMap
+ *          Pointer to map handle
+ * @return  Number of objects in the map
+ */
+Uint32 Map_GetObjectCount(const Map* pstMap)
+{
+    return pstMap->stObjects.u32Count;
 }
 
 /**
  * @brief   Get object name
  * @details Get name of an object
- * @param   pstObject
- *          Pointer to object handle
+ * @param   u32Index
+ *          Object index
+ * @param   pstMap
+ *          Pointer to map handle
  * @return  The object name as a string
  */
-char* Map_GetObjectName(Object* pstObject)
+const char* Map_GetObjectName(const Uint32 u32Index, const Map* pstMap)
+{
+    return &pstMap->stObjects.pacStringPool[pstMap->stObjects.pu32Name[u32Index]];
+}
+
+/**
+ * @brief   Get objects of type
+ * @details Get the indices of all objects of a specific type
+ * @param   u16TypeId
+ *          Object type ID, see Map_GetObjectTypeId()
+ * @param   ppu32Index
+ *          Pointer to store the address of the object index array
+ * @param   pstMap
+ *          Pointer to map handle
+ * @return  Number of objects of the specific type
+ */
+Uint32 Map_GetObjectsOfType(const Uint16 u16TypeId, const Uint32** ppu32Index, const Map* pstMap)
 {
-    return pstObject->acName;
+    const ObjectStore* pstStore = &pstMap->stObjects;
+
+    if (u16TypeId >= pstStore->u16TypeCount)
+    {
+        *ppu32Index = NULL;
+        return 0;
+    }
+
+    *ppu32Index = &pstStore->pu32TypeBucket[pstStore->pu32TypeStart[u16TypeId]];
+
+    return pstStore->pu32TypeStart[u16TypeId + 1] - pstStore->pu32TypeStart[u16TypeId];
 }
 
 /**
  * @brief   Get object type
  * @details Get type of an object
- * @param   pstObject
- *          Pointer to object handle
+ * @param   u32Index
+ *          Object index
+ * @param   pstMap
+ *          Pointer to map handle
  * @return  The object type as a string
  */
-char* Map_GetObjectType(Object* pstObject)
+const char* Map_GetObjectType(const Uint32 u32Index, const Map* pstMap)
+{
+    const ObjectStore* pstStore = &pstMap->stObjects;
+
+    return &pstStore->pacStringPool[pstStore->pu32TypeName[pstStore->pu16Type[u32Index]]];
+}
+
+/**
+ * @brief   Get object type ID
+ * @details Resolves an object type name to its type ID
+ * @param   pacType
+ *          Name of the object type
+ * @param   pstMap
+ *          Pointer to map handle
+ * @return  Object type ID
+ * @retval  -1: Object type does not occur on the map
+ * @remark  Resolve the ID once and pass it to Map_IsObjectOfTypeId()
+ *          or Map_GetObjectsOfType() in hot code paths
+ */
+Sint32 Map_GetObjectTypeId(const char* pacType, const Map* pstMap)
+{
+    const ObjectStore* pstStore = &pstMap->stObjects;
+
+    for (Uint16 u16TypeId = 0; u16TypeId < pstStore->u16TypeCount; u16TypeId++)
+    {
+        if (0 == SDL_strcmp(pacType, &pstStore->pacStringPool[pstStore->pu32TypeName[u16TypeId]]))
+        {
+            return u16TypeId;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * @brief   Get property
+ * @details Looks up a custom property of the map, a layer, a tile or
+ *          an object in constant time
+ * @param   eOwner
+ *          Kind of owner, see PropertyOwner
+ * @param   u32Index
+ *          Owner index: 0 for the map, the layer index, the GID or the
+ *          object index
+ * @param   stKey
+ *          Property key, see Map_GetPropertyKey()
+ * @param   pstMap
+ *          Pointer to map handle
+ * @return  Pointer to property, NULL if the owner has no such property
+ * @remark  Hash the property name once and keep the hash for hot code
+ *          paths, e.g. a damage or friction lookup per tile
+ */
+const MapProperty* Map_GetProperty(
+    const PropertyOwner  eOwner,
+    const Uint32         u32Index,
+    const MapPropertyKey stKey,
+    const Map*           pstMap)
+{
+    const MapProperty* pstProperty;
+
+    if (!pstMap->pstProperty)
+    {
+        return NULL;
+    }
+
+    pstProperty = _FindProperty(_GetPropertyOwner(eOwner, u32Index), stKey, pstMap);
+    if (PROPERTY_NONE == pstProperty->u8Type)
+    {
+        return NULL;
+    }
+
+    return pstProperty;
+}
+
+/**
+ * @brief   Get boolean property
+ * @details Looks up a custom property and returns it as boolean
+ * @param   eOwner
+ *          Kind of owner, see PropertyOwner
+ * @param   u32Index
+ *          Owner index, see Map_GetProperty()
+ * @param   stKey
+ *          Property key, see Map_GetPropertyKey()
+ * @param   bDefault
+ *          Value returned if the property does not exist or is not
+ *          numeric
+ * @param   pstMap
+ *          Pointer to map handle
+ * @return  Property value
+ */
+SDL_bool Map_GetPropertyBool(
+    const PropertyOwner  eOwner,
+    const Uint32         u32Index,
+    const MapPropertyKey stKey,
+    const SDL_bool       bDefault,
+    const Map*           pstMap)
+{
+    const MapProperty* pstProperty = Map_GetProperty(eOwner, u32Index, stKey, pstMap);
+
+    if (!pstProperty || PROPERTY_STRING == pstProperty->u8Type ||
+        PROPERTY_FILE == pstProperty->u8Type)
+    {
+        return bDefault;
+    }
+
+    return (0 != pstProperty->dValue) ? SDL_TRUE : SDL_FALSE;
+}
+
+/**
+ * @brief   Get floating point property
+ * @details Looks up a custom property and returns it as floating point
+ *          number
+ * @param   eOwner
+ *          Kind of owner, see PropertyOwner
+ * @param   u32Index
+ *          Owner index, see Map_GetProperty()
+ * @param   stKey
+ *          Property key, see Map_GetPropertyKey()
+ * @param   dDefault
+ *          Value returned if the property does not exist or is not
+ *          numeric
+ * @param   pstMap
+ *          Pointer to map handle
+ * @return  Property value
+ */
+double Map_GetPropertyFloat(
+    const PropertyOwner  eOwner,
+    const Uint32         u32Index,
+    const MapPropertyKey stKey,
+    const double         dDefault,
+    const Map*           pstMap)
+{
+    const MapProperty* pstProperty = Map_GetProperty(eOwner, u32Index, stKey, pstMap);
+
+    if (!pstProperty || PROPERTY_STRING == pstProperty->u8Type ||
+        PROPERTY_FILE == pstProperty->u8Type)
+    {
+        return dDefault;
+    }
+
+    return pstProperty->dValue;
+}
+
+/**
+ * @brief   Get integer property
+ * @details Looks up a custom property and returns it as integer;
+ *          floating point values are truncated
+ * @param   eOwner
+ *          Kind of owner, see PropertyOwner
+ * @param   u32Index
+ *          Owner index, see Map_GetProperty()
+ * @param   stKey
+ *          Property key, see Map_GetPropertyKey()
+ * @param   s32Default
+ *          Value returned if the property does not exist or is not
+ *          numeric
+ * @param   pstMap
+ *          Pointer to map handle
+ * @return  Property value
+ */
+Sint32 Map_GetPropertyInt(
+    const PropertyOwner  eOwner,
+    const Uint32         u32Index,
+    const MapPropertyKey stKey,
+    const Sint32         s32Default,
+    const Map*           pstMap)
+{
+    const MapProperty* pstProperty = Map_GetProperty(eOwner, u32Index, stKey, pstMap);
+
+    if (!pstProperty || PROPERTY_STRING == pstProperty->u8Type ||
+        PROPERTY_FILE == pstProperty->u8Type)
+    {
+        return s32Default;
+    }
+
+    // Colours exceed the range of Sint32; keep their bit pattern.
+    if (PROPERTY_COLOUR == pstProperty->u8Type)
+    {
+        return (Sint32)(Uint32)pstProperty->dValue;
+    }
+
+    return (Sint32)pstProperty->dValue;
+}
+
+/**
+ * @brief   Get property key
+ * @details Hashes a property name for use with Map_GetProperty() and
+ *          its typed variants
+ * @param   pacName
+ *          Property name; the key refers to it, so it has to outlive
+ *          the key, e.g. a string literal
+ * @return  Property key
+ */
+MapPropertyKey Map_GetPropertyKey(const char* pacName)
+{
+    MapPropertyKey stKey;
+
+    stKey.pacName = pacName;
+    stKey.u32Hash = _HashString(pacName);
+
+    return stKey;
+}
+
+/**
+ * @brief   Get string property
+ * @details Looks up a custom string or file property
+ * @param   eOwner
+ *          Kind of owner, see PropertyOwner
+ * @param   u32Index
+ *          Owner index, see Map_GetProperty()
+ * @param   stKey
+ *          Property key, see Map_GetPropertyKey()
+ * @param   pacDefault
+ *          Value returned if the property does not exist or is not a
+ *          string or file property
+ * @param   pstMap
+ *          Pointer to map handle
+ * @return  Property value, valid as long as the map is loaded
+ */
+const char* Map_GetPropertyString(
+    const PropertyOwner  eOwner,
+    const Uint32         u32Index,
+    const MapPropertyKey stKey,
+    const char*          pacDefault,
+    const Map*           pstMap)
+{
+    const MapProperty* pstProperty = Map_GetProperty(eOwner, u32Index, stKey, pstMap);
+
+    if (!pstProperty ||
+        (PROPERTY_STRING != pstProperty->u8Type && PROPERTY_FILE != pstProperty->u8Type))
+    {
+        return pacDefault;
+    }
+
+    return &pstMap->pacPropertyPool[pstProperty->u32String];
+}
+
+/**
+ * @brief   Get tile
+ * @details Get the GID of a tile
+ * @param   u16Layer
+ *          Layer index, see Map_GetLayerIndex()
+ * @param   u32PosX
+ *          Position along the x-axis in tiles
+ * @param   u32PosY
+ *          Position along the y-axis in tiles
+ * @param   pstMap
+ *          Pointer to map handle
+ * @return  GID of the tile, 0 if empty or out of range
+ */
+Uint32 Map_GetTile(
+    const Uint16 u16Layer,
+    const Uint32 u32PosX,
+    const Uint32 u32PosY,
+    const Map*   pstMap)
+{
+    if (u16Layer >= pstMap->u16LayerCount || u32PosX >= pstMap->u32Columns ||
+        u32PosY >= pstMap->u32Rows)
+    {
+        return 0;
+    }
+
+    return _GetGid(u32PosX, u32PosY, &pstMap->pstLayer[u16Layer]);
+}
+
+/**
+ * @brief   Get tile type ID
+ * @details Resolves a tile type name to the ID it has been interned
+ *          with when loading the map
+ * @param   pacType
+ *          Name of the tile type
+ * @param   pstMap
+ *          Pointer to map handle
+ * @return  Tile type ID
+ * @retval  -1: Tile type does not occur on the map
+ * @remark  Resolve the ID once and pass it to Map_IsCoordOfTypeId()
+ *          or Map_IsOnTileOfTypeId() in hot code paths
+ */
+Sint8 Map_GetTypeId(const char* pacType, const Map* pstMap)
+{
+    for (Uint8 u8TypeId = 0; u8TypeId < pstMap->u8TypeCount; u8TypeId++)
+    {
+        if (0 == SDL_strncmp(pacType, pstMap->acTypeName[u8TypeId], TILE_TYPE_LEN))
+        {
+            return u8TypeId;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * @brief   Get tile type mask
+ * @details Resolves a tile type name to its bit in the tile type grid
+ * @param   pacType
+ *          Name of the tile type
+ * @param   pstMap
+ *          Pointer to map handle
+ * @return  Tile type mask, 0 if the tile type does not occur on the map
+ * @remark  Masks of several types can be combined, e.g. to pass all
+ *          solid tile types to Map_SweepBox()
+ */
+Uint32 Map_GetTypeMask(const char* pacType, const Map* pstMap)
 {
-    return pstObject->acType;
+    Sint8 s8TypeId = Map_GetTypeId(pacType, pstMap);
+
+    if (-1 == s8TypeId)
+    {
+        return 0;
+    }
+
+    return 1u << s8TypeId;
 }
 
 /**
@@ -493,60 +3913,429 @@ Sint8 Map_Init(
     const Uint8 u8MeterInPixel,
     Map**       pstMap)
 {
-    Uint32 u32Size = sizeof(struct Map_t) + TS_IMG_PATH_LEN;
+    Sint8 s8ReturnValue = -1;
+
+    *pstMap = SDL_calloc(sizeof(struct Map_t), sizeof(Sint8));
+    if (!*pstMap)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InitMap(): error allocating memory.\n");
+        return -1;
+    }
+
+    if (-1 == _LoadTmx(pacFileName, *pstMap))
+    {
+        goto exit;
+    }
+
+    (*pstMap)->u32Columns    = (*pstMap)->pstTmxMap->width;
+    (*pstMap)->u32Rows       = (*pstMap)->pstTmxMap->height;
+    (*pstMap)->u16TileWidth  = (*pstMap)->pstTmxMap->tile_width;
+    (*pstMap)->u16TileHeight = (*pstMap)->pstTmxMap->tile_height;
+    (*pstMap)->u32BgColour   = (*pstMap)->pstTmxMap->backgroundcolor;
+
+    if (-1 == _LoadLayers(*pstMap))
+    {
+        goto exit;
+    }
+
+    if (-1 == _LoadObjects(*pstMap))
+    {
+        goto exit;
+    }
+
+    if (-1 == _BuildObjectIndex(*pstMap))
+    {
+        goto exit;
+    }
+
+    if (-1 == _LoadProperties(*pstMap))
+    {
+        goto exit;
+    }
+
+    (*pstMap)->dTmxGravitation = Map_GetPropertyFloat(
+        PROPERTY_OF_MAP, 0, Map_GetPropertyKey("Gravitation"), 0.f, *pstMap);
+    #ifdef DEBUG
+    Map_ShowObjects(*pstMap);
+    #endif
+
+    if (-1 == _LoadTilesets(pacFileName, pacTilesetImage, *pstMap))
+    {
+        goto exit;
+    }
+    _UpdateTileExtents(*pstMap);
+
+    if (-1 == _BakeTypeGrid(*pstMap))
+    {
+        goto exit;
+    }
+
+    if (-1 == _LoadAnimTiles(*pstMap))
+    {
+        goto exit;
+    }
+
+    // All data has been converted, the TMX map is no longer needed.
+    tmx_map_free((*pstMap)->pstTmxMap);
+    (*pstMap)->pstTmxMap = NULL;
+
+    (*pstMap)->u32Height      = (*pstMap)->u32Rows * (*pstMap)->u16TileHeight;
+    (*pstMap)->u32Width       = (*pstMap)->u32Columns * (*pstMap)->u16TileWidth;
+    (*pstMap)->u8MeterInPixel = u8MeterInPixel;
+    (*pstMap)->dAnimSpeed     = 6.25f;
+
+    for (Uint8 u8Index = 0; u8Index < MAP_TEXTURES; u8Index++)
+    {
+        (*pstMap)->pstTexture[u8Index] = NULL;
+    }
+
+    SDL_Log(
+        "Load TMX map file: %s containing %u object(s).\n",
+        pacFileName,
+        (*pstMap)->stObjects.u32Count);
+    Map_SetGravitation(0, 1, *pstMap);
+    s8ReturnValue = 0;
+
+exit:
+    if (-1 == s8ReturnValue)
+    {
+        Map_Free(*pstMap);
+        *pstMap = NULL;
+    }
+
+    return s8ReturnValue;
+}
+
+/**
+ * @brief   Initialise map asynchronously
+ * @details Loads a map as background job of the default job pool
+ *          while the current map keeps running, see
+ *          Job_SubmitBackground().  All CPU-side work, including
+ *          decoding the tileset images and composing the atlas, is done
+ *          by the worker threads; Map_FinalizeAsync() only uploads the
+ *          atlas.
+ * @param   pacFileName
+ *          Path and filename of the TMX map to load
+ * @param   pacTilesetImage
+ *          Path and filename of the tileset image, may be NULL
+ * @param   pacBakedFile
+ *          Path and filename of the baked map, may be NULL.  If set,
+ *          the baked map is used if it is up to date; otherwise the
+ *          TMX map is loaded and baked to this file.
+ * @param   u8MeterInPixel
+ *          Definition of meter in pixel
+ * @param   pstLoader
+ *          Pointer to map loader handle
+ * @return  Error code
+ * @retval  0:  OK
+ * @retval  -1: Error
+ * @remark  Without a default job pool, the map is loaded right away.
+ */
+Sint8 Map_InitAsync(
+    const char* pacFileName,
+    const char* pacTilesetImage,
+    const char* pacBakedFile,
+    const Uint8 u8MeterInPixel,
+    MapLoader** pstLoader)
+{
+    *pstLoader = SDL_calloc(sizeof(struct MapLoader_t), sizeof(Sint8));
+    if (!*pstLoader)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InitMapAsync(): error allocating memory.\n");
+        return -1;
+    }
+
+    SDL_strlcpy((*pstLoader)->acFileName, pacFileName, MAP_PATH_LEN);
+
+    if (pacTilesetImage)
+    {
+        SDL_strlcpy((*pstLoader)->acTilesetImage, pacTilesetImage, TS_IMG_PATH_LEN);
+    }
+
+    if (pacBakedFile)
+    {
+        SDL_strlcpy((*pstLoader)->acBakedFile, pacBakedFile, MAP_PATH_LEN);
+    }
+
+    (*pstLoader)->u8MeterInPixel = u8MeterInPixel;
+    (*pstLoader)->pstPool        = Job_GetDefaultPool();
+    SDL_AtomicSet(&(*pstLoader)->stState, MAP_LOAD_PENDING);
+
+    Job_SubmitBackground(_LoadAsync, *pstLoader, &(*pstLoader)->stJob, (*pstLoader)->pstPool);
+
+    return 0;
+}
+
+/**
+ * @brief   Initialise map from baked map
+ * @details Initialises/loads a map written by Map_Bake().  The file is
+ *          memory-mapped and its content used in place; no XML is
+ *          parsed.
+ * @param   pacFileName
+ *          Path and filename of the baked map to load
+ * @param   pacSourceFile
+ *          Path and filename of the TMX map the baked map has been
+ *          created from; if set, the baked map is rejected when the
+ *          TMX map has been modified since.  May be NULL.
+ * @param   u8MeterInPixel
+ *          Definition of meter in pixel
+ * @param   pstMap
+ *          Pointer to map handle
+ * @return  Error code
+ * @retval  0:  OK
+ * @retval  -1: Error, e.g. the baked map is missing, out of date or
+ *          has been written by an incompatible build
+ * @remark  On error, fall back to Map_Init() and re-bake the map using
+ *          Map_Bake().  The hash only covers the TMX file itself, not
+ *          external tilesets or images.
+ */
+Sint8 Map_InitFromBaked(
+    const char* pacFileName,
+    const char* pacSourceFile,
+    const Uint8 u8MeterInPixel,
+    Map**       pstMap)
+{
+    const BakedMapHeader* pstHeader;
+    ObjectStore*          pstStore;
+    Uint64                au64Size[BAKED_SECTIONS];
+    Uint32*               pu32RowStart;
+    MapRun*               pstRun;
+    Uint32*               pu32Gid;
+    Uint32                u32RunCount   = 0;
+    Uint32                u32GidCount   = 0;
+    Uint16                u16Restored   = 0;
+    Sint8                 s8ReturnValue = -1;
+
+    *pstMap = SDL_calloc(sizeof(struct Map_t), sizeof(Sint8));
+    if (!*pstMap)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InitMap(): error allocating memory.\n");
+        return -1;
+    }
+
+    if (-1 == Utils_MapFile(pacFileName, &(*pstMap)->stBaked))
+    {
+        goto exit;
+    }
+
+    pstHeader = (*pstMap)->stBaked.pData;
+    pstStore  = &(*pstMap)->stObjects;
+
+    if ((*pstMap)->stBaked.zSize < sizeof(struct BakedMapHeader_t) ||
+        0 != SDL_memcmp(pstHeader->acMagic, "ESZM", sizeof(pstHeader->acMagic)) ||
+        BAKED_VERSION != pstHeader->u32Version || _GetLayoutKey() != pstHeader->u32LayoutKey)
+    {
+        SDL_LogError(
+            SDL_LOG_CATEGORY_APPLICATION,
+            "InitMap(): %s is not a compatible baked map.\n",
+            pacFileName);
+        goto exit;
+    }
+
+    if (pacSourceFile)
+    {
+        if (-1 == _HashFile(pacSourceFile, &(*pstMap)->u32SourceHash))
+        {
+            goto exit;
+        }
+
+        if ((*pstMap)->u32SourceHash != pstHeader->u32SourceHash)
+        {
+            SDL_LogError(
+                SDL_LOG_CATEGORY_APPLICATION,
+                "InitMap(): %s is out of date.\n",
+                pacFileName);
+            goto exit;
+        }
+    }
 
-    *pstMap = SDL_calloc(u32Size, sizeof(Sint8));
-    if (!*pstMap)
+    // Tile sizes are used as divisors, and the sizes below are derived
+    // from the cell counts, which have to fit in 32 bits.
+    if (0 == pstHeader->u16TileWidth || 0 == pstHeader->u16TileHeight ||
+        (Uint64)pstHeader->u32Columns * pstHeader->u32Rows > SDL_MAX_UINT32 ||
+        (Uint64)pstHeader->u32GridWidth * pstHeader->u32GridHeight >= SDL_MAX_UINT32)
     {
-        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InitMap(): error allocating memory.\n");
-        return -1;
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InitMap(): %s is corrupt.\n", pacFileName);
+        goto exit;
     }
 
-    (*pstMap)->pstTmxMap = tmx_load(pacFileName);
-    if (!(*pstMap)->pstTmxMap)
+    (*pstMap)->u32SourceHash       = pstHeader->u32SourceHash;
+    (*pstMap)->u32Columns          = pstHeader->u32Columns;
+    (*pstMap)->u32Rows             = pstHeader->u32Rows;
+    (*pstMap)->u16TileWidth        = pstHeader->u16TileWidth;
+    (*pstMap)->u16TileHeight       = pstHeader->u16TileHeight;
+    (*pstMap)->u32BgColour         = pstHeader->u32BgColour;
+    (*pstMap)->dTmxGravitation     = pstHeader->dTmxGravitation;
+    (*pstMap)->u16LayerCount       = pstHeader->u16LayerCount;
+    (*pstMap)->u16TilesetCount     = pstHeader->u16TilesetCount;
+    (*pstMap)->u32TileInfoCount    = pstHeader->u32TileInfoCount;
+    (*pstMap)->u32AnimTileCount    = pstHeader->u32AnimTileCount;
+    (*pstMap)->u32AnimFrameCount   = pstHeader->u32AnimFrameCount;
+    (*pstMap)->u8TypeCount         = SDL_min(pstHeader->u8TypeCount, TILE_TYPE_MAX);
+    (*pstMap)->u8AtlasCount        = SDL_min(pstHeader->u8AtlasCount, ATLAS_PAGES_MAX);
+    pstStore->u16TypeCount         = pstHeader->u16ObjectTypeCount;
+    pstStore->u32Count             = pstHeader->u32ObjectCount;
+    pstStore->u32StringPoolSize    = pstHeader->u32StringPoolSize;
+    pstStore->u32GridWidth         = pstHeader->u32GridWidth;
+    pstStore->u32GridHeight        = pstHeader->u32GridHeight;
+    (*pstMap)->u32PropertySize     = pstHeader->u32PropertySize;
+    (*pstMap)->u32PropertyPoolSize = pstHeader->u32PropertyPoolSize;
+
+    for (Uint8 u8Page = 0; u8Page < (*pstMap)->u8AtlasCount; u8Page++)
     {
-        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", tmx_strerr());
-        return -1;
+        (*pstMap)->astAtlas[u8Page].u16Width  = pstHeader->au16AtlasWidth[u8Page];
+        (*pstMap)->astAtlas[u8Page].u16Height = pstHeader->au16AtlasHeight[u8Page];
+    }
+
+    // Verify that every section has the size implied by the header
+    // and lies within the file.
+    _GetBakedSizes(pstHeader, au64Size, *pstMap);
+    for (Uint8 u8Section = 0; u8Section < BAKED_SECTIONS; u8Section++)
+    {
+        Uint32 u32Offset = pstHeader->au32Offset[u8Section];
+
+        if (au64Size[u8Section] != pstHeader->au32Size[u8Section] || (u32Offset & 7) ||
+            u32Offset > (*pstMap)->stBaked.zSize ||
+            au64Size[u8Section] > (*pstMap)->stBaked.zSize - u32Offset)
+        {
+            SDL_LogError(
+                SDL_LOG_CATEGORY_APPLICATION, "InitMap(): %s is corrupt.\n", pacFileName);
+            goto exit;
+        }
+    }
+
+    (*pstMap)->pstLayer        = _GetBakedSection(BAKED_LAYERS, pstHeader, *pstMap);
+    (*pstMap)->pstTileset      = _GetBakedSection(BAKED_TILESETS, pstHeader, *pstMap);
+    (*pstMap)->pstTileInfo     = _GetBakedSection(BAKED_TILE_INFO, pstHeader, *pstMap);
+    (*pstMap)->pstAnimTile     = _GetBakedSection(BAKED_ANIM_TILES, pstHeader, *pstMap);
+    (*pstMap)->pstAnimFrame    = _GetBakedSection(BAKED_ANIM_FRAMES, pstHeader, *pstMap);
+    (*pstMap)->pu32TypeGrid    = _GetBakedSection(BAKED_TYPE_GRID, pstHeader, *pstMap);
+    pstStore->pu32Id           = _GetBakedSection(BAKED_OBJECT_ID, pstHeader, *pstMap);
+    pstStore->ps32PosX         = _GetBakedSection(BAKED_OBJECT_POS_X, pstHeader, *pstMap);
+    pstStore->ps32PosY         = _GetBakedSection(BAKED_OBJECT_POS_Y, pstHeader, *pstMap);
+    pstStore->pu32Width        = _GetBakedSection(BAKED_OBJECT_WIDTH, pstHeader, *pstMap);
+    pstStore->pu32Height       = _GetBakedSection(BAKED_OBJECT_HEIGHT, pstHeader, *pstMap);
+    pstStore->pstBB            = _GetBakedSection(BAKED_OBJECT_BB, pstHeader, *pstMap);
+    pstStore->pu32Name         = _GetBakedSection(BAKED_OBJECT_NAME, pstHeader, *pstMap);
+    pstStore->pu16Type         = _GetBakedSection(BAKED_OBJECT_TYPE, pstHeader, *pstMap);
+    pstStore->pu32TypeName     = _GetBakedSection(BAKED_OBJECT_TYPE_NAME, pstHeader, *pstMap);
+    pstStore->pu32TypeStart    = _GetBakedSection(BAKED_OBJECT_TYPE_START, pstHeader, *pstMap);
+    pstStore->pu32TypeBucket   = _GetBakedSection(BAKED_OBJECT_BUCKET, pstHeader, *pstMap);
+    pstStore->pacStringPool    = _GetBakedSection(BAKED_STRING_POOL, pstHeader, *pstMap);
+    pstStore->pu32CellStart    = _GetBakedSection(BAKED_CELL_START, pstHeader, *pstMap);
+    pstStore->pu32CellObject   = _GetBakedSection(BAKED_CELL_OBJECT, pstHeader, *pstMap);
+    (*pstMap)->pstProperty     = _GetBakedSection(BAKED_PROPERTIES, pstHeader, *pstMap);
+    (*pstMap)->pacPropertyPool = _GetBakedSection(BAKED_PROPERTY_POOL, pstHeader, *pstMap);
+
+    // Indices are used unchecked later on; make sure they stay within
+    // the tables they refer to.
+    if (-1 == _CheckProperties(*pstMap) || -1 == _CheckTiles(*pstMap) ||
+        -1 == _CheckObjects(pstHeader->u32CellObjectCount, *pstMap))
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InitMap(): %s is corrupt.\n", pacFileName);
+        goto exit;
     }
 
-    (*pstMap)->u16ObjectCount = Map_GetObjectCount(*pstMap);
+    SDL_memcpy(
+        (*pstMap)->acTypeName,
+        _GetBakedSection(BAKED_TYPE_NAMES, pstHeader, *pstMap),
+        sizeof((*pstMap)->acTypeName));
+
+    for (Uint8 u8TypeId = 0; u8TypeId < (*pstMap)->u8TypeCount; u8TypeId++)
+    {
+        if ('\0' != (*pstMap)->acTypeName[u8TypeId][TILE_TYPE_LEN - 1])
+        {
+            SDL_LogError(
+                SDL_LOG_CATEGORY_APPLICATION, "InitMap(): %s is corrupt.\n", pacFileName);
+            goto exit;
+        }
+    }
 
-    if ((*pstMap)->u16ObjectCount > 0)
+    // Restore the layer pointers, which are meaningless on disk, and
+    // make sure all runs lie within the map.
+    pu32RowStart = _GetBakedSection(BAKED_ROW_START, pstHeader, *pstMap);
+    pstRun       = _GetBakedSection(BAKED_RUNS, pstHeader, *pstMap);
+    pu32Gid      = _GetBakedSection(BAKED_GIDS, pstHeader, *pstMap);
+    for (Uint16 u16Layer = 0; u16Layer < (*pstMap)->u16LayerCount; u16Layer++)
     {
-        u32Size = u32Size + ((*pstMap)->u16ObjectCount * sizeof(struct Object_t));
-        *pstMap = SDL_realloc(*pstMap, u32Size);
+        MapLayer* pstLayer = &(*pstMap)->pstLayer[u16Layer];
 
-        if (!*pstMap)
+        if (pstLayer->u32RunCount > pstHeader->u32RunCount - u32RunCount ||
+            pstLayer->u32GidCount > pstHeader->u32GidCount - u32GidCount)
         {
-            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InitMap(): error re-allocating memory.\n");
-            return -1;
+            SDL_LogError(
+                SDL_LOG_CATEGORY_APPLICATION, "InitMap(): %s is corrupt.\n", pacFileName);
+            goto exit;
+        }
+
+        pstLayer->pu32RowStart = &pu32RowStart[u16Layer * ((*pstMap)->u32Rows + 1)];
+        pstLayer->pstRun       = pstRun ? &pstRun[u32RunCount] : NULL;
+        pstLayer->pu32Gid      = pu32Gid ? &pu32Gid[u32GidCount] : NULL;
+        pstLayer->u32RunSize   = pstLayer->u32RunCount;
+        pstLayer->u32GidSize   = pstLayer->u32GidCount;
+        u32RunCount += pstLayer->u32RunCount;
+        u32GidCount += pstLayer->u32GidCount;
+        u16Restored++;
+
+        if (-1 == _CheckLayer(pstLayer, *pstMap))
+        {
+            SDL_LogError(
+                SDL_LOG_CATEGORY_APPLICATION, "InitMap(): %s is corrupt.\n", pacFileName);
+            goto exit;
         }
+    }
 
-        Map_GetObjects((*pstMap), (*pstMap)->astObject);
-        #ifdef DEBUG
-        Map_ShowMapObjects(*pstMap);
-        #endif
+    for (Uint32 u32Index = 0; u32Index < (*pstMap)->u32AnimTileCount; u32Index++)
+    {
+        (*pstMap)->pstAnimTile[u32Index].u16Frame   = 0;
+        (*pstMap)->pstAnimTile[u32Index].dFrameTime = 0.f;
     }
+    _UpdateTileExtents(*pstMap);
 
-    (*pstMap)->u16Height      = (*pstMap)->pstTmxMap->height * (*pstMap)->pstTmxMap->tile_height;
-    (*pstMap)->u16Width       = (*pstMap)->pstTmxMap->width * (*pstMap)->pstTmxMap->tile_width;
+    (*pstMap)->u32Height      = (*pstMap)->u32Rows * (*pstMap)->u16TileHeight;
+    (*pstMap)->u32Width       = (*pstMap)->u32Columns * (*pstMap)->u16TileWidth;
     (*pstMap)->u8MeterInPixel = u8MeterInPixel;
     (*pstMap)->dAnimSpeed     = 6.25f;
 
-    SDL_strlcat((*pstMap)->acTilesetImage, pacTilesetImage, TS_IMG_PATH_LEN - 1);
+    SDL_Log(
+        "Load baked map file: %s containing %u object(s).\n",
+        pacFileName,
+        pstStore->u32Count);
+    Map_SetGravitation(0, 1, *pstMap);
+    s8ReturnValue = 0;
 
-    for (Uint8 u8Index = 0; u8Index < MAP_TEXTURES; u8Index++)
+exit:
+    if (-1 == s8ReturnValue)
     {
-        (*pstMap)->pstTexture[u8Index] = NULL;
+        // Layers that have not been restored still hold the pointers
+        // read from disk, which must not be freed.
+        (*pstMap)->u16LayerCount = u16Restored;
+        Map_Free(*pstMap);
+        *pstMap = NULL;
     }
-    (*pstMap)->pstAnimTexture = NULL;
-    (*pstMap)->pstTileset     = NULL;
 
-    SDL_Log(
-        "Load TMX map file: %s containing %d object(s).\n", pacFileName, (*pstMap)->u16ObjectCount);
-    Map_SetGravitation(0, 1, *pstMap);
+    return s8ReturnValue;
+}
 
-    return 0;
+/**
+ * @brief   Check if asynchronous map load is done
+ * @details Checks whether a map load started with Map_InitAsync() has
+ *          completed, successfully or not
+ * @param   pstLoader
+ *          Pointer to map loader handle
+ * @return  Boolean state
+ * @retval  SDL_TRUE: Map_FinalizeAsync() can be called without
+ *          blocking
+ * @retval  SDL_FALSE: Map is still being loaded
+ */
+SDL_bool Map_IsAsyncDone(const MapLoader* pstLoader)
+{
+    if (MAP_LOAD_PENDING == SDL_AtomicGet((SDL_atomic_t*)&pstLoader->stState))
+    {
+        return SDL_FALSE;
+    }
+
+    return SDL_TRUE;
 }
 
 /**
@@ -566,47 +4355,61 @@ Sint8 Map_Init(
  */
 SDL_bool Map_IsCoordOfType(const char* pacType, const Map* pstMap, double dPosX, double dPosY)
 {
-    tmx_layer* pstLayers;
-    dPosX /= (double)pstMap->pstTmxMap->tile_width;
-    dPosY /= (double)pstMap->pstTmxMap->tile_height;
+    Sint8 s8TypeId = Map_GetTypeId(pacType, pstMap);
 
-    // Set boundaries to prevent segfault.
-    if ((dPosX < 0.0) || (dPosY < 0.0) || (dPosX > (double)pstMap->pstTmxMap->width) ||
-        (dPosY > (double)pstMap->pstTmxMap->height))
+    if (-1 == s8TypeId)
     {
         return SDL_FALSE;
     }
 
-    pstLayers = pstMap->pstTmxMap->ly_head;
-    while (pstLayers)
-    {
-        if (pstLayers->type != L_LAYER)
-        {
-            pstLayers = pstLayers->next;
-            continue;
-        }
+    return Map_IsCoordOfTypeId(s8TypeId, pstMap, dPosX, dPosY);
+}
+
+/**
+ * @brief   Check if map coordinate is of specific type ID
+ * @details Checks if a coodinate is of a specific type using the
+ *          per-cell tile type grid
+ * @param   u8TypeId
+ *          ID of the type to check for, see Map_GetTypeId()
+ * @param   pstMap
+ *          Pointer to map handle
+ * @param   dPosX
+ *          Coordinate along the x-axis
+ * @param   dPosY
+ *          Coordinate along the y-axis
+ * @return  Boolean state
+ * @retval  SDL_TRUE: Map coordinate is of specific type
+ * @retval  SDL_FALSE: Map coordinate is not of specific type
+ */
+SDL_bool Map_IsCoordOfTypeId(
+    const Uint8  u8TypeId,
+    const Map*   pstMap,
+    const double dPosX,
+    const double dPosY)
+{
+    double dCellX = dPosX / (double)pstMap->u16TileWidth;
+    double dCellY = dPosY / (double)pstMap->u16TileHeight;
+    Uint32 u32Cell;
 
-        Uint16 u16Gid = _ClearGidFlags(
-            pstLayers->content.gids[((int32_t)dPosY * pstMap->pstTmxMap->width) + (int32_t)dPosX]);
+    // Unknown types have no bit in the grid; shifting by them would be
+    // undefined.
+    if (u8TypeId >= TILE_TYPE_MAX || u8TypeId >= pstMap->u8TypeCount)
+    {
+        return SDL_FALSE;
+    }
 
-        if (0 == u16Gid)
-        {
-            pstLayers = pstLayers->next;
-            continue;
-        }
+    // Set boundaries to prevent segfault.
+    if ((dCellX < 0.0) || (dCellY < 0.0) || (dCellX >= (double)pstMap->u32Columns) ||
+        (dCellY >= (double)pstMap->u32Rows))
+    {
+        return SDL_FALSE;
+    }
 
-        if (pstMap->pstTmxMap->tiles[u16Gid])
-        {
-            if (pstMap->pstTmxMap->tiles[u16Gid]->type)
-            {
-                if (0 == SDL_strncmp(pacType, pstMap->pstTmxMap->tiles[u16Gid]->type, 20))
-                {
-                    return SDL_TRUE;
-                }
-            }
-        }
+    u32Cell = ((Uint32)dCellY * pstMap->u32Columns) + (Uint32)dCellX;
 
-        pstLayers = pstLayers->next;
+    if ((pstMap->pu32TypeGrid[u32Cell] >> u8TypeId) & 1)
+    {
+        return SDL_TRUE;
     }
 
     return SDL_FALSE;
@@ -617,15 +4420,42 @@ SDL_bool Map_IsCoordOfType(const char* pacType, const Map* pstMap, double dPosX,
  * @details Determines if an object is of a specific type
  * @param   pacType
  *          The type name to check for
- * @param   pstObject
- *          Pointer to object handle
+ * @param   u32Index
+ *          Object index
+ * @param   pstMap
+ *          Pointer to map handle
+ * @return  Boolean state
+ * @retval  SDL_TRUE: Object is of specific type
+ * @retval  SDL_FALSE: Object is not of specific type
+ */
+SDL_bool Map_IsObjectOfType(const char* pacType, const Uint32 u32Index, const Map* pstMap)
+{
+    if (0 == SDL_strcmp(pacType, Map_GetObjectType(u32Index, pstMap)))
+    {
+        return 1;
+    }
+    else
+    {
+        return 0;
+    }
+}
+
+/**
+ * @brief   Determine if object is of specific type ID
+ * @details Determines if an object is of a specific type ID
+ * @param   u16TypeId
+ *          The type ID to check for, see Map_GetObjectTypeId()
+ * @param   u32Index
+ *          Object index
+ * @param   pstMap
+ *          Pointer to map handle
  * @return  Boolean state
  * @retval  SDL_TRUE: Object is of specific type
  * @retval  SDL_FALSE: Object is not of specific type
  */
-SDL_bool Map_IsObjectOfType(const char* pacType, Object* pstObject)
+SDL_bool Map_IsObjectOfTypeId(const Uint16 u16TypeId, const Uint32 u32Index, const Map* pstMap)
 {
-    if (0 == SDL_strncmp(pacType, Map_GetObjectType(pstObject), OBJECT_TYPE_LEN))
+    if (u16TypeId == pstMap->stObjects.pu16Type[u32Index])
     {
         return 1;
     }
@@ -664,6 +4494,154 @@ SDL_bool Map_IsOnTileOfType(
     return Map_IsCoordOfType(pacType, pstMap, dPosX, dPosY + (double)(u8EntityHeight / 2.f));
 }
 
+/**
+ * @brief   Determine if entity/object is on-top of tile of specific
+ *          type ID
+ * @details Same as Map_IsOnTileOfType() but takes a type ID as
+ *          returned by Map_GetTypeId()
+ * @param   u8TypeId
+ *          The type ID to check for
+ * @param   dPosX
+ *          Position along the x-axis
+ * @param   dPosY
+ *          Position along the y-axis
+ * @param   u8EntityHeight
+ *          Height ob the entity/object in pixel
+ * @param   pstMap
+ *          Pointer to map handle
+ * @return  Boolean state
+ * @retval  SDL_TRUE: entity is on-top of tile of specific type
+ * @retval  SDL_FALSE: entity is not on-top of tile of specific type
+ */
+SDL_bool Map_IsOnTileOfTypeId(
+    const Uint8  u8TypeId,
+    const double dPosX,
+    const double dPosY,
+    const Uint8  u8EntityHeight,
+    const Map*   pstMap)
+{
+    return Map_IsCoordOfTypeId(u8TypeId, pstMap, dPosX, dPosY + (double)(u8EntityHeight / 2.f));
+}
+
+/**
+ * @brief   Query objects at point
+ * @details Determines all objects whose bounding box contains a point
+ * @param   dPosX
+ *          Position along the x-axis
+ * @param   dPosY
+ *          Position along the y-axis
+ * @param   pu32Result
+ *          Array to store the object indices
+ * @param   u32MaxResults
+ *          Capacity of the result array
+ * @param   pstMap
+ *          Pointer to map handle
+ * @return  Number of object indices stored
+ */
+Uint32 Map_QueryObjectsAtPoint(
+    const double dPosX,
+    const double dPosY,
+    Uint32*      pu32Result,
+    const Uint32 u32MaxResults,
+    const Map*   pstMap)
+{
+    AABB stPoint;
+
+    stPoint.dBottom = Scalar_FromDouble(dPosY);
+    stPoint.dLeft   = Scalar_FromDouble(dPosX);
+    stPoint.dRight  = Scalar_FromDouble(dPosX);
+    stPoint.dTop    = Scalar_FromDouble(dPosY);
+
+    return Map_QueryObjectsInRect(stPoint, pu32Result, u32MaxResults, pstMap);
+}
+
+/**
+ * @brief   Query objects in rectangle
+ * @details Determines all objects whose bounding box intersects a
+ *          rectangle using the object spatial index, so the cost
+ *          depends on the number of nearby objects rather than on the
+ *          total object count
+ * @param   stRect
+ *          Rectangle to query
+ * @param   pu32Result
+ *          Array to store the object indices
+ * @param   u32MaxResults
+ *          Capacity of the result array
+ * @param   pstMap
+ *          Pointer to map handle
+ * @return  Number of object indices stored
+ */
+Uint32 Map_QueryObjectsInRect(
+    const AABB   stRect,
+    Uint32*      pu32Result,
+    const Uint32 u32MaxResults,
+    const Map*   pstMap)
+{
+    const ObjectStore* pstStore   = &pstMap->stObjects;
+    Uint32             u32Results = 0;
+    Uint32             u32QueryX0;
+    Uint32             u32QueryY0;
+    Uint32             u32QueryX1;
+    Uint32             u32QueryY1;
+
+    if (!pstStore->pu32CellObject || 0 == u32MaxResults)
+    {
+        return 0;
+    }
+
+    _GetObjectCells(stRect, pstStore, &u32QueryX0, &u32QueryY0, &u32QueryX1, &u32QueryY1);
+
+    for (Uint32 u32CellY = u32QueryY0; u32CellY <= u32QueryY1; u32CellY++)
+    {
+        for (Uint32 u32CellX = u32QueryX0; u32CellX <= u32QueryX1; u32CellX++)
+        {
+            Uint32 u32Cell = (u32CellY * pstStore->u32GridWidth) + u32CellX;
+
+            for (Uint32 u32Entry = pstStore->pu32CellStart[u32Cell];
+                 u32Entry < pstStore->pu32CellStart[u32Cell + 1];
+                 u32Entry++)
+            {
+                Uint32 u32Index = pstStore->pu32CellObject[u32Entry];
+                Uint32 u32CellX0;
+                Uint32 u32CellY0;
+                Uint32 u32CellX1;
+                Uint32 u32CellY1;
+
+                if (!AABB_BoxesDoIntersect(stRect, pstStore->pstBB[u32Index]))
+                {
+                    continue;
+                }
+
+                // Objects spanning several cells are only reported in
+                // the first cell shared with the query rectangle.
+                _GetObjectCells(
+                    pstStore->pstBB[u32Index],
+                    pstStore,
+                    &u32CellX0,
+                    &u32CellY0,
+                    &u32CellX1,
+                    &u32CellY1);
+
+                if (SDL_max(u32CellX0, u32QueryX0) != u32CellX ||
+                    SDL_max(u32CellY0, u32QueryY0) != u32CellY)
+                {
+                    continue;
+                }
+
+                pu32Result[u32Results] = u32Index;
+                u32Results++;
+
+                if (u32Results >= u32MaxResults)
+                {
+                    return u32Results;
+                }
+            }
+        }
+    }
+
+    return u32Results;
+}
+
 /**
  * @brief   Set map gravitation
  * @details Sets the gravitational constant of the map
@@ -675,13 +4653,7 @@ void Map_SetGravitation(const double dGravitation, const SDL_bool bUseTmxConstan
 {
     if (bUseTmxConstant)
     {
-        double*       dTmxConstant = NULL;
-        tmx_property* pProperty;
-
-        dTmxConstant = &pstMap->dGravitation;
-        pProperty    = pstMap->pstTmxMap->properties;
-        tmx_property_foreach(pProperty, _GetGravitation, (void*)dTmxConstant);
-        pstMap->dGravitation = *dTmxConstant;
+        pstMap->dGravitation = pstMap->dTmxGravitation;
     }
     else
     {
@@ -694,11 +4666,157 @@ void Map_SetGravitation(const double dGravitation, const SDL_bool bUseTmxConstan
         pstMap->u8MeterInPixel);
 }
 
+/**
+ * @brief   Set tile
+ * @details Replaces a tile at runtime, e.g. for destructible terrain
+ *          or opening doors
+ * @param   u16Layer
+ *          Layer index, see Map_GetLayerIndex()
+ * @param   u32PosX
+ *          Position along the x-axis in tiles
+ * @param   u32PosY
+ *          Position along the y-axis in tiles
+ * @param   u32Gid
+ *          GID of the new tile, 0 to remove the tile
+ * @param   pstMap
+ *          Pointer to map handle
+ * @return  Error code
+ * @retval  0:  OK
+ * @retval  -1: Error
+ * @remark  The tile type lookup of the cell is updated immediately.
+ *          Cached map textures and chunks only redraw the changed area
+ *          the next time they are drawn.
+ */
+Sint8 Map_SetTile(
+    const Uint16 u16Layer,
+    const Uint32 u32PosX,
+    const Uint32 u32PosY,
+    const Uint32 u32Gid,
+    Map*         pstMap)
+{
+    Uint32   u32Cell   = (u32PosY * pstMap->u32Columns) + u32PosX;
+    Uint32   u32Types  = 0;
+    Uint8    u8Pending = 0;
+    SDL_Rect stDirty;
+
+    if (u16Layer >= pstMap->u16LayerCount || u32PosX >= pstMap->u32Columns ||
+        u32PosY >= pstMap->u32Rows)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "SetTile(): position out of range.\n");
+        return -1;
+    }
+
+    if (u32Gid == _GetGid(u32PosX, u32PosY, &pstMap->pstLayer[u16Layer]))
+    {
+        return 0;
+    }
+
+    if (-1 == _SetGid(u32PosX, u32PosY, u32Gid, &pstMap->pstLayer[u16Layer], pstMap))
+    {
+        return -1;
+    }
+
+    // Update the tile types of the cell.
+    for (Uint16 u16Index = 0; u16Index < pstMap->u16LayerCount; u16Index++)
+    {
+        Uint32 u32TileGid = _ClearGidFlags(_GetGid(u32PosX, u32PosY, &pstMap->pstLayer[u16Index]));
+
+        if (u32TileGid < pstMap->u32TileInfoCount &&
+            -1 != pstMap->pstTileInfo[u32TileGid].s8TypeId)
+        {
+            u32Types |= (Uint32)1 << pstMap->pstTileInfo[u32TileGid].s8TypeId;
+        }
+    }
+    pstMap->pu32TypeGrid[u32Cell] = u32Types;
+
+    // The changed area is the largest tile anchored in the cell.
+    stDirty.x = u32PosX * pstMap->u16TileWidth;
+    stDirty.y = ((u32PosY + 1) * pstMap->u16TileHeight) - pstMap->u16MaxTileHeight;
+    stDirty.w = pstMap->u16MaxTileWidth;
+    stDirty.h = pstMap->u16MaxTileHeight;
+
+    if (stDirty.y < 0)
+    {
+        stDirty.h += stDirty.y;
+        stDirty.y  = 0;
+    }
+
+    if (stDirty.x + stDirty.w > (Sint32)(pstMap->u32Columns * pstMap->u16TileWidth))
+    {
+        stDirty.w = (pstMap->u32Columns * pstMap->u16TileWidth) - stDirty.x;
+    }
+
+    // Queue the area for each existing whole-map texture.
+    for (Uint8 u8Index = 0; u8Index < MAP_TEXTURES; u8Index++)
+    {
+        if (pstMap->pstTexture[u8Index])
+        {
+            u8Pending |= 1 << u8Index;
+        }
+    }
+
+    if (u8Pending)
+    {
+        if (pstMap->u32DirtyCount == pstMap->u32DirtySize)
+        {
+            Uint32        u32Size  = pstMap->u32DirtySize ? pstMap->u32DirtySize * 2 : 16;
+            MapDirtyRect* pstDirty = SDL_realloc(pstMap->pstDirty, u32Size * sizeof(MapDirtyRect));
+
+            if (!pstDirty)
+            {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "SetTile(): error allocating memory.\n");
+                return -1;
+            }
+
+            pstMap->pstDirty     = pstDirty;
+            pstMap->u32DirtySize = u32Size;
+        }
+
+        pstMap->pstDirty[pstMap->u32DirtyCount].stRect    = stDirty;
+        pstMap->pstDirty[pstMap->u32DirtyCount].u8Pending = u8Pending;
+        pstMap->u32DirtyCount++;
+    }
+
+    // Mark the area in all cached chunks it overlaps.
+    for (Uint16 u16Index = 0; u16Index < pstMap->u16ChunkCount; u16Index++)
+    {
+        MapChunk* pstChunk = &pstMap->pstChunk[u16Index];
+        SDL_Rect  stChunk;
+
+        if (!pstChunk->bIsValid)
+        {
+            continue;
+        }
+
+        stChunk.x = pstChunk->s32ChunkX * pstMap->u16ChunkSize * pstMap->u16TileWidth;
+        stChunk.y = pstChunk->s32ChunkY * pstMap->u16ChunkSize * pstMap->u16TileHeight;
+        stChunk.w = pstMap->u16ChunkSize * pstMap->u16TileWidth;
+        stChunk.h = pstMap->u16ChunkSize * pstMap->u16TileHeight;
+
+        if (!SDL_HasIntersection(&stChunk, &stDirty))
+        {
+            continue;
+        }
+
+        if (SDL_RectEmpty(&pstChunk->stDirty))
+        {
+            pstChunk->stDirty = stDirty;
+        }
+        else
+        {
+            SDL_UnionRect(&pstChunk->stDirty, &stDirty, &pstChunk->stDirty);
+        }
+    }
+
+    return 0;
+}
+
 /**
  * @brief   Set speed of animated tiles
- * @details Sets the speed of animated tiles
+ * @details Sets the speed of animated tiles whose frames do not define
+ *          a duration in the TMX map
  * @param   dAnimSpeed
- *          Animation speed
+ *          Animation speed in frames per second
  * @param   pstMap
  *          Pointer to map handle
  */
@@ -716,22 +4834,90 @@ void Map_SetTileAnimationSpeed(const double dAnimSpeed, Map* pstMap)
  */
 void Map_ShowObjects(const Map* pstMap)
 {
-    if ((*pstMap).u16ObjectCount > 0)
+    const ObjectStore* pstStore = &pstMap->stObjects;
+
+    for (Uint32 u32Index = 0; u32Index < pstStore->u32Count; u32Index++)
     {
-        for (Uint16 u16Index = 0; u16Index < (*pstMap).u16ObjectCount; u16Index++)
-        {
-            SDL_Log("Object %d\n", u16Index);
-            SDL_Log("  ID:   %d\n", (*pstMap).astObject[u16Index].u16Id);
-            SDL_Log("  X:    %d\n", (*pstMap).astObject[u16Index].u32PosX);
-            SDL_Log("  Y:    %d\n", (*pstMap).astObject[u16Index].u32PosY);
-            SDL_Log("  W:    %d\n", (*pstMap).astObject[u16Index].u16Width);
-            SDL_Log("  H:    %d\n", (*pstMap).astObject[u16Index].u16Height);
-            SDL_Log("  NAME: %s\n", (*pstMap).astObject[u16Index].acName);
-            SDL_Log("  TYPE: %s\n", (*pstMap).astObject[u16Index].acType);
-            SDL_Log("  BB B: %f\n", (*pstMap).astObject[u16Index].stBB.dBottom);
-            SDL_Log("  BB L: %f\n", (*pstMap).astObject[u16Index].stBB.dLeft);
-            SDL_Log("  BB R: %f\n", (*pstMap).astObject[u16Index].stBB.dRight);
-            SDL_Log("  BB T: %f\n", (*pstMap).astObject[u16Index].stBB.dTop);
-        }
+        SDL_Log("Object %u\n", u32Index);
+        SDL_Log("  ID:   %u\n", pstStore->pu32Id[u32Index]);
+        SDL_Log("  X:    %d\n", pstStore->ps32PosX[u32Index]);
+        SDL_Log("  Y:    %d\n", pstStore->ps32PosY[u32Index]);
+        SDL_Log("  W:    %u\n", pstStore->pu32Width[u32Index]);
+        SDL_Log("  H:    %u\n", pstStore->pu32Height[u32Index]);
+        SDL_Log("  NAME: %s\n", Map_GetObjectName(u32Index, pstMap));
+        SDL_Log("  TYPE: %s\n", Map_GetObjectType(u32Index, pstMap));
+        SDL_Log("  BB B: %f\n", Scalar_ToDouble(pstStore->pstBB[u32Index].dBottom));
+        SDL_Log("  BB L: %f\n", Scalar_ToDouble(pstStore->pstBB[u32Index].dLeft));
+        SDL_Log("  BB R: %f\n", Scalar_ToDouble(pstStore->pstBB[u32Index].dRight));
+        SDL_Log("  BB T: %f\n", Scalar_ToDouble(pstStore->pstBB[u32Index].dTop));
     }
 }
+
+/**
+ * @brief   Sweep box against solid tiles
+ * @details Moves an axis-aligned box along the x-axis and then along
+ *          the y-axis and stops it at the first solid tile in its way
+ * @param   stBB
+ *          Axis-aligned bounding box at the start of the movement
+ * @param   dDeltaX
+ *          Movement along the x-axis in pixel
+ * @param   dDeltaY
+ *          Movement along the y-axis in pixel
+ * @param   u32SolidMask
+ *          Tile types to collide with, see Map_GetTypeMask()
+ * @param   pstMap
+ *          Pointer to map handle
+ * @param   pstContact
+ *          Pointer to store the resolved movement and contact normals
+ * @remark  Every tile the box passes is tested, no matter how far it
+ *          moves within one call.  Tiles outside the map are never
+ *          solid.  A box that starts inside solid tiles is first
+ *          pushed out along the axis and direction of least
+ *          penetration; the push is part of the resolved movement and
+ *          sets the contact normal.  Boxes buried deeper than
+ *          SWEEP_PUSH_CELLS cells in every direction are not pushed.
+ */
+void Map_SweepBox(
+    const AABB   stBB,
+    const double dDeltaX,
+    const double dDeltaY,
+    const Uint32 u32SolidMask,
+    const Map*   pstMap,
+    TileContact* pstContact)
+{
+    double dBottom = Scalar_ToDouble(stBB.dBottom);
+    double dLeft   = Scalar_ToDouble(stBB.dLeft);
+    double dRight  = Scalar_ToDouble(stBB.dRight);
+    double dTop    = Scalar_ToDouble(stBB.dTop);
+    double dPushX;
+    double dPushY;
+
+    pstContact->s8NormalX = 0;
+    pstContact->s8NormalY = 0;
+
+    _PushOut(dLeft, dRight, dTop, dBottom, u32SolidMask, pstMap, pstContact);
+    dPushX = pstContact->dDeltaX;
+    dPushY = pstContact->dDeltaY;
+
+    pstContact->dDeltaX = dPushX + _SweepAxis(
+        dLeft + dPushX,
+        dRight + dPushX,
+        dDeltaX,
+        dTop + dPushY,
+        dBottom + dPushY,
+        SDL_TRUE,
+        u32SolidMask,
+        pstMap,
+        &pstContact->s8NormalX);
+
+    pstContact->dDeltaY = dPushY + _SweepAxis(
+        dTop + dPushY,
+        dBottom + dPushY,
+        dDeltaY,
+        dLeft + pstContact->dDeltaX,
+        dRight + pstContact->dDeltaX,
+        SDL_FALSE,
+        u32SolidMask,
+        pstMap,
+        &pstContact->s8NormalY);
+}
@@ -8,6 +8,8 @@
 #include <SDL.h>
 #include <tmx.h>
 #include "AABB.h"
+#include "Job.h"
+#include "Utils.h"
 
 /**
  * @typedef MapConstants
@@ -17,49 +19,405 @@
  */
 typedef enum MapConstants_t
 {
-    ANIM_TILE_MAX   = 500,  ///< Max. number of animated tiles
     MAP_TEXTURES    = 4,    ///< Max. textures per map (not to be confused with map layers)
-    TS_IMG_PATH_LEN = 64,   ///< Max. tileset image path length
-    OBJECT_NAME_LEN = 50,   ///< Max. object name length
-    OBJECT_TYPE_LEN = 15    ///< Max. object type length
+    MAP_PATH_LEN    = 256,  ///< Max. map file path length
+    TS_IMG_PATH_LEN = 256,  ///< Max. tileset image path length
+    LAYER_NAME_LEN  = 64,   ///< Max. layer name length
+    ATLAS_PAGE_LEN  = 2048, ///< Atlas page edge length in pixel
+    ATLAS_PAGES_MAX = 8,    ///< Max. number of atlas pages per map
+    CHUNK_SIZE_MIN  = 4,    ///< Min. chunk edge length in tiles
+    TILE_TYPE_MAX   = 32,   ///< Max. number of tile types per map
+    TILE_TYPE_LEN   = 20,   ///< Max. tile type length
+    OBJECT_CELL_LEN = 128,  ///< Object spatial index cell edge length in pixel
+    OBJECT_BATCH    = 256,  ///< Objects per parallel extraction batch
+    GRID_ROW_BATCH  = 16,   ///< Rows per parallel type grid batch
+    BAKED_VERSION   = 6     ///< Baked map format version
 
 } MapConstants;
 
+/**
+ * @typedef BakedSection
+ * @brief   Baked map section type
+ * @enum    BakedSection_t
+ * @brief   Baked map section enumeration
+ */
+typedef enum BakedSection_t
+{
+    BAKED_LAYERS = 0,         ///< Tile layers
+    BAKED_ROW_START,          ///< First run per row of all tile layers
+    BAKED_RUNS,               ///< Runs of all tile layers
+    BAKED_GIDS,               ///< GIDs of all tile layers
+    BAKED_TILESETS,           ///< Tilesets
+    BAKED_TILE_INFO,          ///< Tile info per GID
+    BAKED_ANIM_TILES,         ///< Animated tiles
+    BAKED_ANIM_FRAMES,        ///< Animation frames
+    BAKED_TYPE_GRID,          ///< Tile type bitmask per cell
+    BAKED_TYPE_NAMES,         ///< Tile type names
+    BAKED_OBJECT_ID,          ///< Object IDs
+    BAKED_OBJECT_POS_X,       ///< Object positions along the x-axis
+    BAKED_OBJECT_POS_Y,       ///< Object positions along the y-axis
+    BAKED_OBJECT_WIDTH,       ///< Object widths
+    BAKED_OBJECT_HEIGHT,      ///< Object heights
+    BAKED_OBJECT_BB,          ///< Object bounding boxes
+    BAKED_OBJECT_NAME,        ///< Object name handles
+    BAKED_OBJECT_TYPE,        ///< Object type IDs
+    BAKED_OBJECT_TYPE_NAME,   ///< Name handle per object type ID
+    BAKED_OBJECT_TYPE_START,  ///< Bucket start per object type ID
+    BAKED_OBJECT_BUCKET,      ///< Object indices grouped by type ID
+    BAKED_STRING_POOL,        ///< Interned object names and types
+    BAKED_CELL_START,         ///< First entry per object grid cell
+    BAKED_CELL_OBJECT,        ///< Object indices per object grid cell
+    BAKED_PROPERTIES,         ///< Property hash table
+    BAKED_PROPERTY_POOL,      ///< Property string values
+    BAKED_SECTIONS            ///< Number of sections
+
+} BakedSection;
+
+/**
+ * @typedef MapLoadState
+ * @brief   Map load state type
+ * @enum    MapLoadState_t
+ * @brief   Map load state enumeration
+ */
+typedef enum MapLoadState_t
+{
+    MAP_LOAD_PENDING = 0,  ///< Map is being loaded
+    MAP_LOAD_DONE,         ///< Map has been loaded
+    MAP_LOAD_FAILED        ///< Map could not be loaded
+
+} MapLoadState;
+
+/**
+ * @typedef PropertyOwner
+ * @brief   Property owner type
+ * @enum    PropertyOwner_t
+ * @brief   Property owner enumeration
+ */
+typedef enum PropertyOwner_t
+{
+    PROPERTY_OF_MAP = 0,  ///< Map, index is always 0
+    PROPERTY_OF_LAYER,    ///< Tile layer, index see Map_GetLayerIndex()
+    PROPERTY_OF_TILE,     ///< Tile, index is the GID
+    PROPERTY_OF_OBJECT    ///< Object, index see Map_GetObjectCount()
+
+} PropertyOwner;
+
+/**
+ * @typedef PropertyType
+ * @brief   Property type type
+ * @enum    PropertyType_t
+ * @brief   Property type enumeration
+ */
+typedef enum PropertyType_t
+{
+    PROPERTY_NONE = 0,  ///< No property, marks a free hash table slot
+    PROPERTY_INT,       ///< Integer
+    PROPERTY_FLOAT,     ///< Floating point number
+    PROPERTY_BOOL,      ///< Boolean
+    PROPERTY_STRING,    ///< String
+    PROPERTY_COLOUR,    ///< ARGB colour
+    PROPERTY_FILE       ///< File path
+
+} PropertyType;
+
+/**
+ * @typedef MapProperty
+ * @brief   Map property handle type
+ * @struct  MapProperty_t
+ * @brief   Custom property of the map, a layer, a tile or an object
+ * @details Properties of all owners share one open-addressing hash
+ *          table keyed by owner and name hash.  Names and string
+ *          values are referenced by handle (offset into the property
+ *          string pool); numeric values are converted to double.
+ */
+typedef struct MapProperty_t
+{
+    double dValue;       ///< Numeric value, 0 for strings and files
+    Uint32 u32NameHash;  ///< Name hash, see Map_GetPropertyKey()
+    Uint32 u32Name;      ///< Name handle
+    Uint32 u32Owner;     ///< Owner kind in the upper two bits, owner index below
+    Uint32 u32String;    ///< String handle, 0 (empty string) for numeric values
+    Uint8  u8Type;       ///< Property type, see PropertyType
+
+} MapProperty;
+
+/**
+ * @typedef MapPropertyKey
+ * @brief   Map property key handle type
+ * @struct  MapPropertyKey_t
+ * @brief   Pre-hashed property name, see Map_GetPropertyKey()
+ */
+typedef struct MapPropertyKey_t
+{
+    const char* pacName;  ///< Property name, must outlive the key
+    Uint32      u32Hash;  ///< Name hash
+
+} MapPropertyKey;
+
+/**
+ * @typedef TileFlags
+ * @brief   Tile flags type
+ * @enum    TileFlags_t
+ * @brief   Tile flags enumeration
+ */
+typedef enum TileFlags_t
+{
+    TILE_IS_VALID    = 0x01,  ///< GID refers to a drawable tile
+    TILE_IS_ANIMATED = 0x02   ///< Tile is animated
+
+} TileFlags;
+
+/**
+ * @typedef TileInfo
+ * @brief   Tile info handle type
+ * @struct  TileInfo_t
+ * @brief   Per-GID tile data
+ * @details The map keeps one entry per GID so the tile loop only has to
+ *          touch a single flat table.
+ */
+typedef struct TileInfo_t
+{
+    Uint16 u16SrcX;       ///< Source position in the atlas page along the x-axis
+    Uint16 u16SrcY;       ///< Source position in the atlas page along the y-axis
+    Uint16 u16Width;      ///< Tile width in pixel
+    Uint16 u16Height;     ///< Tile height in pixel
+    Uint8  u8Atlas;       ///< Atlas page index
+    Uint8  u8Flags;       ///< Tile flags, see TileFlags
+    Sint8  s8TypeId;      ///< Tile type ID, -1 if none
+    Uint16 u16Tileset;    ///< Tileset index
+    Uint32 u32AnimIndex;  ///< Animated tile index + 1, 0 if static
+
+} TileInfo;
+
+/**
+ * @typedef MapTileset
+ * @brief   Map tileset handle type
+ * @struct  MapTileset_t
+ * @brief   Map tileset data
+ */
+typedef struct MapTileset_t
+{
+    char   acImage[TS_IMG_PATH_LEN];  ///< Tileset image
+    Uint16 u16Width;                  ///< Image width in pixel
+    Uint16 u16Height;                 ///< Image height in pixel
+    Uint16 u16PosX;                   ///< Position in the atlas page along the x-axis
+    Uint16 u16PosY;                   ///< Position in the atlas page along the y-axis
+    Uint8  u8Atlas;                   ///< Atlas page index
+
+} MapTileset;
+
+/**
+ * @typedef AtlasPage
+ * @brief   Atlas page handle type
+ * @struct  AtlasPage_t
+ * @brief   Atlas page data
+ */
+typedef struct AtlasPage_t
+{
+    SDL_Texture* pstTexture;  ///< Atlas texture
+    SDL_Surface* pstSurface;  ///< Composed page, kept until uploaded
+    Uint16       u16Width;    ///< Page width in pixel
+    Uint16       u16Height;   ///< Page height in pixel
+
+} AtlasPage;
+
+/**
+ * @typedef MapRun
+ * @brief   Tile run handle type
+ * @struct  MapRun_t
+ * @brief   Consecutive non-empty cells within a layer row
+ */
+typedef struct MapRun_t
+{
+    Uint32 u32Column;  ///< First column of the run
+    Uint32 u32Length;  ///< Number of cells
+    Uint32 u32Offset;  ///< Index of the first GID in the layer's GID array
+
+} MapRun;
+
+/**
+ * @typedef MapLayer
+ * @brief   Map layer handle type
+ * @struct  MapLayer_t
+ * @brief   Tile layer data
+ * @details Only non-empty cells are stored: each row is a sorted list
+ *          of runs whose GIDs are packed in row-major order.
+ */
+typedef struct MapLayer_t
+{
+    char     acName[LAYER_NAME_LEN];  ///< Layer name
+    Uint32*  pu32RowStart;            ///< First run per row, rows + 1 entries
+    MapRun*  pstRun;                  ///< Runs sorted by row and column
+    Uint32*  pu32Gid;                 ///< GID per non-empty cell, including flip flags
+    Uint32   u32RunCount;             ///< Number of runs
+    Uint32   u32RunSize;              ///< Allocated number of runs
+    Uint32   u32GidCount;             ///< Number of non-empty cells
+    Uint32   u32GidSize;              ///< Allocated number of GIDs
+    SDL_bool bIsVisible;              ///< Layer is visible
+
+} MapLayer;
+
+/**
+ * @typedef AnimFrame
+ * @brief   Animation frame handle type
+ * @struct  AnimFrame_t
+ * @brief   Animation frame data
+ */
+typedef struct AnimFrame_t
+{
+    Uint32 u32Gid;       ///< GID of the tile shown in this frame
+    Uint32 u32Duration;  ///< Frame duration in milliseconds
+
+} AnimFrame;
+
 /**
  * @typedef AnimTile
  * @brief   Animated tile handle type
  * @struct  AnimTile_t
  * @brief   Animated tile data
+ * @details The animation state is kept once per animated GID and
+ *          shared by all instances of the tile on the map.
  */
 typedef struct AnimTile_t
 {
-    Uint16 u16Gid;        ///< GID
-    Uint16 u16TileId;     ///< Tile ID
-    Sint16 s16DstX;       ///< Destination coordinate along the x-axis
-    Sint16 s16DstY;       ///< Destination coordinate along the y-axis
-    Uint8  u8FrameCount;  ///< Frame count
-    Uint8  u8AnimLen;     ///< Animation length
+    Uint32 u32Gid;         ///< GID
+    Uint32 u32FirstFrame;  ///< Index of the first frame in the frame table
+    Uint16 u16FrameCount;  ///< Frame count
+    Uint16 u16Frame;       ///< Current frame
+    double dFrameTime;     ///< Time spent in the current frame in milliseconds
 
 } AnimTile;
 
 /**
- * @typedef Object
- * @brief   Object handle type
- * @struct  Object_t
- * @brief   Object handle data
+ * @typedef MapChunk
+ * @brief   Map chunk handle type
+ * @struct  MapChunk_t
+ * @brief   Pre-rendered map chunk data
  */
-typedef struct Object_t
+typedef struct MapChunk_t
 {
-    Uint16 u16Id;                    ///< Object ID
-    Uint32 u32PosX;                  ///< Position along the x-axis
-    Uint32 u32PosY;                  ///< Position along the y-axis
-    Uint16 u16Width;                 ///< Object width in pixel
-    Uint16 u16Height;                ///< Object height in pixel
-    char   acName[OBJECT_NAME_LEN];  ///< Object name
-    char   acType[OBJECT_TYPE_LEN];  ///< Object type
-    AABB   stBB;                     ///< Axis-aligned bounding box
+    SDL_Texture* pstTexture;   ///< Chunk texture
+    Sint32       s32ChunkX;    ///< Chunk coordinate along the x-axis
+    Sint32       s32ChunkY;    ///< Chunk coordinate along the y-axis
+    Uint32       u32LastUsed;  ///< Frame stamp of last use
+    Uint16       u16Index;     ///< Texture index the chunk belongs to
+    SDL_bool     bIsValid;     ///< Chunk holds rendered content
+    SDL_Rect     stDirty;      ///< Map area to redraw in pixel, empty if up to date
 
-} Object;
+} MapChunk;
+
+/**
+ * @typedef MapDirtyRect
+ * @brief   Dirty rectangle handle type
+ * @struct  MapDirtyRect_t
+ * @brief   Map area to redraw in the map textures
+ */
+typedef struct MapDirtyRect_t
+{
+    SDL_Rect stRect;     ///< Map area in pixel
+    Uint8    u8Pending;  ///< Bit n is set if texture n has yet to be patched
+
+} MapDirtyRect;
+
+/**
+ * @typedef TileContact
+ * @brief   Tile contact handle type
+ * @struct  TileContact_t
+ * @brief   Result of sweeping a box against solid tiles
+ * @details Normals point away from the tile that has been hit, e.g. a
+ *          box landing on the ground gets a normal of -1 along the
+ *          y-axis.
+ */
+typedef struct TileContact_t
+{
+    double dDeltaX;    ///< Resolved movement along the x-axis
+    double dDeltaY;    ///< Resolved movement along the y-axis
+    Sint8  s8NormalX;  ///< Contact normal along the x-axis, 0 if none
+    Sint8  s8NormalY;  ///< Contact normal along the y-axis, 0 if none
+
+} TileContact;
+
+/**
+ * @typedef ObjectStore
+ * @brief   Object store handle type
+ * @struct  ObjectStore_t
+ * @brief   Map objects stored as structure of arrays
+ * @details Object names and types are interned into a string pool and
+ *          referenced by handle (offset into the pool).  Object types
+ *          are additionally numbered by type ID; the object indices of
+ *          each type are grouped into buckets for fast iteration.
+ *          A uniform grid over the object AABBs serves as spatial
+ *          index.
+ */
+typedef struct ObjectStore_t
+{
+    Uint32  u32Count;           ///< Object count
+    Uint32* pu32Id;             ///< Object IDs
+    Sint32* ps32PosX;           ///< Positions along the x-axis, may be negative
+    Sint32* ps32PosY;           ///< Positions along the y-axis, may be negative
+    Uint32* pu32Width;          ///< Widths in pixel
+    Uint32* pu32Height;         ///< Heights in pixel
+    AABB*   pstBB;              ///< Axis-aligned bounding boxes
+    Uint32* pu32Name;           ///< Name handles
+    Uint16* pu16Type;           ///< Type IDs
+    Uint16  u16TypeCount;       ///< Number of object types
+    Uint32* pu32TypeName;       ///< Name handle per type ID
+    Uint32* pu32TypeStart;      ///< Bucket start per type ID, u16TypeCount + 1 entries
+    Uint32* pu32TypeBucket;     ///< Object indices grouped by type ID
+    char*   pacStringPool;      ///< Interned object names and types
+    Uint32  u32StringPoolSize;  ///< String pool size in bytes
+    Uint32  u32GridWidth;       ///< Spatial index width in cells
+    Uint32  u32GridHeight;      ///< Spatial index height in cells
+    Uint32* pu32CellStart;      ///< First entry per grid cell, cell count + 1 entries
+    Uint32* pu32CellObject;     ///< Object indices per grid cell
+
+} ObjectStore;
+
+/**
+ * @typedef BakedMapHeader
+ * @brief   Baked map header type
+ * @struct  BakedMapHeader_t
+ * @brief   Baked map file header
+ * @details A baked map consists of this header followed by the
+ *          sections listed in BakedSection.  Each section is stored
+ *          8-byte aligned in its in-memory layout so that it can be
+ *          used in place after mapping the file.
+ */
+typedef struct BakedMapHeader_t
+{
+    char   acMagic[4];                       ///< File signature
+    Uint32 u32Version;                       ///< Format version, see BAKED_VERSION
+    Uint32 u32LayoutKey;                     ///< Hash of the in-memory structure layout
+    Uint32 u32SourceHash;                    ///< Hash of the source TMX file
+    Uint32 u32Columns;                       ///< Map width in tiles
+    Uint32 u32Rows;                          ///< Map height in tiles
+    Uint16 u16TileWidth;                     ///< Tile width in pixel
+    Uint16 u16TileHeight;                    ///< Tile height in pixel
+    Uint32 u32BgColour;                      ///< Background colour
+    double dTmxGravitation;                  ///< Gravitational constant of the map
+    Uint16 u16LayerCount;                    ///< Number of tile layers
+    Uint32 u32RunCount;                      ///< Number of runs of all tile layers
+    Uint32 u32GidCount;                      ///< Number of GIDs of all tile layers
+    Uint16 u16TilesetCount;                  ///< Number of tilesets
+    Uint32 u32TileInfoCount;                 ///< Number of tile info entries
+    Uint32 u32AnimTileCount;                 ///< Number of animated tiles
+    Uint32 u32AnimFrameCount;                ///< Number of animation frames
+    Uint8  u8TypeCount;                      ///< Number of tile types
+    Uint8  u8AtlasCount;                     ///< Number of atlas pages
+    Uint16 au16AtlasWidth[ATLAS_PAGES_MAX];  ///< Atlas page widths in pixel
+    Uint16 au16AtlasHeight[ATLAS_PAGES_MAX]; ///< Atlas page heights in pixel
+    Uint16 u16ObjectTypeCount;               ///< Number of object types
+    Uint32 u32ObjectCount;                   ///< Object count
+    Uint32 u32StringPoolSize;                ///< String pool size in bytes
+    Uint32 u32GridWidth;                     ///< Object spatial index width in cells
+    Uint32 u32GridHeight;                    ///< Object spatial index height in cells
+    Uint32 u32CellObjectCount;               ///< Number of object grid cell entries
+    Uint32 u32PropertySize;                  ///< Property hash table size
+    Uint32 u32PropertyPoolSize;              ///< Property string pool size in bytes
+    Uint32 au32Offset[BAKED_SECTIONS];       ///< Section offsets in bytes
+    Uint32 au32Size[BAKED_SECTIONS];         ///< Section sizes in bytes
+
+} BakedMapHeader;
 
 /**
  * @typedef Map
@@ -69,26 +427,78 @@ typedef struct Object_t
  */
 typedef struct Map_t
 {
-    tmx_map*     pstTmxMap;                        ///< TMX map handle
-    SDL_Texture* pstAnimTexture;                   ///< Texture for animated tiles
-    SDL_Texture* pstTexture[MAP_TEXTURES];         ///< Map textures
-    SDL_Texture* pstTileset;                       ///< Tileset texture
-    Uint16       u16Height;                        ///< Map height in pixel
-    Uint16       u16Width;                         ///< Map width in pixel
-    double       dPosX;                            ///< Position along the x-axis
-    double       dPosY;                            ///< Position along the y-axis
-    double       dGravitation;                     ///< Gravitational constant
-    Uint8        u8MeterInPixel;                   ///< Definition of meter in pixel
-    char         acTilesetImage[TS_IMG_PATH_LEN];  ///< Tileset image
-    double       dAnimDelay;                       ///< Animation delay
-    double       dAnimSpeed;                       ///< Animation speed
-    Uint16       u16AnimTileSize;                  ///< Animated tile size
-    AnimTile     acAnimTile[ANIM_TILE_MAX];        ///< Animated tiles
-    Uint16       u16ObjectCount;                   ///< Object count
-    Object       astObject[];                      ///< Objects
+    tmx_map*      pstTmxMap;                  ///< TMX map handle, only set while loading
+    MappedFile    stBaked;                    ///< Baked map file
+    Uint32        u32SourceHash;              ///< Hash of the source TMX file
+    MapLayer*     pstLayer;                   ///< Tile layers
+    Uint16        u16LayerCount;              ///< Number of tile layers
+    Uint32        u32Columns;                 ///< Map width in tiles
+    Uint32        u32Rows;                    ///< Map height in tiles
+    Uint16        u16TileWidth;               ///< Tile width in pixel
+    Uint16        u16TileHeight;              ///< Tile height in pixel
+    Uint32        u32BgColour;                ///< Background colour
+    SDL_Texture*  pstTexture[MAP_TEXTURES];   ///< Map textures
+    MapTileset*   pstTileset;                 ///< Tilesets
+    Uint16        u16TilesetCount;            ///< Number of tilesets
+    AtlasPage     astAtlas[ATLAS_PAGES_MAX];  ///< Tileset atlas pages
+    Uint8         u8AtlasCount;               ///< Number of atlas pages
+    TileInfo*     pstTileInfo;                ///< Tile info per GID
+    Uint32        u32TileInfoCount;           ///< Number of tile info entries
+    MapChunk*     pstChunk;                   ///< Chunk cache, NULL if disabled
+    Uint16        u16ChunkCount;              ///< Number of chunk cache slots
+    Uint16        u16ChunkSize;               ///< Chunk edge length in tiles
+    Uint32        u32ChunkFrame;              ///< Chunk cache frame counter
+    MapDirtyRect* pstDirty;                   ///< Areas to redraw in the map textures
+    Uint32        u32DirtyCount;              ///< Number of dirty rectangles
+    Uint32        u32DirtySize;               ///< Capacity of the dirty rectangle array
+    Uint16        u16MaxTileWidth;            ///< Width of the widest tile in pixel
+    Uint16        u16MaxTileHeight;           ///< Height of the tallest tile in pixel
+    Uint32        u32Height;                  ///< Map height in pixel
+    Uint32        u32Width;                   ///< Map width in pixel
+    double        dPosX;                      ///< Position along the x-axis
+    double        dPosY;                      ///< Position along the y-axis
+    double        dGravitation;               ///< Gravitational constant
+    double        dTmxGravitation;            ///< Gravitational constant of the map
+    Uint8         u8MeterInPixel;             ///< Definition of meter in pixel
+    double        dAnimSpeed;                 ///< Animation speed for frames without duration
+    AnimTile*     pstAnimTile;                ///< Animated tiles, one per animated GID
+    AnimFrame*    pstAnimFrame;               ///< Animation frames
+    Uint32        u32AnimTileCount;           ///< Number of animated tiles
+    Uint32        u32AnimFrameCount;          ///< Number of animation frames
+    Uint32*       pu32TypeGrid;               ///< Tile type bitmask per cell
+    Uint8         u8TypeCount;                ///< Number of tile types
+    char          acTypeName[TILE_TYPE_MAX][TILE_TYPE_LEN];  ///< Tile type names
+    ObjectStore   stObjects;                  ///< Objects
+    MapProperty*  pstProperty;                ///< Property hash table, NULL if none
+    Uint32        u32PropertySize;            ///< Property hash table size, power of two
+    char*         pacPropertyPool;            ///< Property string values
+    Uint32        u32PropertyPoolSize;        ///< Property string pool size in bytes
 
 } Map;
 
+/**
+ * @typedef MapLoader
+ * @brief   Map loader handle type
+ * @struct  MapLoader_t
+ * @brief   Asynchronous map loader data
+ */
+typedef struct MapLoader_t
+{
+    JobPool*     pstPool;                          ///< Job pool running the load, may be NULL
+    JobCounter   stJob;                            ///< Tracks the load job
+    SDL_atomic_t stState;                          ///< Load state, see MapLoadState
+    Map*         pstMap;                           ///< Map being loaded
+    char         acFileName[MAP_PATH_LEN];         ///< TMX map file
+    char         acBakedFile[MAP_PATH_LEN];        ///< Baked map file, empty if unused
+    char         acTilesetImage[TS_IMG_PATH_LEN];  ///< Tileset image, empty if unused
+    Uint8        u8MeterInPixel;                   ///< Definition of meter in pixel
+
+} MapLoader;
+
+Sint8 Map_Bake(const char* pacFileName, const Map* pstMap);
+
+void Map_CancelAsync(MapLoader* pstLoader);
+
 Sint8 Map_Draw(
     const Uint16   u16Index,
     const SDL_bool bRenderAnimTiles,
@@ -99,11 +509,67 @@ Sint8 Map_Draw(
     Map*           pstMap,
     SDL_Renderer*  pstRenderer);
 
-void   Map_Free(Map* pstMap);
-void   Map_GetObjects(const Map* pstMap, Object astObject[]);
-Uint16 Map_GetObjectCount(Map* pstMap);
-char*  Map_GetObjectName(Object* pstObject);
-char*  Map_GetObjectType(Object* pstObject);
+Sint8 Map_EnableChunkCache(const Uint16 u16ChunkSize, const Uint32 u32MemoryBudget, Map* pstMap);
+
+Sint8 Map_FinalizeAsync(MapLoader* pstLoader, Map** pstMap, SDL_Renderer* pstRenderer);
+
+void        Map_Free(Map* pstMap);
+Sint32      Map_GetLayerIndex(const char* pacName, const Map* pstMap);
+Uint32      Map_GetObjectCount(const Map* pstMap);
+const char* Map_GetObjectName(const Uint32 u32Index, const Map* pstMap);
+
+Uint32 Map_GetObjectsOfType(
+    const Uint16   u16TypeId,
+    const Uint32** ppu32Index,
+    const Map*     pstMap);
+
+const char* Map_GetObjectType(const Uint32 u32Index, const Map* pstMap);
+Sint32      Map_GetObjectTypeId(const char* pacType, const Map* pstMap);
+
+const MapProperty* Map_GetProperty(
+    const PropertyOwner  eOwner,
+    const Uint32         u32Index,
+    const MapPropertyKey stKey,
+    const Map*           pstMap);
+
+SDL_bool Map_GetPropertyBool(
+    const PropertyOwner  eOwner,
+    const Uint32         u32Index,
+    const MapPropertyKey stKey,
+    const SDL_bool       bDefault,
+    const Map*           pstMap);
+
+double Map_GetPropertyFloat(
+    const PropertyOwner  eOwner,
+    const Uint32         u32Index,
+    const MapPropertyKey stKey,
+    const double         dDefault,
+    const Map*           pstMap);
+
+Sint32 Map_GetPropertyInt(
+    const PropertyOwner  eOwner,
+    const Uint32         u32Index,
+    const MapPropertyKey stKey,
+    const Sint32         s32Default,
+    const Map*           pstMap);
+
+MapPropertyKey Map_GetPropertyKey(const char* pacName);
+
+const char* Map_GetPropertyString(
+    const PropertyOwner  eOwner,
+    const Uint32         u32Index,
+    const MapPropertyKey stKey,
+    const char*          pacDefault,
+    const Map*           pstMap);
+
+Uint32 Map_GetTile(
+    const Uint16 u16Layer,
+    const Uint32 u32PosX,
+    const Uint32 u32PosY,
+    const Map*   pstMap);
+
+Sint8  Map_GetTypeId(const char* pacType, const Map* pstMap);
+Uint32 Map_GetTypeMask(const char* pacType, const Map* pstMap);
 
 Sint8 Map_Init(
     const char* pacFileName,
@@ -111,9 +577,30 @@ Sint8 Map_Init(
     const Uint8 u8MeterInPixel,
     Map**       pstMap);
 
+Sint8 Map_InitFromBaked(
+    const char* pacFileName,
+    const char* pacSourceFile,
+    const Uint8 u8MeterInPixel,
+    Map**       pstMap);
+
+Sint8 Map_InitAsync(
+    const char* pacFileName,
+    const char* pacTilesetImage,
+    const char* pacBakedFile,
+    const Uint8 u8MeterInPixel,
+    MapLoader** pstLoader);
+
+SDL_bool Map_IsAsyncDone(const MapLoader* pstLoader);
 SDL_bool Map_IsCoordOfType(const char* pacType, const Map* pstMap, double dPosX, double dPosY);
 
-SDL_bool Map_IsObjectOfType(const char* pacType, Object* pstObject);
+SDL_bool Map_IsCoordOfTypeId(
+    const Uint8  u8TypeId,
+    const Map*   pstMap,
+    const double dPosX,
+    const double dPosY);
+
+SDL_bool Map_IsObjectOfType(const char* pacType, const Uint32 u32Index, const Map* pstMap);
+SDL_bool Map_IsObjectOfTypeId(const Uint16 u16TypeId, const Uint32 u32Index, const Map* pstMap);
 
 SDL_bool Map_IsOnTileOfType(
     const char*  pacType,
@@ -122,6 +609,42 @@ SDL_bool Map_IsOnTileOfType(
     const Uint8  u8EntityHeight,
     const Map*   pstMap);
 
+SDL_bool Map_IsOnTileOfTypeId(
+    const Uint8  u8TypeId,
+    const double dPosX,
+    const double dPosY,
+    const Uint8  u8EntityHeight,
+    const Map*   pstMap);
+
+Uint32 Map_QueryObjectsAtPoint(
+    const double dPosX,
+    const double dPosY,
+    Uint32*      pu32Result,
+    const Uint32 u32MaxResults,
+    const Map*   pstMap);
+
+Uint32 Map_QueryObjectsInRect(
+    const AABB   stRect,
+    Uint32*      pu32Result,
+    const Uint32 u32MaxResults,
+    const Map*   pstMap);
+
 void Map_SetGravitation(const double dGravitation, const SDL_bool bUseTmxConstant, Map* pstMap);
+
+Sint8 Map_SetTile(
+    const Uint16 u16Layer,
+    const Uint32 u32PosX,
+    const Uint32 u32PosY,
+    const Uint32 u32Gid,
+    Map*         pstMap);
+
 void Map_SetTileAnimationSpeed(const double dAnimSpeed, Map* pstMap);
 void Map_ShowObjects(const Map* pstMap);
+
+void Map_SweepBox(
+    const AABB   stBB,
+    const double dDeltaX,
+    const double dDeltaY,
+    const Uint32 u32SolidMask,
+    const Map*   pstMap,
+    TileContact* pstContact);
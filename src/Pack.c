@@ -0,0 +1,521 @@
+// SPDX-License-Identifier: Beerware
+/**
+ * @file      Pack.c
+ * @ingroup   Pack
+ * @defgroup  Pack Memory-mapped asset archive
+ * @author    Michael Fitzmayer
+ * @copyright "THE BEER-WARE LICENCE" (Revision 42)
+ */
+
+#include <SDL.h>
+#ifdef WANT_ZLIB
+#include <zlib.h>
+#endif
+#include "Pack.h"
+#include "Utils.h"
+
+static Pack* _pstDefaultPack = NULL;
+
+#ifdef WANT_ZLIB
+static int SDLCALL _CloseInflated(SDL_RWops* pstRW)
+{
+    SDL_free(pstRW->hidden.mem.base);
+    SDL_FreeRW(pstRW);
+
+    return 0;
+}
+#endif
+
+static int _CompareEntries(const void* pA, const void* pB)
+{
+    return SDL_strcmp(((const PackEntry*)pA)->acName, ((const PackEntry*)pB)->acName);
+}
+
+static const PackEntry* _Lookup(const char* pacFileName, const Pack* pstPack)
+{
+    char   acName[PACK_NAME_LEN];
+    Uint32 u32First = 0;
+    Uint32 u32Last;
+
+    if (!pstPack || !pacFileName || !Utils_NormalisePath(pacFileName, PACK_NAME_LEN, acName))
+    {
+        return NULL;
+    }
+
+    u32Last = pstPack->u32EntryCount;
+    while (u32First < u32Last)
+    {
+        Uint32 u32Middle = u32First + (u32Last - u32First) / 2;
+        int    iOrder    = SDL_strcmp(acName, pstPack->pstEntry[u32Middle].acName);
+
+        if (0 == iOrder)
+        {
+            return &pstPack->pstEntry[u32Middle];
+        }
+        else if (iOrder < 0)
+        {
+            u32Last = u32Middle;
+        }
+        else
+        {
+            u32First = u32Middle + 1;
+        }
+    }
+
+    return NULL;
+}
+
+static Sint8 _WriteEntry(
+    const char*    pacSource,
+    const SDL_bool bCompress,
+    PackEntry*     pstEntry,
+    SDL_RWops*     pstRW)
+{
+    Sint64 s64Offset = SDL_RWtell(pstRW);
+    void*  pData;
+    void*  pPacked = NULL;
+    size_t zSize;
+    size_t zPacked;
+
+    pData = SDL_LoadFile(pacSource, &zSize);
+    if (!pData)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+        return -1;
+    }
+
+    zPacked = zSize;
+
+    #ifdef WANT_ZLIB
+    if (bCompress && zSize > 0)
+    {
+        uLongf zBound = compressBound(zSize);
+
+        pPacked = SDL_malloc(zBound);
+        if (pPacked &&
+            Z_OK == compress2(pPacked, &zBound, pData, zSize, Z_BEST_COMPRESSION) &&
+            zBound < zSize)
+        {
+            zPacked = zBound;
+        }
+        else
+        {
+            // Already compressed formats such as PNG or OGG rarely
+            // shrink any further and are stored as they are.
+            SDL_free(pPacked);
+            pPacked = NULL;
+        }
+    }
+    #else
+    (void)bCompress;
+    #endif
+
+    if (s64Offset < 0 || zSize > SDL_MAX_UINT32 ||
+        (Uint64)s64Offset + zPacked > SDL_MAX_UINT32)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "BuildPack(): archive exceeds 4 GiB.\n");
+        SDL_free(pPacked);
+        SDL_free(pData);
+        return -1;
+    }
+
+    if (zPacked > 0 && 1 != SDL_RWwrite(pstRW, pPacked ? pPacked : pData, zPacked, 1))
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+        SDL_free(pPacked);
+        SDL_free(pData);
+        return -1;
+    }
+
+    pstEntry->u32Offset     = SDL_SwapLE32((Uint32)s64Offset);
+    pstEntry->u32Size       = SDL_SwapLE32((Uint32)zSize);
+    pstEntry->u32PackedSize = SDL_SwapLE32((Uint32)zPacked);
+    pstEntry->u32Flags      = SDL_SwapLE32(pPacked ? PACK_DEFLATED : 0);
+
+    SDL_free(pPacked);
+    SDL_free(pData);
+
+    return 0;
+}
+
+static Sint8 _Write(
+    const char**   ppacFiles,
+    const Uint32   u32FileCount,
+    const SDL_bool bCompress,
+    PackEntry*     pstEntry,
+    SDL_RWops*     pstRW)
+{
+    PackHeader stHeader;
+    Sint64     s64Index = sizeof(struct PackHeader_t);
+    Sint64     s64Data  = s64Index + (Sint64)u32FileCount * sizeof(struct PackEntry_t);
+
+    SDL_memcpy(stHeader.acMagic, "ESZP", 4);
+    stHeader.u32Version    = SDL_SwapLE32(PACK_VERSION);
+    stHeader.u32EntryCount = SDL_SwapLE32(u32FileCount);
+
+    if (1 != SDL_RWwrite(pstRW, &stHeader, sizeof(struct PackHeader_t), 1) ||
+        s64Data != SDL_RWseek(pstRW, s64Data, RW_SEEK_SET))
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+        return -1;
+    }
+
+    for (Uint32 u32Index = 0; u32Index < u32FileCount; u32Index++)
+    {
+        const char* pacSource = ppacFiles[pstEntry[u32Index].u32Offset];
+
+        if (-1 == _WriteEntry(pacSource, bCompress, &pstEntry[u32Index], pstRW))
+        {
+            return -1;
+        }
+    }
+
+    if (u32FileCount > 0 &&
+        (s64Index != SDL_RWseek(pstRW, s64Index, RW_SEEK_SET) ||
+         1 != SDL_RWwrite(pstRW, pstEntry, u32FileCount * sizeof(struct PackEntry_t), 1)))
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief   Build asset archive
+ * @details Packs files into an asset archive that can be opened with
+ *          Pack_Init().  The files are stored under their normalised
+ *          path, so they have to be given the way the application
+ *          loads them, e.g. "res/images/tileset.png".
+ * @param   pacFileName
+ *          Path and filename of the archive to write
+ * @param   ppacFiles
+ *          Paths and filenames of the files to pack
+ * @param   u32FileCount
+ *          Number of files
+ * @param   bCompress
+ *          Deflate the files that get smaller by it
+ * @return  Error code
+ * @retval  0:  OK
+ * @retval  -1: Error
+ * @remark  Compression requires zlib support (WANT_ZLIB).  Without it,
+ *          all files are stored uncompressed.
+ */
+Sint8 Pack_Build(
+    const char*    pacFileName,
+    const char**   ppacFiles,
+    const Uint32   u32FileCount,
+    const SDL_bool bCompress)
+{
+    PackEntry* pstEntry;
+    SDL_RWops* pstRW;
+    Sint8      s8Result;
+
+    pstEntry = SDL_calloc(u32FileCount + 1, sizeof(struct PackEntry_t));
+    if (!pstEntry)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "BuildPack(): error allocating memory.\n");
+        return -1;
+    }
+
+    // The offset holds the index of the source file until its data
+    // has been written.
+    for (Uint32 u32Index = 0; u32Index < u32FileCount; u32Index++)
+    {
+        if (!Utils_NormalisePath(ppacFiles[u32Index], PACK_NAME_LEN, pstEntry[u32Index].acName))
+        {
+            SDL_LogError(
+                SDL_LOG_CATEGORY_APPLICATION,
+                "BuildPack(): path of %s too long.\n",
+                ppacFiles[u32Index]);
+            SDL_free(pstEntry);
+            return -1;
+        }
+        pstEntry[u32Index].u32Offset = u32Index;
+    }
+
+    SDL_qsort(pstEntry, u32FileCount, sizeof(struct PackEntry_t), _CompareEntries);
+
+    for (Uint32 u32Index = 1; u32Index < u32FileCount; u32Index++)
+    {
+        if (0 == SDL_strcmp(pstEntry[u32Index - 1].acName, pstEntry[u32Index].acName))
+        {
+            SDL_LogError(
+                SDL_LOG_CATEGORY_APPLICATION,
+                "BuildPack(): %s added twice.\n",
+                pstEntry[u32Index].acName);
+            SDL_free(pstEntry);
+            return -1;
+        }
+    }
+
+    #ifndef WANT_ZLIB
+    if (bCompress)
+    {
+        SDL_LogWarn(
+            SDL_LOG_CATEGORY_APPLICATION,
+            "BuildPack(): no zlib support, storing files uncompressed.\n");
+    }
+    #endif
+
+    pstRW = SDL_RWFromFile(pacFileName, "wb");
+    if (!pstRW)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+        SDL_free(pstEntry);
+        return -1;
+    }
+
+    s8Result = _Write(ppacFiles, u32FileCount, bCompress, pstEntry, pstRW);
+
+    if (0 != SDL_RWclose(pstRW))
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+        s8Result = -1;
+    }
+
+    SDL_free(pstEntry);
+
+    return s8Result;
+}
+
+/**
+ * @brief   Check if file is packed
+ * @details Checks whether an asset archive contains a file
+ * @param   pacFileName
+ *          Path and filename of the file
+ * @param   pstPack
+ *          Pointer to asset archive handle, may be NULL
+ * @return  Whether the file is packed
+ */
+SDL_bool Pack_Contains(const char* pacFileName, const Pack* pstPack)
+{
+    return _Lookup(pacFileName, pstPack) ? SDL_TRUE : SDL_FALSE;
+}
+
+/**
+ * @brief   Free asset archive
+ * @details Unmaps the archive.  Uncompressed entries are served from
+ *          the mapping without copying, so free the assets loaded from
+ *          the archive first, in particular fonts and music, which
+ *          keep reading from it while in use.
+ * @param   pstPack
+ *          Pointer to asset archive handle
+ */
+void Pack_Free(Pack* pstPack)
+{
+    if (!pstPack)
+    {
+        return;
+    }
+
+    if (_pstDefaultPack == pstPack)
+    {
+        _pstDefaultPack = NULL;
+    }
+
+    Utils_UnmapFile(&pstPack->stFile);
+    SDL_free(pstPack);
+}
+
+/**
+ * @brief   Get default asset archive
+ * @details Returns the archive the loaders of the framework look into
+ *          before falling back to the file system
+ * @return  Pointer to the default asset archive handle, NULL if no
+ *          archive has been opened
+ */
+Pack* Pack_GetDefaultPack(void)
+{
+    return _pstDefaultPack;
+}
+
+/**
+ * @brief   Get size of packed file
+ * @param   pacFileName
+ *          Path and filename of the file
+ * @param   pstPack
+ *          Pointer to asset archive handle, may be NULL
+ * @return  Uncompressed size of the file in bytes, -1 if the file is
+ *          not packed
+ */
+Sint64 Pack_GetSize(const char* pacFileName, const Pack* pstPack)
+{
+    const PackEntry* pstEntry = _Lookup(pacFileName, pstPack);
+
+    return pstEntry ? (Sint64)SDL_SwapLE32(pstEntry->u32Size) : -1;
+}
+
+/**
+ * @brief   Initialise asset archive
+ * @details Maps an archive built by Pack_Build() into memory.  The
+ *          first archive that is opened becomes the default archive:
+ *          from then on, Map_Init(), Font_Init(), Audio_InitMusic()
+ *          and all image loads look up their files in it first.
+ * @param   pacFileName
+ *          Path and filename of the archive
+ * @param   pstPack
+ *          Pointer to asset archive handle
+ * @return  Error code
+ * @retval  0:  OK
+ * @retval  -1: Error
+ */
+Sint8 Pack_Init(const char* pacFileName, Pack** pstPack)
+{
+    const PackHeader* pstHeader;
+    Uint64            u64Size;
+
+    *pstPack = SDL_calloc(sizeof(struct Pack_t), sizeof(Sint8));
+    if (!*pstPack)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InitPack(): error allocating memory.\n");
+        return -1;
+    }
+
+    if (-1 == Utils_MapFile(pacFileName, &(*pstPack)->stFile))
+    {
+        Pack_Free(*pstPack);
+        *pstPack = NULL;
+        return -1;
+    }
+
+    pstHeader = (*pstPack)->stFile.pData;
+    u64Size   = (*pstPack)->stFile.zSize;
+
+    if (u64Size < sizeof(struct PackHeader_t) || 0 != SDL_memcmp(pstHeader->acMagic, "ESZP", 4) ||
+        PACK_VERSION != SDL_SwapLE32(pstHeader->u32Version) ||
+        (Uint64)SDL_SwapLE32(pstHeader->u32EntryCount) * sizeof(struct PackEntry_t) >
+            u64Size - sizeof(struct PackHeader_t))
+    {
+        SDL_LogError(
+            SDL_LOG_CATEGORY_APPLICATION,
+            "InitPack(): %s is not a valid asset archive.\n",
+            pacFileName);
+        Pack_Free(*pstPack);
+        *pstPack = NULL;
+        return -1;
+    }
+
+    (*pstPack)->pstEntry      = (const PackEntry*)(pstHeader + 1);
+    (*pstPack)->u32EntryCount = SDL_SwapLE32(pstHeader->u32EntryCount);
+
+    // The lookup relies on terminated names in ascending order and the
+    // loaders on data within the archive.  Stored entries are served
+    // with their unpacked size, so both sizes have to agree.
+    for (Uint32 u32Index = 0; u32Index < (*pstPack)->u32EntryCount; u32Index++)
+    {
+        const PackEntry* pstEntry = &(*pstPack)->pstEntry[u32Index];
+        Uint64           u64End   = SDL_SwapLE32(pstEntry->u32Offset);
+        SDL_bool         bStored  = !(SDL_SwapLE32(pstEntry->u32Flags) & PACK_DEFLATED);
+
+        u64End += SDL_SwapLE32(pstEntry->u32PackedSize);
+
+        if ('\0' != pstEntry->acName[PACK_NAME_LEN - 1] || u64End > u64Size ||
+            (bStored && pstEntry->u32Size != pstEntry->u32PackedSize) ||
+            (u32Index > 0 && SDL_strcmp((pstEntry - 1)->acName, pstEntry->acName) >= 0))
+        {
+            SDL_LogError(
+                SDL_LOG_CATEGORY_APPLICATION,
+                "InitPack(): %s has a corrupt index.\n",
+                pacFileName);
+            Pack_Free(*pstPack);
+            *pstPack = NULL;
+            return -1;
+        }
+    }
+
+    if (!_pstDefaultPack)
+    {
+        _pstDefaultPack = *pstPack;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief   Open file from asset archive
+ * @details Opens a packed file for reading.  Uncompressed files are
+ *          read straight from the mapped archive without copying,
+ *          compressed ones are inflated into memory that is freed
+ *          when the stream is closed.
+ * @param   pacFileName
+ *          Path and filename of the file
+ * @param   pstPack
+ *          Pointer to asset archive handle, may be NULL
+ * @return  Read-only stream, NULL on error
+ * @remark  Files that are not packed are opened from the file system.
+ */
+SDL_RWops* Pack_OpenRW(const char* pacFileName, const Pack* pstPack)
+{
+    const PackEntry* pstEntry = _Lookup(pacFileName, pstPack);
+    const Uint8*     pu8Data;
+    SDL_RWops*       pstRW;
+    Uint32           u32Size;
+
+    if (!pstEntry)
+    {
+        pstRW = SDL_RWFromFile(pacFileName, "rb");
+        if (!pstRW)
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+        }
+        return pstRW;
+    }
+
+    pu8Data = (const Uint8*)pstPack->stFile.pData + SDL_SwapLE32(pstEntry->u32Offset);
+    u32Size = SDL_SwapLE32(pstEntry->u32Size);
+
+    if (!(SDL_SwapLE32(pstEntry->u32Flags) & PACK_DEFLATED))
+    {
+        pstRW = SDL_RWFromConstMem(pu8Data, (int)u32Size);
+        if (!pstRW)
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+        }
+        return pstRW;
+    }
+
+    #ifdef WANT_ZLIB
+    {
+        uLongf zInflated = u32Size;
+        void*  pInflated = SDL_malloc(u32Size);
+
+        if (!pInflated)
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "OpenPackRW(): error allocating memory.\n");
+            return NULL;
+        }
+
+        if (Z_OK != uncompress(
+                pInflated, &zInflated, pu8Data, SDL_SwapLE32(pstEntry->u32PackedSize)) ||
+            u32Size != zInflated)
+        {
+            SDL_LogError(
+                SDL_LOG_CATEGORY_APPLICATION,
+                "OpenPackRW(): error inflating %s.\n",
+                pstEntry->acName);
+            SDL_free(pInflated);
+            return NULL;
+        }
+
+        pstRW = SDL_RWFromConstMem(pInflated, (int)u32Size);
+        if (!pstRW)
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+            SDL_free(pInflated);
+            return NULL;
+        }
+
+        pstRW->close = _CloseInflated;
+
+        return pstRW;
+    }
+    #else
+    SDL_LogError(
+        SDL_LOG_CATEGORY_APPLICATION,
+        "OpenPackRW(): %s is compressed, but zlib support is disabled.\n",
+        pstEntry->acName);
+
+    return NULL;
+    #endif
+}
@@ -0,0 +1,96 @@
+// SPDX-License-Identifier: Beerware
+/**
+ * @file    Pack.h
+ * @brief   Asset archive include header
+ * @ingroup Pack
+ */
+#pragma once
+
+#include <SDL.h>
+#include "Utils.h"
+
+/**
+ * @typedef PackConstants
+ * @brief   Asset archive constants handle type
+ * @enum    PackConstants_t
+ * @brief   Asset archive constants enumeration
+ */
+typedef enum PackConstants_t
+{
+    PACK_NAME_LEN = 240,  ///< Max. normalised entry name length, keeps entries at 256 bytes
+    PACK_VERSION  = 1     ///< Archive format version
+
+} PackConstants;
+
+/**
+ * @typedef PackFlags
+ * @brief   Asset archive entry flags handle type
+ * @enum    PackFlags_t
+ * @brief   Asset archive entry flags enumeration
+ */
+typedef enum PackFlags_t
+{
+    PACK_DEFLATED = 0x01  ///< Entry is zlib-compressed
+
+} PackFlags;
+
+/**
+ * @typedef PackEntry
+ * @brief   Asset archive entry handle type
+ * @struct  PackEntry_t
+ * @brief   Index entry of an asset archive
+ * @details All numbers are stored in little-endian byte order.
+ */
+typedef struct PackEntry_t
+{
+    char   acName[PACK_NAME_LEN];  ///< Normalised path of the packed file
+    Uint32 u32Offset;              ///< Offset of the data from the start of the archive
+    Uint32 u32Size;                ///< Size of the file in bytes
+    Uint32 u32PackedSize;          ///< Size of the stored data in bytes
+    Uint32 u32Flags;               ///< PackFlags
+
+} PackEntry;
+
+/**
+ * @typedef PackHeader
+ * @brief   Asset archive header handle type
+ * @struct  PackHeader_t
+ * @brief   File header of an asset archive
+ * @details Followed by the index, sorted by name, and the data of
+ *          all entries.  All numbers are stored in little-endian byte
+ *          order.
+ */
+typedef struct PackHeader_t
+{
+    char   acMagic[4];     ///< "ESZP"
+    Uint32 u32Version;     ///< PACK_VERSION
+    Uint32 u32EntryCount;  ///< Number of index entries
+
+} PackHeader;
+
+/**
+ * @typedef Pack
+ * @brief   Asset archive handle type
+ * @struct  Pack_t
+ * @brief   Asset archive handle data
+ */
+typedef struct Pack_t
+{
+    MappedFile       stFile;         ///< Mapped archive
+    const PackEntry* pstEntry;       ///< Index, sorted by name
+    Uint32           u32EntryCount;  ///< Number of index entries
+
+} Pack;
+
+Sint8 Pack_Build(
+    const char*    pacFileName,
+    const char**   ppacFiles,
+    const Uint32   u32FileCount,
+    const SDL_bool bCompress);
+
+SDL_bool   Pack_Contains(const char* pacFileName, const Pack* pstPack);
+void       Pack_Free(Pack* pstPack);
+Pack*      Pack_GetDefaultPack(void);
+Sint64     Pack_GetSize(const char* pacFileName, const Pack* pstPack);
+Sint8      Pack_Init(const char* pacFileName, Pack** pstPack);
+SDL_RWops* Pack_OpenRW(const char* pacFileName, const Pack* pstPack);
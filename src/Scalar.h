@@ -0,0 +1,73 @@
+// SPDX-License-Identifier: Beerware
+/**
+ * @file    Scalar.h
+ * @brief   Scalar type include header
+ * @ingroup Scalar
+ * @details Selects the number type of the AABB, entity, bullet and
+ *          camera math at build time:
+ *
+ *          - default: double
+ *          - ESZFW_SCALAR_FLOAT: float, half the memory traffic and
+ *            twice the SIMD width
+ *          - ESZFW_SCALAR_FIXED: signed 16.16 fixed-point, bit-exact
+ *            results on all targets for deterministic simulation;
+ *            limits positions to +/-32767 pixel
+ *
+ *          The framework and the application have to be built with the
+ *          same setting, see the ESZFW_SCALAR CMake option.  Members
+ *          and arrays of this type keep their d prefix so existing code
+ *          compiles unchanged; outside of the default configuration
+ *          their values have to be converted with Scalar_FromDouble()
+ *          and Scalar_ToDouble().  Additions, subtractions and
+ *          comparisons work on all types as they are.  SCALAR_MODE
+ *          identifies the selected type.
+ */
+#pragma once
+
+#include <SDL.h>
+
+#if defined(ESZFW_SCALAR_FIXED)
+
+/**
+ * @typedef Scalar
+ * @brief   Scalar type
+ */
+typedef Sint32 Scalar;
+
+#define SCALAR_FRACTION_BITS 16
+#define SCALAR_MODE          2
+
+#define Scalar_Div(a, b)     ((Scalar)(((Sint64)(a) * (1 << SCALAR_FRACTION_BITS)) / (b)))
+#define Scalar_FromDouble(d) ((Scalar)((d) * (double)(1 << SCALAR_FRACTION_BITS)))
+#define Scalar_FromInt(i)    ((Scalar)((Sint32)(i) * (1 << SCALAR_FRACTION_BITS)))
+#define Scalar_Mul(a, b)     ((Scalar)(((Sint64)(a) * (b)) / (1 << SCALAR_FRACTION_BITS)))
+#define Scalar_ToDouble(s)   ((double)(s) / (double)(1 << SCALAR_FRACTION_BITS))
+#define Scalar_ToInt(s)      ((Sint32)((s) / (1 << SCALAR_FRACTION_BITS)))
+
+#elif defined(ESZFW_SCALAR_FLOAT)
+
+typedef float Scalar;
+
+#define SCALAR_MODE 1
+
+#define Scalar_Div(a, b)     ((a) / (b))
+#define Scalar_FromDouble(d) ((Scalar)(d))
+#define Scalar_FromInt(i)    ((Scalar)(i))
+#define Scalar_Mul(a, b)     ((a) * (b))
+#define Scalar_ToDouble(s)   ((double)(s))
+#define Scalar_ToInt(s)      ((Sint32)(s))
+
+#else
+
+typedef double Scalar;
+
+#define SCALAR_MODE 0
+
+#define Scalar_Div(a, b)     ((a) / (b))
+#define Scalar_FromDouble(d) ((Scalar)(d))
+#define Scalar_FromInt(i)    ((Scalar)(i))
+#define Scalar_Mul(a, b)     ((a) * (b))
+#define Scalar_ToDouble(s)   ((double)(s))
+#define Scalar_ToInt(s)      ((Sint32)(s))
+
+#endif
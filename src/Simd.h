@@ -0,0 +1,186 @@
+// SPDX-License-Identifier: Beerware
+/**
+ * @file    Simd.h
+ * @brief   SIMD abstraction include header
+ * @ingroup Simd
+ * @details Maps a minimal set of packed Scalar operations to AVX, SSE
+ *          or AArch64 NEON, depending on the target the framework is
+ *          compiled for, and to plain scalar code on all other targets.
+ *          Loads and stores are unaligned.  Comparisons yield a
+ *          SimdMask that Simd_MoveMask() turns into one bit per lane.
+ *          Fixed-point scalars always use the plain scalar code.
+ */
+#pragma once
+
+#include <SDL.h>
+#include "Scalar.h"
+
+#if defined(ESZFW_SCALAR_FIXED)
+
+// Packed 16.16 multiplication needs 64-bit intermediate products;
+// handled by the scalar fallback below.
+
+#elif defined(ESZFW_SCALAR_FLOAT) && defined(__AVX__)
+
+#include <immintrin.h>
+
+#define SIMD_WIDTH 8
+
+typedef __m256 SimdScalar;
+typedef __m256 SimdMask;
+
+#define Simd_Add(a, b)   _mm256_add_ps(a, b)
+#define Simd_And(a, b)   _mm256_and_ps(a, b)
+#define Simd_CmpLe(a, b) _mm256_cmp_ps(a, b, _CMP_LE_OQ)
+#define Simd_Load(p)     _mm256_loadu_ps(p)
+#define Simd_Max(a, b)   _mm256_max_ps(a, b)
+#define Simd_Min(a, b)   _mm256_min_ps(a, b)
+#define Simd_MoveMask(m) _mm256_movemask_ps(m)
+#define Simd_Mul(a, b)   _mm256_mul_ps(a, b)
+#define Simd_Set(d)      _mm256_set1_ps(d)
+#define Simd_Store(p, v) _mm256_storeu_ps(p, v)
+#define Simd_Sub(a, b)   _mm256_sub_ps(a, b)
+
+#elif defined(ESZFW_SCALAR_FLOAT) && \
+    (defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1))
+
+#include <xmmintrin.h>
+
+#define SIMD_WIDTH 4
+
+typedef __m128 SimdScalar;
+typedef __m128 SimdMask;
+
+#define Simd_Add(a, b)   _mm_add_ps(a, b)
+#define Simd_And(a, b)   _mm_and_ps(a, b)
+#define Simd_CmpLe(a, b) _mm_cmple_ps(a, b)
+#define Simd_Load(p)     _mm_loadu_ps(p)
+#define Simd_Max(a, b)   _mm_max_ps(a, b)
+#define Simd_Min(a, b)   _mm_min_ps(a, b)
+#define Simd_MoveMask(m) _mm_movemask_ps(m)
+#define Simd_Mul(a, b)   _mm_mul_ps(a, b)
+#define Simd_Set(d)      _mm_set1_ps(d)
+#define Simd_Store(p, v) _mm_storeu_ps(p, v)
+#define Simd_Sub(a, b)   _mm_sub_ps(a, b)
+
+#elif defined(ESZFW_SCALAR_FLOAT) && defined(__ARM_NEON) && defined(__aarch64__)
+
+#include <arm_neon.h>
+
+#define SIMD_WIDTH 4
+
+typedef float32x4_t SimdScalar;
+typedef uint32x4_t  SimdMask;
+
+#define Simd_Add(a, b)   vaddq_f32(a, b)
+#define Simd_And(a, b)   vandq_u32(a, b)
+#define Simd_CmpLe(a, b) vcleq_f32(a, b)
+#define Simd_Load(p)     vld1q_f32(p)
+#define Simd_Max(a, b)   vmaxq_f32(a, b)
+#define Simd_Min(a, b)   vminq_f32(a, b)
+#define Simd_MoveMask(m) \
+    (int)((vgetq_lane_u32(m, 0) & 1) | ((vgetq_lane_u32(m, 1) & 1) << 1) | \
+          ((vgetq_lane_u32(m, 2) & 1) << 2) | ((vgetq_lane_u32(m, 3) & 1) << 3))
+#define Simd_Mul(a, b)   vmulq_f32(a, b)
+#define Simd_Set(d)      vdupq_n_f32(d)
+#define Simd_Store(p, v) vst1q_f32(p, v)
+#define Simd_Sub(a, b)   vsubq_f32(a, b)
+
+#elif defined(ESZFW_SCALAR_FLOAT)
+
+// No packed float support on this target; handled by the scalar
+// fallback below.
+
+#elif defined(__AVX__)
+
+#include <immintrin.h>
+
+#define SIMD_WIDTH 4
+
+typedef __m256d SimdScalar;
+typedef __m256d SimdMask;
+
+#define Simd_Add(a, b)   _mm256_add_pd(a, b)
+#define Simd_And(a, b)   _mm256_and_pd(a, b)
+#define Simd_CmpLe(a, b) _mm256_cmp_pd(a, b, _CMP_LE_OQ)
+#define Simd_Load(p)     _mm256_loadu_pd(p)
+#define Simd_Max(a, b)   _mm256_max_pd(a, b)
+#define Simd_Min(a, b)   _mm256_min_pd(a, b)
+#define Simd_MoveMask(m) _mm256_movemask_pd(m)
+#define Simd_Mul(a, b)   _mm256_mul_pd(a, b)
+#define Simd_Set(d)      _mm256_set1_pd(d)
+#define Simd_Store(p, v) _mm256_storeu_pd(p, v)
+#define Simd_Sub(a, b)   _mm256_sub_pd(a, b)
+
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+
+#include <emmintrin.h>
+
+#define SIMD_WIDTH 2
+
+typedef __m128d SimdScalar;
+typedef __m128d SimdMask;
+
+#define Simd_Add(a, b)   _mm_add_pd(a, b)
+#define Simd_And(a, b)   _mm_and_pd(a, b)
+#define Simd_CmpLe(a, b) _mm_cmple_pd(a, b)
+#define Simd_Load(p)     _mm_loadu_pd(p)
+#define Simd_Max(a, b)   _mm_max_pd(a, b)
+#define Simd_Min(a, b)   _mm_min_pd(a, b)
+#define Simd_MoveMask(m) _mm_movemask_pd(m)
+#define Simd_Mul(a, b)   _mm_mul_pd(a, b)
+#define Simd_Set(d)      _mm_set1_pd(d)
+#define Simd_Store(p, v) _mm_storeu_pd(p, v)
+#define Simd_Sub(a, b)   _mm_sub_pd(a, b)
+
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+
+#include <arm_neon.h>
+
+#define SIMD_WIDTH 2
+
+typedef float64x2_t SimdScalar;
+typedef uint64x2_t  SimdMask;
+
+#define Simd_Add(a, b)   vaddq_f64(a, b)
+#define Simd_And(a, b)   vandq_u64(a, b)
+#define Simd_CmpLe(a, b) vcleq_f64(a, b)
+#define Simd_Load(p)     vld1q_f64(p)
+#define Simd_Max(a, b)   vmaxq_f64(a, b)
+#define Simd_Min(a, b)   vminq_f64(a, b)
+#define Simd_MoveMask(m) (int)((vgetq_lane_u64(m, 0) & 1) | ((vgetq_lane_u64(m, 1) & 1) << 1))
+#define Simd_Mul(a, b)   vmulq_f64(a, b)
+#define Simd_Set(d)      vdupq_n_f64(d)
+#define Simd_Store(p, v) vst1q_f64(p, v)
+#define Simd_Sub(a, b)   vsubq_f64(a, b)
+
+#endif
+
+#ifndef SIMD_WIDTH
+
+#define SIMD_WIDTH 1
+
+typedef Scalar SimdScalar;
+typedef int    SimdMask;
+
+#define Simd_Add(a, b)   ((a) + (b))
+#define Simd_And(a, b)   ((a) & (b))
+#define Simd_CmpLe(a, b) ((a) <= (b))
+#define Simd_Load(p)     (*(p))
+#define Simd_Max(a, b)   SDL_max(a, b)
+#define Simd_Min(a, b)   SDL_min(a, b)
+#define Simd_MoveMask(m) (m)
+#define Simd_Mul(a, b)   Scalar_Mul(a, b)
+#define Simd_Set(d)      ((Scalar)(d))
+#define Simd_Store(p, v) (*(p) = (v))
+#define Simd_Sub(a, b)   ((a) - (b))
+
+#endif
+
+/**
+ * @def     SIMD_PADDING
+ * @brief   Array length all SIMD loops may round up to
+ * @details Arrays processed with the macros above are padded to a
+ *          multiple of this length so the loops need no scalar tail.
+ */
+#define SIMD_PADDING 8
@@ -0,0 +1,786 @@
+// SPDX-License-Identifier: Beerware
+/**
+ * @file      SpriteAtlas.c
+ * @ingroup   SpriteAtlas
+ * @defgroup  SpriteAtlas Sprite atlas
+ * @author    Michael Fitzmayer
+ * @copyright "THE BEER-WARE LICENCE" (Revision 42)
+ */
+
+#include <SDL.h>
+#include "Asset.h"
+#include "Job.h"
+#include "Map.h"
+#include "SpriteAtlas.h"
+#include "Utils.h"
+
+/**
+ * @typedef SkylineNode
+ * @brief   Skyline node handle type
+ * @struct  SkylineNode_t
+ * @brief   Horizontal segment of the upper outline of a packed page
+ */
+typedef struct SkylineNode_t
+{
+    Uint16 u16PosX;   ///< Left edge of the segment
+    Uint16 u16PosY;   ///< Height of the outline along the segment
+    Uint16 u16Width;  ///< Segment width
+
+} SkylineNode;
+
+/**
+ * @typedef SpriteAtlasDecode
+ * @brief   Sprite atlas decode handle type
+ * @struct  SpriteAtlasDecode_t
+ * @brief   Sprite images decoded in parallel while composing the atlas
+ */
+typedef struct SpriteAtlasDecode_t
+{
+    const SpriteAtlasEntry* pstEntry;    ///< Entries
+    const Uint32*           pu32Source;  ///< First entry with the same image file
+    SDL_Surface**           ppstImage;   ///< Decoded image per first entry, NULL on error
+
+} SpriteAtlasDecode;
+
+static void _AddSkylineLevel(
+    const Uint32 u32Index,
+    const Uint16 u16PosX,
+    const Uint16 u16PosY,
+    const Uint16 u16Width,
+    const Uint16 u16Height,
+    SkylineNode* pstNode,
+    Uint32*      pu32Count)
+{
+    SDL_memmove(
+        &pstNode[u32Index + 1], &pstNode[u32Index], (*pu32Count - u32Index) * sizeof(SkylineNode));
+    pstNode[u32Index].u16PosX  = u16PosX;
+    pstNode[u32Index].u16PosY  = u16PosY + u16Height;
+    pstNode[u32Index].u16Width = u16Width;
+    (*pu32Count)++;
+
+    // Cut the segments now covered by the new one.
+    while (u32Index + 1 < *pu32Count)
+    {
+        SkylineNode* pstNext = &pstNode[u32Index + 1];
+        Uint16       u16End  = u16PosX + u16Width;
+
+        if (pstNext->u16PosX >= u16End)
+        {
+            break;
+        }
+
+        if (pstNext->u16PosX + pstNext->u16Width <= u16End)
+        {
+            SDL_memmove(
+                pstNext, pstNext + 1, (*pu32Count - u32Index - 2) * sizeof(SkylineNode));
+            (*pu32Count)--;
+            continue;
+        }
+
+        pstNext->u16Width -= u16End - pstNext->u16PosX;
+        pstNext->u16PosX = u16End;
+        break;
+    }
+
+    // Merge neighbours of equal height.
+    for (Uint32 u32Node = 0; u32Node + 1 < *pu32Count;)
+    {
+        if (pstNode[u32Node].u16PosY == pstNode[u32Node + 1].u16PosY)
+        {
+            pstNode[u32Node].u16Width += pstNode[u32Node + 1].u16Width;
+            SDL_memmove(
+                &pstNode[u32Node + 1],
+                &pstNode[u32Node + 2],
+                (*pu32Count - u32Node - 2) * sizeof(SkylineNode));
+            (*pu32Count)--;
+            continue;
+        }
+        u32Node++;
+    }
+}
+
+static void _DecodeImages(const Uint32 u32First, const Uint32 u32Last, void* pData)
+{
+    SpriteAtlasDecode* pstDecode = pData;
+
+    for (Uint32 u32Index = u32First; u32Index < u32Last; u32Index++)
+    {
+        // Entries sharing an image file use the first one's image.
+        if (u32Index != pstDecode->pu32Source[u32Index])
+        {
+            continue;
+        }
+
+        pstDecode->ppstImage[u32Index] =
+            Asset_LoadImage(pstDecode->pstEntry[u32Index].acImage, Asset_GetDefaultCache());
+    }
+}
+
+static Sint32 _FitSkyline(
+    const SkylineNode* pstNode,
+    const Uint32       u32Count,
+    Uint32             u32Index,
+    const Uint16       u16Width,
+    const Uint16       u16Height)
+{
+    Sint32 s32PosY = 0;
+    Sint32 s32Left = u16Width;
+
+    if (pstNode[u32Index].u16PosX + u16Width > ATLAS_PAGE_LEN)
+    {
+        return -1;
+    }
+
+    // The area rests on the highest segment it spans.
+    while (s32Left > 0 && u32Index < u32Count)
+    {
+        s32PosY = SDL_max(s32PosY, pstNode[u32Index].u16PosY);
+        if (s32PosY + u16Height > ATLAS_PAGE_LEN)
+        {
+            return -1;
+        }
+
+        s32Left -= pstNode[u32Index].u16Width;
+        u32Index++;
+    }
+
+    return s32PosY;
+}
+
+static void _FreePages(SpriteAtlas* pstAtlas)
+{
+    for (Uint8 u8Page = 0; u8Page < pstAtlas->u8PageCount; u8Page++)
+    {
+        AtlasPage* pstPage = &pstAtlas->astPage[u8Page];
+
+        if (pstPage->pstSurface)
+        {
+            SDL_FreeSurface(pstPage->pstSurface);
+            pstPage->pstSurface = NULL;
+        }
+
+        if (pstPage->pstTexture)
+        {
+            SDL_DestroyTexture(pstPage->pstTexture);
+            pstPage->pstTexture = NULL;
+        }
+    }
+}
+
+static Sint8 _PackEntries(SpriteAtlas* pstAtlas)
+{
+    Uint32*      pu32Order;
+    SkylineNode* pstNode;
+    Uint32       au32NodeCount[ATLAS_PAGES_MAX];
+    Uint32       u32NodeMax = pstAtlas->u32EntryCount + 1;
+
+    pu32Order = SDL_malloc(pstAtlas->u32EntryCount * sizeof(Uint32));
+    pstNode   = SDL_malloc(ATLAS_PAGES_MAX * u32NodeMax * sizeof(SkylineNode));
+    if (!pu32Order || !pstNode)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "PackSpriteAtlas(): error allocating memory.\n");
+        SDL_free(pu32Order);
+        SDL_free(pstNode);
+        return -1;
+    }
+
+    // Sort entries by height, tallest first (insertion sort, few sprites).
+    for (Uint32 u32Index = 0; u32Index < pstAtlas->u32EntryCount; u32Index++)
+    {
+        Uint32 u32Pos = u32Index;
+
+        while (u32Pos > 0 && pstAtlas->pstEntry[pu32Order[u32Pos - 1]].u16Height <
+                                 pstAtlas->pstEntry[u32Index].u16Height)
+        {
+            pu32Order[u32Pos] = pu32Order[u32Pos - 1];
+            u32Pos--;
+        }
+        pu32Order[u32Pos] = u32Index;
+    }
+
+    pstAtlas->u8PageCount = 0;
+
+    // Skyline bottom-left packer: each area goes where its top edge
+    // ends up lowest, on the first page it fits on.
+    for (Uint32 u32Index = 0; u32Index < pstAtlas->u32EntryCount; u32Index++)
+    {
+        SpriteAtlasEntry* pstEntry  = &pstAtlas->pstEntry[pu32Order[u32Index]];
+        SDL_bool          bIsPlaced = SDL_FALSE;
+
+        for (Uint8 u8Page = 0; u8Page <= pstAtlas->u8PageCount && !bIsPlaced; u8Page++)
+        {
+            SkylineNode* pstPageNode = &pstNode[u8Page * u32NodeMax];
+            AtlasPage*   pstPage     = &pstAtlas->astPage[u8Page];
+            Sint32       s32BestY    = ATLAS_PAGE_LEN;
+            Uint32       u32Best     = 0;
+
+            if (u8Page == pstAtlas->u8PageCount)
+            {
+                if (pstAtlas->u8PageCount >= ATLAS_PAGES_MAX)
+                {
+                    break;
+                }
+
+                // Open a new page.
+                pstPageNode[0].u16PosX  = 0;
+                pstPageNode[0].u16PosY  = 0;
+                pstPageNode[0].u16Width = ATLAS_PAGE_LEN;
+                au32NodeCount[u8Page]   = 1;
+                pstPage->u16Width       = 0;
+                pstPage->u16Height      = 0;
+            }
+
+            for (Uint32 u32Node = 0; u32Node < au32NodeCount[u8Page]; u32Node++)
+            {
+                Sint32 s32PosY = _FitSkyline(
+                    pstPageNode,
+                    au32NodeCount[u8Page],
+                    u32Node,
+                    pstEntry->u16Width,
+                    pstEntry->u16Height);
+
+                if (-1 != s32PosY && s32PosY < s32BestY)
+                {
+                    s32BestY  = s32PosY;
+                    u32Best   = u32Node;
+                    bIsPlaced = SDL_TRUE;
+                }
+            }
+
+            if (!bIsPlaced)
+            {
+                continue;
+            }
+
+            pstEntry->u8Page  = u8Page;
+            pstEntry->u16PosX = pstPageNode[u32Best].u16PosX;
+            pstEntry->u16PosY = (Uint16)s32BestY;
+
+            _AddSkylineLevel(
+                u32Best,
+                pstEntry->u16PosX,
+                pstEntry->u16PosY,
+                pstEntry->u16Width,
+                pstEntry->u16Height,
+                pstPageNode,
+                &au32NodeCount[u8Page]);
+
+            pstPage->u16Width =
+                SDL_max(pstPage->u16Width, pstEntry->u16PosX + pstEntry->u16Width);
+            pstPage->u16Height =
+                SDL_max(pstPage->u16Height, pstEntry->u16PosY + pstEntry->u16Height);
+
+            if (u8Page == pstAtlas->u8PageCount)
+            {
+                pstAtlas->u8PageCount++;
+            }
+        }
+
+        if (!bIsPlaced)
+        {
+            SDL_LogError(
+                SDL_LOG_CATEGORY_APPLICATION,
+                "PackSpriteAtlas(): %s does not fit into %d atlas pages.\n",
+                pstEntry->acImage,
+                ATLAS_PAGES_MAX);
+            SDL_free(pu32Order);
+            SDL_free(pstNode);
+            return -1;
+        }
+    }
+
+    SDL_free(pu32Order);
+    SDL_free(pstNode);
+
+    pstAtlas->bIsPacked = SDL_TRUE;
+
+    return 0;
+}
+
+static Sint8 _ResolveEntries(
+    SDL_Surface** ppstImage,
+    const Uint32* pu32Source,
+    SpriteAtlas*  pstAtlas)
+{
+    for (Uint32 u32Index = 0; u32Index < pstAtlas->u32EntryCount; u32Index++)
+    {
+        SpriteAtlasEntry* pstEntry = &pstAtlas->pstEntry[u32Index];
+        SDL_Surface*      pstImage = ppstImage[pu32Source[u32Index]];
+        SDL_Rect          stSrc    = pstEntry->stSrc;
+
+        if (!pstImage)
+        {
+            return -1;
+        }
+
+        if (0 == stSrc.w || 0 == stSrc.h)
+        {
+            stSrc.w = pstImage->w - stSrc.x;
+            stSrc.h = pstImage->h - stSrc.y;
+        }
+
+        if (stSrc.x < 0 || stSrc.y < 0 || stSrc.w <= 0 || stSrc.h <= 0 ||
+            stSrc.x + stSrc.w > pstImage->w || stSrc.y + stSrc.h > pstImage->h)
+        {
+            SDL_LogError(
+                SDL_LOG_CATEGORY_APPLICATION,
+                "PackSpriteAtlas(): invalid area of %s.\n",
+                pstEntry->acImage);
+            return -1;
+        }
+
+        if (stSrc.w > ATLAS_PAGE_LEN || stSrc.h > ATLAS_PAGE_LEN)
+        {
+            SDL_LogError(
+                SDL_LOG_CATEGORY_APPLICATION,
+                "PackSpriteAtlas(): %s exceeds the atlas page size.\n",
+                pstEntry->acImage);
+            return -1;
+        }
+
+        // A loaded layout is only valid for images of the same size.
+        if (pstAtlas->bIsPacked &&
+            (pstEntry->u16Width != stSrc.w || pstEntry->u16Height != stSrc.h))
+        {
+            SDL_Log("%s has changed, repack sprite atlas.\n", pstEntry->acImage);
+            pstAtlas->bIsPacked = SDL_FALSE;
+        }
+
+        pstEntry->u16Width  = (Uint16)stSrc.w;
+        pstEntry->u16Height = (Uint16)stSrc.h;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief   Add image to sprite atlas
+ * @details Registers an image file, or an area of it, for the next
+ *          SpriteAtlas_Pack()
+ * @param   pacFileName
+ *          Path and filename of the image file
+ * @param   pstSrc
+ *          Area of the image, e.g. a sprite sheet, NULL for all of it
+ * @param   pstAtlas
+ *          Pointer to sprite atlas handle
+ * @return  Entry index, see Entity_InitSpriteFromAtlas()
+ * @retval  -1: Error
+ * @remark  Registering the same area twice returns the same index.
+ */
+Sint32 SpriteAtlas_Add(const char* pacFileName, const SDL_Rect* pstSrc, SpriteAtlas* pstAtlas)
+{
+    SDL_Rect          stSrc = { 0, 0, 0, 0 };
+    SpriteAtlasEntry* pstEntry;
+
+    if (pstAtlas->bIsUploaded)
+    {
+        SDL_LogError(
+            SDL_LOG_CATEGORY_APPLICATION, "AddToSpriteAtlas(): atlas is already packed.\n");
+        return -1;
+    }
+
+    if (SDL_strlen(pacFileName) >= SPRITE_IMG_PATH_LEN)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "AddToSpriteAtlas(): path too long.\n");
+        return -1;
+    }
+
+    if (pstSrc)
+    {
+        stSrc = *pstSrc;
+    }
+
+    for (Uint32 u32Index = 0; u32Index < pstAtlas->u32EntryCount; u32Index++)
+    {
+        pstEntry = &pstAtlas->pstEntry[u32Index];
+
+        if (0 == SDL_strcmp(pstEntry->acImage, pacFileName) && pstEntry->stSrc.x == stSrc.x &&
+            pstEntry->stSrc.y == stSrc.y && pstEntry->stSrc.w == stSrc.w &&
+            pstEntry->stSrc.h == stSrc.h)
+        {
+            return (Sint32)u32Index;
+        }
+    }
+
+    if (pstAtlas->u32EntryCount == pstAtlas->u32EntryCapacity)
+    {
+        Uint32            u32Capacity = SDL_max(pstAtlas->u32EntryCapacity * 2, 16);
+        SpriteAtlasEntry* pstNew;
+
+        pstNew = SDL_realloc(pstAtlas->pstEntry, u32Capacity * sizeof(struct SpriteAtlasEntry_t));
+        if (!pstNew)
+        {
+            SDL_LogError(
+                SDL_LOG_CATEGORY_APPLICATION, "AddToSpriteAtlas(): error allocating memory.\n");
+            return -1;
+        }
+
+        pstAtlas->pstEntry         = pstNew;
+        pstAtlas->u32EntryCapacity = u32Capacity;
+    }
+
+    pstEntry = &pstAtlas->pstEntry[pstAtlas->u32EntryCount];
+    SDL_memset(pstEntry, 0, sizeof(struct SpriteAtlasEntry_t));
+    SDL_strlcpy(pstEntry->acImage, pacFileName, SPRITE_IMG_PATH_LEN);
+    pstEntry->stSrc = stSrc;
+
+    // A new entry invalidates any loaded layout.
+    pstAtlas->bIsPacked = SDL_FALSE;
+
+    return (Sint32)pstAtlas->u32EntryCount++;
+}
+
+/**
+ * @brief   Free sprite atlas
+ * @details Frees up allocated memory and unloads sprite atlas
+ * @param   pstAtlas
+ *          Pointer to sprite atlas handle
+ * @remark  Sprites initialised from the atlas must not be used
+ *          afterwards.
+ */
+void SpriteAtlas_Free(SpriteAtlas* pstAtlas)
+{
+    if (pstAtlas)
+    {
+        _FreePages(pstAtlas);
+        SDL_free(pstAtlas->pstEntry);
+        SDL_free(pstAtlas);
+        SDL_Log("Unload sprite atlas.\n");
+    }
+}
+
+/**
+ * @brief   Initialise sprite atlas
+ * @details Initialises an empty sprite atlas, see SpriteAtlas_Add()
+ * @param   pstAtlas
+ *          Pointer to sprite atlas handle
+ * @return  Error code
+ * @retval   0: OK
+ * @retval  -1: Error
+ */
+Sint8 SpriteAtlas_Init(SpriteAtlas** pstAtlas)
+{
+    *pstAtlas = SDL_calloc(sizeof(struct SpriteAtlas_t), sizeof(Sint8));
+    if (!*pstAtlas)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InitSpriteAtlas(): error allocating memory.\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief   Load sprite atlas layout
+ * @details Loads a layout written by SpriteAtlas_Save() so that
+ *          SpriteAtlas_Pack() does not have to pack the images again
+ * @param   pacFileName
+ *          Path and filename of the saved layout
+ * @param   pstAtlas
+ *          Pointer to sprite atlas handle, with the same images
+ *          registered in the same order as when it was saved
+ * @return  Error code
+ * @retval   0: OK
+ * @retval  -1: Error, the images are packed from scratch
+ */
+Sint8 SpriteAtlas_Load(const char* pacFileName, SpriteAtlas* pstAtlas)
+{
+    const SpriteAtlasHeader* pstHeader;
+    const SpriteAtlasEntry*  pstEntry;
+    MappedFile               stFile;
+    Sint8                    s8ReturnValue = -1;
+
+    if (pstAtlas->bIsUploaded || -1 == Utils_MapFile(pacFileName, &stFile))
+    {
+        return -1;
+    }
+
+    pstHeader = stFile.pData;
+    pstEntry  = (const SpriteAtlasEntry*)(pstHeader + 1);
+
+    if (stFile.zSize < sizeof(struct SpriteAtlasHeader_t) ||
+        0 != SDL_memcmp(pstHeader->acMagic, "ESZA", sizeof(pstHeader->acMagic)) ||
+        SPRITE_ATLAS_VERSION != pstHeader->u32Version ||
+        pstHeader->u32EntryCount != pstAtlas->u32EntryCount ||
+        pstHeader->u8PageCount > ATLAS_PAGES_MAX ||
+        stFile.zSize != sizeof(struct SpriteAtlasHeader_t) +
+                            pstHeader->u32EntryCount * sizeof(struct SpriteAtlasEntry_t))
+    {
+        SDL_Log("%s does not match the sprite atlas.\n", pacFileName);
+        goto exit;
+    }
+
+    for (Uint8 u8Page = 0; u8Page < pstHeader->u8PageCount; u8Page++)
+    {
+        if (0 == pstHeader->au16PageWidth[u8Page] || 0 == pstHeader->au16PageHeight[u8Page] ||
+            pstHeader->au16PageWidth[u8Page] > ATLAS_PAGE_LEN ||
+            pstHeader->au16PageHeight[u8Page] > ATLAS_PAGE_LEN)
+        {
+            SDL_Log("%s does not match the sprite atlas.\n", pacFileName);
+            goto exit;
+        }
+    }
+
+    for (Uint32 u32Index = 0; u32Index < pstAtlas->u32EntryCount; u32Index++)
+    {
+        const SpriteAtlasEntry* pstOwn = &pstAtlas->pstEntry[u32Index];
+        const SpriteAtlasEntry* pstNew = &pstEntry[u32Index];
+
+        if (0 != SDL_strncmp(pstOwn->acImage, pstNew->acImage, SPRITE_IMG_PATH_LEN) ||
+            0 != SDL_memcmp(&pstOwn->stSrc, &pstNew->stSrc, sizeof(SDL_Rect)) ||
+            pstNew->u8Page >= pstHeader->u8PageCount)
+        {
+            SDL_Log("%s does not match the sprite atlas.\n", pacFileName);
+            goto exit;
+        }
+
+        // An area outside its page would make SpriteAtlas_Pack() fail
+        // instead of packing from scratch.
+        if (0 == pstNew->u16Width || 0 == pstNew->u16Height ||
+            (Uint32)pstNew->u16PosX + pstNew->u16Width > pstHeader->au16PageWidth[pstNew->u8Page] ||
+            (Uint32)pstNew->u16PosY + pstNew->u16Height > pstHeader->au16PageHeight[pstNew->u8Page])
+        {
+            SDL_Log("%s does not match the sprite atlas.\n", pacFileName);
+            goto exit;
+        }
+    }
+
+    SDL_memcpy(
+        pstAtlas->pstEntry, pstEntry, pstAtlas->u32EntryCount * sizeof(struct SpriteAtlasEntry_t));
+
+    pstAtlas->u8PageCount = pstHeader->u8PageCount;
+    for (Uint8 u8Page = 0; u8Page < pstAtlas->u8PageCount; u8Page++)
+    {
+        pstAtlas->astPage[u8Page].u16Width  = pstHeader->au16PageWidth[u8Page];
+        pstAtlas->astPage[u8Page].u16Height = pstHeader->au16PageHeight[u8Page];
+    }
+
+    pstAtlas->bIsPacked = SDL_TRUE;
+    s8ReturnValue       = 0;
+
+    SDL_Log("Load sprite atlas layout: %s.\n", pacFileName);
+
+exit:
+    Utils_UnmapFile(&stFile);
+
+    return s8ReturnValue;
+}
+
+/**
+ * @brief   Pack sprite atlas
+ * @details Decodes all registered images, packs them into as few atlas
+ *          pages as possible and uploads the pages
+ * @remark  Sprites on the same page share a texture, which lets a
+ *          SpriteBatch draw them with a single draw call.  Images are
+ *          decoded in parallel, each file only once.  The atlas is
+ *          fixed afterwards.
+ * @param   pstRenderer
+ *          Pointer to SDL2 rendering context
+ * @param   pstAtlas
+ *          Pointer to sprite atlas handle
+ * @return  Error code
+ * @retval   0: OK
+ * @retval  -1: Error
+ */
+Sint8 SpriteAtlas_Pack(SDL_Renderer* pstRenderer, SpriteAtlas* pstAtlas)
+{
+    SpriteAtlasDecode stDecode;
+    Uint32*           pu32Source;
+    Sint8             s8ReturnValue = -1;
+
+    if (pstAtlas->bIsUploaded || 0 == pstAtlas->u32EntryCount)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "PackSpriteAtlas(): nothing to pack.\n");
+        return -1;
+    }
+
+    pu32Source         = SDL_malloc(pstAtlas->u32EntryCount * sizeof(Uint32));
+    stDecode.ppstImage = SDL_calloc(pstAtlas->u32EntryCount, sizeof(SDL_Surface*));
+    if (!pu32Source || !stDecode.ppstImage)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "PackSpriteAtlas(): error allocating memory.\n");
+        SDL_free(pu32Source);
+        SDL_free(stDecode.ppstImage);
+        return -1;
+    }
+
+    for (Uint32 u32Index = 0; u32Index < pstAtlas->u32EntryCount; u32Index++)
+    {
+        pu32Source[u32Index] = u32Index;
+
+        for (Uint32 u32Prev = 0; u32Prev < u32Index; u32Prev++)
+        {
+            if (0 == SDL_strcmp(
+                         pstAtlas->pstEntry[u32Prev].acImage, pstAtlas->pstEntry[u32Index].acImage))
+            {
+                pu32Source[u32Index] = u32Prev;
+                break;
+            }
+        }
+    }
+
+    stDecode.pstEntry   = pstAtlas->pstEntry;
+    stDecode.pu32Source = pu32Source;
+
+    // Decoding dominates; the images are independent of each other.
+    Job_ParallelFor(pstAtlas->u32EntryCount, 1, _DecodeImages, &stDecode, Job_GetDefaultPool());
+
+    if (-1 == _ResolveEntries(stDecode.ppstImage, pu32Source, pstAtlas))
+    {
+        goto exit;
+    }
+
+    if (!pstAtlas->bIsPacked && -1 == _PackEntries(pstAtlas))
+    {
+        goto exit;
+    }
+
+    for (Uint8 u8Page = 0; u8Page < pstAtlas->u8PageCount; u8Page++)
+    {
+        AtlasPage* pstPage = &pstAtlas->astPage[u8Page];
+
+        pstPage->pstSurface = SDL_CreateRGBSurfaceWithFormat(
+            0, pstPage->u16Width, pstPage->u16Height, 32, SDL_PIXELFORMAT_ARGB8888);
+
+        if (!pstPage->pstSurface)
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+            goto exit;
+        }
+    }
+
+    for (Uint32 u32Index = 0; u32Index < pstAtlas->u32EntryCount; u32Index++)
+    {
+        const SpriteAtlasEntry* pstEntry = &pstAtlas->pstEntry[u32Index];
+        SDL_Surface*            pstImage = stDecode.ppstImage[pu32Source[u32Index]];
+        SDL_Rect                stSrc;
+
+        stSrc.x = pstEntry->stSrc.x;
+        stSrc.y = pstEntry->stSrc.y;
+        stSrc.w = pstEntry->u16Width;
+        stSrc.h = pstEntry->u16Height;
+
+        // The image is shared through the asset cache and may be in use
+        // by other threads, so it is only read.
+        if (0 != Utils_CopySurfaceArea(
+                     pstImage,
+                     &stSrc,
+                     pstEntry->u16PosX,
+                     pstEntry->u16PosY,
+                     pstAtlas->astPage[pstEntry->u8Page].pstSurface))
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+            goto exit;
+        }
+    }
+
+    for (Uint8 u8Page = 0; u8Page < pstAtlas->u8PageCount; u8Page++)
+    {
+        AtlasPage* pstPage = &pstAtlas->astPage[u8Page];
+
+        pstPage->pstTexture = SDL_CreateTextureFromSurface(pstRenderer, pstPage->pstSurface);
+        if (!pstPage->pstTexture)
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+            goto exit;
+        }
+
+        if (0 != SDL_SetTextureBlendMode(pstPage->pstTexture, SDL_BLENDMODE_BLEND))
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+            goto exit;
+        }
+
+        SDL_FreeSurface(pstPage->pstSurface);
+        pstPage->pstSurface = NULL;
+    }
+
+    pstAtlas->bIsUploaded = SDL_TRUE;
+    s8ReturnValue         = 0;
+
+    SDL_Log(
+        "Pack %u sprite image area(s) into %d atlas page(s).\n",
+        pstAtlas->u32EntryCount,
+        pstAtlas->u8PageCount);
+
+exit:
+    for (Uint32 u32Index = 0; u32Index < pstAtlas->u32EntryCount; u32Index++)
+    {
+        Asset_Release(ASSET_IMAGE, stDecode.ppstImage[u32Index], Asset_GetDefaultCache());
+    }
+    SDL_free(stDecode.ppstImage);
+    SDL_free(pu32Source);
+
+    if (-1 == s8ReturnValue)
+    {
+        _FreePages(pstAtlas);
+    }
+
+    return s8ReturnValue;
+}
+
+/**
+ * @brief   Save sprite atlas layout
+ * @details Writes the positions of all packed image areas to a file
+ *          that can be loaded with SpriteAtlas_Load()
+ * @param   pacFileName
+ *          Path and filename of the layout to write
+ * @param   pstAtlas
+ *          Pointer to sprite atlas handle
+ * @return  Error code
+ * @retval   0: OK
+ * @retval  -1: Error
+ * @remark  Like baked maps, the format stores the in-memory layout and
+ *          is only meant to be read by the same build of the framework.
+ */
+Sint8 SpriteAtlas_Save(const char* pacFileName, const SpriteAtlas* pstAtlas)
+{
+    SpriteAtlasHeader stHeader;
+    SDL_RWops*        pstRW;
+    Sint8             s8ReturnValue = 0;
+
+    if (!pstAtlas->bIsPacked)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "SaveSpriteAtlas(): atlas is not packed.\n");
+        return -1;
+    }
+
+    SDL_memset(&stHeader, 0, sizeof(struct SpriteAtlasHeader_t));
+    SDL_memcpy(stHeader.acMagic, "ESZA", sizeof(stHeader.acMagic));
+
+    stHeader.u32Version    = SPRITE_ATLAS_VERSION;
+    stHeader.u32EntryCount = pstAtlas->u32EntryCount;
+    stHeader.u8PageCount   = pstAtlas->u8PageCount;
+
+    for (Uint8 u8Page = 0; u8Page < pstAtlas->u8PageCount; u8Page++)
+    {
+        stHeader.au16PageWidth[u8Page]  = pstAtlas->astPage[u8Page].u16Width;
+        stHeader.au16PageHeight[u8Page] = pstAtlas->astPage[u8Page].u16Height;
+    }
+
+    pstRW = SDL_RWFromFile(pacFileName, "wb");
+    if (!pstRW)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+        return -1;
+    }
+
+    if (1 != SDL_RWwrite(pstRW, &stHeader, sizeof(struct SpriteAtlasHeader_t), 1) ||
+        pstAtlas->u32EntryCount != SDL_RWwrite(
+                                       pstRW,
+                                       pstAtlas->pstEntry,
+                                       sizeof(struct SpriteAtlasEntry_t),
+                                       pstAtlas->u32EntryCount))
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+        s8ReturnValue = -1;
+    }
+
+    if (0 != SDL_RWclose(pstRW))
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+        s8ReturnValue = -1;
+    }
+
+    return s8ReturnValue;
+}
@@ -0,0 +1,83 @@
+// SPDX-License-Identifier: Beerware
+/**
+ * @file    SpriteAtlas.h
+ * @brief   Sprite atlas include header
+ * @ingroup SpriteAtlas
+ */
+#pragma once
+
+#include <SDL.h>
+#include "Map.h"
+
+/**
+ * @typedef SpriteAtlasConstants
+ * @brief   Sprite atlas constants handle type
+ * @enum    SpriteAtlasConstants_t
+ * @brief   Sprite atlas constants enumeration
+ */
+typedef enum SpriteAtlasConstants_t
+{
+    SPRITE_IMG_PATH_LEN  = 256,  ///< Max. sprite image path length
+    SPRITE_ATLAS_VERSION = 1     ///< Saved sprite atlas format version
+
+} SpriteAtlasConstants;
+
+/**
+ * @typedef SpriteAtlasEntry
+ * @brief   Sprite atlas entry handle type
+ * @struct  SpriteAtlasEntry_t
+ * @brief   Image area registered with a sprite atlas
+ */
+typedef struct SpriteAtlasEntry_t
+{
+    char     acImage[SPRITE_IMG_PATH_LEN];  ///< Image file
+    SDL_Rect stSrc;                         ///< Area of the image, zero size for all of it
+    Uint16   u16Width;                      ///< Resolved width of the area in pixel
+    Uint16   u16Height;                     ///< Resolved height of the area in pixel
+    Uint16   u16PosX;                       ///< Position in the atlas page along the x-axis
+    Uint16   u16PosY;                       ///< Position in the atlas page along the y-axis
+    Uint8    u8Page;                        ///< Atlas page index
+
+} SpriteAtlasEntry;
+
+/**
+ * @typedef SpriteAtlasHeader
+ * @brief   Sprite atlas header handle type
+ * @struct  SpriteAtlasHeader_t
+ * @brief   File header of a saved sprite atlas, followed by the entries
+ */
+typedef struct SpriteAtlasHeader_t
+{
+    char   acMagic[4];                      ///< "ESZA"
+    Uint32 u32Version;                      ///< SPRITE_ATLAS_VERSION
+    Uint32 u32EntryCount;                   ///< Number of entries
+    Uint16 au16PageWidth[ATLAS_PAGES_MAX];  ///< Page widths in pixel
+    Uint16 au16PageHeight[ATLAS_PAGES_MAX]; ///< Page heights in pixel
+    Uint8  u8PageCount;                     ///< Number of atlas pages
+
+} SpriteAtlasHeader;
+
+/**
+ * @typedef SpriteAtlas
+ * @brief   Sprite atlas handle type
+ * @struct  SpriteAtlas_t
+ * @brief   Sprite atlas handle data
+ */
+typedef struct SpriteAtlas_t
+{
+    SpriteAtlasEntry* pstEntry;                  ///< Registered image areas
+    Uint32            u32EntryCount;             ///< Number of entries
+    Uint32            u32EntryCapacity;          ///< Capacity of pstEntry
+    AtlasPage         astPage[ATLAS_PAGES_MAX];  ///< Atlas pages
+    Uint8             u8PageCount;               ///< Number of atlas pages
+    SDL_bool          bIsPacked;                 ///< Entry positions are valid
+    SDL_bool          bIsUploaded;               ///< Page textures have been created
+
+} SpriteAtlas;
+
+Sint32 SpriteAtlas_Add(const char* pacFileName, const SDL_Rect* pstSrc, SpriteAtlas* pstAtlas);
+void   SpriteAtlas_Free(SpriteAtlas* pstAtlas);
+Sint8  SpriteAtlas_Init(SpriteAtlas** pstAtlas);
+Sint8  SpriteAtlas_Load(const char* pacFileName, SpriteAtlas* pstAtlas);
+Sint8  SpriteAtlas_Pack(SDL_Renderer* pstRenderer, SpriteAtlas* pstAtlas);
+Sint8  SpriteAtlas_Save(const char* pacFileName, const SpriteAtlas* pstAtlas);
@@ -0,0 +1,354 @@
+// SPDX-License-Identifier: Beerware
+/**
+ * @file      SpriteBatch.c
+ * @ingroup   SpriteBatch
+ * @defgroup  SpriteBatch Sprite batch
+ * @author    Michael Fitzmayer
+ * @copyright "THE BEER-WARE LICENCE" (Revision 42)
+ */
+
+#include <SDL.h>
+#include "SpriteBatch.h"
+
+static int _CompareQuads(const void* pA, const void* pB)
+{
+    const SpriteQuad* pstA = pA;
+    const SpriteQuad* pstB = pB;
+
+    if (pstA->s16Layer != pstB->s16Layer)
+    {
+        return (pstA->s16Layer < pstB->s16Layer) ? -1 : 1;
+    }
+
+    if (pstA->pstTexture != pstB->pstTexture)
+    {
+        return ((uintptr_t)pstA->pstTexture < (uintptr_t)pstB->pstTexture) ? -1 : 1;
+    }
+
+    return (pstA->u32Order < pstB->u32Order) ? -1 : (pstA->u32Order > pstB->u32Order);
+}
+
+static Sint8 _DrawRun(
+    const Uint32  u32First,
+    const Uint32  u32Count,
+    SDL_Renderer* pstRenderer,
+    SpriteBatch*  pstBatch)
+{
+    SDL_Texture* pstTexture = pstBatch->pstQuad[u32First].pstTexture;
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    SDL_Vertex* pstVertex = &pstBatch->pstVertex[u32First * 4];
+    int         iTextureWidth;
+    int         iTextureHeight;
+    float       fScaleX;
+    float       fScaleY;
+
+    if (0 != SDL_QueryTexture(pstTexture, NULL, NULL, &iTextureWidth, &iTextureHeight))
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+        return -1;
+    }
+
+    fScaleX = 1.f / (float)iTextureWidth;
+    fScaleY = 1.f / (float)iTextureHeight;
+
+    for (Uint32 u32Index = 0; u32Index < u32Count; u32Index++)
+    {
+        const SpriteQuad* pstQuad   = &pstBatch->pstQuad[u32First + u32Index];
+        SDL_Vertex*       pstCorner = &pstVertex[u32Index * 4];
+        float             fLeft     = (float)pstQuad->stDst.x;
+        float             fTop      = (float)pstQuad->stDst.y;
+        float             fRight    = fLeft + (float)pstQuad->stDst.w;
+        float             fBottom   = fTop + (float)pstQuad->stDst.h;
+        float             fU0       = (float)pstQuad->stSrc.x * fScaleX;
+        float             fV0       = (float)pstQuad->stSrc.y * fScaleY;
+        float             fU1       = (float)(pstQuad->stSrc.x + pstQuad->stSrc.w) * fScaleX;
+        float             fV1       = (float)(pstQuad->stSrc.y + pstQuad->stSrc.h) * fScaleY;
+
+        if (pstQuad->u8Flip & SDL_FLIP_HORIZONTAL)
+        {
+            float fSwap = fU0;
+            fU0         = fU1;
+            fU1         = fSwap;
+        }
+
+        if (pstQuad->u8Flip & SDL_FLIP_VERTICAL)
+        {
+            float fSwap = fV0;
+            fV0         = fV1;
+            fV1         = fSwap;
+        }
+
+        pstCorner[0].position.x  = fLeft;
+        pstCorner[0].position.y  = fTop;
+        pstCorner[0].tex_coord.x = fU0;
+        pstCorner[0].tex_coord.y = fV0;
+        pstCorner[1].position.x  = fRight;
+        pstCorner[1].position.y  = fTop;
+        pstCorner[1].tex_coord.x = fU1;
+        pstCorner[1].tex_coord.y = fV0;
+        pstCorner[2].position.x  = fRight;
+        pstCorner[2].position.y  = fBottom;
+        pstCorner[2].tex_coord.x = fU1;
+        pstCorner[2].tex_coord.y = fV1;
+        pstCorner[3].position.x  = fLeft;
+        pstCorner[3].position.y  = fBottom;
+        pstCorner[3].tex_coord.x = fU0;
+        pstCorner[3].tex_coord.y = fV1;
+
+        for (Uint8 u8Corner = 0; u8Corner < 4; u8Corner++)
+        {
+            pstCorner[u8Corner].color = pstQuad->stColour;
+        }
+    }
+
+    // The indices of every run start at vertex 0 of the run.
+    if (0 != SDL_RenderGeometry(
+                 pstRenderer,
+                 pstTexture,
+                 pstVertex,
+                 (int)u32Count * 4,
+                 pstBatch->piIndex,
+                 (int)u32Count * 6))
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+        return -1;
+    }
+    pstBatch->u32DrawCalls++;
+#else
+    for (Uint32 u32Index = 0; u32Index < u32Count; u32Index++)
+    {
+        const SpriteQuad* pstQuad = &pstBatch->pstQuad[u32First + u32Index];
+
+        SDL_SetTextureColorMod(
+            pstTexture, pstQuad->stColour.r, pstQuad->stColour.g, pstQuad->stColour.b);
+        SDL_SetTextureAlphaMod(pstTexture, pstQuad->stColour.a);
+
+        if (0 != SDL_RenderCopyEx(
+                     pstRenderer,
+                     pstTexture,
+                     &pstQuad->stSrc,
+                     &pstQuad->stDst,
+                     0,
+                     NULL,
+                     (SDL_RendererFlip)pstQuad->u8Flip))
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+            return -1;
+        }
+        pstBatch->u32DrawCalls++;
+    }
+
+    SDL_SetTextureColorMod(pstTexture, 0xff, 0xff, 0xff);
+    SDL_SetTextureAlphaMod(pstTexture, 0xff);
+#endif
+
+    return 0;
+}
+
+/**
+ * @brief   Add quad to sprite batch
+ * @details Queues a textured rectangle for the next SpriteBatch_Draw()
+ * @param   pstTexture
+ *          SDL2 texture
+ * @param   pstSrc
+ *          Source area in the texture, NULL for the entire texture
+ * @param   pstDst
+ *          Destination area on screen
+ * @param   eFlip
+ *          Horizontal and/or vertical mirroring
+ * @param   stColour
+ *          Colour and alpha modulation, white and opaque to draw the
+ *          texture unchanged
+ * @param   s16Layer
+ *          Layer, lower layers are drawn first
+ * @param   pstBatch
+ *          Pointer to sprite batch handle
+ * @return  Error code
+ * @retval   0: OK
+ * @retval  -1: Error, the batch is full or the texture is invalid
+ */
+Sint8 SpriteBatch_Add(
+    SDL_Texture*           pstTexture,
+    const SDL_Rect*        pstSrc,
+    const SDL_Rect*        pstDst,
+    const SDL_RendererFlip eFlip,
+    const SDL_Color        stColour,
+    const Sint16           s16Layer,
+    SpriteBatch*           pstBatch)
+{
+    SpriteQuad* pstQuad;
+
+    if (pstBatch->u32Count >= pstBatch->u32Capacity)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "AddToSpriteBatch(): sprite batch is full.\n");
+        return -1;
+    }
+
+    pstQuad = &pstBatch->pstQuad[pstBatch->u32Count];
+
+    if (pstSrc)
+    {
+        pstQuad->stSrc = *pstSrc;
+    }
+    else
+    {
+        pstQuad->stSrc.x = 0;
+        pstQuad->stSrc.y = 0;
+
+        if (0 != SDL_QueryTexture(pstTexture, NULL, NULL, &pstQuad->stSrc.w, &pstQuad->stSrc.h))
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+            return -1;
+        }
+    }
+
+    pstQuad->pstTexture = pstTexture;
+    pstQuad->stDst      = *pstDst;
+    pstQuad->stColour   = stColour;
+    pstQuad->u32Order   = pstBatch->u32Count;
+    pstQuad->s16Layer   = s16Layer;
+    pstQuad->u8Flip     = (Uint8)eFlip;
+    pstBatch->u32Count++;
+
+    return 0;
+}
+
+/**
+ * @brief   Draw sprite batch
+ * @details Draws and then removes all queued quads
+ * @remark  Quads are sorted by layer and texture.  Quads of the same
+ *          layer and texture keep their submission order; the order of
+ *          different textures on the same layer is unspecified.  With
+ *          SDL 2.0.18 or newer, each run of quads sharing a layer and a
+ *          texture is submitted as one SDL_RenderGeometry() call, see
+ *          SpriteBatch_t::u32DrawCalls.
+ * @param   pstRenderer
+ *          Pointer to SDL2 rendering context
+ * @param   pstBatch
+ *          Pointer to sprite batch handle
+ * @return  Error code
+ * @retval   0: OK
+ * @retval  -1: Error
+ */
+Sint8 SpriteBatch_Draw(SDL_Renderer* pstRenderer, SpriteBatch* pstBatch)
+{
+    Uint32 u32First = 0;
+    Sint8  s8Return = 0;
+
+    pstBatch->u32DrawCalls = 0;
+
+    SDL_qsort(pstBatch->pstQuad, pstBatch->u32Count, sizeof(struct SpriteQuad_t), _CompareQuads);
+
+    for (Uint32 u32Index = 1; u32Index <= pstBatch->u32Count; u32Index++)
+    {
+        const SpriteQuad* pstFirst = &pstBatch->pstQuad[u32First];
+
+        if (u32Index < pstBatch->u32Count &&
+            pstBatch->pstQuad[u32Index].s16Layer == pstFirst->s16Layer &&
+            pstBatch->pstQuad[u32Index].pstTexture == pstFirst->pstTexture)
+        {
+            continue;
+        }
+
+        if (-1 == _DrawRun(u32First, u32Index - u32First, pstRenderer, pstBatch))
+        {
+            s8Return = -1;
+            break;
+        }
+        u32First = u32Index;
+    }
+
+    pstBatch->u32Count = 0;
+
+    return s8Return;
+}
+
+/**
+ * @brief   Free sprite batch
+ * @details Frees up allocated memory and unloads sprite batch
+ * @param   pstBatch
+ *          Pointer to sprite batch handle
+ */
+void SpriteBatch_Free(SpriteBatch* pstBatch)
+{
+    if (pstBatch)
+    {
+        SDL_free(pstBatch->pstQuad);
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+        SDL_free(pstBatch->pstVertex);
+        SDL_free(pstBatch->piIndex);
+#endif
+        SDL_free(pstBatch);
+    }
+}
+
+/**
+ * @brief   Initialise sprite batch
+ * @details Initialises an empty sprite batch with a fixed capacity
+ * @remark  The batch replaces one SDL_RenderCopyEx() call per sprite,
+ *          e.g. of Entity_Draw(), with one draw call per layer and
+ *          texture, see Entity_AddToBatch().
+ * @param   u32Capacity
+ *          Max. number of quads per frame
+ * @param   pstBatch
+ *          Pointer to sprite batch handle
+ * @return  Error code
+ * @retval   0: OK
+ * @retval  -1: Error
+ */
+Sint8 SpriteBatch_Init(const Uint32 u32Capacity, SpriteBatch** pstBatch)
+{
+    *pstBatch = SDL_calloc(sizeof(struct SpriteBatch_t), sizeof(Sint8));
+    if (!*pstBatch)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InitSpriteBatch(): error allocating memory.\n");
+        return -1;
+    }
+
+    // Vertex and index counts are passed to SDL as int.
+    if (0 == u32Capacity || u32Capacity > SDL_MAX_SINT32 / 6)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InitSpriteBatch(): invalid capacity.\n");
+        SpriteBatch_Free(*pstBatch);
+        *pstBatch = NULL;
+        return -1;
+    }
+
+    (*pstBatch)->u32Capacity = u32Capacity;
+    (*pstBatch)->pstQuad     = SDL_calloc(u32Capacity, sizeof(struct SpriteQuad_t));
+    if (!(*pstBatch)->pstQuad)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InitSpriteBatch(): error allocating memory.\n");
+        SpriteBatch_Free(*pstBatch);
+        *pstBatch = NULL;
+        return -1;
+    }
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    (*pstBatch)->pstVertex = SDL_calloc((size_t)u32Capacity * 4, sizeof(SDL_Vertex));
+    (*pstBatch)->piIndex   = SDL_calloc((size_t)u32Capacity * 6, sizeof(int));
+    if (!(*pstBatch)->pstVertex || !(*pstBatch)->piIndex)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InitSpriteBatch(): error allocating memory.\n");
+        SpriteBatch_Free(*pstBatch);
+        *pstBatch = NULL;
+        return -1;
+    }
+
+    for (Uint32 u32Index = 0; u32Index < u32Capacity; u32Index++)
+    {
+        int* piQuad = &(*pstBatch)->piIndex[u32Index * 6];
+        int  iFirst = (int)u32Index * 4;
+
+        piQuad[0] = iFirst;
+        piQuad[1] = iFirst + 1;
+        piQuad[2] = iFirst + 2;
+        piQuad[3] = iFirst;
+        piQuad[4] = iFirst + 2;
+        piQuad[5] = iFirst + 3;
+    }
+#endif
+
+    return 0;
+}
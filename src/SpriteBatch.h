@@ -0,0 +1,59 @@
+// SPDX-License-Identifier: Beerware
+/**
+ * @file    SpriteBatch.h
+ * @brief   Sprite batch include header
+ * @ingroup SpriteBatch
+ */
+#pragma once
+
+#include <SDL.h>
+
+/**
+ * @typedef SpriteQuad
+ * @brief   Sprite quad handle type
+ * @struct  SpriteQuad_t
+ * @brief   Textured rectangle queued for drawing
+ */
+typedef struct SpriteQuad_t
+{
+    SDL_Texture* pstTexture;  ///< SDL2 texture
+    SDL_Rect     stSrc;       ///< Source area in the texture
+    SDL_Rect     stDst;       ///< Destination area on screen
+    SDL_Color    stColour;    ///< Colour and alpha modulation
+    Uint32       u32Order;    ///< Submission order, keeps the sort stable
+    Sint16       s16Layer;    ///< Layer, lower layers are drawn first
+    Uint8        u8Flip;      ///< SDL_RendererFlip flags
+
+} SpriteQuad;
+
+/**
+ * @typedef SpriteBatch
+ * @brief   Sprite batch handle type
+ * @struct  SpriteBatch_t
+ * @brief   Sprite batch handle data
+ */
+typedef struct SpriteBatch_t
+{
+    Uint32      u32Capacity;   ///< Max. number of quads per frame
+    Uint32      u32Count;      ///< Number of queued quads
+    Uint32      u32DrawCalls;  ///< Draw calls issued by the last SpriteBatch_Draw()
+    SpriteQuad* pstQuad;       ///< Queued quads
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    SDL_Vertex* pstVertex;     ///< Vertex buffer, four vertices per quad
+    int*        piIndex;       ///< Index buffer, two triangles per quad
+#endif
+
+} SpriteBatch;
+
+Sint8 SpriteBatch_Add(
+    SDL_Texture*           pstTexture,
+    const SDL_Rect*        pstSrc,
+    const SDL_Rect*        pstDst,
+    const SDL_RendererFlip eFlip,
+    const SDL_Color        stColour,
+    const Sint16           s16Layer,
+    SpriteBatch*           pstBatch);
+
+Sint8 SpriteBatch_Draw(SDL_Renderer* pstRenderer, SpriteBatch* pstBatch);
+void  SpriteBatch_Free(SpriteBatch* pstBatch);
+Sint8 SpriteBatch_Init(const Uint32 u32Capacity, SpriteBatch** pstBatch);
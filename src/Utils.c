@@ -7,9 +7,72 @@
  * @copyright "THE BEER-WARE LICENCE" (Revision 42)
  */
 
+#if defined(__unix__) || defined(__APPLE__)
+#define _POSIX_C_SOURCE 200112L
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define USE_MMAP
+#endif
+
 #include <SDL.h>
+#include "Pack.h"
 #include "Utils.h"
 
+static Sint8 _CopyIndexed(
+    const SDL_Surface* pstSrc,
+    const SDL_Rect*    pstArea,
+    const int          iPosX,
+    const int          iPosY,
+    SDL_Surface*       pstDst)
+{
+    const SDL_Palette* pstPalette = pstSrc->format->palette;
+    Uint8              u8Bits     = pstSrc->format->BitsPerPixel;
+    Uint8              u8Mask     = (Uint8)((1 << u8Bits) - 1);
+    SDL_bool           bIsLsb     = SDL_BITMAPORDER_1234 == SDL_PIXELORDER(pstSrc->format->format);
+    Uint32             u32Key     = 0;
+    SDL_bool           bHasKey;
+
+    if (!pstPalette || 4 != pstDst->format->BytesPerPixel || u8Bits > 8)
+    {
+        SDL_SetError("Utils_CopySurfaceArea(): unsupported indexed pixel format.");
+        return -1;
+    }
+
+    bHasKey = 0 == SDL_GetColorKey((SDL_Surface*)pstSrc, &u32Key) ? SDL_TRUE : SDL_FALSE;
+
+    // Look the colours up by hand: converting the surface with SDL
+    // temporarily changes its blit mapping, which other threads use.
+    for (int iRow = 0; iRow < pstArea->h; iRow++)
+    {
+        const Uint8* pu8Row  = (const Uint8*)pstSrc->pixels + (pstArea->y + iRow) * pstSrc->pitch;
+        Uint32*      pu32Dst =
+            (Uint32*)((Uint8*)pstDst->pixels + (iPosY + iRow) * pstDst->pitch) + iPosX;
+
+        for (int iColumn = 0; iColumn < pstArea->w; iColumn++)
+        {
+            int   iBit    = (pstArea->x + iColumn) * u8Bits;
+            int   iShift  = bIsLsb ? iBit % 8 : 8 - u8Bits - (iBit % 8);
+            Uint8 u8Index = (Uint8)((pu8Row[iBit / 8] >> iShift) & u8Mask);
+
+            if ((bHasKey && u8Index == u32Key) || u8Index >= pstPalette->ncolors)
+            {
+                pu32Dst[iColumn] = SDL_MapRGBA(pstDst->format, 0, 0, 0, 0);
+            }
+            else
+            {
+                const SDL_Color* pstColour = &pstPalette->colors[u8Index];
+
+                pu32Dst[iColumn] = SDL_MapRGBA(
+                    pstDst->format, pstColour->r, pstColour->g, pstColour->b, pstColour->a);
+            }
+        }
+    }
+
+    return 0;
+}
+
 /**
  * @brief   Clear flag
  * @details Clears specific flag in bit/flag field
@@ -23,6 +86,115 @@ void Utils_ClearFlag(const Uint8 u8Bit, Uint16* pu16Flags)
     *pu16Flags &= ~(1 << u8Bit);
 }
 
+/**
+ * @brief   Copy surface area
+ * @details Copies an area of a surface as is, including its alpha
+ *          channel, without touching the blend mode of the source.
+ *          Indexed sources are expanded through their palette; pixels
+ *          of their colour key become transparent.
+ * @param   pstSrc
+ *          Pointer to source surface; it is only read, so it may be
+ *          shared with other threads
+ * @param   pstArea
+ *          Area of the source surface, NULL for all of it
+ * @param   iPosX
+ *          Destination position along the x-axis
+ * @param   iPosY
+ *          Destination position along the y-axis
+ * @param   pstDst
+ *          Pointer to destination surface
+ * @return  Error code
+ * @retval  0:  OK
+ * @retval  -1: Error, see SDL_GetError()
+ * @remark  Neither surface may be RLE-encoded and the area has to fit
+ *          into both surfaces.
+ */
+Sint8 Utils_CopySurfaceArea(
+    const SDL_Surface* pstSrc,
+    const SDL_Rect*    pstArea,
+    const int          iPosX,
+    const int          iPosY,
+    SDL_Surface*       pstDst)
+{
+    SDL_Rect     stArea = { 0, 0, pstSrc->w, pstSrc->h };
+    const Uint8* pu8Src;
+    Uint8*       pu8Dst;
+
+    if (pstArea)
+    {
+        stArea = *pstArea;
+    }
+
+    if (SDL_MUSTLOCK(pstSrc) || SDL_MUSTLOCK(pstDst))
+    {
+        SDL_SetError("Utils_CopySurfaceArea(): RLE-encoded surfaces are not supported.");
+        return -1;
+    }
+
+    if (stArea.x < 0 || stArea.y < 0 || stArea.w < 0 || stArea.h < 0 || iPosX < 0 || iPosY < 0 ||
+        stArea.x + stArea.w > pstSrc->w || stArea.y + stArea.h > pstSrc->h ||
+        iPosX + stArea.w > pstDst->w || iPosY + stArea.h > pstDst->h)
+    {
+        SDL_SetError("Utils_CopySurfaceArea(): area exceeds the surfaces.");
+        return -1;
+    }
+
+    // SDL_ConvertPixels() does not support indexed formats, which may
+    // also pack several pixels into one byte.
+    if (SDL_ISPIXELFORMAT_INDEXED(pstSrc->format->format))
+    {
+        return _CopyIndexed(pstSrc, &stArea, iPosX, iPosY, pstDst);
+    }
+
+    pu8Src = (const Uint8*)pstSrc->pixels + stArea.y * pstSrc->pitch +
+             stArea.x * pstSrc->format->BytesPerPixel;
+    pu8Dst = (Uint8*)pstDst->pixels + iPosY * pstDst->pitch + iPosX * pstDst->format->BytesPerPixel;
+
+    if (0 != SDL_ConvertPixels(
+                 stArea.w,
+                 stArea.h,
+                 pstSrc->format->format,
+                 pu8Src,
+                 pstSrc->pitch,
+                 pstDst->format->format,
+                 pu8Dst,
+                 pstDst->pitch))
+    {
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief   Get view size
+ * @details Determines the size of the area the renderer draws to: the
+ *          logical size if one is set, the output size otherwise
+ * @param   pstRenderer
+ *          Pointer to SDL2 rendering context
+ * @param   ps32ViewWidth
+ *          Pointer to store the view width in pixel
+ * @param   ps32ViewHeight
+ *          Pointer to store the view height in pixel
+ * @return  Error code
+ * @retval  0:  OK
+ * @retval  -1: Error
+ */
+Sint8 Utils_GetViewSize(SDL_Renderer* pstRenderer, Sint32* ps32ViewWidth, Sint32* ps32ViewHeight)
+{
+    SDL_RenderGetLogicalSize(pstRenderer, ps32ViewWidth, ps32ViewHeight);
+    if (0 == *ps32ViewWidth || 0 == *ps32ViewHeight)
+    {
+        if (0 != SDL_GetRendererOutputSize(pstRenderer, ps32ViewWidth, ps32ViewHeight))
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
 /**
  * @brief   Check if flag is set
  * @details Checks whether a specific flag is set or not
@@ -46,6 +218,202 @@ SDL_bool Utils_IsFlagSet(const Uint8 u8Bit, Uint16 u16Flags)
     }
 }
 
+/**
+ * @brief   Map file into memory
+ * @details Maps a file into memory for in-place use.  The mapping is
+ *          private: the content may be modified without the changes
+ *          being written back to the file.
+ * @param   pacFileName
+ *          Path and filename of the file to map
+ * @param   pstFile
+ *          Pointer to mapped file handle
+ * @return  Error code
+ * @retval  0:  OK
+ * @retval  -1: Error
+ * @remark  On platforms without mmap() (and if mapping fails, e.g.
+ *          for files inside an Android APK) the file is read into
+ *          memory instead, as are files contained in the default asset
+ *          archive.  Release the file with Utils_UnmapFile().
+ */
+Sint8 Utils_MapFile(const char* pacFileName, MappedFile* pstFile)
+{
+    const Pack* pstPack = Pack_GetDefaultPack();
+    SDL_RWops*  pstRW;
+    Sint64      s64Size;
+
+    pstFile->pData     = NULL;
+    pstFile->zSize     = 0;
+    pstFile->bIsMapped = SDL_FALSE;
+
+    #ifdef USE_MMAP
+    if (!Pack_Contains(pacFileName, pstPack))
+    {
+        struct stat stStat;
+        int         nFd = open(pacFileName, O_RDONLY);
+
+        if (-1 != nFd)
+        {
+            if (0 == fstat(nFd, &stStat) && stStat.st_size > 0)
+            {
+                void* pData = mmap(
+                    NULL, stStat.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, nFd, 0);
+
+                if (MAP_FAILED != pData)
+                {
+                    pstFile->pData     = pData;
+                    pstFile->zSize     = stStat.st_size;
+                    pstFile->bIsMapped = SDL_TRUE;
+                }
+            }
+            close(nFd);
+
+            if (pstFile->bIsMapped)
+            {
+                return 0;
+            }
+        }
+    }
+    #endif
+
+    pstRW = Pack_OpenRW(pacFileName, pstPack);
+    if (!pstRW)
+    {
+        return -1;
+    }
+
+    s64Size = SDL_RWsize(pstRW);
+    if (s64Size <= 0)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "MapFile(): %s is empty.\n", pacFileName);
+        SDL_RWclose(pstRW);
+        return -1;
+    }
+
+    pstFile->pData = SDL_malloc(s64Size);
+    if (!pstFile->pData)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "MapFile(): error allocating memory.\n");
+        SDL_RWclose(pstRW);
+        return -1;
+    }
+
+    if (1 != SDL_RWread(pstRW, pstFile->pData, s64Size, 1))
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s\n", SDL_GetError());
+        SDL_free(pstFile->pData);
+        pstFile->pData = NULL;
+        SDL_RWclose(pstRW);
+        return -1;
+    }
+
+    pstFile->zSize = s64Size;
+    SDL_RWclose(pstRW);
+
+    return 0;
+}
+
+/**
+ * @brief   Normalise path
+ * @details Converts backslashes to slashes and removes empty and "."
+ *          segments as well as ".." segments together with the segment
+ *          they follow, so that different spellings of the same path
+ *          compare equal
+ * @param   pacFileName
+ *          Path and filename to normalise
+ * @param   zPathLen
+ *          Size of pacPath in bytes
+ * @param   pacPath
+ *          Pointer to the normalised path
+ * @return  Whether the normalised path fits into pacPath
+ */
+SDL_bool Utils_NormalisePath(const char* pacFileName, const size_t zPathLen, char* pacPath)
+{
+    const char* pacSegment = pacFileName;
+    size_t      zLength    = 0;
+    size_t      zRoot      = 0;
+
+    if ('/' == *pacSegment || '\\' == *pacSegment)
+    {
+        pacPath[0] = '/';
+        zLength    = 1;
+        zRoot      = 1;
+    }
+
+    for (;;)
+    {
+        size_t   zSegment = 0;
+        size_t   zStart   = zLength;
+        SDL_bool bIsUp    = SDL_FALSE;
+
+        while ('/' == *pacSegment || '\\' == *pacSegment)
+        {
+            pacSegment++;
+        }
+
+        if ('\0' == *pacSegment)
+        {
+            break;
+        }
+
+        while ('\0' != pacSegment[zSegment] && '/' != pacSegment[zSegment] &&
+               '\\' != pacSegment[zSegment])
+        {
+            zSegment++;
+        }
+
+        if (1 == zSegment && '.' == pacSegment[0])
+        {
+            pacSegment += zSegment;
+            continue;
+        }
+
+        // Drop the previous segment unless there is none or it is
+        // another "..".
+        while (zStart > zRoot && '/' != pacPath[zStart - 1])
+        {
+            zStart--;
+        }
+
+        if (2 == zSegment && '.' == pacSegment[0] && '.' == pacSegment[1] && zLength > zRoot)
+        {
+            bIsUp = SDL_TRUE;
+            if (2 == zLength - zStart && 0 == SDL_strncmp(&pacPath[zStart], "..", 2))
+            {
+                bIsUp = SDL_FALSE;
+            }
+        }
+
+        if (bIsUp)
+        {
+            zLength = (zStart > zRoot) ? zStart - 1 : zStart;
+        }
+        else
+        {
+            size_t zSeparator = (zLength > zRoot) ? 1 : 0;
+
+            if (zLength + zSeparator + zSegment >= zPathLen)
+            {
+                return SDL_FALSE;
+            }
+
+            if (zSeparator)
+            {
+                pacPath[zLength] = '/';
+                zLength++;
+            }
+
+            SDL_memcpy(&pacPath[zLength], pacSegment, zSegment);
+            zLength += zSegment;
+        }
+
+        pacSegment += zSegment;
+    }
+
+    pacPath[zLength] = '\0';
+
+    return SDL_TRUE;
+}
+
 /**
  * @brief   Set flag
  * @details Sets specific flag in bit/flag field
@@ -72,6 +440,37 @@ void Utils_ToggleFlag(const Uint8 u8Bit, Uint16* pu16Flags)
     *pu16Flags ^= 1 << u8Bit;
 }
 
+/**
+ * @brief   Unmap file
+ * @details Releases a file mapped by Utils_MapFile()
+ * @param   pstFile
+ *          Pointer to mapped file handle
+ */
+void Utils_UnmapFile(MappedFile* pstFile)
+{
+    if (!pstFile->pData)
+    {
+        return;
+    }
+
+    #ifdef USE_MMAP
+    if (pstFile->bIsMapped)
+    {
+        munmap(pstFile->pData, pstFile->zSize);
+    }
+    else
+    {
+        SDL_free(pstFile->pData);
+    }
+    #else
+    SDL_free(pstFile->pData);
+    #endif
+
+    pstFile->pData     = NULL;
+    pstFile->zSize     = 0;
+    pstFile->bIsMapped = SDL_FALSE;
+}
+
 /**
  * @brief   Round to integral value
  * @details Round to integral value, regardless of rounding direction
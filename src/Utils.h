@@ -15,9 +15,39 @@
  */
 #define RETURN_ON_ERROR(value) if (-1 == value) { return value; }
 
-void     Utils_ClearFlag(const Uint8 u8Bit, Uint16* pu16Flags);
+/**
+ * @typedef MappedFile
+ * @brief   Mapped file handle type
+ * @struct  MappedFile_t
+ * @brief   Mapped file data
+ */
+typedef struct MappedFile_t
+{
+    void*    pData;      ///< File content
+    size_t   zSize;      ///< File size in bytes
+    SDL_bool bIsMapped;  ///< Content is memory-mapped rather than read into memory
+
+} MappedFile;
+
+void Utils_ClearFlag(const Uint8 u8Bit, Uint16* pu16Flags);
+
+Sint8 Utils_CopySurfaceArea(
+    const SDL_Surface* pstSrc,
+    const SDL_Rect*    pstArea,
+    const int          iPosX,
+    const int          iPosY,
+    SDL_Surface*       pstDst);
+
+Sint8 Utils_GetViewSize(
+    SDL_Renderer* pstRenderer,
+    Sint32*       ps32ViewWidth,
+    Sint32*       ps32ViewHeight);
+
 SDL_bool Utils_IsFlagSet(const Uint8 u8Bit, Uint16 u16Flags);
+Sint8    Utils_MapFile(const char* pacFileName, MappedFile* pstFile);
+SDL_bool Utils_NormalisePath(const char* pacFileName, const size_t zPathLen, char* pacPath);
 void     Utils_SetFlag(const Uint8 u8Bit, Uint16* pu16Flags);
 void     Utils_ToggleFlag(const Uint8 u8Bit, Uint16* pu16Flags);
+void     Utils_UnmapFile(MappedFile* pstFile);
 double   Utils_Round(double dValue);
 Uint32   Utils_Xorshift(Uint32* pu32State);
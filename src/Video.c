@@ -9,6 +9,7 @@
 
 #include <SDL.h>
 #include <SDL_image.h>
+#include "Asset.h"
 #include "Video.h"
 #include "Constants.h"
 
@@ -20,6 +21,9 @@
  */
 void Video_Free(Video* pstVideo)
 {
+    // Cached textures are tied to the renderer.
+    Asset_Purge(ASSET_TEXTURE, Asset_GetDefaultCache());
+
     IMG_Quit();
     if (pstVideo)
     {
@@ -0,0 +1,486 @@
+// SPDX-License-Identifier: Beerware
+/**
+ * @file      World.c
+ * @ingroup   World
+ * @defgroup  World World streaming
+ * @author    Michael Fitzmayer
+ * @copyright "THE BEER-WARE LICENCE" (Revision 42)
+ */
+
+#include <SDL.h>
+#include "Utils.h"
+#include "World.h"
+
+static WorldRegion* _FindRegion(const Sint32 s32RegionX, const Sint32 s32RegionY, World* pstWorld)
+{
+    for (Uint16 u16Index = 0; u16Index < pstWorld->u16RegionCount; u16Index++)
+    {
+        WorldRegion* pstRegion = &pstWorld->pstRegion[u16Index];
+
+        if (pstRegion->bIsUsed && s32RegionX == pstRegion->s32RegionX &&
+            s32RegionY == pstRegion->s32RegionY)
+        {
+            return pstRegion;
+        }
+    }
+
+    return NULL;
+}
+
+static void _EvictRegion(WorldRegion* pstRegion)
+{
+    if (pstRegion->pstLoader)
+    {
+        Map_CancelAsync(pstRegion->pstLoader);
+        pstRegion->pstLoader = NULL;
+    }
+
+    if (pstRegion->pstMap)
+    {
+        SDL_Log(
+            "Unload world region %d, %d.\n", pstRegion->s32RegionX, pstRegion->s32RegionY);
+        Map_Free(pstRegion->pstMap);
+        pstRegion->pstMap = NULL;
+    }
+
+    pstRegion->bIsUsed = SDL_FALSE;
+}
+
+static WorldRegion* _GetFreeRegion(World* pstWorld)
+{
+    WorldRegion* pstLeastUsed = NULL;
+
+    // Prefer empty slots, then the least recently used region that is
+    // not needed for the current update and not still loading.
+    for (Uint16 u16Index = 0; u16Index < pstWorld->u16RegionCount; u16Index++)
+    {
+        WorldRegion* pstRegion = &pstWorld->pstRegion[u16Index];
+
+        if (!pstRegion->bIsUsed)
+        {
+            return pstRegion;
+        }
+
+        if (pstRegion->u32LastUsed == pstWorld->u32Update || pstRegion->pstLoader)
+        {
+            continue;
+        }
+
+        if (!pstLeastUsed || pstRegion->u32LastUsed < pstLeastUsed->u32LastUsed)
+        {
+            pstLeastUsed = pstRegion;
+        }
+    }
+
+    if (pstLeastUsed)
+    {
+        _EvictRegion(pstLeastUsed);
+    }
+
+    return pstLeastUsed;
+}
+
+static Sint8 _LoadRegion(const Sint32 s32RegionX, const Sint32 s32RegionY, World* pstWorld)
+{
+    WorldRegion* pstRegion = _GetFreeRegion(pstWorld);
+    char         acFileName[MAP_PATH_LEN];
+    char         acBakedFile[MAP_PATH_LEN];
+
+    // All slots are needed; the region is loaded once one gets free.
+    if (!pstRegion)
+    {
+        return 0;
+    }
+
+    SDL_snprintf(acFileName, MAP_PATH_LEN, pstWorld->acPattern, s32RegionX, s32RegionY);
+    SDL_snprintf(acBakedFile, MAP_PATH_LEN, "%s.bin", acFileName);
+
+    pstRegion->s32RegionX  = s32RegionX;
+    pstRegion->s32RegionY  = s32RegionY;
+    pstRegion->u32LastUsed = pstWorld->u32Update;
+    pstRegion->bIsUsed     = SDL_TRUE;
+
+    if (-1 == Map_InitAsync(
+            acFileName, NULL, acBakedFile, pstWorld->u8MeterInPixel, &pstRegion->pstLoader))
+    {
+        pstRegion->bIsUsed = SDL_FALSE;
+        return -1;
+    }
+
+    return 0;
+}
+
+static Sint8 _FinishRegion(WorldRegion* pstRegion, World* pstWorld, SDL_Renderer* pstRenderer)
+{
+    MapLoader* pstLoader = pstRegion->pstLoader;
+
+    pstRegion->pstLoader = NULL;
+
+    // A missing or broken region stays resident as an empty region so
+    // it is not loaded over and over again.
+    if (-1 == Map_FinalizeAsync(pstLoader, &pstRegion->pstMap, pstRenderer))
+    {
+        SDL_LogError(
+            SDL_LOG_CATEGORY_APPLICATION,
+            "World region %d, %d is not available.\n",
+            pstRegion->s32RegionX,
+            pstRegion->s32RegionY);
+        return 0;
+    }
+
+    pstRegion->pstMap->dPosX = (double)pstRegion->s32RegionX * pstWorld->u32RegionWidth;
+    pstRegion->pstMap->dPosY = (double)pstRegion->s32RegionY * pstWorld->u32RegionHeight;
+
+    // Keeps the texture memory of a region bounded no matter its size.
+    if (-1 == Map_EnableChunkCache(
+            pstWorld->u16ChunkSize, pstWorld->u32ChunkBudget, pstRegion->pstMap))
+    {
+        return -1;
+    }
+
+    SDL_Log("Load world region %d, %d.\n", pstRegion->s32RegionX, pstRegion->s32RegionY);
+
+    return 0;
+}
+
+/**
+ * @brief   Draw world
+ * @details Draws all resident regions of the world
+ * @param   u16Index
+ *          The texture index, see Map_Draw()
+ * @param   bRenderAnimTiles
+ *          If set to 1, all animated tiles will be updated and
+ *          rendered in this call.
+ * @param   bRenderBgColour
+ *          Determine if the maps' background colour should be rendered
+ * @param   pacLayerName
+ *          Sub-string of the layer(s) to render
+ * @param   dCameraPosX
+ *          Camera position along the x-axis in world coordinates
+ * @param   dCameraPosY
+ *          Camera position along the y-axis in world coordinates
+ * @param   pstWorld
+ *          Pointer to world handle
+ * @param   pstRenderer
+ *          Pointer to SDL2 rendering context
+ * @return  Error code
+ * @retval  0:  OK
+ * @retval  -1: Error
+ */
+Sint8 World_Draw(
+    const Uint16   u16Index,
+    const SDL_bool bRenderAnimTiles,
+    const SDL_bool bRenderBgColour,
+    const char*    pacLayerName,
+    const double   dCameraPosX,
+    const double   dCameraPosY,
+    World*         pstWorld,
+    SDL_Renderer*  pstRenderer)
+{
+    for (Uint16 u16Region = 0; u16Region < pstWorld->u16RegionCount; u16Region++)
+    {
+        WorldRegion* pstRegion = &pstWorld->pstRegion[u16Region];
+
+        if (!pstRegion->pstMap)
+        {
+            continue;
+        }
+
+        if (-1 == Map_Draw(
+                u16Index,
+                bRenderAnimTiles,
+                bRenderBgColour,
+                pacLayerName,
+                dCameraPosX,
+                dCameraPosY,
+                pstRegion->pstMap,
+                pstRenderer))
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief   Configure chunk cache of world regions
+ * @details Changes the chunk cache of all resident and future regions,
+ *          see Map_EnableChunkCache()
+ * @param   u16ChunkSize
+ *          Chunk edge length in tiles
+ * @param   u32MemoryBudget
+ *          Texture memory budget per region in bytes
+ * @param   pstWorld
+ *          Pointer to world handle
+ * @return  Error code
+ * @retval  0:  OK
+ * @retval  -1: Error
+ * @remark  Regions always use a chunk cache, so they are never
+ *          pre-rendered into textures of their full size.  By default,
+ *          it uses WORLD_CHUNK_SIZE and WORLD_CHUNK_BUDGET.
+ */
+Sint8 World_EnableChunkCache(
+    const Uint16 u16ChunkSize,
+    const Uint32 u32MemoryBudget,
+    World*       pstWorld)
+{
+    pstWorld->u16ChunkSize   = u16ChunkSize;
+    pstWorld->u32ChunkBudget = u32MemoryBudget;
+
+    for (Uint16 u16Region = 0; u16Region < pstWorld->u16RegionCount; u16Region++)
+    {
+        Map* pstMap = pstWorld->pstRegion[u16Region].pstMap;
+
+        if (pstMap && -1 == Map_EnableChunkCache(u16ChunkSize, u32MemoryBudget, pstMap))
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief   Free world
+ * @details Frees up allocated memory and unloads all regions
+ * @param   pstWorld
+ *          Pointer to world handle
+ */
+void World_Free(World* pstWorld)
+{
+    if (pstWorld)
+    {
+        for (Uint16 u16Region = 0; pstWorld->pstRegion && u16Region < pstWorld->u16RegionCount;
+             u16Region++)
+        {
+            _EvictRegion(&pstWorld->pstRegion[u16Region]);
+        }
+
+        SDL_free(pstWorld->pstRegion);
+        SDL_free(pstWorld);
+        SDL_Log("Unload world.\n");
+    }
+}
+
+/**
+ * @brief   Get map at world position
+ * @details Returns the resident region map covering a position
+ * @param   dPosX
+ *          Position along the x-axis in world coordinates
+ * @param   dPosY
+ *          Position along the y-axis in world coordinates
+ * @param   pstWorld
+ *          Pointer to world handle
+ * @return  Pointer to map handle, NULL if the region is not resident
+ * @remark  Map functions expect positions relative to the map, i.e.
+ *          minus the map's dPosX and dPosY.  Type and object IDs are
+ *          specific to each region map.
+ */
+Map* World_GetMapAt(const double dPosX, const double dPosY, const World* pstWorld)
+{
+    Sint32 s32RegionX = SDL_floor(dPosX / pstWorld->u32RegionWidth);
+    Sint32 s32RegionY = SDL_floor(dPosY / pstWorld->u32RegionHeight);
+
+    for (Uint16 u16Region = 0; u16Region < pstWorld->u16RegionCount; u16Region++)
+    {
+        const WorldRegion* pstRegion = &pstWorld->pstRegion[u16Region];
+
+        if (pstRegion->pstMap && s32RegionX == pstRegion->s32RegionX &&
+            s32RegionY == pstRegion->s32RegionY)
+        {
+            return pstRegion->pstMap;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief   Initialise world
+ * @details Initialises a streamed world made of equally sized regions
+ * @param   pacPattern
+ *          File name pattern of the region TMX maps; the region
+ *          position along the x-axis and y-axis is inserted for the
+ *          first and second %d, e.g. "res/maps/world_%d_%d.tmx"
+ * @param   u32RegionWidth
+ *          Region width in pixel
+ * @param   u32RegionHeight
+ *          Region height in pixel
+ * @param   u16RegionCount
+ *          Max. number of resident regions; bounds the memory used by
+ *          the world regardless of its size
+ * @param   u8MeterInPixel
+ *          Definition of meter in pixel
+ * @param   pstWorld
+ *          Pointer to world handle
+ * @return  Error code
+ * @retval  0:  OK
+ * @retval  -1: Error
+ * @remark  Each region is baked next to its TMX map (".bin" suffix) on
+ *          first use and loaded from the baked map afterwards.
+ *          Regions without a map file are treated as empty.
+ */
+Sint8 World_Init(
+    const char*  pacPattern,
+    const Uint32 u32RegionWidth,
+    const Uint32 u32RegionHeight,
+    const Uint16 u16RegionCount,
+    const Uint8  u8MeterInPixel,
+    World**      pstWorld)
+{
+    if (0 == u32RegionWidth || 0 == u32RegionHeight || 0 == u16RegionCount)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InitWorld(): invalid region size.\n");
+        return -1;
+    }
+
+    *pstWorld = SDL_calloc(sizeof(struct World_t), sizeof(Sint8));
+    if (!*pstWorld)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InitWorld(): error allocating memory.\n");
+        return -1;
+    }
+
+    (*pstWorld)->pstRegion = SDL_calloc(u16RegionCount, sizeof(struct WorldRegion_t));
+    if (!(*pstWorld)->pstRegion)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "InitWorld(): error allocating memory.\n");
+        return -1;
+    }
+
+    SDL_strlcpy((*pstWorld)->acPattern, pacPattern, MAP_PATH_LEN);
+    (*pstWorld)->u16RegionCount  = u16RegionCount;
+    (*pstWorld)->u32RegionWidth  = u32RegionWidth;
+    (*pstWorld)->u32RegionHeight = u32RegionHeight;
+    (*pstWorld)->u16ChunkSize    = WORLD_CHUNK_SIZE;
+    (*pstWorld)->u32ChunkBudget  = WORLD_CHUNK_BUDGET;
+    (*pstWorld)->u8MeterInPixel  = u8MeterInPixel;
+
+    SDL_Log("Initialise world: %s.\n", pacPattern);
+
+    return 0;
+}
+
+/**
+ * @brief   Determine if world coordinate is of specific tile type
+ * @details Determines if a world coordinate is of a specific tile type
+ * @param   pacType
+ *          The tile type name to check for
+ * @param   pstWorld
+ *          Pointer to world handle
+ * @param   dPosX
+ *          Position along the x-axis in world coordinates
+ * @param   dPosY
+ *          Position along the y-axis in world coordinates
+ * @return  Boolean state
+ * @retval  SDL_TRUE:  Coordinate is of specific type
+ * @retval  SDL_FALSE: Coordinate is not of specific type or its region
+ *          is not resident
+ */
+SDL_bool World_IsCoordOfType(
+    const char*  pacType,
+    const World* pstWorld,
+    const double dPosX,
+    const double dPosY)
+{
+    const Map* pstMap = World_GetMapAt(dPosX, dPosY, pstWorld);
+
+    if (!pstMap)
+    {
+        return SDL_FALSE;
+    }
+
+    return Map_IsCoordOfType(pacType, pstMap, dPosX - pstMap->dPosX, dPosY - pstMap->dPosY);
+}
+
+/**
+ * @brief   Update world
+ * @details Streams regions around the camera: regions in view and one
+ *          region beyond in every direction are loaded asynchronously,
+ *          the least recently used ones are evicted to make room.
+ * @param   dCameraPosX
+ *          Camera position along the x-axis in world coordinates
+ * @param   dCameraPosY
+ *          Camera position along the y-axis in world coordinates
+ * @param   pstWorld
+ *          Pointer to world handle
+ * @param   pstRenderer
+ *          Pointer to SDL2 rendering context
+ * @return  Error code
+ * @retval  0:  OK
+ * @retval  -1: Error
+ * @remark  Call once per frame before World_Draw().  Regions become
+ *          collidable once they have been loaded.
+ */
+Sint8 World_Update(
+    const double  dCameraPosX,
+    const double  dCameraPosY,
+    World*        pstWorld,
+    SDL_Renderer* pstRenderer)
+{
+    Sint32 s32ViewWidth  = 0;
+    Sint32 s32ViewHeight = 0;
+    Sint32 s32FirstX;
+    Sint32 s32FirstY;
+    Sint32 s32LastX;
+    Sint32 s32LastY;
+
+    if (-1 == Utils_GetViewSize(pstRenderer, &s32ViewWidth, &s32ViewHeight))
+    {
+        return -1;
+    }
+
+    pstWorld->u32Update++;
+
+    // Finish regions loaded in the meantime.
+    for (Uint16 u16Region = 0; u16Region < pstWorld->u16RegionCount; u16Region++)
+    {
+        WorldRegion* pstRegion = &pstWorld->pstRegion[u16Region];
+
+        if (pstRegion->pstLoader && Map_IsAsyncDone(pstRegion->pstLoader))
+        {
+            if (-1 == _FinishRegion(pstRegion, pstWorld, pstRenderer))
+            {
+                return -1;
+            }
+        }
+    }
+
+    s32FirstX = SDL_floor(dCameraPosX / pstWorld->u32RegionWidth) - 1;
+    s32FirstY = SDL_floor(dCameraPosY / pstWorld->u32RegionHeight) - 1;
+    s32LastX  = SDL_floor((dCameraPosX + s32ViewWidth - 1) / pstWorld->u32RegionWidth) + 1;
+    s32LastY  = SDL_floor((dCameraPosY + s32ViewHeight - 1) / pstWorld->u32RegionHeight) + 1;
+
+    // Mark all needed regions first so none of them gets evicted.
+    for (Sint32 s32RegionY = s32FirstY; s32RegionY <= s32LastY; s32RegionY++)
+    {
+        for (Sint32 s32RegionX = s32FirstX; s32RegionX <= s32LastX; s32RegionX++)
+        {
+            WorldRegion* pstRegion = _FindRegion(s32RegionX, s32RegionY, pstWorld);
+
+            if (pstRegion)
+            {
+                pstRegion->u32LastUsed = pstWorld->u32Update;
+            }
+        }
+    }
+
+    for (Sint32 s32RegionY = s32FirstY; s32RegionY <= s32LastY; s32RegionY++)
+    {
+        for (Sint32 s32RegionX = s32FirstX; s32RegionX <= s32LastX; s32RegionX++)
+        {
+            if (_FindRegion(s32RegionX, s32RegionY, pstWorld))
+            {
+                continue;
+            }
+
+            if (-1 == _LoadRegion(s32RegionX, s32RegionY, pstWorld))
+            {
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,100 @@
+// SPDX-License-Identifier: Beerware
+/**
+ * @file    World.h
+ * @brief   World streaming include header
+ * @ingroup World
+ */
+#pragma once
+
+#include <SDL.h>
+#include "Map.h"
+
+/**
+ * @typedef WorldConstants
+ * @brief   World constants handle type
+ * @enum    WorldConstants_t
+ * @brief   World constants enumeration
+ */
+typedef enum WorldConstants_t
+{
+    WORLD_CHUNK_SIZE   = 16,               ///< Default chunk edge length in tiles
+    WORLD_CHUNK_BUDGET = 16 * 1024 * 1024  ///< Default chunk cache budget per region in bytes
+
+} WorldConstants;
+
+/**
+ * @typedef WorldRegion
+ * @brief   World region handle type
+ * @struct  WorldRegion_t
+ * @brief   Resident world region data
+ */
+typedef struct WorldRegion_t
+{
+    Map*       pstMap;       ///< Region map, NULL if loading or missing
+    MapLoader* pstLoader;    ///< Pending load, NULL if none
+    Sint32     s32RegionX;   ///< Region position along the x-axis in regions
+    Sint32     s32RegionY;   ///< Region position along the y-axis in regions
+    Uint32     u32LastUsed;  ///< Update in which the region was last needed
+    SDL_bool   bIsUsed;      ///< Slot holds a region
+
+} WorldRegion;
+
+/**
+ * @typedef World
+ * @brief   World handle type
+ * @struct  World_t
+ * @brief   World handle data
+ * @details A world is a grid of equally sized TMX maps (regions).  Only
+ *          a fixed number of regions around the camera is resident.
+ */
+typedef struct World_t
+{
+    char         acPattern[MAP_PATH_LEN];  ///< Region file name pattern
+    WorldRegion* pstRegion;                ///< Region slots
+    Uint16       u16RegionCount;           ///< Number of region slots
+    Uint32       u32RegionWidth;           ///< Region width in pixel
+    Uint32       u32RegionHeight;          ///< Region height in pixel
+    Uint32       u32Update;                ///< Update counter
+    Uint16       u16ChunkSize;             ///< Chunk edge length in tiles
+    Uint32       u32ChunkBudget;           ///< Chunk cache budget per region in bytes
+    Uint8        u8MeterInPixel;           ///< Definition of meter in pixel
+
+} World;
+
+Sint8 World_Draw(
+    const Uint16   u16Index,
+    const SDL_bool bRenderAnimTiles,
+    const SDL_bool bRenderBgColour,
+    const char*    pacLayerName,
+    const double   dCameraPosX,
+    const double   dCameraPosY,
+    World*         pstWorld,
+    SDL_Renderer*  pstRenderer);
+
+Sint8 World_EnableChunkCache(
+    const Uint16 u16ChunkSize,
+    const Uint32 u32MemoryBudget,
+    World*       pstWorld);
+
+void World_Free(World* pstWorld);
+Map* World_GetMapAt(const double dPosX, const double dPosY, const World* pstWorld);
+
+Sint8 World_Init(
+    const char*  pacPattern,
+    const Uint32 u32RegionWidth,
+    const Uint32 u32RegionHeight,
+    const Uint16 u16RegionCount,
+    const Uint8  u8MeterInPixel,
+    World**      pstWorld);
+
+SDL_bool World_IsCoordOfType(
+    const char*  pacType,
+    const World* pstWorld,
+    const double dPosX,
+    const double dPosY);
+
+Sint8 World_Update(
+    const double  dCameraPosX,
+    const double  dCameraPosY,
+    World*        pstWorld,
+    SDL_Renderer* pstRenderer);
@@ -6,11 +6,19 @@
 #pragma once
 
 #include "AABB.h"
+#include "Asset.h"
 #include "Audio.h"
 #include "Background.h"
+#include "Broadphase.h"
 #include "Constants.h"
 #include "Entity.h"
 #include "Font.h"
+#include "Job.h"
 #include "Map.h"
+#include "Pack.h"
+#include "Scalar.h"
+#include "SpriteAtlas.h"
+#include "SpriteBatch.h"
 #include "Utils.h"
 #include "Video.h"
+#include "World.h"
@@ -0,0 +1,48 @@
+// SPDX-License-Identifier: Beerware
+/**
+ * @file      PackTool.c
+ * @brief     Asset archive build tool
+ * @details   Packs the given files into an asset archive, see
+ *            Pack_Build().  Run it from the directory the application
+ *            loads its assets relative to, e.g.
+ *            PackTool -z res.pak res/maps/level.tmx res/images/tileset.png
+ * @author    Michael Fitzmayer
+ * @copyright "THE BEER-WARE LICENCE" (Revision 42)
+ */
+
+#define SDL_MAIN_HANDLED
+#include <stdio.h>
+#include <SDL.h>
+#include "Pack.h"
+
+int main(int argc, char* argv[])
+{
+    SDL_bool bCompress = SDL_FALSE;
+    int      iArchive  = 1;
+
+    if (argc > 1 && 0 == SDL_strcmp(argv[1], "-z"))
+    {
+        bCompress = SDL_TRUE;
+        iArchive  = 2;
+    }
+
+    if (argc - iArchive < 2)
+    {
+        printf("Usage: %s [-z] archive file...\n", argv[0]);
+        printf("  -z  deflate the files that get smaller by it\n");
+        return 1;
+    }
+
+    if (-1 == Pack_Build(
+                  argv[iArchive],
+                  (const char**)&argv[iArchive + 1],
+                  (Uint32)(argc - iArchive - 1),
+                  bCompress))
+    {
+        return 1;
+    }
+
+    printf("Pack %d file(s) into %s.\n", argc - iArchive - 1, argv[iArchive]);
+
+    return 0;
+}